@@ -44,6 +44,7 @@
 
 #include "ojph_base.h"
 #include "ojph_defs.h"
+#include "ojph_codestream.h"
 
 #ifdef OJPH_ENABLE_TIFF_SUPPORT
   #include "tiffio.h"
@@ -360,6 +361,8 @@ namespace ojph {
         bytes_per_sample[i] = 0;
       }
       num_com = 0;
+      frame_size = 0;
+      num_frames = 0;
 
       cur_line = 0;
       last_comp = 0;
@@ -384,6 +387,12 @@ namespace ojph {
     ui32 *get_bit_depth() { assert(fh); return bit_depth; }
     point *get_comp_subsampling() { assert(fh); return subsampling; }
 
+    /** number of complete frames in the file; a file can hold many
+     *  frames stored one after the other */
+    ui64 get_num_frames() { assert(fh); return num_frames; }
+    /** moves to the start of frame; the next read() gets its first line */
+    void seek_frame(ui64 frame);
+
   private:
     FILE *fh;
     const char *fname;
@@ -391,6 +400,7 @@ namespace ojph {
     ui32 width[3], height[3], num_com;
     ui32 bytes_per_sample[3];
     ui32 comp_address[3];
+    ui64 frame_size, num_frames;
 
     ui32 cur_line, last_comp;
     bool planar;
@@ -418,6 +428,8 @@ namespace ojph {
       cur_line = 0;
       buffer = NULL;
       buffer_size = 0;
+      frame_size = 0;
+      num_frames = 0;
     }
     virtual ~raw_in()
     {
@@ -435,6 +447,12 @@ namespace ojph {
     ui32 get_bit_depth() { assert(fh); return bit_depth; }
     bool get_is_signed() { assert(fh); return is_signed; }
 
+    /** number of complete frames in the file; a file can hold many
+     *  frames stored one after the other */
+    ui64 get_num_frames() { assert(fh); return num_frames; }
+    /** moves to the start of frame; the next read() gets its first line */
+    void seek_frame(ui64 frame);
+
   private:
     FILE *fh;
     const char *fname;
@@ -444,6 +462,7 @@ namespace ojph {
     ui32 cur_line;
     void* buffer;
     size_t buffer_size;
+    ui64 frame_size, num_frames;
   };
 
   ////////////////////////////////////////////////////////////////////////////
@@ -581,6 +600,15 @@ namespace ojph {
   public:
     virtual ~image_out_base() {}
     virtual ui32 write(const line_buf* line, ui32 comp_num) = 0;
+    /** a writer whose file holds samples as codestream::pull_stripe()
+     *  stores them returns true, and sets stripe to describe a buffer of
+     *  num_rows rows, laid out as in the file; write_stripe() then writes
+     *  the first num_rows rows of this buffer, which hold component
+     *  comp_num in planar order, or all components otherwise */
+    virtual bool get_stripe(ui32 num_rows, frame_buffer& stripe)
+    { ojph_unused(num_rows); ojph_unused(stripe); return false; }
+    virtual void write_stripe(ui32 comp_num, ui32 num_rows)
+    { ojph_unused(comp_num); ojph_unused(num_rows); }
     virtual void close() {}
   };
 
@@ -617,6 +645,8 @@ namespace ojph {
     void configure(ui32 width, ui32 height, ui32 num_components,
                    ui32 bit_depth);
     virtual ui32 write(const line_buf* line, ui32 comp_num);
+    virtual bool get_stripe(ui32 num_rows, frame_buffer& stripe);
+    virtual void write_stripe(ui32 comp_num, ui32 num_rows);
     virtual void close() { if(fh) { fclose(fh); fh = NULL; } fname = NULL; }
 
   private:
@@ -629,6 +659,7 @@ namespace ojph {
     ui32 cur_line, samples_per_line, bytes_per_line;
     conversion_fun converter;
     const line_buf *lptr[3];
+    frame_component stripe_comps[3];
   };
 
 #ifdef OJPH_ENABLE_TIFF_SUPPORT
@@ -716,8 +747,13 @@ namespace ojph {
     virtual ~yuv_out();
 
     void open(char* filename);
+    /** opens an existing file, without truncating it, and moves to byte
+     *  offset; many objects can then write different frames of one file */
+    void open(char* filename, si64 offset);
     void configure(ui32 bit_depth, ui32 num_components, ui32 *comp_width);
     virtual ui32 write(const line_buf* line, ui32 comp_num);
+    virtual bool get_stripe(ui32 num_rows, frame_buffer& stripe);
+    virtual void write_stripe(ui32 comp_num, ui32 num_rows);
     virtual void close() { if(fh) { fclose(fh); fh = NULL; } fname = NULL; }
 
   private:
@@ -729,6 +765,7 @@ namespace ojph {
     ui32 *comp_width;
     ui8 *buffer;
     ui32 buffer_size;
+    frame_component stripe_comps[3];
   };
 
   ////////////////////////////////////////////////////////////////////////////
@@ -755,8 +792,13 @@ namespace ojph {
     virtual ~raw_out();
 
     void open(char* filename);
+    /** opens an existing file, without truncating it, and moves to byte
+     *  offset; many objects can then write different frames of one file */
+    void open(char* filename, si64 offset);
     void configure(bool is_signed, ui32 bit_depth, ui32 width);
     virtual ui32 write(const line_buf* line, ui32 comp_num = 0);
+    virtual bool get_stripe(ui32 num_rows, frame_buffer& stripe);
+    virtual void write_stripe(ui32 comp_num, ui32 num_rows);
     virtual void close() { if (fh) { fclose(fh); fh = NULL; } fname = NULL; }
 
   private:
@@ -768,6 +810,7 @@ namespace ojph {
     ui32 width;
     ui8* buffer;
     ui32 buffer_size;
+    frame_component stripe_comps[1];
   };
 
   ////////////////////////////////////////////////////////////////////////////
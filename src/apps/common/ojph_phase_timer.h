@@ -0,0 +1,221 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2026, Aous Naman
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_phase_timer.h
+// Author: Aous Naman
+// Date: 19 October 2026
+//***************************************************************************/
+
+#ifndef OJPH_PHASE_TIMER_H
+#define OJPH_PHASE_TIMER_H
+
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+
+#include "ojph_arch.h"
+#include "ojph_defs.h"
+
+#ifdef OJPH_OS_WINDOWS
+  #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+  #endif
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#endif
+
+namespace ojph
+{
+
+  ////////////////////////////////////////////////////////////////////////////
+  /**
+   *  @brief Accumulates the wall-clock and CPU time of the phases of an
+   *         application, such as reading an image or encoding it.
+   *
+   *  One phase is current at a time; next() charges the time since the
+   *  previous transition to the current phase, and makes another phase
+   *  current.  CPU time is that of the calling thread, where the platform
+   *  provides it, so that each thread can own a timer; timers of several
+   *  threads are then combined with add().  A disabled timer reads no
+   *  clocks.
+   */
+  class phase_timer
+  {
+  public:
+    enum : ui32 { MAX_PHASES = 16, NO_PHASE = 0xFFFFFFFF };
+
+  public:
+    phase_timer() : enabled(false), num_phases(0), cur_phase(NO_PHASE),
+                    last_wall(0.0), last_cpu(0.0)
+    {
+      for (ui32 i = 0; i < MAX_PHASES; ++i) {
+        names[i] = NULL;
+        wall[i] = cpu[i] = 0.0;
+      }
+    }
+
+    void enable(bool enable) { enabled = enable; }
+    bool is_enabled() const { return enabled; }
+
+    /** adds a phase, named name, and returns its index */
+    ui32 add_phase(const char *name)
+    {
+      assert(num_phases < MAX_PHASES);
+      names[num_phases] = name;
+      return num_phases++;
+    }
+
+    /** charges the time since the last transition to the current phase,
+     *  if any, and makes phase current; NO_PHASE stops timing */
+    void next(ui32 phase)
+    {
+      if (!enabled)
+        return;
+      double w = get_wall_time(), c = get_cpu_time();
+      if (cur_phase != NO_PHASE) {
+        wall[cur_phase] += w - last_wall;
+        cpu[cur_phase] += c - last_cpu;
+      }
+      last_wall = w;
+      last_cpu = c;
+      cur_phase = phase;
+    }
+
+    /** stops timing, charging the current phase */
+    void stop() { next(NO_PHASE); }
+
+    /** adds the times of other, which must have the same phases */
+    void add(const phase_timer& other)
+    {
+      assert(other.num_phases == num_phases);
+      for (ui32 i = 0; i < num_phases; ++i) {
+        wall[i] += other.wall[i];
+        cpu[i] += other.cpu[i];
+      }
+    }
+
+    ui32 get_num_phases() const { return num_phases; }
+    const char *get_name(ui32 phase) const { return names[phase]; }
+    double get_wall(ui32 phase) const { return wall[phase]; }
+    double get_cpu(ui32 phase) const { return cpu[phase]; }
+
+    /**
+     *  @brief Prints the time of every phase, followed by the total wall
+     *         and CPU time of the process, and the throughput.
+     *
+     *  @param json true to print a JSON object instead of a table.
+     *  @param total_wall seconds elapsed since the start of processing.
+     *  @param total_cpu CPU seconds used by the process, all threads.
+     *  @param num_frames images processed.
+     *  @param num_pixels pixels processed, counting the samples of
+     *         one component per pixel.
+     *  @param num_bytes codestream bytes produced or consumed.
+     */
+    void print(bool json, double total_wall, double total_cpu,
+               ui64 num_frames, ui64 num_pixels, ui64 num_bytes) const
+    {
+      double mps = 0.0, bps = 0.0;
+      if (total_wall > 0.0) {
+        mps = (double)num_pixels / total_wall / 1e6;
+        bps = (double)num_bytes / total_wall;
+      }
+      if (json)
+      {
+        printf("{\n  \"phases\": {\n");
+        for (ui32 i = 0; i < num_phases; ++i)
+          printf("    \"%s\": { \"wall\": %.6f, \"cpu\": %.6f }%s\n",
+            names[i], wall[i], cpu[i], i + 1 < num_phases ? "," : "");
+        printf("  },\n  \"total\": { \"wall\": %.6f, \"cpu\": %.6f },\n",
+          total_wall, total_cpu);
+        printf("  \"frames\": %llu,\n  \"pixels\": %llu,\n"
+          "  \"codestream_bytes\": %llu,\n", (unsigned long long)num_frames,
+          (unsigned long long)num_pixels, (unsigned long long)num_bytes);
+        printf("  \"megapixels_per_second\": %.3f,\n"
+          "  \"bytes_per_second\": %.0f\n}\n", mps, bps);
+      }
+      else
+      {
+        printf("%-16s %12s %12s\n", "phase", "wall (s)", "cpu (s)");
+        for (ui32 i = 0; i < num_phases; ++i)
+          printf("%-16s %12.6f %12.6f\n", names[i], wall[i], cpu[i]);
+        printf("%-16s %12.6f %12.6f\n", "total", total_wall, total_cpu);
+        printf("%llu frame(s), %.3f MP/s, %.0f codestream bytes/s\n",
+          (unsigned long long)num_frames, mps, bps);
+      }
+    }
+
+    /** seconds from a steady clock */
+    static double get_wall_time()
+    {
+      return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /** CPU seconds used by the calling thread, or by the process where
+     *  per-thread time is not available */
+    static double get_cpu_time()
+    {
+#if defined(OJPH_OS_WINDOWS)
+      FILETIME creation, exit_time, kernel, user;
+      if (GetThreadTimes(GetCurrentThread(), &creation, &exit_time, &kernel,
+                         &user))
+      {
+        ui64 k = ((ui64)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime;
+        ui64 u = ((ui64)user.dwHighDateTime << 32) | user.dwLowDateTime;
+        return (double)(k + u) * 1e-7;
+      }
+#elif defined(CLOCK_THREAD_CPUTIME_ID)
+      timespec ts;
+      if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+        return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+      return get_process_cpu_time();
+    }
+
+    /** CPU seconds used by all the threads of the process */
+    static double get_process_cpu_time()
+    {
+      return (double)clock() / CLOCKS_PER_SEC;
+    }
+
+  private:
+    bool enabled;
+    ui32 num_phases, cur_phase;
+    const char *names[MAX_PHASES];
+    double wall[MAX_PHASES], cpu[MAX_PHASES];
+    double last_wall, last_cpu;
+  };
+
+}
+
+#endif // !OJPH_PHASE_TIMER_H
@@ -0,0 +1,271 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2026, Aous Naman
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_size_report.h
+// Author: Aous Naman
+// Date: 19 October 2026
+//***************************************************************************/
+
+#ifndef OJPH_SIZE_REPORT_H
+#define OJPH_SIZE_REPORT_H
+
+#include <cstdio>
+#include <vector>
+
+#include "ojph_defs.h"
+#include "ojph_codestream.h"
+#include "ojph_params.h"
+
+namespace ojph
+{
+
+  ////////////////////////////////////////////////////////////////////////////
+  /**
+   *  @brief Sums the coded sizes of the codeblocks of one or more
+   *         codestreams, per component, resolution, and band, and prints
+   *         them.
+   *
+   *  All the codestreams added to a report must have the same number of
+   *  components and resolutions, such as the frames of a video.  Reports
+   *  of several threads are combined with add().
+   */
+  class coded_size_report
+  {
+  public:
+    enum : ui32 { NUM_BANDS = 4, ALL_BANDS = NUM_BANDS, PER_RES = 5 };
+
+  public:
+    coded_size_report() : num_codestreams(0) {}
+
+    /** adds the sizes of codestream, which must have been flushed, when
+     *  encoding, or created, when decoding */
+    void add(codestream& cs)
+    {
+      if (num_codestreams == 0)
+      {
+        const param_siz siz = cs.get_siz();
+        const param_cod cod = cs.get_cod();
+        for (ui32 i = 0; i < siz.get_num_components(); ++i)
+          num_res.push_back(cod.get_num_decompositions(i) + 1);
+        size_t n = 0;
+        for (size_t i = 0; i < num_res.size(); ++i)
+          n += num_res[i] * PER_RES;
+        stats.resize(n, zero_stats());
+      }
+      std::vector<coded_size_stats>::iterator p = stats.begin();
+      for (ui32 i = 0; i < (ui32)num_res.size(); ++i)
+        for (ui32 r = 0; r < num_res[i]; ++r)
+          for (ui32 b = 0; b < PER_RES; ++b, ++p)
+            accumulate(*p, cs.get_coded_size_stats(i, r,
+              b == ALL_BANDS ? (ui32)coded_size_stats::ALL : b));
+      ++num_codestreams;
+    }
+
+    /** adds the sizes of other, which must have the same components and
+     *  resolutions */
+    void add(const coded_size_report& other)
+    {
+      if (other.num_codestreams == 0)
+        return;
+      if (num_codestreams == 0)
+        *this = other;
+      else {
+        for (size_t i = 0; i < stats.size(); ++i)
+          accumulate(stats[i], other.stats[i]);
+        num_codestreams += other.num_codestreams;
+      }
+    }
+
+    /**
+     *  @brief Prints, for every component, resolution, and band, the
+     *         number of codeblocks, the fraction of zero blocks, the
+     *         average missing MSBs, and the coded bytes, followed by the
+     *         totals and a histogram of codeblock sizes.
+     *
+     *  @param json true to print a JSON object instead of a table.
+     */
+    void print(bool json) const
+    {
+      static const char *band_names[NUM_BANDS] = { "LL", "HL", "LH", "HH" };
+      coded_size_stats total = zero_stats();
+      std::vector<coded_size_stats>::const_iterator p = stats.begin();
+      if (json)
+        printf("{\n  \"codestreams\": %llu,\n  \"components\": [",
+          (unsigned long long)num_codestreams);
+      else
+        printf("%-4s %-3s %-4s %10s %8s %9s %12s %12s\n", "comp", "res",
+          "band", "blocks", "zero", "avg_msbs", "coded_bytes",
+          "packet_bytes");
+      for (ui32 i = 0; i < (ui32)num_res.size(); ++i)
+      {
+        coded_size_stats comp = zero_stats();
+        if (json)
+          printf("%s\n    {\n      \"component\": %u,\n"
+            "      \"resolutions\": [", i ? "," : "", i);
+        for (ui32 r = 0; r < num_res[i]; ++r, p += PER_RES)
+        {
+          accumulate(comp, p[ALL_BANDS]);
+          if (json)
+            printf("%s\n        {\n          \"resolution\": %u,\n"
+              "          \"packet_bytes\": %llu,\n"
+              "          \"bands\": [", r ? "," : "", r,
+              (unsigned long long)p[ALL_BANDS].packet_bytes);
+          bool first = true;
+          for (ui32 b = 0; b < NUM_BANDS; ++b)
+          {
+            if (p[b].num_blocks == 0)
+              continue;
+            if (json)
+              print_json(p[b], first ? "\n" : ",\n", band_names[b],
+                "            ");
+            else
+              print_row(p[b], i, r, band_names[b]);
+            first = false;
+          }
+          if (json)
+            printf("\n          ]\n        }");
+        }
+        if (json)
+          printf("\n      ],\n      \"total\":");
+        else
+          printf("%-4u %-3s %-4s", i, "all", "all");
+        print_totals(comp, json, "      ");
+        if (json)
+          printf("\n    }");
+        accumulate(total, comp);
+      }
+      if (json) {
+        printf("\n  ],\n  \"total\":");
+        print_totals(total, json, "  ");
+        printf(",\n  \"size_histogram\": [");
+        for (ui32 k = 0; k < coded_size_stats::NUM_SIZE_BINS; ++k)
+          printf("%s\n    { \"min_bytes\": %u, \"max_bytes\": %u, "
+            "\"blocks\": %llu }", k ? "," : "", bin_min(k), bin_max(k),
+            (unsigned long long)total.size_histogram[k]);
+        printf("\n  ]\n}\n");
+      }
+      else {
+        printf("%-4s %-3s %-4s", "all", "all", "all");
+        print_totals(total, json, "");
+        printf("\n%-24s %10s\n", "codeblock bytes", "blocks");
+        for (ui32 k = 0; k < coded_size_stats::NUM_SIZE_BINS; ++k)
+        {
+          if (total.size_histogram[k] == 0)
+            continue;
+          char range[32];
+          snprintf(range, sizeof(range), "%u-%u", bin_min(k), bin_max(k));
+          printf("%-24s %10llu\n", range,
+            (unsigned long long)total.size_histogram[k]);
+        }
+      }
+    }
+
+  private:
+    static coded_size_stats zero_stats()
+    {
+      coded_size_stats s;
+      s.num_blocks = s.num_zero_blocks = s.coded_bytes = 0;
+      s.missing_msbs = s.packet_bytes = 0;
+      for (ui32 k = 0; k < coded_size_stats::NUM_SIZE_BINS; ++k)
+        s.size_histogram[k] = 0;
+      return s;
+    }
+
+    static void accumulate(coded_size_stats& dst,
+                           const coded_size_stats& src)
+    {
+      dst.num_blocks += src.num_blocks;
+      dst.num_zero_blocks += src.num_zero_blocks;
+      dst.coded_bytes += src.coded_bytes;
+      dst.missing_msbs += src.missing_msbs;
+      dst.packet_bytes += src.packet_bytes;
+      for (ui32 k = 0; k < coded_size_stats::NUM_SIZE_BINS; ++k)
+        dst.size_histogram[k] += src.size_histogram[k];
+    }
+
+    // the smallest and largest sizes counted by bin k of size_histogram
+    static ui32 bin_min(ui32 k) { return k ? 1u << (k - 1) : 0; }
+    static ui32 bin_max(ui32 k)
+    {
+      if (k + 1 == coded_size_stats::NUM_SIZE_BINS)
+        return 0xFFFFFFFF;
+      return k ? (1u << k) - 1 : 0;
+    }
+
+    static void print_row(const coded_size_stats& s, ui32 comp, ui32 res,
+                          const char *band)
+    {
+      printf("%-4u %-3u %-4s %10llu %7.2f%% %9.3f %12llu\n", comp, res,
+        band, (unsigned long long)s.num_blocks,
+        100.0 * s.get_zero_block_ratio(), s.get_average_missing_msbs(),
+        (unsigned long long)s.coded_bytes);
+    }
+
+    static void print_json(const coded_size_stats& s, const char *sep,
+                           const char *band, const char *indent)
+    {
+      printf("%s%s{ \"band\": \"%s\", \"blocks\": %llu, "
+        "\"zero_blocks\": %llu,\n%s  \"zero_block_ratio\": %.6f, "
+        "\"average_missing_msbs\": %.6f,\n%s  \"coded_bytes\": %llu }",
+        sep, indent, band, (unsigned long long)s.num_blocks,
+        (unsigned long long)s.num_zero_blocks, indent,
+        s.get_zero_block_ratio(), s.get_average_missing_msbs(), indent,
+        (unsigned long long)s.coded_bytes);
+    }
+
+    static void print_totals(const coded_size_stats& s, bool json,
+                             const char *indent)
+    {
+      if (json)
+        printf(" { \"blocks\": %llu, \"zero_blocks\": %llu,\n"
+          "%s  \"zero_block_ratio\": %.6f, \"average_missing_msbs\": %.6f,"
+          "\n%s  \"coded_bytes\": %llu, \"packet_bytes\": %llu }",
+          (unsigned long long)s.num_blocks,
+          (unsigned long long)s.num_zero_blocks, indent,
+          s.get_zero_block_ratio(), s.get_average_missing_msbs(), indent,
+          (unsigned long long)s.coded_bytes,
+          (unsigned long long)s.packet_bytes);
+      else
+        printf(" %10llu %7.2f%% %9.3f %12llu %12llu\n",
+          (unsigned long long)s.num_blocks,
+          100.0 * s.get_zero_block_ratio(), s.get_average_missing_msbs(),
+          (unsigned long long)s.coded_bytes,
+          (unsigned long long)s.packet_bytes);
+    }
+
+  private:
+    ui64 num_codestreams;
+    std::vector<ui32> num_res;               // per component
+    std::vector<coded_size_stats> stats;     // PER_RES per resolution
+  };
+
+}
+
+#endif // !OJPH_SIZE_REPORT_H
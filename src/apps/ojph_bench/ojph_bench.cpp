@@ -0,0 +1,563 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2019, Aous Naman
+// Copyright (c) 2019, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2019, The University of New South Wales, Australia
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_bench.cpp
+// Author: Aous Naman
+// Date: 19 October 2026
+//***************************************************************************/
+
+// Measures end-to-end encoding and decoding throughput with no file I/O or
+// sample format conversion in the timed loop.  A frame is synthesized, or
+// loaded once from a .pgm/.ppm file, into memory; it is then encoded N
+// times into a mem_outfile, and the resulting codestream is decoded N
+// times from a mem_infile, reusing the same codestream object through
+// codestream::restart().  The time spent in each stage is obtained from
+// codestream::get_stats().
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "ojph_arch.h"
+#include "ojph_arg.h"
+#include "ojph_mem.h"
+#include "ojph_img_io.h"
+#include "ojph_file.h"
+#include "ojph_codestream.h"
+#include "ojph_params.h"
+#include "ojph_message.h"
+
+/////////////////////////////////////////////////////////////////////////////
+struct size_interpreter : public ojph::cli_interpreter::arg_inter_base
+{
+  size_interpreter(ojph::size& val) : val(val) {}
+  virtual void operate(const char *str)
+  {
+    const char *next_char = str;
+    if (*next_char != '{')
+      throw "size must start with {";
+    next_char++;
+    char *endptr;
+    val.w = (ojph::ui32)strtoul(next_char, &endptr, 10);
+    if (endptr == next_char)
+      throw "size number is improperly formatted";
+    next_char = endptr;
+    if (*next_char != ',')
+      throw "size must have a "","" between the two numbers";
+    next_char++;
+    val.h = (ojph::ui32)strtoul(next_char, &endptr, 10);
+    if (endptr == next_char)
+      throw "number is improperly formatted";
+    next_char = endptr;
+    if (*next_char != '}')
+      throw "size must end with }";
+    next_char++;
+    if (*next_char != '\0') //must be end of string
+      throw "size has extra characters";
+  }
+  ojph::size& val;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+struct bench_params
+{
+  bench_params()
+  : input_filename(NULL), mode(NULL), placement(NULL), dims(1920, 1080),
+    num_comps(3),
+    bit_depth(8), is_signed(false), tile_size(0, 0), block_size(64, 64),
+    num_decompositions(5), reversible(false), quantization_step(-1.0f),
+    employ_color_transform(-1), num_iterations(10), stage_timing(true),
+    header_cache(false)
+  {}
+
+  char *input_filename;
+  char *mode;
+  char *placement;
+  ojph::size dims;
+  ojph::ui32 num_comps;
+  ojph::ui32 bit_depth;
+  bool is_signed;
+  ojph::size tile_size;
+  ojph::size block_size;
+  ojph::ui32 num_decompositions;
+  bool reversible;
+  float quantization_step;
+  int employ_color_transform;
+  ojph::ui32 num_iterations;
+  bool stage_timing;
+  bool header_cache;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+static
+bool get_arguments(int argc, char *argv[], bench_params& p)
+{
+  ojph::cli_interpreter interpreter;
+  interpreter.init(argc, argv);
+
+  interpreter.reinterpret("-i", p.input_filename);
+  interpreter.reinterpret("-mode", p.mode);
+  interpreter.reinterpret("-placement", p.placement);
+  interpreter.reinterpret("-num_comps", p.num_comps);
+  interpreter.reinterpret("-bit_depth", p.bit_depth);
+  interpreter.reinterpret("-signed", p.is_signed);
+  interpreter.reinterpret("-num_decomps", p.num_decompositions);
+  interpreter.reinterpret("-reversible", p.reversible);
+  interpreter.reinterpret("-qstep", p.quantization_step);
+  interpreter.reinterpret_to_bool("-colour_trans", p.employ_color_transform);
+  interpreter.reinterpret("-iter", p.num_iterations);
+  interpreter.reinterpret("-stage_timing", p.stage_timing);
+  interpreter.reinterpret("-header_cache", p.header_cache);
+
+  size_interpreter dims_interpreter(p.dims);
+  size_interpreter tile_size_interpreter(p.tile_size);
+  size_interpreter block_interpreter(p.block_size);
+  try
+  {
+    interpreter.reinterpret("-dims", &dims_interpreter);
+    interpreter.reinterpret("-tile_size", &tile_size_interpreter);
+    interpreter.reinterpret("-block_size", &block_interpreter);
+  }
+  catch (const char *s)
+  {
+    printf("%s\n",s);
+    return false;
+  }
+
+  if (interpreter.is_exhausted() == false) {
+    printf("The following arguments were not interpreted:\n");
+    ojph::argument t = interpreter.get_argument_zero();
+    t = interpreter.get_next_avail_argument(t);
+    while (t.is_valid()) {
+      printf("%s\n", t.arg);
+      t = interpreter.get_next_avail_argument(t);
+    }
+    return false;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Holds one frame in memory, one plane per component, one si32 per sample;
+// this is the format the codestream exchanges lines in, so the timed loops
+// only need memcpy.
+struct frame
+{
+  ojph::ui32 width, height, num_comps;
+  ojph::ui32 bit_depth;
+  bool is_signed;
+  std::vector<ojph::si32> samples;
+
+  ojph::si32* row(ojph::ui32 comp, ojph::ui32 y)
+  { return samples.data() + ((size_t)comp * height + y) * width; }
+  const ojph::si32* row(ojph::ui32 comp, ojph::ui32 y) const
+  { return samples.data() + ((size_t)comp * height + y) * width; }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// Synthesizes a frame that compresses roughly like natural content: smooth
+// low-frequency structure, a few edges, and a little noise, so that every
+// subband has significant coefficients.
+static
+void synthesize_frame(frame& f)
+{
+  f.samples.resize((size_t)f.num_comps * f.width * f.height);
+  const double max_val = (double)((1ULL << f.bit_depth) - 1);
+  const double offset = f.is_signed ? (double)(1ULL << (f.bit_depth - 1)) : 0;
+  const double noise_amp = max_val / 128.0;
+  ojph::ui32 seed = 0x12345678u;
+  for (ojph::ui32 c = 0; c < f.num_comps; ++c)
+  {
+    double phase = 0.7 * c;
+    for (ojph::ui32 y = 0; y < f.height; ++y)
+    {
+      ojph::si32 *dp = f.row(c, y);
+      double fy = (double)y / (double)f.height;
+      for (ojph::ui32 x = 0; x < f.width; ++x)
+      {
+        double fx = (double)x / (double)f.width;
+        double v = 0.35 + 0.25 * fx + 0.15 * fy
+          + 0.15 * sin(11.0 * fx + phase) * cos(7.0 * fy - phase)
+          + ((((x >> 6) ^ (y >> 6)) & 7) == 0 ? 0.1 : 0.0);
+        seed = seed * 1664525u + 1013904223u;  // LCG
+        double n = ((double)(seed >> 8) / (double)(1u << 24) - 0.5);
+        v = v * max_val + n * noise_amp;
+        v = v < 0.0 ? 0.0 : (v > max_val ? max_val : v);
+        *dp++ = (ojph::si32)floor(v - offset + 0.5);
+      }
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+static
+void load_frame(const char *filename, frame& f)
+{
+  ojph::ppm_in ppm;
+  ppm.open(filename);
+  f.width = ppm.get_width();
+  f.height = ppm.get_height();
+  f.num_comps = ppm.get_num_components();
+  f.bit_depth = ppm.get_bit_depth(0);
+  f.is_signed = ppm.get_is_signed(0);
+  f.samples.resize((size_t)f.num_comps * f.width * f.height);
+
+  ojph::line_buf line;
+  line.size = f.width;
+  line.pre_size = 0;
+  line.flags = ojph::line_buf::LFT_32BIT | ojph::line_buf::LFT_INTEGER;
+  for (ojph::ui32 y = 0; y < f.height; ++y)
+    for (ojph::ui32 c = 0; c < f.num_comps; ++c)
+    {
+      line.i32 = f.row(c, y);
+      ppm.read(&line, c);
+    }
+  ppm.close();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+static
+void configure(ojph::codestream& codestream, const frame& f,
+               const bench_params& p, bool color_transform)
+{
+  ojph::param_siz siz = codestream.access_siz();
+  siz.set_image_extent(ojph::point(f.width, f.height));
+  siz.set_num_components(f.num_comps);
+  for (ojph::ui32 c = 0; c < f.num_comps; ++c)
+    siz.set_component(c, ojph::point(1, 1), f.bit_depth, f.is_signed);
+  siz.set_image_offset(ojph::point(0, 0));
+  siz.set_tile_size(p.tile_size);
+  siz.set_tile_offset(ojph::point(0, 0));
+
+  ojph::param_cod cod = codestream.access_cod();
+  cod.set_num_decomposition(p.num_decompositions);
+  cod.set_block_dims(p.block_size.w, p.block_size.h);
+  cod.set_color_transform(color_transform);
+  cod.set_reversible(p.reversible);
+  if (!p.reversible && p.quantization_step != -1.0f)
+    codestream.access_qcd().set_irrev_quant(p.quantization_step);
+  codestream.set_planar(!color_transform);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+static
+size_t encode_frame(ojph::codestream& codestream, ojph::mem_outfile& file,
+                    const frame& f, const bench_params& p,
+                    bool color_transform, bool reconfigure)
+{
+  codestream.restart();
+  if (reconfigure) // otherwise, the cached header of the last frame is used
+    configure(codestream, f, p, color_transform);
+  file.seek(0, ojph::outfile_base::OJPH_SEEK_SET);
+  codestream.write_headers(&file);
+
+  const size_t row_bytes = f.width * sizeof(ojph::si32);
+  ojph::ui32 next_comp;
+  ojph::line_buf* line = codestream.exchange(NULL, next_comp);
+  if (codestream.is_planar())
+  {
+    for (ojph::ui32 c = 0; c < f.num_comps; ++c)
+      for (ojph::ui32 y = 0; y < f.height; ++y)
+      {
+        memcpy(line->i32, f.row(next_comp, y), row_bytes);
+        line = codestream.exchange(line, next_comp);
+      }
+  }
+  else
+  {
+    for (ojph::ui32 y = 0; y < f.height; ++y)
+      for (ojph::ui32 c = 0; c < f.num_comps; ++c)
+      {
+        memcpy(line->i32, f.row(next_comp, y), row_bytes);
+        line = codestream.exchange(line, next_comp);
+      }
+  }
+  codestream.flush();
+  return (size_t)file.tell();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+static
+void decode_frame(ojph::codestream& codestream, ojph::mem_infile& file,
+                  const std::vector<ojph::ui8>& data, frame& f)
+{
+  codestream.restart();
+  file.open(data.data(), data.size(), true); // codeblocks are used in place
+  codestream.read_headers(&file);
+  codestream.set_planar(!codestream.access_cod().is_using_color_transform());
+  codestream.create();
+
+  const size_t row_bytes = f.width * sizeof(ojph::si32);
+  ojph::ui32 comp;
+  if (codestream.is_planar())
+  {
+    for (ojph::ui32 c = 0; c < f.num_comps; ++c)
+      for (ojph::ui32 y = 0; y < f.height; ++y)
+      {
+        ojph::line_buf *line = codestream.pull(comp);
+        memcpy(f.row(comp, y), line->i32, row_bytes);
+      }
+  }
+  else
+  {
+    for (ojph::ui32 y = 0; y < f.height; ++y)
+      for (ojph::ui32 c = 0; c < f.num_comps; ++c)
+      {
+        ojph::line_buf *line = codestream.pull(comp);
+        memcpy(f.row(comp, y), line->i32, row_bytes);
+      }
+  }
+  codestream.close(); // closes file
+}
+
+/////////////////////////////////////////////////////////////////////////////
+static
+double seconds_since(std::chrono::steady_clock::time_point start)
+{
+  std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+  return d.count();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+static
+void print_report(const char *name, ojph::ui32 num_iterations,
+                  double elapsed, const frame& f, bool stage_timing,
+                  const ojph::codestream_stats& s)
+{
+  double per_frame = elapsed / num_iterations;
+  double mp = (double)f.width * (double)f.height * 1e-6;
+  printf("%s: %.3f ms/frame, %.2f MP/s, %.2f frames/s\n", name,
+    per_frame * 1e3, mp / per_frame, 1.0 / per_frame);
+  if (!stage_timing)
+    return;
+
+  const char *names[] = { "colour", "dwt", "cb_transfer", "block_coding",
+                          "codestream", "other" };
+  double t[6] = { s.colour, s.dwt, s.cb_transfer, s.block_coding,
+                  s.codestream, 0.0 };
+  double sum = 0.0;
+  for (int i = 0; i < 5; ++i)
+    sum += t[i];
+  t[5] = elapsed > sum ? elapsed - sum : 0.0;
+  for (int i = 0; i < 6; ++i)
+    printf("  %-13s %9.3f ms/frame %6.1f%%\n", names[i],
+      t[i] / num_iterations * 1e3, elapsed > 0.0 ? 100.0 * t[i] / elapsed
+                                                 : 0.0);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+int main(int argc, char *argv[]) {
+
+  bench_params p;
+
+  if (argc <= 1) {
+    printf(
+    "\nojph_bench encodes and decodes a frame held in memory a number of\n"
+    "times, and reports throughput and the time spent in each stage.\n"
+    "All of the following arguments have default values (optional):\n"
+    " -i            (None) a .pgm or .ppm file to load into memory; when\n"
+    "               given, -dims, -num_comps, -bit_depth, and -signed\n"
+    "               are taken from the file.  Otherwise, a frame is\n"
+    "               synthesized.\n"
+    " -dims         {x,y} ({1920,1080}) frame width and height.\n"
+    " -num_comps    (3) number of components.\n"
+    " -bit_depth    (8) bit depth of all components, 1 to 31.\n"
+    " -signed       <true | false> (false) signedness of all components.\n"
+    " -tile_size    {x,y} ({0,0}) tile width and height; {0,0} for one\n"
+    "               tile covering the whole frame.\n"
+    " -block_size   {x,y} ({64,64}) codeblock width and height.\n"
+    " -num_decomps  (5) number of decompositions.\n"
+    " -reversible   <true | false> (false) 5/3 reversible or 9/7\n"
+    "               irreversible wavelet.\n"
+    " -qstep        (library default) quantization step size for lossy\n"
+    "               compression.\n"
+    " -colour_trans <true | false> (true when there are 3 or more\n"
+    "               components) employ a colour transform.\n"
+    " -iter         (10) number of timed iterations; one untimed\n"
+    "               iteration precedes them to allocate memory.\n"
+    " -mode         <encode | decode | both> (both) what to time.\n"
+    " -stage_timing <true | false> (true) collect a per-stage breakdown;\n"
+    "               set to false to measure without its small overhead.\n"
+    " -placement    <default | huge | hugetlb | local> (default) how the\n"
+    "               codestream's fixed memory block is allocated; huge\n"
+    "               asks for transparent huge pages, hugetlb for reserved\n"
+    "               huge pages, and local prefaults it on this thread's\n"
+    "               node.\n"
+    " -header_cache <true | false> (false) keep the main header across\n"
+    "               frames; timed frames are encoded without setting the\n"
+    "               parameters again, and decoded without parsing it.\n"
+    "\n"
+    "Run with at least one argument, for example \"-iter 10\".\n"
+    "\n");
+    return -1;
+  }
+  if (!get_arguments(argc, argv, p))
+    return -1;
+
+  try
+  {
+    bool do_encode = true, do_decode = true;
+    if (p.mode != NULL)
+    {
+      if (strcmp(p.mode, "encode") == 0)
+        do_decode = false;
+      else if (strcmp(p.mode, "decode") == 0)
+        do_encode = false;
+      else if (strcmp(p.mode, "both") != 0)
+        OJPH_ERROR(0x04000001, "-mode must be encode, decode, or both\n");
+    }
+    if (p.num_iterations == 0)
+      OJPH_ERROR(0x04000002, "-iter must be larger than 0\n");
+    ojph::ui32 placement = ojph::OJPH_MEM_DEFAULT;
+    if (p.placement != NULL)
+    {
+      if (strcmp(p.placement, "huge") == 0)
+        placement = ojph::OJPH_MEM_HUGE_PAGES;
+      else if (strcmp(p.placement, "hugetlb") == 0)
+        placement = ojph::OJPH_MEM_HUGETLB;
+      else if (strcmp(p.placement, "local") == 0)
+        placement = ojph::OJPH_MEM_LOCAL_NODE;
+      else if (strcmp(p.placement, "default") != 0)
+        OJPH_ERROR(0x04000007,
+          "-placement must be default, huge, hugetlb, or local\n");
+    }
+
+    frame src;
+    if (p.input_filename)
+      load_frame(p.input_filename, src);
+    else
+    {
+      if (p.bit_depth < 1 || p.bit_depth > 31)
+        OJPH_ERROR(0x04000003, "-bit_depth must be between 1 and 31\n");
+      if (p.num_comps < 1 || p.num_comps > 16384)
+        OJPH_ERROR(0x04000004, "-num_comps must be between 1 and 16384\n");
+      if (p.dims.w == 0 || p.dims.h == 0)
+        OJPH_ERROR(0x04000005, "-dims must be larger than {0,0}\n");
+      src.width = p.dims.w;
+      src.height = p.dims.h;
+      src.num_comps = p.num_comps;
+      src.bit_depth = p.bit_depth;
+      src.is_signed = p.is_signed;
+      synthesize_frame(src);
+    }
+
+    bool color_transform = src.num_comps >= 3;
+    if (p.employ_color_transform != -1)
+      color_transform = p.employ_color_transform == 1;
+    if (color_transform && src.num_comps < 3)
+      OJPH_ERROR(0x04000006,
+        "-colour_trans needs 3 or more components\n");
+
+    printf("frame: %ux%u, %u component(s), %u bit %s, %s, %u decomps, "
+      "%ux%u blocks, colour transform %s, cpu ext level %d\n",
+      src.width, src.height, src.num_comps, src.bit_depth,
+      src.is_signed ? "signed" : "unsigned",
+      p.reversible ? "reversible" : "irreversible", p.num_decompositions,
+      p.block_size.w, p.block_size.h, color_transform ? "on" : "off",
+      ojph::get_cpu_ext_level());
+
+    ojph::codestream codestream;
+    codestream.set_fixed_memory_placement(placement);
+    codestream.enable_header_cache(p.header_cache);
+    ojph::mem_outfile out;
+    out.open();
+
+    // the untimed first pass allocates memory and produces the codestream
+    // decoded below
+    size_t num_bytes =
+      encode_frame(codestream, out, src, p, color_transform, true);
+    std::vector<ojph::ui8> coded(out.get_data(), out.get_data() + num_bytes);
+    double bpp = 8.0 * (double)num_bytes / ((double)src.width * src.height);
+    printf("codestream: %zu bytes/frame, %.3f bits/pixel\n", num_bytes, bpp);
+
+    if (do_encode)
+    {
+      codestream.enable_stats(p.stage_timing);
+      codestream.reset_stats();
+      std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+      for (ojph::ui32 i = 0; i < p.num_iterations; ++i)
+        encode_frame(codestream, out, src, p, color_transform,
+          !p.header_cache);
+      double elapsed = seconds_since(start);
+      print_report("encode", p.num_iterations, elapsed, src, p.stage_timing,
+        codestream.get_stats());
+      codestream.enable_stats(false);
+    }
+
+    if (do_decode)
+    {
+      frame dst = src;
+      ojph::mem_infile in;
+      decode_frame(codestream, in, coded, dst); // untimed, allocates memory
+
+      codestream.enable_stats(p.stage_timing);
+      codestream.reset_stats();
+      std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+      for (ojph::ui32 i = 0; i < p.num_iterations; ++i)
+        decode_frame(codestream, in, coded, dst);
+      double elapsed = seconds_since(start);
+      print_report("decode", p.num_iterations, elapsed, src, p.stage_timing,
+        codestream.get_stats());
+      codestream.enable_stats(false);
+
+      // sanity check the decoded frame against the source
+      double sse = 0.0;
+      for (size_t i = 0; i < src.samples.size(); ++i)
+      {
+        double d = (double)dst.samples[i] - (double)src.samples[i];
+        sse += d * d;
+      }
+      if (sse == 0.0)
+        printf("decoded frame: lossless\n");
+      else
+      {
+        double max_val = (double)((1ULL << src.bit_depth) - 1);
+        double mse = sse / (double)src.samples.size();
+        printf("decoded frame: PSNR %.2f dB\n",
+          10.0 * log10(max_val * max_val / mse));
+      }
+    }
+  }
+  catch (const std::exception& e)
+  {
+    const char *p = e.what();
+    if (strncmp(p, "ojph error", 10) != 0)
+      printf("%s\n", p);
+    exit(-1);
+  }
+
+  return 0;
+}
@@ -0,0 +1,1035 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2026, Aous Naman
+// Copyright (c) 2026, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2026, The University of New South Wales, Australia
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_bench_kernels.cpp
+// Author: Aous Naman
+// Date: 19 October 2026
+//***************************************************************************/
+
+// Times every kernel that the library dispatches through function pointers,
+// once for each instruction set extension it has an implementation for and
+// the CPU supports.  Inputs are synthetic, drawn from a two-sided geometric
+// (Laplacian) distribution whose entropy is set by -bits.  The kernels are
+// library internals, and so this executable links to them directly.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#include "ojph_arch.h"
+#include "ojph_arg.h"
+#include "ojph_mem.h"
+#include "ojph_message.h"
+#include "ojph_params.h"
+#include "ojph_params_local.h"
+#include "ojph_codeblock.h"
+#include "ojph_codeblock_fun.h"
+#include "ojph_block_decoder.h"
+#include "ojph_block_encoder.h"
+#include "ojph_colour_local.h"
+#include "ojph_transform_local.h"
+
+#if (defined(OJPH_ARCH_X86_64) || defined(OJPH_ARCH_I386))
+  #ifdef _MSC_VER
+    #include <intrin.h>
+  #else
+    #include <x86intrin.h>
+  #endif
+  #define OJPH_BENCH_HAS_TSC
+#endif
+
+#if !defined(OJPH_DISABLE_SIMD)
+  #if (defined(OJPH_ARCH_X86_64) || defined(OJPH_ARCH_I386))
+    #define OJPH_BENCH_X86
+  #elif defined(OJPH_ARCH_PPC64LE)
+    #define OJPH_BENCH_VSX
+  #endif
+#endif
+
+using namespace ojph;
+using namespace ojph::local;
+
+/////////////////////////////////////////////////////////////////////////////
+struct bench_options
+{
+  ui32 width;        // samples per line
+  float bits;        // approximate entropy of samples, in bits per sample
+  float min_time;    // seconds spent measuring each kernel
+  char* kernel;      // if not NULL, only kernels containing this string
+  char* isa;         // if not NULL, only this instruction set
+};
+
+/////////////////////////////////////////////////////////////////////////////
+//                               timing
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+static inline ui64 read_cycles()
+{
+#ifdef OJPH_BENCH_HAS_TSC
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+/////////////////////////////////////////////////////////////////////////////
+static bool is_selected(const bench_options& opt, const char* kernel,
+                        const char* isa)
+{
+  if (opt.kernel && strstr(kernel, opt.kernel) == NULL)
+    return false;
+  if (opt.isa && strcmp(isa, opt.isa) != 0)
+    return false;
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Calls f() repeatedly and prints the best of a few repetitions, each
+// lasting about opt.min_time / num_reps; samples and bytes are what a
+// single call processes and touches (read plus written).
+template<typename F>
+static void measure(const bench_options& opt, const char* kernel,
+                    const char* isa, double samples, double bytes, F f)
+{
+  const int num_reps = 5;
+  const double rep_time = opt.min_time / num_reps;
+  typedef std::chrono::steady_clock clock;
+
+  if (!is_selected(opt, kernel, isa))
+    return;
+
+  f(); // warm up caches and branch predictors
+  ui64 iters = 1;
+  double best_ns = 0.0, best_cycles = 0.0;
+  for (int r = -1; r < num_reps; ++r)
+  {
+    for (;;)
+    {
+      clock::time_point t0 = clock::now();
+      ui64 c0 = read_cycles();
+      for (ui64 i = iters; i > 0; --i)
+        f();
+      ui64 c1 = read_cycles();
+      clock::time_point t1 = clock::now();
+      double ns = (double)std::chrono::duration_cast<
+        std::chrono::nanoseconds>(t1 - t0).count();
+      if (r < 0 && ns * 1e-9 < rep_time && iters < (1ull << 40)) {
+        iters *= 2;  // still calibrating the number of iterations
+        continue;
+      }
+      if (r >= 0 && (r == 0 || ns < best_ns)) {
+        best_ns = ns;
+        best_cycles = (double)(c1 - c0);
+      }
+      break;
+    }
+  }
+
+  double ns_per_call = best_ns / (double)iters;
+  printf("%-34s %-7s %10.3f", kernel, isa, ns_per_call / samples);
+#ifdef OJPH_BENCH_HAS_TSC
+  printf(" %10.3f", best_cycles / (double)iters / samples);
+#else
+  printf(" %10s", "-");
+#endif
+  printf(" %9.2f\n", bytes / ns_per_call);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//                               inputs
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Two-sided geometric samples; for a scale s >> 1, the entropy is about
+// log2(2 e s) bits, so s = 2^bits / (2 e) gives "bits" bits per sample.
+static void fill_samples(si32* p, size_t count, float bits, si32 max_mag,
+                         ui32 seed)
+{
+  std::mt19937 gen(seed);
+  std::exponential_distribution<double> dist(1.0);
+  const double scale = pow(2.0, (double)bits) / (2.0 * 2.718281828459045);
+  for (size_t i = 0; i < count; ++i)
+  {
+    double m = floor(scale * dist(gen));
+    si32 v = m < (double)max_mag ? (si32)m : max_mag;
+    p[i] = (gen() & 1) ? -v : v;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// An aligned buffer with room before and after, wrapped by a line_buf
+class bench_line
+{
+public:
+  bench_line() : store(NULL) {}
+  ~bench_line() { if (store) ojph_aligned_free(store); }
+
+  template<typename T>
+  void init(ui32 width)
+  {
+    size_t bytes = (width + 2 * (size_t)pad) * sizeof(T);
+    store = ojph_aligned_malloc(byte_alignment, bytes);
+    if (store == NULL)
+      OJPH_ERROR(0x00F00001, "memory allocation failed");
+    memset(store, 0, bytes);
+    line.wrap((T*)store + pad, width + pad, pad);
+  }
+
+  template<typename T>
+  T* data() { return (T*)line.p; }
+
+  line_buf line;
+
+private:
+  static const ui32 pad = 64; // in samples, keeps line data aligned
+  void* store;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+template<typename F>
+struct variant { const char* isa; int level; F fun; };
+
+/////////////////////////////////////////////////////////////////////////////
+static bool is_supported(int level)
+{
+  return get_cpu_ext_level() >= level;
+}
+
+#ifdef OJPH_BENCH_X86
+  #define OJPH_LVL(x) X86_CPU_EXT_LEVEL_##x
+#endif
+#ifdef OJPH_BENCH_VSX
+  #define OJPH_LVL_VSX PPC_CPU_EXT_LEVEL_ARCH_3_00
+#endif
+
+/////////////////////////////////////////////////////////////////////////////
+//                          codeblock kernels
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+static void bench_codeblock(const bench_options& opt)
+{
+  const ui32 w = opt.width;
+  const ui32 cb_w = 64, cb_h = 64, cb_n = cb_w * cb_h;
+
+  // source lines
+  bench_line src32, src16, srcf, src64;
+  src32.init<si32>(w); src16.init<si16>(w); srcf.init<float>(w);
+  src64.init<si64>(w);
+  fill_samples(src32.data<si32>(), w, opt.bits, (1 << 24) - 1, 1);
+  si32 max_mag = 0;
+  for (ui32 i = 0; i < w; ++i) {
+    si32 v = src32.data<si32>()[i];
+    src16.data<si16>()[i] = (si16)ojph_max(-4095, ojph_min(4095, v));
+    srcf.data<float>()[i] = (float)v / (float)(1 << 24);
+    src64.data<si64>()[i] = v;
+    max_mag = ojph_max(max_mag, v < 0 ? -v : v);
+  }
+  ui32 K_max = 2;
+  while (K_max < 30 && (1 << K_max) <= max_mag)
+    ++K_max;
+
+  bench_line dst32, dst64;
+  dst32.init<si32>(w); dst64.init<si64>(w);
+  ui32* dp32 = dst32.data<ui32>();
+  ui64* dp64 = dst64.data<ui64>();
+  alignas(64) ui64 max_val64[4] = { 0 };
+  ui32* max_val32 = (ui32*)max_val64;
+
+  // mem_clear
+  {
+    const variant<mem_clear_fun> v[] = {
+      { "gen", 0, gen_mem_clear },
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_SSE
+      { "sse", OJPH_LVL(SSE), sse_mem_clear },
+  #endif
+  #ifndef OJPH_DISABLE_AVX
+      { "avx", OJPH_LVL(AVX), avx_mem_clear },
+  #endif
+#endif
+#ifdef OJPH_BENCH_VSX
+      { "vsx", OJPH_LVL_VSX, vsx_mem_clear },
+#endif
+    };
+    for (const auto& k : v)
+      if (is_supported(k.level))
+        measure(opt, "mem_clear", k.isa, w, 4.0 * w,
+          [&]() { k.fun(dp32, w * sizeof(ui32)); });
+  }
+
+  // find_max_val
+  {
+    const variant<find_max_val_fun32> v32[] = {
+      { "gen", 0, gen_find_max_val32 },
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_SSE2
+      { "sse2", OJPH_LVL(SSE2), sse2_find_max_val32 },
+  #endif
+  #ifndef OJPH_DISABLE_AVX2
+      { "avx2", OJPH_LVL(AVX2), avx2_find_max_val32 },
+  #endif
+#endif
+#ifdef OJPH_BENCH_VSX
+      { "vsx", OJPH_LVL_VSX, vsx_find_max_val32 },
+#endif
+    };
+    for (const auto& k : v32)
+      if (is_supported(k.level))
+        measure(opt, "find_max_val32 (per call)", k.isa, 1, 32,
+          [&]() { k.fun(max_val32); });
+
+    const variant<find_max_val_fun64> v64[] = {
+      { "gen", 0, gen_find_max_val64 },
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_SSE2
+      { "sse2", OJPH_LVL(SSE2), sse2_find_max_val64 },
+  #endif
+  #ifndef OJPH_DISABLE_AVX2
+      { "avx2", OJPH_LVL(AVX2), avx2_find_max_val64 },
+  #endif
+#endif
+#ifdef OJPH_BENCH_VSX
+      { "vsx", OJPH_LVL_VSX, vsx_find_max_val64 },
+#endif
+    };
+    for (const auto& k : v64)
+      if (is_supported(k.level))
+        measure(opt, "find_max_val64 (per call)", k.isa, 1, 32,
+          [&]() { k.fun(max_val64); });
+  }
+
+  // tx_to_cb and tx_from_cb
+  {
+    const variant<tx_to_cb_fun32> rev_to32[] = {
+      { "gen", 0, gen_rev_tx_to_cb32 },
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_SSE2
+      { "sse2", OJPH_LVL(SSE2), sse2_rev_tx_to_cb32 },
+  #endif
+  #ifndef OJPH_DISABLE_AVX2
+      { "avx2", OJPH_LVL(AVX2), avx2_rev_tx_to_cb32 },
+  #endif
+#endif
+#ifdef OJPH_BENCH_VSX
+      { "vsx", OJPH_LVL_VSX, vsx_rev_tx_to_cb32 },
+#endif
+    };
+    for (const auto& k : rev_to32)
+      if (is_supported(k.level))
+        measure(opt, "rev_tx_to_cb32", k.isa, w, 8.0 * w,
+          [&]() { k.fun(src32.data<si32>(), dp32, K_max, 1.0f, w,
+                        max_val32); });
+
+    const variant<tx_to_cb_fun32> rev_to16[] = {
+      { "gen", 0, gen_rev_tx16_to_cb32 },
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_SSE2
+      { "sse2", OJPH_LVL(SSE2), sse2_rev_tx16_to_cb32 },
+  #endif
+  #ifndef OJPH_DISABLE_AVX2
+      { "avx2", OJPH_LVL(AVX2), avx2_rev_tx16_to_cb32 },
+  #endif
+#endif
+    };
+    for (const auto& k : rev_to16)
+      if (is_supported(k.level))
+        measure(opt, "rev_tx16_to_cb32", k.isa, w, 6.0 * w,
+          [&]() { k.fun(src16.data<si16>(), dp32, 13, 1.0f, w,
+                        max_val32); });
+
+    const variant<tx_to_cb_fun32> irv_to32[] = {
+      { "gen", 0, gen_irv_tx_to_cb32 },
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_SSE2
+      { "sse2", OJPH_LVL(SSE2), sse2_irv_tx_to_cb32 },
+  #endif
+  #ifndef OJPH_DISABLE_AVX2
+      { "avx2", OJPH_LVL(AVX2), avx2_irv_tx_to_cb32 },
+  #endif
+#endif
+#ifdef OJPH_BENCH_VSX
+      { "vsx", OJPH_LVL_VSX, vsx_irv_tx_to_cb32 },
+#endif
+    };
+    for (const auto& k : irv_to32)
+      if (is_supported(k.level))
+        measure(opt, "irv_tx_to_cb32", k.isa, w, 8.0 * w,
+          [&]() { k.fun(srcf.data<float>(), dp32, K_max,
+                        (float)(1 << 24), w, max_val32); });
+
+    const variant<tx_to_cb_fun64> rev_to64[] = {
+      { "gen", 0, gen_rev_tx_to_cb64 },
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_SSE2
+      { "sse2", OJPH_LVL(SSE2), sse2_rev_tx_to_cb64 },
+  #endif
+  #ifndef OJPH_DISABLE_AVX2
+      { "avx2", OJPH_LVL(AVX2), avx2_rev_tx_to_cb64 },
+  #endif
+#endif
+#ifdef OJPH_BENCH_VSX
+      { "vsx", OJPH_LVL_VSX, vsx_rev_tx_to_cb64 },
+#endif
+    };
+    for (const auto& k : rev_to64)
+      if (is_supported(k.level))
+        measure(opt, "rev_tx_to_cb64", k.isa, w, 16.0 * w,
+          [&]() { k.fun(src64.data<si64>(), dp64, K_max, 1.0f, w,
+                        max_val64); });
+
+    // codeblock samples for the transfers back
+    gen_rev_tx_to_cb32(src32.data<si32>(), dp32, K_max, 1.0f, w, max_val32);
+    gen_rev_tx_to_cb64(src64.data<si64>(), dp64, K_max, 1.0f, w, max_val64);
+
+    const variant<tx_from_cb_fun32> rev_from32[] = {
+      { "gen", 0, gen_rev_tx_from_cb32 },
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_SSE2
+      { "sse2", OJPH_LVL(SSE2), sse2_rev_tx_from_cb32 },
+  #endif
+  #ifndef OJPH_DISABLE_AVX2
+      { "avx2", OJPH_LVL(AVX2), avx2_rev_tx_from_cb32 },
+  #endif
+#endif
+#ifdef OJPH_BENCH_VSX
+      { "vsx", OJPH_LVL_VSX, vsx_rev_tx_from_cb32 },
+#endif
+    };
+    for (const auto& k : rev_from32)
+      if (is_supported(k.level))
+        measure(opt, "rev_tx_from_cb32", k.isa, w, 8.0 * w,
+          [&]() { k.fun(dp32, src32.data<si32>(), K_max, 1.0f, w); });
+
+    const variant<tx_from_cb_fun32> rev_from16[] = {
+      { "gen", 0, gen_rev_tx16_from_cb32 },
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_SSE2
+      { "sse2", OJPH_LVL(SSE2), sse2_rev_tx16_from_cb32 },
+  #endif
+  #ifndef OJPH_DISABLE_AVX2
+      { "avx2", OJPH_LVL(AVX2), avx2_rev_tx16_from_cb32 },
+  #endif
+#endif
+    };
+    for (const auto& k : rev_from16)
+      if (is_supported(k.level))
+        measure(opt, "rev_tx16_from_cb32", k.isa, w, 6.0 * w,
+          [&]() { k.fun(dp32, src16.data<si16>(), K_max, 1.0f, w); });
+
+    const variant<tx_from_cb_fun32> irv_from32[] = {
+      { "gen", 0, gen_irv_tx_from_cb32 },
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_SSE2
+      { "sse2", OJPH_LVL(SSE2), sse2_irv_tx_from_cb32 },
+  #endif
+  #ifndef OJPH_DISABLE_AVX2
+      { "avx2", OJPH_LVL(AVX2), avx2_irv_tx_from_cb32 },
+  #endif
+#endif
+#ifdef OJPH_BENCH_VSX
+      { "vsx", OJPH_LVL_VSX, vsx_irv_tx_from_cb32 },
+#endif
+    };
+    for (const auto& k : irv_from32)
+      if (is_supported(k.level))
+        measure(opt, "irv_tx_from_cb32", k.isa, w, 8.0 * w,
+          [&]() { k.fun(dp32, srcf.data<float>(), K_max,
+                        1.0f / (float)(1 << 24), w); });
+
+    const variant<tx_from_cb_fun64> rev_from64[] = {
+      { "gen", 0, gen_rev_tx_from_cb64 },
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_SSE2
+      { "sse2", OJPH_LVL(SSE2), sse2_rev_tx_from_cb64 },
+  #endif
+  #ifndef OJPH_DISABLE_AVX2
+      { "avx2", OJPH_LVL(AVX2), avx2_rev_tx_from_cb64 },
+  #endif
+#endif
+#ifdef OJPH_BENCH_VSX
+      { "vsx", OJPH_LVL_VSX, vsx_rev_tx_from_cb64 },
+#endif
+    };
+    for (const auto& k : rev_from64)
+      if (is_supported(k.level))
+        measure(opt, "rev_tx_from_cb64", k.isa, w, 16.0 * w,
+          [&]() { k.fun(dp64, src64.data<si64>(), K_max, 1.0f, w); });
+
+    measure(opt, "irv_tx_from_cb64", "gen", w, 12.0 * w,
+      [&]() { gen_irv_tx_from_cb64(dp64, srcf.data<float>(), K_max,
+                                   1.0f / (float)(1 << 24), w); });
+  }
+
+  // block encoder and decoder, on a 64x64 codeblock
+  {
+    bench_line cb_src;
+    cb_src.init<si32>(cb_n);
+    fill_samples(cb_src.data<si32>(), cb_n, opt.bits, (1 << 24) - 1, 2);
+    si32 cb_max = 0;
+    for (ui32 i = 0; i < cb_n; ++i)
+      cb_max = ojph_max(cb_max, abs(cb_src.data<si32>()[i]));
+    ui32 cb_K_max = 2;
+    while (cb_K_max < 30 && (1 << cb_K_max) <= cb_max)
+      ++cb_K_max;
+    ui32 missing_msbs = cb_K_max - 1;
+
+    bench_line cb32, cb64, dec32, dec64;
+    cb32.init<si32>(cb_n); cb64.init<si64>(cb_n);
+    dec32.init<si32>(cb_n); dec64.init<si64>(cb_n);
+    bench_line cb_src64, check;
+    cb_src64.init<si64>(cb_n); check.init<si32>(cb_n);
+    for (ui32 i = 0; i < cb_n; ++i)
+      cb_src64.data<si64>()[i] = cb_src.data<si32>()[i];
+    gen_rev_tx_to_cb32(cb_src.data<si32>(), cb32.data<ui32>(), cb_K_max,
+                       1.0f, cb_n, max_val32);
+    gen_rev_tx_to_cb64(cb_src64.data<si64>(), cb64.data<ui64>(), cb_K_max,
+                       1.0f, cb_n, max_val64);
+
+    mem_elastic_allocator elastic(1048576);
+    coded_lists* coded = NULL;
+    ui32 lengths[2] = { 0, 0 };
+
+    initialize_block_encoder_tables();
+    const variant<cb_encoder_fun32> enc32[] = {
+      { "gen", 0, ojph_encode_codeblock32 },
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_AVX2
+      { "avx2", OJPH_LVL(AVX2), ojph_encode_codeblock_avx2 },
+  #endif
+  #if (defined(OJPH_ARCH_X86_64) && !defined(OJPH_DISABLE_AVX512))
+      { "avx512", OJPH_LVL(AVX512), ojph_encode_codeblock_avx512 },
+  #endif
+#endif
+    };
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_AVX2
+    if (is_supported(OJPH_LVL(AVX2)))
+      initialize_block_encoder_tables_avx2();
+  #endif
+  #if (defined(OJPH_ARCH_X86_64) && !defined(OJPH_DISABLE_AVX512))
+    if (is_supported(OJPH_LVL(AVX512)))
+      initialize_block_encoder_tables_avx512();
+  #endif
+#endif
+    for (const auto& k : enc32)
+      if (is_supported(k.level))
+        measure(opt, "encode_cb32", k.isa, cb_n, 4.0 * cb_n,
+          [&]() {
+            k.fun(cb32.data<ui32>(), missing_msbs, 1, cb_w, cb_h, cb_w,
+                  lengths, &elastic, coded);
+            elastic.restart();
+          });
+    measure(opt, "encode_cb64", "gen", cb_n, 8.0 * cb_n,
+      [&]() {
+        ojph_encode_codeblock64(cb64.data<ui64>(), missing_msbs, 1,
+          cb_w, cb_h, cb_w, lengths, &elastic, coded);
+        elastic.restart();
+      });
+
+    // coded data, with the padding the decoders expect around it
+    const int pre = coded_cb_header::prefix_buf_size;
+    const int suf = coded_cb_header::suffix_buf_size;
+    ui8 *coded32 = NULL, *coded64 = NULL;
+    ui32 len32 = 0, len64 = 0;
+    for (int t = 0; t < 2; ++t)
+    {
+      if (t == 0)
+        ojph_encode_codeblock32(cb32.data<ui32>(), missing_msbs, 1, cb_w,
+          cb_h, cb_w, lengths, &elastic, coded);
+      else
+        ojph_encode_codeblock64(cb64.data<ui64>(), missing_msbs, 1, cb_w,
+          cb_h, cb_w, lengths, &elastic, coded);
+      ui8* p = (ui8*)calloc(lengths[0] + pre + suf, 1);
+      if (p == NULL)
+        OJPH_ERROR(0x00F00002, "memory allocation failed");
+      memcpy(p + pre, coded->buf, lengths[0]);
+      elastic.restart();
+      if (t == 0) { coded32 = p; len32 = lengths[0]; }
+      else { coded64 = p; len64 = lengths[0]; }
+    }
+    if (opt.kernel == NULL || strstr("encode_cb decode_cb", opt.kernel))
+      printf("%-34s %.3f bits/sample\n", "  (coded 64x64 codeblock)",
+        8.0 * len32 / cb_n);
+
+    const variant<cb_decoder_fun32> dec32v[] = {
+      { "gen", 0, ojph_decode_codeblock32 },
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_SSSE3
+      { "ssse3", OJPH_LVL(SSSE3), ojph_decode_codeblock_ssse3 },
+  #endif
+  #ifndef OJPH_DISABLE_AVX2
+      { "avx2", OJPH_LVL(AVX2), ojph_decode_codeblock_avx2 },
+  #endif
+#endif
+#ifdef OJPH_BENCH_VSX
+      { "vsx", OJPH_LVL_VSX, ojph_decode_codeblock_vsx },
+#endif
+    };
+    for (const auto& k : dec32v)
+      if (is_supported(k.level))
+      {
+        // decoders add half a quantization step, which the transfer
+        // to samples drops; compare samples
+        bool ok = k.fun(coded32 + pre, dec32.data<ui32>(), missing_msbs, 1,
+          len32, 0, cb_w, cb_h, cb_w, false);
+        gen_rev_tx_from_cb32(dec32.data<ui32>(), check.data<si32>(),
+          cb_K_max, 1.0f, cb_n);
+        if (!ok || memcmp(check.data<si32>(), cb_src.data<si32>(),
+                          cb_n * sizeof(si32)) != 0)
+          OJPH_WARN(0x00F00003, "decode_cb32 (%s) did not reproduce the "
+            "encoded codeblock", k.isa);
+        measure(opt, "decode_cb32", k.isa, cb_n, 4.0 * cb_n + len32,
+          [&]() { k.fun(coded32 + pre, dec32.data<ui32>(), missing_msbs, 1,
+                        len32, 0, cb_w, cb_h, cb_w, false); });
+      }
+    measure(opt, "decode_cb64", "gen", cb_n, 8.0 * cb_n + len64,
+      [&]() { ojph_decode_codeblock64(coded64 + pre, dec64.data<ui64>(),
+                missing_msbs, 1, len64, 0, cb_w, cb_h, cb_w, false); });
+
+    free(coded32);
+    free(coded64);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//                            wavelet kernels
+/////////////////////////////////////////////////////////////////////////////
+
+typedef void (*vert_step_fun)(const lifting_step* s, const line_buf* sig,
+  const line_buf* other, const line_buf* aug, ui32 repeat, bool synthesis);
+typedef void (*vert_times_K_fun)(float K, const line_buf* aug, ui32 repeat);
+typedef void (*horz_ana_fun)(const param_atk* atk, const line_buf* ldst,
+  const line_buf* hdst, const line_buf* src, ui32 width, bool even);
+typedef void (*horz_syn_fun)(const param_atk* atk, const line_buf* dst,
+  const line_buf* lsrc, const line_buf* hsrc, ui32 width, bool even);
+
+/////////////////////////////////////////////////////////////////////////////
+struct wavelet_variant
+{
+  const char* isa;
+  int level;
+  vert_step_fun vert_step;
+  horz_ana_fun horz_ana;
+  horz_syn_fun horz_syn;
+  bool supports_16bit;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+template<typename T>
+static void bench_wavelet_lines(const bench_options& opt, const char* name,
+                                const wavelet_variant& k,
+                                const param_atk* atk, ui32 max_mag)
+{
+  const ui32 w = opt.width;
+  bench_line line[4], ldst, hdst;
+  for (int i = 0; i < 4; ++i)
+    line[i].init<T>(w);
+  ldst.init<T>(w / 2 + 1); hdst.init<T>(w / 2 + 1);
+
+  bench_line s;
+  s.init<si32>(w);
+  for (int i = 0; i < 4; ++i) {
+    fill_samples(s.data<si32>(), w, opt.bits, (si32)max_mag, 10 + i);
+    for (ui32 j = 0; j < w; ++j)
+      line[i].data<T>()[j] = (T)s.data<si32>()[j];
+  }
+
+  const ui32 num_steps = atk->get_num_steps();
+  const double b = (double)sizeof(T);
+  char label[64];
+
+  // analysis followed by synthesis, so that lines do not grow
+  snprintf(label, sizeof(label), "%s_vert_step (per step)", name);
+  measure(opt, label, k.isa, 2.0 * w * num_steps,
+    8.0 * b * w * num_steps,
+    [&]() {
+      for (ui32 j = 0; j < num_steps; ++j)
+        k.vert_step(atk->get_step(num_steps - j - 1), &line[j & 1].line,
+          &line[2 + (j & 1)].line, &line[(j + 1) & 1].line, w, false);
+      for (ui32 j = num_steps; j > 0; --j)
+        k.vert_step(atk->get_step(num_steps - j), &line[(j - 1) & 1].line,
+          &line[2 + ((j - 1) & 1)].line, &line[j & 1].line, w, true);
+    });
+
+  snprintf(label, sizeof(label), "%s_horz_ana", name);
+  measure(opt, label, k.isa, w, 2.0 * b * w,
+    [&]() { k.horz_ana(atk, &ldst.line, &hdst.line, &line[0].line, w,
+                       true); });
+
+  snprintf(label, sizeof(label), "%s_horz_syn", name);
+  measure(opt, label, k.isa, w, 2.0 * b * w,
+    [&]() { k.horz_syn(atk, &line[1].line, &ldst.line, &hdst.line, w,
+                       true); });
+}
+
+/////////////////////////////////////////////////////////////////////////////
+static void bench_wavelet(const bench_options& opt)
+{
+  param_atk atk53_store, atk97_store;
+  const param_atk* atk53 = atk53_store.get_atk(1);
+  const param_atk* atk97 = atk97_store.get_atk(0);
+
+  const wavelet_variant rev[] = {
+    { "gen", 0, gen_rev_vert_step, gen_rev_horz_ana, gen_rev_horz_syn,
+      true },
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_SSE2
+    { "sse2", OJPH_LVL(SSE2),
+      sse2_rev_vert_step, sse2_rev_horz_ana, sse2_rev_horz_syn, true },
+  #endif
+  #ifndef OJPH_DISABLE_AVX2
+    { "avx2", OJPH_LVL(AVX2),
+      avx2_rev_vert_step, avx2_rev_horz_ana, avx2_rev_horz_syn, true },
+  #endif
+  #if (defined(OJPH_ARCH_X86_64) && !defined(OJPH_DISABLE_AVX512))
+    { "avx512", OJPH_LVL(AVX512),
+      avx512_rev_vert_step, avx512_rev_horz_ana, avx512_rev_horz_syn,
+      false },
+  #endif
+#endif
+#ifdef OJPH_BENCH_VSX
+    { "vsx", OJPH_LVL_VSX,
+      vsx_rev_vert_step, vsx_rev_horz_ana, vsx_rev_horz_syn, false },
+#endif
+  };
+  for (const auto& k : rev)
+    if (is_supported(k.level))
+      bench_wavelet_lines<si32>(opt, "rev32", k, atk53, (1 << 24) - 1);
+  for (const auto& k : rev)
+    if (is_supported(k.level) && k.supports_16bit)
+      bench_wavelet_lines<si16>(opt, "rev16", k, atk53, 4095);
+
+  const wavelet_variant irv[] = {
+    { "gen", 0, gen_irv_vert_step, gen_irv_horz_ana, gen_irv_horz_syn,
+      false },
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_SSE
+    { "sse", OJPH_LVL(SSE),
+      sse_irv_vert_step, sse_irv_horz_ana, sse_irv_horz_syn, false },
+  #endif
+  #ifndef OJPH_DISABLE_AVX
+    { "avx", OJPH_LVL(AVX),
+      avx_irv_vert_step, avx_irv_horz_ana, avx_irv_horz_syn, false },
+  #endif
+  #if (defined(OJPH_ARCH_X86_64) && !defined(OJPH_DISABLE_AVX512))
+    { "avx512", OJPH_LVL(AVX512),
+      avx512_irv_vert_step, avx512_irv_horz_ana, avx512_irv_horz_syn,
+      false },
+  #endif
+#endif
+#ifdef OJPH_BENCH_VSX
+    { "vsx", OJPH_LVL_VSX,
+      vsx_irv_vert_step, vsx_irv_horz_ana, vsx_irv_horz_syn, false },
+#endif
+  };
+  for (const auto& k : irv)
+    if (is_supported(k.level))
+      bench_wavelet_lines<float>(opt, "irv", k, atk97, (1 << 24) - 1);
+
+  const variant<vert_times_K_fun> times_K[] = {
+    { "gen", 0, gen_irv_vert_times_K },
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_SSE
+    { "sse", OJPH_LVL(SSE), sse_irv_vert_times_K },
+  #endif
+  #ifndef OJPH_DISABLE_AVX
+    { "avx", OJPH_LVL(AVX), avx_irv_vert_times_K },
+  #endif
+  #if (defined(OJPH_ARCH_X86_64) && !defined(OJPH_DISABLE_AVX512))
+    { "avx512", OJPH_LVL(AVX512), avx512_irv_vert_times_K },
+  #endif
+#endif
+#ifdef OJPH_BENCH_VSX
+    { "vsx", OJPH_LVL_VSX, vsx_irv_vert_times_K },
+#endif
+  };
+  const ui32 w = opt.width;
+  bench_line fl;
+  fl.init<float>(w);
+  for (const auto& k : times_K)
+    if (is_supported(k.level))
+      measure(opt, "irv_vert_times_K", k.isa, w, 8.0 * w,
+        [&]() { k.fun(1.0f, &fl.line, w); });
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//                            colour kernels
+/////////////////////////////////////////////////////////////////////////////
+
+typedef void (*rev_convert_fun)(const line_buf* src_line,
+  const ui32 src_line_offset, line_buf* dst_line,
+  const ui32 dst_line_offset, si64 shift, ui32 width);
+typedef void (*irv_to_float_fun)(const line_buf* src_line,
+  ui32 src_line_offset, line_buf* dst_line, ui32 bit_depth,
+  bool is_signed, ui32 width);
+typedef void (*irv_to_integer_fun)(const line_buf* src_line,
+  line_buf* dst_line, ui32 dst_line_offset, ui32 bit_depth,
+  bool is_signed, ui32 width);
+typedef void (*rct_fun)(const line_buf* a, const line_buf* b,
+  const line_buf* c, line_buf* x, line_buf* y, line_buf* z, ui32 repeat);
+typedef void (*ict_fun)(const float* a, const float* b, const float* c,
+  float* x, float* y, float* z, ui32 repeat);
+
+/////////////////////////////////////////////////////////////////////////////
+struct colour_variant
+{
+  const char* isa;
+  int level;
+  rev_convert_fun rev_convert;
+  rev_convert_fun rev_convert_nlt_type3;
+  irv_to_float_fun irv_convert_to_float;
+  irv_to_integer_fun irv_convert_to_integer;
+  irv_to_float_fun irv_convert_to_float_nlt_type3;
+  irv_to_integer_fun irv_convert_to_integer_nlt_type3;
+  rct_fun rct_forward;
+  rct_fun rct_backward;
+  bool supports_16bit;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+static void bench_colour(const bench_options& opt)
+{
+  const ui32 w = opt.width;
+
+  bench_line in32[3], out32[3], in16[3], fl[6];
+  for (int c = 0; c < 3; ++c)
+  {
+    in32[c].init<si32>(w); out32[c].init<si32>(w); in16[c].init<si16>(w);
+    fl[c].init<float>(w); fl[c + 3].init<float>(w);
+    fill_samples(in32[c].data<si32>(), w, opt.bits, 2047, 20 + c);
+    for (ui32 i = 0; i < w; ++i)
+    {
+      si32 v = in32[c].data<si32>()[i];
+      in16[c].data<si16>()[i] = (si16)v;
+      fl[c].data<float>()[i] = (float)v / 4096.0f;
+    }
+  }
+
+  const colour_variant v[] = {
+    { "gen", 0, gen_rev_convert, gen_rev_convert_nlt_type3,
+      gen_irv_convert_to_float, gen_irv_convert_to_integer,
+      gen_irv_convert_to_float_nlt_type3,
+      gen_irv_convert_to_integer_nlt_type3,
+      gen_rct_forward, gen_rct_backward, true },
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_SSE2
+    { "sse2", OJPH_LVL(SSE2), sse2_rev_convert, sse2_rev_convert_nlt_type3,
+      sse2_irv_convert_to_float, sse2_irv_convert_to_integer,
+      sse2_irv_convert_to_float_nlt_type3,
+      sse2_irv_convert_to_integer_nlt_type3,
+      sse2_rct_forward, sse2_rct_backward, true },
+  #endif
+  #ifndef OJPH_DISABLE_AVX2
+    { "avx2", OJPH_LVL(AVX2), avx2_rev_convert, avx2_rev_convert_nlt_type3,
+      avx2_irv_convert_to_float, avx2_irv_convert_to_integer,
+      avx2_irv_convert_to_float_nlt_type3,
+      avx2_irv_convert_to_integer_nlt_type3,
+      avx2_rct_forward, avx2_rct_backward, true },
+  #endif
+#endif
+#ifdef OJPH_BENCH_VSX
+    { "vsx", OJPH_LVL_VSX, vsx_rev_convert, vsx_rev_convert_nlt_type3,
+      vsx_irv_convert_to_float, vsx_irv_convert_to_integer,
+      vsx_irv_convert_to_float_nlt_type3,
+      vsx_irv_convert_to_integer_nlt_type3,
+      vsx_rct_forward, vsx_rct_backward, false },
+#endif
+  };
+
+  for (const auto& k : v)
+  {
+    if (!is_supported(k.level))
+      continue;
+    measure(opt, "rev_convert", k.isa, w, 8.0 * w,
+      [&]() { k.rev_convert(&in32[0].line, 0, &out32[0].line, 0, -2048,
+                            w); });
+    measure(opt, "rev_convert_nlt_type3", k.isa, w, 8.0 * w,
+      [&]() { k.rev_convert_nlt_type3(&in32[0].line, 0, &out32[0].line, 0,
+                                      -2048, w); });
+    if (k.supports_16bit)
+      measure(opt, "rev_convert (to 16bit)", k.isa, w, 6.0 * w,
+        [&]() { k.rev_convert(&in32[0].line, 0, &in16[1].line, 0, -2048,
+                              w); });
+    measure(opt, "irv_convert_to_float", k.isa, w, 8.0 * w,
+      [&]() { k.irv_convert_to_float(&in32[0].line, 0, &fl[3].line, 12,
+                                     false, w); });
+    measure(opt, "irv_convert_to_integer", k.isa, w, 8.0 * w,
+      [&]() { k.irv_convert_to_integer(&fl[0].line, &out32[0].line, 0, 12,
+                                       false, w); });
+    measure(opt, "irv_convert_to_float_nlt_type3", k.isa, w, 8.0 * w,
+      [&]() { k.irv_convert_to_float_nlt_type3(&in32[0].line, 0,
+                                               &fl[3].line, 12, true, w); });
+    measure(opt, "irv_convert_to_integer_nlt_type3", k.isa, w, 8.0 * w,
+      [&]() { k.irv_convert_to_integer_nlt_type3(&fl[0].line,
+                &out32[0].line, 0, 12, true, w); });
+    measure(opt, "rct_forward", k.isa, w, 24.0 * w,
+      [&]() { k.rct_forward(&in32[0].line, &in32[1].line, &in32[2].line,
+                &out32[0].line, &out32[1].line, &out32[2].line, w); });
+    measure(opt, "rct_backward", k.isa, w, 24.0 * w,
+      [&]() { k.rct_backward(&in32[0].line, &in32[1].line, &in32[2].line,
+                &out32[0].line, &out32[1].line, &out32[2].line, w); });
+    if (k.supports_16bit)
+    {
+      measure(opt, "rct_forward (to 16bit)", k.isa, w, 18.0 * w,
+        [&]() { k.rct_forward(&in32[0].line, &in32[1].line, &in32[2].line,
+                  &in16[0].line, &in16[1].line, &in16[2].line, w); });
+      measure(opt, "rct_backward (from 16bit)", k.isa, w, 18.0 * w,
+        [&]() { k.rct_backward(&in16[0].line, &in16[1].line,
+                  &in16[2].line, &out32[0].line, &out32[1].line,
+                  &out32[2].line, w); });
+    }
+  }
+
+  const variant<ict_fun> ict_fwd[] = {
+    { "gen", 0, gen_ict_forward },
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_SSE
+    { "sse", OJPH_LVL(SSE), sse_ict_forward },
+  #endif
+  #ifndef OJPH_DISABLE_AVX
+    { "avx", OJPH_LVL(AVX), avx_ict_forward },
+  #endif
+#endif
+#ifdef OJPH_BENCH_VSX
+    { "vsx", OJPH_LVL_VSX, vsx_ict_forward },
+#endif
+  };
+  const variant<ict_fun> ict_bwd[] = {
+    { "gen", 0, gen_ict_backward },
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_SSE
+    { "sse", OJPH_LVL(SSE), sse_ict_backward },
+  #endif
+  #ifndef OJPH_DISABLE_AVX
+    { "avx", OJPH_LVL(AVX), avx_ict_backward },
+  #endif
+#endif
+#ifdef OJPH_BENCH_VSX
+    { "vsx", OJPH_LVL_VSX, vsx_ict_backward },
+#endif
+  };
+  float *f[6];
+  for (int c = 0; c < 6; ++c)
+    f[c] = fl[c].data<float>();
+  for (const auto& k : ict_fwd)
+    if (is_supported(k.level))
+      measure(opt, "ict_forward", k.isa, w, 24.0 * w,
+        [&]() { k.fun(f[0], f[1], f[2], f[3], f[4], f[5], w); });
+  for (const auto& k : ict_bwd)
+    if (is_supported(k.level))
+      measure(opt, "ict_backward", k.isa, w, 24.0 * w,
+        [&]() { k.fun(f[0], f[1], f[2], f[3], f[4], f[5], w); });
+}
+
+/////////////////////////////////////////////////////////////////////////////
+static
+bool get_arguments(int argc, char *argv[], bench_options& opt)
+{
+  ojph::cli_interpreter interpreter;
+  interpreter.init(argc, argv);
+
+  interpreter.reinterpret("-width", opt.width);
+  interpreter.reinterpret("-bits", opt.bits);
+  interpreter.reinterpret("-time", opt.min_time);
+  interpreter.reinterpret("-kernel", opt.kernel);
+  interpreter.reinterpret("-isa", opt.isa);
+
+  if (interpreter.is_exhausted() == false) {
+    printf("The following arguments were not interpreted:\n");
+    ojph::argument t = interpreter.get_argument_zero();
+    t = interpreter.get_next_avail_argument(t);
+    while (t.is_valid()) {
+      printf("%s\n", t.arg);
+      t = interpreter.get_next_avail_argument(t);
+    }
+    return false;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+int main(int argc, char *argv[])
+{
+  bench_options opt;
+  opt.width = 1024;
+  opt.bits = 8.0f;
+  opt.min_time = 0.25f;
+  opt.kernel = NULL;
+  opt.isa = NULL;
+
+  if (!get_arguments(argc, argv, opt))
+  {
+    printf(
+    "\nThe following arguments are optional:\n"
+    " -width   <samples> line width used for line-based kernels.\n"
+    "          Default: 1024.\n"
+    " -bits    <bits> approximate entropy of synthetic samples, in bits\n"
+    "          per sample.  Default: 8.\n"
+    " -time    <seconds> time spent measuring each kernel.  Default: 0.25.\n"
+    " -kernel  <name> only run kernels whose name contains <name>.\n"
+    " -isa     <name> only run one instruction set, such as gen, sse2,\n"
+    "          avx2, or avx512.\n"
+    "\n");
+    return -1;
+  }
+  if (opt.width < 2 || opt.width > (1u << 24))
+    OJPH_ERROR(0x00F00004, "-width must be between 2 and 2^24");
+
+  printf("# width %u samples, %.2f bits/sample; best of 5 repetitions\n",
+    opt.width, opt.bits);
+#ifdef OJPH_BENCH_HAS_TSC
+  printf("# cyc/smpl uses the time stamp counter, which ticks at the "
+    "nominal clock rate\n");
+#endif
+  printf("%-34s %-7s %10s %10s %9s\n",
+    "kernel", "isa", "ns/smpl", "cyc/smpl", "GB/s");
+
+  try {
+    bench_codeblock(opt);
+    bench_wavelet(opt);
+    bench_colour(opt);
+  }
+  catch (const std::exception& e)
+  {
+    const char *p = e.what();
+    if (strncmp(p, "ojph error", 10) != 0)
+      printf("%s\n", p);
+    return -1;
+  }
+
+  return 0;
+}
@@ -38,14 +38,26 @@
 
 #include <ctime>
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include "ojph_arg.h"
 #include "ojph_mem.h"
 #include "ojph_img_io.h"
 #include "ojph_file.h"
+#include "ojph_boxes.h"
 #include "ojph_codestream.h"
 #include "ojph_params.h"
 #include "ojph_message.h"
+#include "ojph_phase_timer.h"
+#include "ojph_size_report.h"
+#include "ojph_trace.h"
+
+#ifndef OJPH_EMSCRIPTEN
+  #include <condition_variable>
+  #include <mutex>
+  #include <thread>
+#endif
 
 /////////////////////////////////////////////////////////////////////////////
 struct size_list_interpreter : public ojph::cli_interpreter::arg_inter_base
@@ -372,7 +384,11 @@ bool get_arguments(int argc, char *argv[], char *&input_filename,
                    ojph::ui32& num_bit_depths, ojph::ui32*& bit_depth,
                    ojph::ui32& num_is_signed, ojph::si32*& is_signed,
                    bool& tlm_marker, bool& tileparts_at_resolutions,
-                   bool& tileparts_at_components, char *&com_string)
+                   bool& tileparts_at_components, char *&com_string,
+                   bool& async_write, ojph::ui32& first_frame,
+                   ojph::ui32& num_frames, ojph::ui32& num_threads,
+                   char *&timing, char *&trace_filename,
+                   char *&size_stats)
 {
   ojph::cli_interpreter interpreter;
   interpreter.init(argc, argv);
@@ -389,6 +405,13 @@ bool get_arguments(int argc, char *argv[], char *&input_filename,
   interpreter.reinterpret("-num_comps", num_comps);
   interpreter.reinterpret("-tlm_marker", tlm_marker);
   interpreter.reinterpret("-com", com_string);
+  interpreter.reinterpret("-async_write", async_write);
+  interpreter.reinterpret("-first_frame", first_frame);
+  interpreter.reinterpret("-num_frames", num_frames);
+  interpreter.reinterpret("-num_threads", num_threads);
+  interpreter.reinterpret("-timing", timing);
+  interpreter.reinterpret("-trace", trace_filename);
+  interpreter.reinterpret("-stats", size_stats);
 
   size_interpreter block_interpreter(block_size);
   size_interpreter dims_interpreter(dims);
@@ -485,6 +508,264 @@ bool is_matching(const char *ref, const char *other)
   return true;
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// returns true if name has exactly one printf-style integer field of the
+// form %d, %5d, or %05d; "%%" is accepted as a literal percent sign
+static
+bool is_numbered_name(const char *name)
+{
+  int num_fields = 0;
+  for (const char *p = name; *p; ++p)
+  {
+    if (*p != '%')
+      continue;
+    ++p;
+    if (*p == '%')
+      continue;
+    while (*p >= '0' && *p <= '9')
+      ++p;
+    if (*p != 'd')
+      OJPH_ERROR(0x010000B1, "the output file name \"%s\" has a %% that "
+        "is not followed by an integer field, such as %%05d; use %%%% for "
+        "a percent sign\n", name);
+    ++num_fields;
+  }
+  if (num_fields > 1)
+    OJPH_ERROR(0x010000B2, "the output file name \"%s\" can have only one "
+      "integer field\n", name);
+  return num_fields == 1;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// the phases reported by -timing
+enum : ojph::ui32 {
+  PHASE_OPEN, PHASE_WRITE_HEADERS, PHASE_READ_IMAGE, PHASE_ENCODE,
+  PHASE_FLUSH, PHASE_WRITE_FILE, PHASE_CLOSE
+};
+
+/////////////////////////////////////////////////////////////////////////////
+static
+void init_phase_timer(ojph::phase_timer& timer, bool enable)
+{
+  timer.add_phase("open");
+  timer.add_phase("write_headers");
+  timer.add_phase("read_image");
+  timer.add_phase("encode");
+  timer.add_phase("flush");
+  timer.add_phase("write_file");
+  timer.add_phase("close");
+  timer.enable(enable);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// pushes all the lines of one image from base into codestream; reading
+// lines and pushing them are timed separately
+static
+void encode_image(ojph::codestream& codestream, ojph::image_in_base *base,
+                  ojph::phase_timer& timer)
+{
+  ojph::ui32 next_comp;
+  ojph::line_buf* cur_line = codestream.exchange(NULL, next_comp);
+  if (codestream.is_planar())
+  {
+    const ojph::param_siz siz = codestream.get_siz();
+    for (ojph::ui32 c = 0; c < siz.get_num_components(); ++c)
+    {
+      ojph::point p = siz.get_downsampling(c);
+      ojph::ui32 height = ojph_div_ceil(siz.get_image_extent().y, p.y);
+      height -= ojph_div_ceil(siz.get_image_offset().y, p.y);
+      for (ojph::ui32 i = height; i > 0; --i)
+      {
+        assert(c == next_comp);
+        timer.next(PHASE_READ_IMAGE);
+        base->read(cur_line, next_comp);
+        timer.next(PHASE_ENCODE);
+        cur_line = codestream.exchange(cur_line, next_comp);
+      }
+    }
+  }
+  else
+  {
+    const ojph::param_siz siz = codestream.get_siz();
+    ojph::ui32 height = siz.get_image_extent().y;
+    height -= siz.get_image_offset().y;
+    for (ojph::ui32 i = 0; i < height; ++i)
+    {
+      for (ojph::ui32 c = 0; c < siz.get_num_components(); ++c)
+      {
+        assert(c == next_comp);
+        timer.next(PHASE_READ_IMAGE);
+        base->read(cur_line, next_comp);
+        timer.next(PHASE_ENCODE);
+        cur_line = codestream.exchange(cur_line, next_comp);
+      }
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// everything one thread needs to encode frames; the codestream is
+// configured once, and restart()ed between frames, keeping its memory and
+// its main header
+struct frame_worker
+{
+  frame_worker() : base(NULL), num_bytes(0) {}
+
+  ojph::codestream codestream;
+  ojph::yuv_in yuv;
+  ojph::raw_in raw;
+  ojph::image_in_base *base;
+  ojph::mem_outfile mem_file;
+  ojph::phase_timer timer;
+  ojph::coded_size_report sizes; // of the codestreams of this worker
+  ojph::ui64 num_bytes;      // of the codestreams of this worker
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// the frames of a batch and the state shared by its workers
+struct frame_batch
+{
+  frame_batch()
+  : next_frame(0), end_frame(0), next_to_write(0), out_file(NULL),
+    numbered_name(NULL), com_string(NULL), jph_output(false),
+    colour_space(ojph::jph_writer::DEFAULT_COLOUR_SPACE), size_stats(false),
+    failed(false)
+  {}
+
+  ojph::ui64 next_frame;     // the next frame to be picked by a worker
+  ojph::ui64 end_frame;      // one past the last frame to encode
+  ojph::ui64 next_to_write;  // the frame whose codestream goes out next
+  ojph::outfile_base *out_file; // receives codestreams, when not numbered
+  const char *numbered_name; // the output name, when numbered
+  const char *com_string;
+  std::vector<ojph::ui64> offsets; // offset and length of each codestream
+  bool jph_output;           // true to wrap each codestream in a .jph file
+  ojph::ui32 colour_space;   // for the colr box of a .jph file
+  bool size_stats;           // true to collect the sizes of codeblocks
+  bool failed;
+#ifndef OJPH_EMSCRIPTEN
+  std::mutex mutex;
+  std::condition_variable written;
+#endif
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// picks frames from batch and encodes them until none is left; in a
+// concatenated stream, codestreams are written in frame order
+static
+void encode_frames(frame_worker *worker, frame_batch *batch)
+{
+  try
+  {
+    ojph::comment_exchange com_ex;
+    if (batch->com_string)
+      com_ex.set_string(batch->com_string);
+    ojph::j2c_outfile j2c_file;
+    // read once, through get_siz(), since access_siz() would discard the
+    // main header kept by restart(), and with it the coding parameters
+    ojph::codestream& codestream = worker->codestream;
+    const ojph::param_siz siz = codestream.get_siz();
+    while (true)
+    {
+      ojph::ui64 frame;
+      {
+#ifndef OJPH_EMSCRIPTEN
+        std::lock_guard<std::mutex> lock(batch->mutex);
+#endif
+        if (batch->failed || batch->next_frame >= batch->end_frame)
+          break;
+        frame = batch->next_frame++;
+      }
+
+      ojph::trace_span span("encode_frame", "frame", "frame",
+                            (ojph::si64)frame);
+      ojph::phase_timer& timer = worker->timer;
+      timer.next(PHASE_OPEN);
+      if (worker->base == &worker->yuv)
+        worker->yuv.seek_frame(frame);
+      else
+        worker->raw.seek_frame(frame);
+
+      ojph::outfile_base *out_file;
+      if (batch->numbered_name)
+      {
+        char name[1024];
+        int len = snprintf(name, sizeof(name), batch->numbered_name,
+          (int)frame);
+        if (len < 0 || len >= (int)sizeof(name))
+          OJPH_ERROR(0x010000B3, "the output file name for frame %d is "
+            "too long\n", (int)frame);
+        j2c_file.open(name);
+        out_file = &j2c_file;
+      }
+      else
+      {
+        worker->mem_file.open();
+        out_file = &worker->mem_file;
+      }
+
+      timer.next(PHASE_WRITE_HEADERS);
+      ojph::jph_writer jph;
+      if (batch->jph_output) {
+        jph.set_colour_space(batch->colour_space);
+        jph.write_headers(out_file, siz);
+      }
+      codestream.write_headers(out_file, &com_ex, batch->com_string ? 1:0);
+      encode_image(codestream, worker->base, timer);
+      timer.next(PHASE_FLUSH);
+      codestream.flush();
+      if (batch->jph_output)
+        jph.finalize(out_file);
+      worker->num_bytes += (ojph::ui64)out_file->tell();
+      if (batch->size_stats)
+        worker->sizes.add(codestream);
+      timer.next(PHASE_CLOSE);
+      codestream.close();
+
+      if (batch->numbered_name == NULL)
+      {
+        timer.next(PHASE_WRITE_FILE);
+        size_t len = worker->mem_file.get_used_size();
+#ifndef OJPH_EMSCRIPTEN
+        std::unique_lock<std::mutex> lock(batch->mutex);
+        {
+          ojph::trace_span wait_span("wait_turn", "frame");
+          while (!batch->failed && batch->next_to_write != frame)
+            batch->written.wait(lock);
+        }
+#endif
+        if (batch->failed)
+          break;
+        batch->offsets.push_back((ojph::ui64)batch->out_file->tell());
+        batch->offsets.push_back((ojph::ui64)len);
+        if (batch->out_file->write(worker->mem_file.get_data(), len) != len)
+          OJPH_ERROR(0x010000B4, "error writing the codestream of frame "
+            "%d\n", (int)frame);
+        ++batch->next_to_write;
+#ifndef OJPH_EMSCRIPTEN
+        batch->written.notify_all();
+#endif
+      }
+      timer.next(PHASE_CLOSE);
+      codestream.restart();
+      timer.stop();
+    }
+  }
+  catch (const std::exception& e)
+  {
+    const char *p = e.what();
+    if (strncmp(p, "ojph error", 10) != 0)
+      printf("%s\n", p);
+#ifndef OJPH_EMSCRIPTEN
+    std::lock_guard<std::mutex> lock(batch->mutex);
+#endif
+    batch->failed = true;
+#ifndef OJPH_EMSCRIPTEN
+    batch->written.notify_all();
+#endif
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // main
 //////////////////////////////////////////////////////////////////////////////
@@ -527,6 +808,13 @@ int main(int argc, char * argv[]) {
   bool tlm_marker = false;
   bool tileparts_at_resolutions = false;
   bool tileparts_at_components = false;
+  bool async_write = false;
+  ojph::ui32 first_frame = 0;
+  ojph::ui32 num_frames = 1;
+  ojph::ui32 num_threads = 0;
+  char *timing = NULL;
+  char *trace_filename = NULL;
+  char *size_stats = NULL;
 
   if (argc <= 1) {
     std::cout <<
@@ -536,7 +824,9 @@ int main(int argc, char * argv[]) {
 #else
     " -i input file name (either pgm, ppm, pfm, or raw(yuv))\n"
 #endif // !OJPH_ENABLE_TIFF_SUPPORT
-    " -o output file name\n\n"
+    " -o output file name; a .jph file holds the codestream in the boxes\n"
+    "    of the JPH file format, and any other name receives the bare\n"
+    "    codestream, usually named .j2c\n\n"
 
     "The following option has a default value (optional):\n"
     " -num_decomps  (5) number of decompositions\n"
@@ -585,6 +875,44 @@ int main(int argc, char * argv[]) {
     " -com          (None) if set, inserts a COM marker with the specified\n"
     "               string. If the string has spaces, please use\n"
     "               double quotes, as in -com \"This is a comment\".\n"
+    " -async_write  <true | false> if 'true', the output file is written\n"
+    "               from a background thread, overlapping disk writes with\n"
+    "               compression. Default value is false.\n"
+    "\n"
+
+    "A .yuv or .raw file can hold many frames, one after the other.\n"
+    "The following arguments encode several of these frames in one run:\n"
+    " -first_frame  (0) the index of the first frame to encode.\n"
+    " -num_frames   (1) the number of frames to encode; 0 encodes all\n"
+    "               frames from first_frame to the end of the file.\n"
+    " -num_threads  (0) the number of frames encoded concurrently; 0 uses\n"
+    "               one thread per available processor.\n"
+    "               When the output file name has a printf-style integer\n"
+    "               field, such as out_%05d.j2c, every frame is written to\n"
+    "               its own file, named with the index of the frame.\n"
+    "               Otherwise, the codestreams are stored one after the\n"
+    "               other in the output file, and the file <output>.idx\n"
+    "               lists the byte offset and length of each codestream,\n"
+    "               one frame per line.\n"
+    "\n"
+
+    "The following argument reports where time is spent:\n"
+    " -timing       <text | json> prints, instead of the elapsed time,\n"
+    "               the wall-clock and CPU time of every phase: opening\n"
+    "               files, writing headers, reading the image,\n"
+    "               encoding, flushing, writing the codestream, and\n"
+    "               closing, followed by the totals, megapixels per\n"
+    "               second, and codestream bytes per second.  With many\n"
+    "               threads, phase times are summed over all threads.\n"
+    " -trace        <file> writes a timeline of the work of every thread\n"
+    "               to file, as trace-event JSON, which chrome://tracing\n"
+    "               and ui.perfetto.dev display.\n"
+    " -stats        <text | json> prints the coded size of every\n"
+    "               component, resolution, and band: the number of\n"
+    "               codeblocks, the fraction of them that have no coded\n"
+    "               data, their average missing MSBs, and their bytes,\n"
+    "               followed by a histogram of codeblock sizes.  With\n"
+    "               many frames, sizes are summed over all frames.\n"
     "\n"
 
     "When the input file is a YUV file, these arguments need to be \n"
@@ -636,7 +964,9 @@ int main(int argc, char * argv[]) {
                      num_comp_downsamps, comp_downsampling,
                      num_bit_depths, bit_depth, num_is_signed, is_signed,
                      tlm_marker, tileparts_at_resolutions,
-                     tileparts_at_components, com_string))
+                     tileparts_at_components, com_string, async_write,
+                     first_frame, num_frames, num_threads, timing,
+                     trace_filename, size_stats))
   {
     return -1;
   }
@@ -649,15 +979,27 @@ int main(int argc, char * argv[]) {
       "-qfactor must be between 1 and 100\n");
 
   clock_t begin = clock();
+  double begin_wall = ojph::phase_timer::get_wall_time();
+  ojph::phase_timer phase_times;  // the sum of the timers of all workers
+  init_phase_timer(phase_times, timing != NULL);
+  ojph::ui64 num_encoded = 0, num_pixels = 0, num_bytes = 0;
+  ojph::coded_size_report sizes;  // the sum of the sizes of all workers
 
   try
   {
-    ojph::codestream codestream;
+    if (timing && !is_matching("text", timing)
+               && !is_matching("json", timing))
+      OJPH_ERROR(0x010000BA, "-timing must be text or json\n");
+    if (size_stats && !is_matching("text", size_stats)
+                   && !is_matching("json", size_stats))
+      OJPH_ERROR(0x010000BD, "-stats must be text or json\n");
+    if (trace_filename && !ojph::trace_start(trace_filename))
+      OJPH_ERROR(0x010000BB, "unable to open file %s for writing\n",
+        trace_filename);
+    ojph::trace_set_thread_name("main");
 
     ojph::ppm_in ppm;
     ojph::pfm_in pfm;
-    ojph::yuv_in yuv;
-    ojph::raw_in raw;
     ojph::dpx_in dpx;
 #ifdef OJPH_ENABLE_TIFF_SUPPORT
     ojph::tif_in tif;
@@ -672,6 +1014,33 @@ int main(int argc, char * argv[]) {
         " the -o command line option");
     const char *v = get_file_extension(input_filename);
 
+    // a batch encodes frames of a multi-frame .yuv or .raw file, using
+    // one worker per thread; otherwise, worker 0 does all the work
+    bool numbered = is_numbered_name(output_filename);
+    bool batch = numbered || first_frame != 0 || num_frames != 1;
+    ojph::ui32 num_workers = 1;
+    if (batch)
+    {
+      if (v == NULL || (!is_matching(".yuv", v) && !is_matching(".raw", v)))
+        OJPH_ERROR(0x010000B5, "-first_frame, -num_frames, and numbered "
+          "output files are only supported for .yuv and .raw files\n");
+#ifndef OJPH_EMSCRIPTEN
+      num_workers = num_threads;
+      if (num_workers == 0)
+        num_workers = ojph_max(std::thread::hardware_concurrency(), 1u);
+      if (num_frames != 0)
+        num_workers = ojph_min(num_workers, num_frames);
+#endif
+    }
+    else if (num_threads > 1)
+      OJPH_WARN(0x010000B6,
+        "-num_threads is only used when encoding many frames\n");
+    frame_worker *workers = new frame_worker[num_workers];
+    ojph::codestream& codestream = workers[0].codestream;
+    for (ojph::ui32 w = 0; w < num_workers; ++w)
+      init_phase_timer(workers[w].timer, timing != NULL);
+    workers[0].timer.next(PHASE_OPEN);
+
     if (v)
     {
       if (is_matching(".pgm", v))
@@ -951,12 +1320,9 @@ int main(int argc, char * argv[]) {
 #endif // !OJPH_ENABLE_TIFF_SUPPORT
       else if (is_matching(".yuv", v))
       {
-        ojph::param_siz siz = codestream.access_siz();
         if (dims.w == 0 || dims.h == 0)
           OJPH_ERROR(0x01000021,
             "-dims option must have positive dimensions\n");
-        siz.set_image_extent(ojph::point(image_offset.x + dims.w,
-          image_offset.y + dims.h));
         if (num_components <= 0)
           OJPH_ERROR(0x01000022,
             "-num_comps option is missing and must be provided\n");
@@ -969,38 +1335,7 @@ int main(int argc, char * argv[]) {
         if (num_comp_downsamps <= 0)
           OJPH_ERROR(0x01000025,
             "-downsamp option is missing and must be provided\n");
-
-        yuv.set_img_props(dims, num_components, num_comp_downsamps,
-          comp_downsampling);
-        yuv.set_bit_depth(num_bit_depths, bit_depth);
-
-        ojph::ui32 last_signed_idx = 0, last_bit_depth_idx = 0;
-        ojph::ui32 last_downsamp_idx = 0;
-        siz.set_num_components(num_components);
-        for (ojph::ui32 c = 0; c < num_components; ++c)
-        {
-          ojph::point cp_ds = comp_downsampling
-              [c < num_comp_downsamps ? c : last_downsamp_idx];
-          last_downsamp_idx += last_downsamp_idx+1 < num_comp_downsamps ? 1:0;
-          ojph::ui32 bd = bit_depth[c<num_bit_depths ? c : last_bit_depth_idx];
-          last_bit_depth_idx += last_bit_depth_idx + 1 < num_bit_depths ? 1:0;
-          int is = is_signed[c < num_is_signed ? c : last_signed_idx];
-          last_signed_idx += last_signed_idx + 1 < num_is_signed ? 1 : 0;
-          siz.set_component(c, cp_ds, bd, is == 1);
-        }
-        siz.set_image_offset(image_offset);
-        siz.set_tile_size(tile_size);
-        siz.set_tile_offset(tile_offset);
-
-        ojph::param_cod cod = codestream.access_cod();
-        cod.set_num_decomposition(num_decompositions);
-        cod.set_block_dims(block_size.w, block_size.h);
-        if (num_precincts != -1)
-          cod.set_precinct_size(num_precincts, precinct_size);
-        cod.set_progression_order(prog_order);
-        if (employ_color_transform == -1)
-          cod.set_color_transform(false);
-        else
+        if (employ_color_transform != -1)
           OJPH_ERROR(0x01000031,
             "We currently do not support color transform on raw(yuv) files."
             " In any case, this not a normal usage scenario.  The OpenJPH "
@@ -1008,34 +1343,73 @@ int main(int argc, char * argv[]) {
             "modified to send all lines from one component before moving to "
             "the next component;  this requires buffering components outside"
             " of the OpenJPH library");
-        cod.set_reversible(reversible);
-        if (!reversible && quantization_step != -1.0f)
-          codestream.access_qcd().set_irrev_quant(quantization_step);
-        if (!reversible && qfactor != -1) {
+        if (!reversible && qfactor != -1)
           if (num_components != 1 && num_components != 3)
             OJPH_ERROR(0x010000A4,
               "-qfactor is only supported for images with 1 or 3 "
               "components\n");
-          codestream.access_qcd().set_qfactor((ojph::ui8)qfactor);
-        }
-        codestream.set_planar(true);
-        if (profile_string[0] != '\0')
-          codestream.set_profile(profile_string);
-        codestream.set_tilepart_divisions(tileparts_at_resolutions,
-                                          tileparts_at_components);
-        codestream.request_tlm_marker(tlm_marker);
 
-        yuv.open(input_filename);
-        base = &yuv;
+        for (ojph::ui32 w = 0; w < num_workers; ++w)
+        {
+          ojph::codestream& cs = workers[w].codestream;
+          ojph::yuv_in& yuv = workers[w].yuv;
+
+          ojph::param_siz siz = cs.access_siz();
+          siz.set_image_extent(ojph::point(image_offset.x + dims.w,
+            image_offset.y + dims.h));
+
+          yuv.set_img_props(dims, num_components, num_comp_downsamps,
+            comp_downsampling);
+          yuv.set_bit_depth(num_bit_depths, bit_depth);
+
+          ojph::ui32 last_signed_idx = 0, last_bit_depth_idx = 0;
+          ojph::ui32 last_downsamp_idx = 0;
+          siz.set_num_components(num_components);
+          for (ojph::ui32 c = 0; c < num_components; ++c)
+          {
+            ojph::point cp_ds = comp_downsampling
+                [c < num_comp_downsamps ? c : last_downsamp_idx];
+            last_downsamp_idx += last_downsamp_idx+1 < num_comp_downsamps?1:0;
+            ojph::ui32 bd = bit_depth[c<num_bit_depths?c:last_bit_depth_idx];
+            last_bit_depth_idx += last_bit_depth_idx + 1 < num_bit_depths?1:0;
+            int is = is_signed[c < num_is_signed ? c : last_signed_idx];
+            last_signed_idx += last_signed_idx + 1 < num_is_signed ? 1 : 0;
+            siz.set_component(c, cp_ds, bd, is == 1);
+          }
+          siz.set_image_offset(image_offset);
+          siz.set_tile_size(tile_size);
+          siz.set_tile_offset(tile_offset);
+
+          ojph::param_cod cod = cs.access_cod();
+          cod.set_num_decomposition(num_decompositions);
+          cod.set_block_dims(block_size.w, block_size.h);
+          if (num_precincts != -1)
+            cod.set_precinct_size(num_precincts, precinct_size);
+          cod.set_progression_order(prog_order);
+          cod.set_color_transform(false);
+          cod.set_reversible(reversible);
+          if (!reversible && quantization_step != -1.0f)
+            cs.access_qcd().set_irrev_quant(quantization_step);
+          if (!reversible && qfactor != -1)
+            cs.access_qcd().set_qfactor((ojph::ui8)qfactor);
+          cs.set_planar(true);
+          if (profile_string[0] != '\0')
+            cs.set_profile(profile_string);
+          cs.set_tilepart_divisions(tileparts_at_resolutions,
+                                    tileparts_at_components);
+          cs.request_tlm_marker(tlm_marker);
+          cs.enable_header_cache(batch);
+
+          yuv.open(input_filename);
+          workers[w].base = &yuv;
+        }
+        base = workers[0].base;
       }
       else if (is_matching(".raw", v))
       {
-        ojph::param_siz siz = codestream.access_siz();
         if (dims.w == 0 || dims.h == 0)
           OJPH_ERROR(0x01000081,
             "-dims option must have positive dimensions\n");
-        siz.set_image_extent(ojph::point(image_offset.x + dims.w,
-          image_offset.y + dims.h));
         if (num_components != 1)
           OJPH_ERROR(0x01000082,
             "-num_comps must be 1\n");
@@ -1048,39 +1422,51 @@ int main(int argc, char * argv[]) {
         if (num_comp_downsamps <= 0)
           OJPH_ERROR(0x01000085,
             "-downsamp option is missing and must be provided\n");
-
-        raw.set_img_props(dims, bit_depth[0], is_signed[0] == 1);
-
-        siz.set_num_components(num_components);
-        siz.set_component(0, comp_downsampling[0], bit_depth[0], is_signed[0]);
-        siz.set_image_offset(image_offset);
-        siz.set_tile_size(tile_size);
-        siz.set_tile_offset(tile_offset);
-
-        ojph::param_cod cod = codestream.access_cod();
-        cod.set_num_decomposition(num_decompositions);
-        cod.set_block_dims(block_size.w, block_size.h);
-        if (num_precincts != -1)
-          cod.set_precinct_size(num_precincts, precinct_size);
-        cod.set_progression_order(prog_order);
         if (employ_color_transform != -1)
           OJPH_ERROR(0x01000086,
             "color transform is meaningless since .raw files are single "
             "component files");
-        cod.set_reversible(reversible);
-        if (!reversible && quantization_step != -1.0f)
-          codestream.access_qcd().set_irrev_quant(quantization_step);
-        if (!reversible && qfactor != -1)
-          codestream.access_qcd().set_qfactor((ojph::ui8)qfactor);
-        codestream.set_planar(true);
-        if (profile_string[0] != '\0')
-          codestream.set_profile(profile_string);
-        codestream.set_tilepart_divisions(tileparts_at_resolutions,
-                                          tileparts_at_components);
-        codestream.request_tlm_marker(tlm_marker);
 
-        raw.open(input_filename);
-        base = &raw;
+        for (ojph::ui32 w = 0; w < num_workers; ++w)
+        {
+          ojph::codestream& cs = workers[w].codestream;
+          ojph::raw_in& raw = workers[w].raw;
+
+          raw.set_img_props(dims, bit_depth[0], is_signed[0] == 1);
+
+          ojph::param_siz siz = cs.access_siz();
+          siz.set_image_extent(ojph::point(image_offset.x + dims.w,
+            image_offset.y + dims.h));
+          siz.set_num_components(num_components);
+          siz.set_component(0, comp_downsampling[0], bit_depth[0],
+            is_signed[0]);
+          siz.set_image_offset(image_offset);
+          siz.set_tile_size(tile_size);
+          siz.set_tile_offset(tile_offset);
+
+          ojph::param_cod cod = cs.access_cod();
+          cod.set_num_decomposition(num_decompositions);
+          cod.set_block_dims(block_size.w, block_size.h);
+          if (num_precincts != -1)
+            cod.set_precinct_size(num_precincts, precinct_size);
+          cod.set_progression_order(prog_order);
+          cod.set_reversible(reversible);
+          if (!reversible && quantization_step != -1.0f)
+            cs.access_qcd().set_irrev_quant(quantization_step);
+          if (!reversible && qfactor != -1)
+            cs.access_qcd().set_qfactor((ojph::ui8)qfactor);
+          cs.set_planar(true);
+          if (profile_string[0] != '\0')
+            cs.set_profile(profile_string);
+          cs.set_tilepart_divisions(tileparts_at_resolutions,
+                                    tileparts_at_components);
+          cs.request_tlm_marker(tlm_marker);
+          cs.enable_header_cache(batch);
+
+          raw.open(input_filename);
+          workers[w].base = &raw;
+        }
+        base = workers[0].base;
       }
       else if (is_matching(".dpx", v))
       {
@@ -1157,50 +1543,133 @@ int main(int argc, char * argv[]) {
         "Please supply a proper input filename with a proper three-letter "
         "extension\n");
 
-    ojph::comment_exchange com_ex;
-    if (com_string)
-      com_ex.set_string(com_string);
+    ojph::param_siz siz = codestream.access_siz();
+    ojph::ui64 frame_pixels = siz.get_image_extent().x;
+    const char *ov = strrchr(output_filename, '.');
+    bool jph_output = ov != NULL && is_matching(".jph", ov);
+    ojph::ui32 colour_space = ojph::jph_writer::DEFAULT_COLOUR_SPACE;
+    if (is_matching(".yuv", v) && siz.get_num_components() == 3)
+      colour_space = ojph::jph_writer::SYCC; // not converted to RGB
+    if (jph_output && batch && !numbered)
+      OJPH_ERROR(0x010000BE, "a .jph file holds one frame only; to encode "
+        "many frames into .jph files, use an output file name with an "
+        "integer field, such as out_%%05d.jph\n");
+    frame_pixels -= siz.get_image_offset().x;
+    frame_pixels *= siz.get_image_extent().y - siz.get_image_offset().y;
+
     ojph::j2c_outfile j2c_file;
-    j2c_file.open(output_filename);
-    codestream.write_headers(&j2c_file, &com_ex, com_string ? 1 : 0);
+    ojph::j2c_async_outfile async_file;
+    ojph::outfile_base *out_file = NULL;
+    if (!numbered)
+    {
+      if (async_write) {
+        async_file.open(output_filename);
+        out_file = &async_file;
+      }
+      else {
+        j2c_file.open(output_filename);
+        out_file = &j2c_file;
+      }
+    }
 
-    ojph::ui32 next_comp;
-    ojph::line_buf* cur_line = codestream.exchange(NULL, next_comp);
-    if (codestream.is_planar())
+    if (batch)
     {
-      ojph::param_siz siz = codestream.access_siz();
-      for (ojph::ui32 c = 0; c < siz.get_num_components(); ++c)
+      ojph::ui64 frames_in_file = base == &workers[0].yuv
+        ? workers[0].yuv.get_num_frames() : workers[0].raw.get_num_frames();
+      if (first_frame >= frames_in_file)
+        OJPH_ERROR(0x010000B7, "-first_frame is %u, but the input file has "
+          "%llu frames only\n", first_frame,
+          (unsigned long long)frames_in_file);
+      frame_batch fb;
+      fb.next_frame = fb.next_to_write = first_frame;
+      fb.end_frame = frames_in_file;
+      if (num_frames != 0)
+        fb.end_frame = (ojph::ui64)first_frame + num_frames;
+      if (fb.end_frame > frames_in_file)
+        OJPH_ERROR(0x010000B8, "frames %u to %llu are requested, but the "
+          "input file has %llu frames only\n", first_frame,
+          (unsigned long long)fb.end_frame - 1,
+          (unsigned long long)frames_in_file);
+      fb.out_file = out_file;
+      fb.numbered_name = numbered ? output_filename : NULL;
+      fb.com_string = com_string;
+      fb.jph_output = jph_output;
+      fb.colour_space = colour_space;
+      fb.size_stats = size_stats != NULL;
+      workers[0].timer.stop();
+
+#ifndef OJPH_EMSCRIPTEN
+      std::vector<std::thread> threads;
+      for (ojph::ui32 w = 1; w < num_workers; ++w)
+        threads.push_back(std::thread([workers, w, &fb]() {
+          ojph::trace_set_thread_name("frame worker");
+          encode_frames(workers + w, &fb);
+        }));
+      encode_frames(workers, &fb);
+      for (size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+#else
+      encode_frames(workers, &fb);
+#endif
+      if (fb.failed)
+        exit(-1);
+
+      phase_times.next(PHASE_CLOSE);
+      if (!numbered)
       {
-        ojph::point p = siz.get_downsampling(c);
-        ojph::ui32 height = ojph_div_ceil(siz.get_image_extent().y, p.y);
-        height -= ojph_div_ceil(siz.get_image_offset().y, p.y);
-        for (ojph::ui32 i = height; i > 0; --i)
-        {
-          assert(c == next_comp);
-          base->read(cur_line, next_comp);
-          cur_line = codestream.exchange(cur_line, next_comp);
-        }
+        out_file->close();
+        std::string index_name = output_filename;
+        index_name += ".idx";
+        FILE *f = fopen(index_name.c_str(), "w");
+        if (f == NULL)
+          OJPH_ERROR(0x010000B9, "unable to open file %s for writing\n",
+            index_name.c_str());
+        for (size_t i = 0; i < fb.offsets.size(); i += 2)
+          fprintf(f, "%llu %llu\n", (unsigned long long)fb.offsets[i],
+            (unsigned long long)fb.offsets[i + 1]);
+        fclose(f);
       }
+      for (ojph::ui32 w = 0; w < num_workers; ++w)
+        workers[w].base->close();
+      phase_times.stop();
+      num_encoded = fb.end_frame - first_frame;
     }
     else
     {
-      ojph::param_siz siz = codestream.access_siz();
-      ojph::ui32 height = siz.get_image_extent().y;
-      height -= siz.get_image_offset().y;
-      for (ojph::ui32 i = 0; i < height; ++i)
-      {
-        for (ojph::ui32 c = 0; c < siz.get_num_components(); ++c)
-        {
-          assert(c == next_comp);
-          base->read(cur_line, next_comp);
-          cur_line = codestream.exchange(cur_line, next_comp);
-        }
+      ojph::phase_timer& timer = workers[0].timer;
+      ojph::comment_exchange com_ex;
+      if (com_string)
+        com_ex.set_string(com_string);
+      timer.next(PHASE_WRITE_HEADERS);
+      ojph::jph_writer jph;
+      if (jph_output) {
+        jph.set_colour_space(colour_space);
+        jph.write_headers(out_file, siz);
       }
+      codestream.write_headers(out_file, &com_ex, com_string ? 1 : 0);
+      encode_image(codestream, base, timer);
+      timer.next(PHASE_FLUSH);
+      codestream.flush();
+      if (jph_output)
+        jph.finalize(out_file);
+      workers[0].num_bytes = (ojph::ui64)out_file->tell();
+      if (size_stats)
+        workers[0].sizes.add(codestream);
+      timer.next(PHASE_CLOSE);
+      codestream.close();
+      base->close();
+      timer.stop();
+      num_encoded = 1;
     }
-
-    codestream.flush();
-    codestream.close();
-    base->close();
+    num_pixels = num_encoded * frame_pixels;
+    for (ojph::ui32 w = 0; w < num_workers; ++w) {
+      phase_times.add(workers[w].timer);
+      sizes.add(workers[w].sizes);
+      num_bytes += workers[w].num_bytes;
+    }
+    delete[] workers;
+    if (trace_filename && !ojph::trace_stop())
+      OJPH_ERROR(0x010000BC, "error writing file %s\n", trace_filename);
 
     if (max_num_comps != initial_num_comps)
     {
@@ -1219,7 +1688,14 @@ int main(int argc, char * argv[]) {
 
   clock_t end = clock();
   double elapsed_secs = double(end - begin) / CLOCKS_PER_SEC;
-  printf("Elapsed time = %f\n", elapsed_secs);
+  if (timing)
+    phase_times.print(is_matching("json", timing),
+      ojph::phase_timer::get_wall_time() - begin_wall, elapsed_secs,
+      num_encoded, num_pixels, num_bytes);
+  else
+    printf("Elapsed time = %f\n", elapsed_secs);
+  if (size_stats)
+    sizes.print(is_matching("json", size_stats));
 
   return 0;
 
@@ -35,9 +35,12 @@
 // Date: 28 August 2019
 //***************************************************************************/
 
+#include <chrono>
 #include <ctime>
 #include <iostream>
 #include <cstdlib>
+#include <string>
+#include <vector>
 
 #include "ojph_arg.h"
 #include "ojph_mem.h"
@@ -46,6 +49,14 @@
 #include "ojph_codestream.h"
 #include "ojph_params.h"
 #include "ojph_message.h"
+#include "ojph_phase_timer.h"
+#include "ojph_size_report.h"
+#include "ojph_trace.h"
+
+#ifndef OJPH_EMSCRIPTEN
+  #include <mutex>
+  #include <thread>
+#endif
 
 /////////////////////////////////////////////////////////////////////////////
 struct ui32_list_interpreter : public ojph::cli_interpreter::arg_inter_base
@@ -95,7 +106,10 @@ bool get_arguments(int argc, char *argv[],
                    char *&input_filename, char *&output_filename,
                    ojph::ui32& skipped_res_for_read,
                    ojph::ui32& skipped_res_for_recon,
-                   bool& resilient)
+                   bool& resilient, bool& use_mmap, bool& prefetch,
+                   ojph::ui32& first_frame, ojph::ui32& num_frames,
+                   ojph::ui32& num_threads, char *&timing,
+                   char *&trace_filename, char *&size_stats)
 {
   ojph::cli_interpreter interpreter;
   interpreter.init(argc, argv);
@@ -108,6 +122,14 @@ bool get_arguments(int argc, char *argv[],
   interpreter.reinterpret("-o", output_filename);
   interpreter.reinterpret("-skip_res", &ilist);
   interpreter.reinterpret("-resilient", resilient);
+  interpreter.reinterpret("-mmap", use_mmap);
+  interpreter.reinterpret("-prefetch", prefetch);
+  interpreter.reinterpret("-first_frame", first_frame);
+  interpreter.reinterpret("-num_frames", num_frames);
+  interpreter.reinterpret("-num_threads", num_threads);
+  interpreter.reinterpret("-timing", timing);
+  interpreter.reinterpret("-trace", trace_filename);
+  interpreter.reinterpret("-stats", size_stats);
 
   //interpret skipped_string
   if (num_skipped_res > 0)
@@ -161,6 +183,524 @@ bool is_matching(const char *ref, const char *other)
   return true;
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// returns true if name has exactly one printf-style integer field of the
+// form %d, %5d, or %05d; "%%" is accepted as a literal percent sign
+static
+bool is_numbered_name(const char *name)
+{
+  int num_fields = 0;
+  for (const char *p = name; *p; ++p)
+  {
+    if (*p != '%')
+      continue;
+    ++p;
+    if (*p == '%')
+      continue;
+    while (*p >= '0' && *p <= '9')
+      ++p;
+    if (*p != 'd')
+      OJPH_ERROR(0x02000011, "the file name \"%s\" has a %% that is not "
+        "followed by an integer field, such as %%05d; use %%%% for a "
+        "percent sign\n", name);
+    ++num_fields;
+  }
+  if (num_fields > 1)
+    OJPH_ERROR(0x02000012, "the file name \"%s\" can have only one "
+      "integer field\n", name);
+  return num_fields == 1;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// the image writers; one is used, depending on the output file extension
+struct image_outputs
+{
+  ojph::ppm_out ppm;
+  ojph::pfm_out pfm;
+#ifdef OJPH_ENABLE_TIFF_SUPPORT
+  ojph::tif_out tif;
+#endif // !OJPH_ENABLE_TIFF_SUPPORT
+  ojph::yuv_out yuv;
+  ojph::raw_out raw;
+  bool stripes; // the writer stores samples as pull_stripe() does
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// whether a writer that clamps every component to [0, 2^bit_depth - 1]
+// stores the samples that pull_stripe() stores; that is, whether all
+// components are unsigned, and have this bit depth, of up to 16 bits
+static
+bool has_stripe_samples(const ojph::param_siz& siz, ojph::ui32 bit_depth)
+{
+  if (bit_depth > 16)
+    return false;
+  for (ojph::ui32 c = 0; c < siz.get_num_components(); ++c)
+    if (siz.is_signed(c) || siz.get_bit_depth(c) != bit_depth)
+      return false;
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// configures codestream and one of outs for the output file extension v,
+// and opens output_filename; when frame is not negative, the .yuv or .raw
+// file already exists, and the image is written as frame number frame
+static
+ojph::image_out_base* open_output(ojph::codestream& codestream,
+                                  const char *v, char *output_filename,
+                                  image_outputs& outs, ojph::si64 frame)
+{
+  ojph::image_out_base *base = NULL;
+  ojph::param_siz siz = codestream.access_siz();
+  outs.stripes = false;
+
+  if (is_matching(".pgm", v))
+  {
+
+    if (siz.get_num_components() != 1)
+      OJPH_ERROR(0x02000002,
+        "The file has more than one color component, but .pgm can "
+        "contain only one color component\n");
+    outs.ppm.configure(siz.get_recon_width(0), siz.get_recon_height(0),
+                       siz.get_num_components(), siz.get_bit_depth(0));
+    outs.ppm.open(output_filename);
+    base = &outs.ppm;
+    outs.stripes = has_stripe_samples(siz, siz.get_bit_depth(0));
+  }
+  else if (is_matching(".ppm", v))
+  {
+    codestream.set_planar(false);
+    ojph::param_siz siz = codestream.access_siz();
+
+    if (siz.get_num_components() != 3)
+      OJPH_ERROR(0x02000003,
+        "The file has %d color components; this cannot be saved to"
+        " a .ppm file\n", siz.get_num_components());
+    bool all_same = true;
+    ojph::point p = siz.get_downsampling(0);
+    for (ojph::ui32 i = 1; i < siz.get_num_components(); ++i)
+    {
+      ojph::point p1 = siz.get_downsampling(i);
+      all_same = all_same && (p1.x == p.x) && (p1.y == p.y);
+    }
+    if (!all_same)
+      OJPH_ERROR(0x02000004,
+        "To save an image to ppm, all the components must have the "
+        "same downsampling ratio\n");
+    outs.ppm.configure(siz.get_recon_width(0), siz.get_recon_height(0),
+                       siz.get_num_components(), siz.get_bit_depth(0));
+    outs.ppm.open(output_filename);
+    base = &outs.ppm;
+    outs.stripes = has_stripe_samples(siz, siz.get_bit_depth(0));
+  }
+  else if (is_matching(".pfm", v))
+  {
+    OJPH_INFO(0x02000010, "Note: The .pfm implementation is "
+      "experimental.  Here, we are assuming that the original data is "
+      "floating-point numbers.");
+
+    codestream.set_planar(false);
+    ojph::param_siz siz = codestream.access_siz();
+
+    ojph::ui32 num_comps = siz.get_num_components();
+    if (num_comps != 3 && num_comps != 1)
+      OJPH_ERROR(0x0200000C,
+        "The file has %d color components; this cannot be saved to"
+        " a .pfm file", num_comps);
+    bool all_same = true;
+    ojph::point p = siz.get_downsampling(0);
+    for (ojph::ui32 i = 1; i < siz.get_num_components(); ++i) {
+      ojph::point p1 = siz.get_downsampling(i);
+      all_same = all_same && (p1.x == p.x) && (p1.y == p.y);
+    }
+    if (!all_same)
+      OJPH_ERROR(0x0200000D,
+        "To save an image to ppm, all the components must have the "
+        "same downsampling ratio");
+    ojph::ui32 bit_depth[3];
+    for (ojph::ui32 c = 0; c < siz.get_num_components(); ++c)
+      bit_depth[c] = siz.get_bit_depth(c);
+    outs.pfm.configure(siz.get_recon_width(0), siz.get_recon_height(0),
+      siz.get_num_components(), -1.0f, bit_depth);
+    outs.pfm.open(output_filename);
+    base = &outs.pfm;
+  }
+#ifdef OJPH_ENABLE_TIFF_SUPPORT
+  else if (is_matching(".tif", v) || is_matching(".tiff", v))
+  {
+    codestream.set_planar(false);
+    ojph::param_siz siz = codestream.access_siz();
+
+    bool all_same = true;
+    ojph::point p = siz.get_downsampling(0);
+    for (unsigned int i = 1; i < siz.get_num_components(); ++i)
+    {
+      ojph::point p1 = siz.get_downsampling(i);
+      all_same = all_same && (p1.x == p.x) && (p1.y == p.y);
+    }
+    if (!all_same)
+      OJPH_ERROR(0x02000005,
+        "To save an image to tif(f), all the components must have the "
+        "same downsampling ratio\n");
+    ojph::ui32 bit_depths[4] = { 0, 0, 0, 0 };
+    for (ojph::ui32 c = 0; c < siz.get_num_components(); c++)
+    {
+      bit_depths[c] = siz.get_bit_depth(c);
+    }
+    outs.tif.configure(siz.get_recon_width(0), siz.get_recon_height(0),
+      siz.get_num_components(), bit_depths);
+    outs.tif.open(output_filename);
+    base = &outs.tif;
+  }
+#endif // !OJPH_ENABLE_TIFF_SUPPORT
+  else if (is_matching(".yuv", v))
+  {
+    codestream.set_planar(true);
+    ojph::param_siz siz = codestream.access_siz();
+
+    if (siz.get_num_components() != 3 && siz.get_num_components() != 1)
+      OJPH_ERROR(0x02000006,
+        "The file has %d color components; this cannot be saved to"
+         " .yuv file\n", siz.get_num_components());
+    ojph::param_cod cod = codestream.access_cod();
+    if (cod.is_using_color_transform())
+      OJPH_ERROR(0x02000007,
+        "The current implementation of yuv file object does not"
+        " support saving file when conversion from yuv to rgb is"
+        " needed; in any case, this is not the normal usage of yuv"
+        "file.");
+    ojph::ui32 comp_widths[3];
+    ojph::ui32 max_bit_depth = 0;
+    for (ojph::ui32 i = 0; i < siz.get_num_components(); ++i)
+    {
+      comp_widths[i] = siz.get_recon_width(i);
+      max_bit_depth = ojph_max(max_bit_depth, siz.get_bit_depth(i));
+    }
+    codestream.set_planar(true);
+    outs.yuv.configure(max_bit_depth, siz.get_num_components(),
+                       comp_widths);
+    if (frame < 0)
+      outs.yuv.open(output_filename);
+    else
+    {
+      ojph::ui64 frame_size = 0;
+      for (ojph::ui32 i = 0; i < siz.get_num_components(); ++i)
+        frame_size += (ojph::ui64)comp_widths[i] * siz.get_recon_height(i);
+      frame_size *= max_bit_depth > 8 ? 2 : 1;
+      outs.yuv.open(output_filename, (ojph::si64)frame_size * frame);
+    }
+    base = &outs.yuv;
+    outs.stripes = has_stripe_samples(siz, max_bit_depth);
+  }
+  else if (is_matching(".raw", v))
+  {
+    ojph::param_siz siz = codestream.access_siz();
+
+    if (siz.get_num_components() != 1)
+      OJPH_ERROR(0x02000008,
+        "The file has %d color components; this cannot be saved to"
+        " .raw file (only one component is allowed).\n",
+        siz.get_num_components());
+    bool is_signed = siz.is_signed(0);
+    ojph::ui32 width = siz.get_recon_width(0);
+    ojph::ui32 bit_depth = siz.get_bit_depth(0);
+    outs.raw.configure(is_signed, bit_depth, width);
+    if (frame < 0)
+      outs.raw.open(output_filename);
+    else
+    {
+      ojph::ui64 frame_size = (ojph::ui64)width * siz.get_recon_height(0);
+      frame_size *= (bit_depth + 7) >> 3;
+      outs.raw.open(output_filename, (ojph::si64)frame_size * frame);
+    }
+    base = &outs.raw;
+    outs.stripes = bit_depth <= 16;
+  }
+  else
+#ifdef OJPH_ENABLE_TIFF_SUPPORT
+    OJPH_ERROR(0x02000009,
+      "unknown output file extension; only pgm, ppm, tif(f) and raw(yuv))"
+      " are supported\n");
+#else
+    OJPH_ERROR(0x0200000A,
+      "unknown output file extension; only pgm, ppm, and raw(yuv) are"
+      " supported\n");
+#endif // !OJPH_ENABLE_TIFF_SUPPORT
+
+  return base;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// the phases reported by -timing
+enum : ojph::ui32 {
+  PHASE_OPEN, PHASE_READ_FILE, PHASE_READ_HEADERS, PHASE_CREATE,
+  PHASE_DECODE, PHASE_WRITE_IMAGE, PHASE_CLOSE
+};
+
+/////////////////////////////////////////////////////////////////////////////
+static
+void init_phase_timer(ojph::phase_timer& timer, bool enable)
+{
+  timer.add_phase("open");
+  timer.add_phase("read_file");
+  timer.add_phase("read_headers");
+  timer.add_phase("create");
+  timer.add_phase("decode");
+  timer.add_phase("write_image");
+  timer.add_phase("close");
+  timer.enable(enable);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// the rows decoded into a stripe and written out together
+static const ojph::ui32 STRIPE_ROWS = 64;
+
+/////////////////////////////////////////////////////////////////////////////
+// creates the codestream and pulls all the lines of one image into base;
+// pulling lines and writing them are timed separately.  When stripes is
+// true and base supports it, rows are decoded straight into the layout of
+// the file with pull_stripe(), instead of being pulled one line at a time
+static
+void decode_image(ojph::codestream& codestream, ojph::image_out_base *base,
+                  bool stripes, ojph::phase_timer& timer)
+{
+  timer.next(PHASE_CREATE);
+  codestream.create();
+
+  ojph::frame_buffer stripe;
+  if (stripes && base->get_stripe(STRIPE_ROWS, stripe))
+  {
+    ojph::param_siz siz = codestream.access_siz();
+    bool planar = codestream.is_planar();
+    ojph::ui32 c = 0, rows_left = siz.get_recon_height(0);
+    while (true)
+    {
+      timer.next(PHASE_DECODE);
+      ojph::ui32 rows = codestream.pull_stripe(stripe, STRIPE_ROWS);
+      if (rows == 0)
+        break;
+      timer.next(PHASE_WRITE_IMAGE);
+      base->write_stripe(c, rows);
+      rows_left -= rows;
+      if (planar && rows_left == 0 && ++c < siz.get_num_components())
+        rows_left = siz.get_recon_height(c);
+    }
+  }
+  else if (codestream.is_planar())
+  {
+    ojph::param_siz siz = codestream.access_siz();
+    for (ojph::ui32 c = 0; c < siz.get_num_components(); ++c)
+    {
+      ojph::ui32 height = siz.get_recon_height(c);
+      for (ojph::ui32 i = height; i > 0; --i)
+      {
+        ojph::ui32 comp_num;
+        timer.next(PHASE_DECODE);
+        ojph::line_buf *line = codestream.pull(comp_num);
+        assert(comp_num == c);
+        timer.next(PHASE_WRITE_IMAGE);
+        base->write(line, comp_num);
+      }
+    }
+  }
+  else
+  {
+    ojph::param_siz siz = codestream.access_siz();
+    ojph::ui32 height = siz.get_recon_height(0);
+    for (ojph::ui32 i = 0; i < height; ++i)
+    {
+      for (ojph::ui32 c = 0; c < siz.get_num_components(); ++c)
+      {
+        ojph::ui32 comp_num;
+        timer.next(PHASE_DECODE);
+        ojph::line_buf *line = codestream.pull(comp_num);
+        assert(comp_num == c);
+        timer.next(PHASE_WRITE_IMAGE);
+        base->write(line, comp_num);
+      }
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// everything one thread needs to decode frames; the codestream is
+// restart()ed between frames, keeping its memory, and the buffer that
+// receives each codestream only grows
+struct frame_worker
+{
+  frame_worker() : num_pixels(0), num_bytes(0) {}
+
+  ojph::codestream codestream;
+  ojph::mem_infile mem_file;
+  std::vector<ojph::ui8> data;
+  ojph::phase_timer timer;
+  ojph::coded_size_report sizes; // of the codestreams of this worker
+  ojph::ui64 num_pixels;     // decoded by this worker, in component 0
+  ojph::ui64 num_bytes;      // of the codestreams decoded by this worker
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// the frames of a batch and the state shared by its workers
+struct frame_batch
+{
+  frame_batch()
+  : next_frame(0), end_frame(0), first_frame(0), input_filename(NULL),
+    output_filename(NULL), extension(NULL), numbered_input(false),
+    numbered_output(false), skipped_res_for_read(0),
+    skipped_res_for_recon(0), resilient(false), size_stats(false),
+    failed(false)
+  {}
+
+  ojph::ui64 next_frame;     // the next frame to be picked by a worker
+  ojph::ui64 end_frame;      // one past the last frame to decode
+  ojph::ui64 first_frame;
+  const char *input_filename;
+  char *output_filename;
+  const char *extension;     // of the output file
+  bool numbered_input;       // else, codestreams are listed in offsets
+  bool numbered_output;      // else, frames go into one .yuv or .raw file
+  std::vector<ojph::ui64> offsets; // offset and length of each codestream
+  ojph::ui32 skipped_res_for_read, skipped_res_for_recon;
+  bool resilient;
+  bool size_stats;           // true to collect the sizes of codeblocks
+  bool failed;
+#ifndef OJPH_EMSCRIPTEN
+  std::mutex mutex;
+#endif
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// reads the codestream of frame into the buffer of worker
+static
+size_t read_frame(frame_worker *worker, frame_batch *batch, FILE *fh,
+                  ojph::ui64 frame)
+{
+  char name[1024];
+  ojph::si64 offset = 0, length;
+  if (batch->numbered_input)
+  {
+    int len = snprintf(name, sizeof(name), batch->input_filename, (int)frame);
+    if (len < 0 || len >= (int)sizeof(name))
+      OJPH_ERROR(0x02000013, "the input file name for frame %d is too "
+        "long\n", (int)frame);
+    fh = fopen(name, "rb");
+    if (fh == NULL)
+      OJPH_ERROR(0x02000014, "unable to open file %s\n", name);
+    ojph::ojph_fseek(fh, 0, SEEK_END);
+    length = ojph::ojph_ftell(fh);
+  }
+  else
+  {
+    offset = (ojph::si64)batch->offsets[2 * frame];
+    length = (ojph::si64)batch->offsets[2 * frame + 1];
+  }
+
+  bool success = length > 0 && ojph::ojph_fseek(fh, offset, SEEK_SET) == 0;
+  if (success)
+  {
+    if (worker->data.size() < (size_t)length)
+      worker->data.resize((size_t)length);
+    success = fread(worker->data.data(), 1, (size_t)length, fh)
+            == (size_t)length;
+  }
+  if (batch->numbered_input)
+    fclose(fh);
+  if (!success)
+    OJPH_ERROR(0x02000015, "unable to read the codestream of frame %d\n",
+      (int)frame);
+  return (size_t)length;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// picks frames from batch and decodes them until none is left
+static
+void decode_frames(frame_worker *worker, frame_batch *batch)
+{
+  FILE *fh = NULL;
+  try
+  {
+    if (!batch->numbered_input)
+    {
+      fh = fopen(batch->input_filename, "rb");
+      if (fh == NULL)
+        OJPH_ERROR(0x02000016, "unable to open file %s\n",
+          batch->input_filename);
+    }
+    ojph::codestream& codestream = worker->codestream;
+    codestream.enable_header_cache(true);
+    while (true)
+    {
+      ojph::ui64 frame;
+      {
+#ifndef OJPH_EMSCRIPTEN
+        std::lock_guard<std::mutex> lock(batch->mutex);
+#endif
+        if (batch->failed || batch->next_frame >= batch->end_frame)
+          break;
+        frame = batch->next_frame++;
+      }
+
+      ojph::trace_span span("decode_frame", "frame", "frame",
+                            (ojph::si64)frame);
+      ojph::phase_timer& timer = worker->timer;
+      timer.next(PHASE_READ_FILE);
+      size_t length = read_frame(worker, batch, fh, frame);
+      worker->num_bytes += length;
+      timer.next(PHASE_READ_HEADERS);
+      worker->mem_file.open(worker->data.data(), length, true);
+      if (batch->resilient)
+        codestream.enable_resilience();
+      codestream.read_headers(&worker->mem_file);
+      codestream.restrict_input_resolution(batch->skipped_res_for_read,
+        batch->skipped_res_for_recon);
+
+      char name[1024];
+      ojph::si64 out_frame = -1;
+      if (batch->numbered_output)
+      {
+        int len = snprintf(name, sizeof(name), batch->output_filename,
+          (int)frame);
+        if (len < 0 || len >= (int)sizeof(name))
+          OJPH_ERROR(0x02000017, "the output file name for frame %d is "
+            "too long\n", (int)frame);
+      }
+      else
+      {
+        strncpy(name, batch->output_filename, sizeof(name) - 1);
+        name[sizeof(name) - 1] = '\0';
+        out_frame = (ojph::si64)(frame - batch->first_frame);
+      }
+
+      timer.next(PHASE_OPEN);
+      image_outputs outs;
+      ojph::image_out_base *base =
+        open_output(codestream, batch->extension, name, outs, out_frame);
+      const ojph::param_siz siz = codestream.get_siz();
+      worker->num_pixels +=
+        (ojph::ui64)siz.get_recon_width(0) * siz.get_recon_height(0);
+      decode_image(codestream, base, outs.stripes, timer);
+      if (batch->size_stats)
+        worker->sizes.add(codestream);
+      timer.next(PHASE_CLOSE);
+      base->close();
+      codestream.close();
+      codestream.restart();
+      timer.stop();
+    }
+  }
+  catch (const std::exception& e)
+  {
+    const char *p = e.what();
+    if (strncmp(p, "ojph error", 10) != 0)
+      printf("%s\n", p);
+#ifndef OJPH_EMSCRIPTEN
+    std::lock_guard<std::mutex> lock(batch->mutex);
+#endif
+    batch->failed = true;
+  }
+  if (fh)
+    fclose(fh);
+}
+
 /////////////////////////////////////////////////////////////////////////////
 int main(int argc, char *argv[]) {
 
@@ -169,6 +709,14 @@ int main(int argc, char *argv[]) {
   ojph::ui32 skipped_res_for_read = 0;
   ojph::ui32 skipped_res_for_recon = 0;
   bool resilient = false;
+  bool use_mmap = false;
+  bool prefetch = false;
+  ojph::ui32 first_frame = 0;
+  ojph::ui32 num_frames = 1;
+  ojph::ui32 num_threads = 0;
+  char *timing = NULL;
+  char *trace_filename = NULL;
+  char *size_stats = NULL;
 
   if (argc <= 1) {
     std::cout <<
@@ -190,237 +738,259 @@ int main(int argc, char *argv[]) {
     " -resilient <true | false> if 'true', the decoder will not exit when\n"
     "            running into recoverable errors in the codestream.\n"
     "            Default: 'false'.\n"
+    " -mmap      <true | false> if 'true', the input file is memory-mapped\n"
+    "            and codeblock data is used in place, instead of being\n"
+    "            copied; this reduces memory usage for large files.\n"
+    "            Default: 'false'.\n"
+    " -prefetch  <true | false> if 'true', the input file is read ahead by\n"
+    "            a background thread while the codestream is decoded.\n"
+    "            Default: 'false'.\n"
+    "\n"
+    "The following arguments decode many frames in one run:\n"
+    " -first_frame (0) the index of the first frame to decode.\n"
+    " -num_frames  (1) the number of frames to decode; 0 decodes all\n"
+    "              frames from first_frame on.\n"
+    " -num_threads (0) the number of frames decoded concurrently; 0 uses\n"
+    "              one thread per available processor.\n"
+    "            The input is either a file name with a printf-style\n"
+    "            integer field, such as in_%05d.j2c, where every frame is\n"
+    "            in its own file, or a file of concatenated codestreams,\n"
+    "            with a companion <input>.idx file that lists the byte\n"
+    "            offset and length of each codestream, one per line, as\n"
+    "            written by ojph_compress.  Similarly, the output is either\n"
+    "            a file name with an integer field, or a .yuv or .raw file\n"
+    "            that receives all the frames, one after the other.\n"
+    "\n"
+    "The following argument reports where time is spent:\n"
+    " -timing    <text | json> prints, instead of the elapsed time, the\n"
+    "            wall-clock and CPU time of every phase: opening files,\n"
+    "            reading codestreams, reading headers, creating the\n"
+    "            codestream, decoding, writing the image, and closing,\n"
+    "            followed by the totals, megapixels per second, and\n"
+    "            codestream bytes per second.  With many threads, phase\n"
+    "            times are summed over all threads.\n"
+    " -trace     <file> writes a timeline of the work of every thread to\n"
+    "            file, as trace-event JSON, which chrome://tracing and\n"
+    "            ui.perfetto.dev display.\n"
+    " -stats     <text | json> prints the coded size of every component,\n"
+    "            resolution, and band, from the packet headers: the\n"
+    "            number of codeblocks, the fraction of them that have no\n"
+    "            coded data, their average missing MSBs, and their\n"
+    "            bytes, followed by a histogram of codeblock sizes.  With\n"
+    "            many frames, sizes are summed over all frames.\n"
     "\n"
     ;
     return -1;
   }
   if (!get_arguments(argc, argv, input_filename, output_filename,
                      skipped_res_for_read, skipped_res_for_recon,
-                     resilient))
+                     resilient, use_mmap, prefetch,
+                     first_frame, num_frames, num_threads, timing,
+                     trace_filename, size_stats))
   {
     return -1;
   }
 
   clock_t begin = clock();
+  double begin_wall = ojph::phase_timer::get_wall_time();
+  ojph::phase_timer phase_times;  // the sum of the timers of all workers
+  init_phase_timer(phase_times, timing != NULL);
+  ojph::ui64 num_decoded = 0, num_pixels = 0, num_bytes = 0;
+  ojph::coded_size_report sizes;  // the sum of the sizes of all workers
 
   try {
+    if (timing && !is_matching("text", timing)
+               && !is_matching("json", timing))
+      OJPH_ERROR(0x0200001F, "-timing must be text or json\n");
+    if (size_stats && !is_matching("text", size_stats)
+                   && !is_matching("json", size_stats))
+      OJPH_ERROR(0x02000022, "-stats must be text or json\n");
+    if (trace_filename && !ojph::trace_start(trace_filename))
+      OJPH_ERROR(0x02000020, "unable to open file %s for writing\n",
+        trace_filename);
+    ojph::trace_set_thread_name("main");
     if (output_filename == NULL)
       OJPH_ERROR(0x02000001,
                  "Please provide an output file using the -o option\n");
+    if (input_filename == NULL)
+      OJPH_ERROR(0x02000018,
+                 "Please provide an input file using the -i option\n");
 
-    ojph::j2c_infile j2c_file;
-    j2c_file.open(input_filename);
-    ojph::codestream codestream;
-
-    ojph::ppm_out ppm;
-    ojph::pfm_out pfm;
-    #ifdef OJPH_ENABLE_TIFF_SUPPORT
-    ojph::tif_out tif;
-    #endif /* OJPH_ENABLE_TIFF_SUPPORT */
-    ojph::yuv_out yuv;
-    ojph::raw_out raw;
-    ojph::image_out_base *base = NULL;
     const char *v = get_file_extension(output_filename);
-    if (v)
-    {
-      if (resilient)
-        codestream.enable_resilience();
-      codestream.read_headers(&j2c_file);
-      codestream.restrict_input_resolution(skipped_res_for_read,
-        skipped_res_for_recon);
-      ojph::param_siz siz = codestream.access_siz();
-
-      if (is_matching(".pgm", v))
-      {
+    if (v == NULL)
+      OJPH_ERROR(0x0200000B,
+        "Please supply a proper output filename with a proper extension\n");
 
-        if (siz.get_num_components() != 1)
-          OJPH_ERROR(0x02000002,
-            "The file has more than one color component, but .pgm can "
-            "contain only one color component\n");
-        ppm.configure(siz.get_recon_width(0), siz.get_recon_height(0),
-                      siz.get_num_components(), siz.get_bit_depth(0));
-        ppm.open(output_filename);
-        base = &ppm;
-      }
-      else if (is_matching(".ppm", v))
-      {
-        codestream.set_planar(false);
-        ojph::param_siz siz = codestream.access_siz();
-
-        if (siz.get_num_components() != 3)
-          OJPH_ERROR(0x02000003,
-            "The file has %d color components; this cannot be saved to"
-            " a .ppm file\n", siz.get_num_components());
-        bool all_same = true;
-        ojph::point p = siz.get_downsampling(0);
-        for (ojph::ui32 i = 1; i < siz.get_num_components(); ++i)
-        {
-          ojph::point p1 = siz.get_downsampling(i);
-          all_same = all_same && (p1.x == p.x) && (p1.y == p.y);
-        }
-        if (!all_same)
-          OJPH_ERROR(0x02000004,
-            "To save an image to ppm, all the components must have the "
-            "same downsampling ratio\n");
-        ppm.configure(siz.get_recon_width(0), siz.get_recon_height(0),
-                      siz.get_num_components(), siz.get_bit_depth(0));
-        ppm.open(output_filename);
-        base = &ppm;
-      }
-      else if (is_matching(".pfm", v))
-      {
-        OJPH_INFO(0x02000010, "Note: The .pfm implementation is "
-          "experimental.  Here, we are assuming that the original data is "
-          "floating-point numbers.");
-
-        codestream.set_planar(false);
-        ojph::param_siz siz = codestream.access_siz();
-
-        ojph::ui32 num_comps = siz.get_num_components();
-        if (num_comps != 3 && num_comps != 1)
-          OJPH_ERROR(0x0200000C,
-            "The file has %d color components; this cannot be saved to"
-            " a .pfm file", num_comps);
-        bool all_same = true;
-        ojph::point p = siz.get_downsampling(0);
-        for (ojph::ui32 i = 1; i < siz.get_num_components(); ++i) {
-          ojph::point p1 = siz.get_downsampling(i);
-          all_same = all_same && (p1.x == p.x) && (p1.y == p.y);
-        }
-        if (!all_same)
-          OJPH_ERROR(0x0200000D,
-            "To save an image to ppm, all the components must have the "
-            "same downsampling ratio");
-        ojph::ui32 bit_depth[3];
-        for (ojph::ui32 c = 0; c < siz.get_num_components(); ++c)
-          bit_depth[c] = siz.get_bit_depth(c);
-        pfm.configure(siz.get_recon_width(0), siz.get_recon_height(0),
-          siz.get_num_components(), -1.0f, bit_depth);
-        pfm.open(output_filename);
-        base = &pfm;
-      }
-#ifdef OJPH_ENABLE_TIFF_SUPPORT
-      else if (is_matching(".tif", v) || is_matching(".tiff", v))
+    bool numbered_input = is_numbered_name(input_filename);
+    bool numbered_output = is_numbered_name(output_filename);
+    if (numbered_input || numbered_output || first_frame != 0
+        || num_frames != 1)
+    {
+      frame_batch batch;
+      batch.first_frame = first_frame;
+      batch.input_filename = input_filename;
+      batch.output_filename = output_filename;
+      batch.extension = v;
+      batch.numbered_input = numbered_input;
+      batch.numbered_output = numbered_output;
+      batch.skipped_res_for_read = skipped_res_for_read;
+      batch.skipped_res_for_recon = skipped_res_for_recon;
+      batch.resilient = resilient;
+      batch.size_stats = size_stats != NULL;
+      if (use_mmap || prefetch)
+        OJPH_WARN(0x02000019, "-mmap and -prefetch are not used when "
+          "decoding many frames\n");
+
+      ojph::ui64 available;
+      if (numbered_input)
       {
-        codestream.set_planar(false);
-        ojph::param_siz siz = codestream.access_siz();
-
-        bool all_same = true;
-        ojph::point p = siz.get_downsampling(0);
-        for (unsigned int i = 1; i < siz.get_num_components(); ++i)
+        // frames are available up to the first missing file
+        available = first_frame;
+        while (num_frames == 0 || available < (ojph::ui64)first_frame
+                                              + num_frames)
         {
-          ojph::point p1 = siz.get_downsampling(i);
-          all_same = all_same && (p1.x == p.x) && (p1.y == p.y);
+          char name[1024];
+          snprintf(name, sizeof(name), input_filename, (int)available);
+          FILE *f = fopen(name, "rb");
+          if (f == NULL)
+            break;
+          fclose(f);
+          ++available;
         }
-        if (!all_same)
-          OJPH_ERROR(0x02000005,
-            "To save an image to tif(f), all the components must have the "
-            "same downsampling ratio\n");
-        ojph::ui32 bit_depths[4] = { 0, 0, 0, 0 };
-        for (ojph::ui32 c = 0; c < siz.get_num_components(); c++)
-        {
-          bit_depths[c] = siz.get_bit_depth(c);
-        }
-        tif.configure(siz.get_recon_width(0), siz.get_recon_height(0),
-          siz.get_num_components(), bit_depths);
-        tif.open(output_filename);
-        base = &tif;
       }
-#endif // !OJPH_ENABLE_TIFF_SUPPORT
-      else if (is_matching(".yuv", v))
+      else
       {
-        codestream.set_planar(true);
-        ojph::param_siz siz = codestream.access_siz();
-
-        if (siz.get_num_components() != 3 && siz.get_num_components() != 1)
-          OJPH_ERROR(0x02000006,
-            "The file has %d color components; this cannot be saved to"
-             " .yuv file\n", siz.get_num_components());
-        ojph::param_cod cod = codestream.access_cod();
-        if (cod.is_using_color_transform())
-          OJPH_ERROR(0x02000007,
-            "The current implementation of yuv file object does not"
-            " support saving file when conversion from yuv to rgb is"
-            " needed; in any case, this is not the normal usage of yuv"
-            "file.");
-        ojph::ui32 comp_widths[3];
-        ojph::ui32 max_bit_depth = 0;
-        for (ojph::ui32 i = 0; i < siz.get_num_components(); ++i)
+        std::string index_name = input_filename;
+        index_name += ".idx";
+        FILE *f = fopen(index_name.c_str(), "r");
+        if (f == NULL)
+          OJPH_ERROR(0x0200001A, "decoding many frames from %s needs the "
+            "index file %s\n", input_filename, index_name.c_str());
+        unsigned long long offset, length;
+        while (fscanf(f, "%llu %llu", &offset, &length) == 2)
         {
-          comp_widths[i] = siz.get_recon_width(i);
-          max_bit_depth = ojph_max(max_bit_depth, siz.get_bit_depth(i));
+          batch.offsets.push_back((ojph::ui64)offset);
+          batch.offsets.push_back((ojph::ui64)length);
         }
-        codestream.set_planar(true);
-        yuv.configure(max_bit_depth, siz.get_num_components(), comp_widths);
-        yuv.open(output_filename);
-        base = &yuv;
+        fclose(f);
+        available = batch.offsets.size() / 2;
       }
-      else if (is_matching(".raw", v))
+      if (first_frame >= available)
+        OJPH_ERROR(0x0200001B, "-first_frame is %u, but there are %llu "
+          "frames only\n", first_frame, (unsigned long long)available);
+      batch.next_frame = first_frame;
+      batch.end_frame = available;
+      if (num_frames != 0)
+        batch.end_frame = (ojph::ui64)first_frame + num_frames;
+      if (batch.end_frame > available)
+        OJPH_ERROR(0x0200001C, "frames %u to %llu are requested, but there "
+          "are %llu frames only\n", first_frame,
+          (unsigned long long)batch.end_frame - 1,
+          (unsigned long long)available);
+
+      if (!numbered_output)
       {
-        ojph::param_siz siz = codestream.access_siz();
-
-        if (siz.get_num_components() != 1)
-          OJPH_ERROR(0x02000008,
-            "The file has %d color components; this cannot be saved to"
-            " .raw file (only one component is allowed).\n",
-            siz.get_num_components());
-        bool is_signed = siz.is_signed(0);
-        ojph::ui32 width = siz.get_recon_width(0);
-        ojph::ui32 bit_depth = siz.get_bit_depth(0);
-        raw.configure(is_signed, bit_depth, width);
-        raw.open(output_filename);
-        base = &raw;
+        if (!is_matching(".yuv", v) && !is_matching(".raw", v))
+          OJPH_ERROR(0x0200001D, "many frames can be stored in one .yuv "
+            "or .raw file only; otherwise, the output file name must have "
+            "an integer field, such as out_%%05d.ppm\n");
+        FILE *f = fopen(output_filename, "wb"); // workers write into it
+        if (f == NULL)
+          OJPH_ERROR(0x0200001E, "unable to open file %s for writing\n",
+            output_filename);
+        fclose(f);
       }
-      else
-#ifdef OJPH_ENABLE_TIFF_SUPPORT
-        OJPH_ERROR(0x02000009,
-          "unknown output file extension; only pgm, ppm, tif(f) and raw(yuv))"
-          " are supported\n");
-#else
-        OJPH_ERROR(0x0200000A,
-          "unknown output file extension; only pgm, ppm, and raw(yuv) are"
-          " supported\n");
-#endif // !OJPH_ENABLE_TIFF_SUPPORT
-    }
-    else
-      OJPH_ERROR(0x0200000B,
-        "Please supply a proper output filename with a proper extension\n");
-
-    codestream.create();
 
-    if (codestream.is_planar())
-    {
-      ojph::param_siz siz = codestream.access_siz();
-      for (ojph::ui32 c = 0; c < siz.get_num_components(); ++c)
-      {
-        ojph::ui32 height = siz.get_recon_height(c);
-        for (ojph::ui32 i = height; i > 0; --i)
-        {
-          ojph::ui32 comp_num;
-          ojph::line_buf *line = codestream.pull(comp_num);
-          assert(comp_num == c);
-          base->write(line, comp_num);
-        }
+      num_decoded = batch.end_frame - batch.next_frame;
+      ojph::ui32 num_workers = 1;
+#ifndef OJPH_EMSCRIPTEN
+      num_workers = num_threads;
+      if (num_workers == 0)
+        num_workers = ojph_max(std::thread::hardware_concurrency(), 1u);
+      if (num_workers > num_decoded)
+        num_workers = (ojph::ui32)num_decoded;
+#endif
+
+      std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+      frame_worker *workers = new frame_worker[num_workers];
+      for (ojph::ui32 w = 0; w < num_workers; ++w)
+        init_phase_timer(workers[w].timer, timing != NULL);
+#ifndef OJPH_EMSCRIPTEN
+      std::vector<std::thread> threads;
+      for (ojph::ui32 w = 1; w < num_workers; ++w)
+        threads.push_back(std::thread([workers, w, &batch]() {
+          ojph::trace_set_thread_name("frame worker");
+          decode_frames(workers + w, &batch);
+        }));
+      decode_frames(workers, &batch);
+      for (size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+#else
+      decode_frames(workers, &batch);
+#endif
+      for (ojph::ui32 w = 0; w < num_workers; ++w) {
+        phase_times.add(workers[w].timer);
+        sizes.add(workers[w].sizes);
+        num_pixels += workers[w].num_pixels;
+        num_bytes += workers[w].num_bytes;
       }
+      delete[] workers;
+      if (batch.failed)
+        exit(-1);
+      double secs = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+      if (!timing)
+        printf("Decoded %llu frames in %f seconds, %f frames per second, "
+          "using %u threads\n", (unsigned long long)num_decoded, secs,
+          secs > 0.0 ? (double)num_decoded / secs : 0.0, num_workers);
     }
     else
     {
-      ojph::param_siz siz = codestream.access_siz();
-      ojph::ui32 height = siz.get_recon_height(0);
-      for (ojph::ui32 i = 0; i < height; ++i)
-      {
-        for (ojph::ui32 c = 0; c < siz.get_num_components(); ++c)
-        {
-          ojph::ui32 comp_num;
-          ojph::line_buf *line = codestream.pull(comp_num);
-          assert(comp_num == c);
-          base->write(line, comp_num);
-        }
+      phase_times.next(PHASE_OPEN);
+      ojph::j2c_infile j2c_file;
+      ojph::mmap_infile mmap_file;
+      ojph::j2c_prefetch_infile prefetch_file;
+      ojph::infile_base *in_file = &j2c_file;
+      if (use_mmap) {
+        mmap_file.open(input_filename);
+        in_file = &mmap_file;
       }
-    }
+      else if (prefetch) {
+        prefetch_file.open(input_filename);
+        in_file = &prefetch_file;
+      }
+      else
+        j2c_file.open(input_filename);
+      ojph::codestream codestream;
 
-    base->close();
-    codestream.close();
+      phase_times.next(PHASE_READ_HEADERS);
+      if (resilient)
+        codestream.enable_resilience();
+      codestream.read_headers(in_file);
+      codestream.restrict_input_resolution(skipped_res_for_read,
+        skipped_res_for_recon);
+
+      phase_times.next(PHASE_OPEN);
+      image_outputs outs;
+      ojph::image_out_base *base =
+        open_output(codestream, v, output_filename, outs, -1);
+      decode_image(codestream, base, outs.stripes, phase_times);
+      if (size_stats)
+        sizes.add(codestream);
+      num_decoded = 1;
+      const ojph::param_siz siz = codestream.get_siz();
+      num_pixels = (ojph::ui64)siz.get_recon_width(0)
+                 * siz.get_recon_height(0);
+      num_bytes = (ojph::ui64)in_file->tell();
+
+      phase_times.next(PHASE_CLOSE);
+      base->close();
+      codestream.close();
+      phase_times.stop();
+    }
+    if (trace_filename && !ojph::trace_stop())
+      OJPH_ERROR(0x02000021, "error writing file %s\n", trace_filename);
   }
   catch (const std::exception& e)
   {
@@ -432,7 +1002,14 @@ int main(int argc, char *argv[]) {
 
   clock_t end = clock();
   double elapsed_secs = double(end - begin) / CLOCKS_PER_SEC;
-  printf("Elapsed time = %f\n", elapsed_secs);
+  if (timing)
+    phase_times.print(is_matching("json", timing),
+      ojph::phase_timer::get_wall_time() - begin_wall, elapsed_secs,
+      num_decoded, num_pixels, num_bytes);
+  else
+    printf("Elapsed time = %f\n", elapsed_secs);
+  if (size_stats)
+    sizes.print(is_matching("json", size_stats));
 
   return 0;
 }
@@ -40,6 +40,7 @@
 #include "ojph_arg.h"
 #include "ojph_sockets.h"
 #include "ojph_threads.h"
+#include "ojph_trace.h"
 #include "stream_expand_support.h"
 
 #ifdef OJPH_OS_WINDOWS
@@ -56,7 +57,8 @@ bool get_arguments(int argc, char *argv[],
                    char *&target_name, ojph::ui32& num_threads, 
                    ojph::ui32& num_inflight_packets,
                    ojph::ui32& recvfrm_buf_size, bool& blocking,
-                   bool& quiet)
+                   bool& quiet, char *&trace_name,
+                   ojph::ui32& trace_frames)
 {
   ojph::cli_interpreter interpreter;
   interpreter.init(argc, argv);
@@ -69,6 +71,8 @@ bool get_arguments(int argc, char *argv[],
   interpreter.reinterpret("-num_threads", num_threads);
   interpreter.reinterpret("-num_packets", num_inflight_packets);
   interpreter.reinterpret("-recv_buf_size", recvfrm_buf_size);
+  interpreter.reinterpret("-trace", trace_name);
+  interpreter.reinterpret("-trace_frames", trace_frames);
 
   blocking = interpreter.reinterpret("-blocking");
   quiet = interpreter.reinterpret("-quiet");
@@ -122,6 +126,8 @@ int main(int argc, char* argv[])
   ojph::ui32 recvfrm_buf_size = 65536;
   bool blocking = false;
   bool quiet = false;
+  char *trace_name = NULL;
+  ojph::ui32 trace_frames = 100;
 	
   if (argc <= 1) {
     printf(
@@ -165,18 +171,28 @@ int main(int argc, char* argv[])
     "                output_%%05d. An extension will be added, either .j2c\n"
     "                for original frames, or .ppm for decoded images.\n"
     " -quiet         use to stop printing informative messages.\n."
+    " -trace         <string> writes a timeline of the work of every\n"
+    "                thread to this file, as trace-event JSON, which\n"
+    "                chrome://tracing and ui.perfetto.dev display.\n"
+    " -trace_frames  <integer> the number of frames to trace; default is\n"
+    "                100.  The file is written once these are received.\n"
     "\n"
     );
     exit(-1);
   }
   if (!get_arguments(argc, argv, recv_addr, recv_port, src_addr, src_port,
                      target_name, num_threads, num_inflight_packets,
-                     recvfrm_buf_size, blocking, quiet))
+                     recvfrm_buf_size, blocking, quiet, trace_name,
+                     trace_frames))
   {
     exit(-1);
   }
 
   try {
+    if (trace_name && !ojph::trace_start(trace_name))
+      OJPH_ERROR(0x02000007, "Could not open file %s for writing",
+        trace_name);
+    ojph::trace_set_thread_name("main");
     ojph::thds::thread_pool thread_pool;
     thread_pool.init(num_threads);
     ojph::stex::frames_handler frames_handler;
@@ -326,6 +342,20 @@ int main(int argc, char* argv[])
 
       packet->num_bytes = (ojph::ui32)num_bytes;
 
+      if (ojph::trace_is_enabled())
+      {
+        ojph::ui32 total_frames = 0, trunc_frames = 0, lost_frames = 0;
+        frames_handler.get_stats(total_frames, trunc_frames, lost_frames);
+        if (total_frames >= trace_frames)
+        {
+          if (!ojph::trace_stop())
+            OJPH_ERROR(0x02000008, "Could not write file %s", trace_name);
+          if (!quiet)
+            printf("Wrote the timeline of %d frames to %s\n",
+              total_frames, trace_name);
+        }
+      }
+
       if (last_time_stamp == 0)
         last_time_stamp = packet->get_time_stamp();
 
@@ -35,6 +35,7 @@
 // Date: 23 April 2024
 //***************************************************************************/
 
+#include "ojph_trace.h"
 #include "threaded_frame_processors.h"
 
 namespace ojph
@@ -52,6 +53,7 @@ namespace stex
 
 void j2k_frame_storer::execute()
 {
+  trace_span span("store_frame", "task", "frame", file->frame_idx);
   //printf("saving file with index %d\n", file->frame_idx);
   char buf[128], name[128];
   snprintf(buf, 128, "%s.j2c", file->name_template);
@@ -554,6 +554,40 @@ namespace ojph {
     return 0;
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  bool ppm_out::get_stripe(ui32 num_rows, frame_buffer& stripe)
+  {
+    assert(fh);
+    size_t size = (size_t)num_rows * bytes_per_line;
+    if (size > buffer_size)
+    {
+      buffer = (ui8*)realloc(buffer, size);
+      buffer_size = size;
+    }
+    for (ui32 c = 0; c < num_components; ++c)
+    {
+      stripe_comps[c].data = buffer + c * bytes_per_sample;
+      stripe_comps[c].stride = bytes_per_line;
+      stripe_comps[c].step = num_components;
+    }
+    stripe.sample = bytes_per_sample == 1 ? OJPH_FRAME_8BIT
+                                          : OJPH_FRAME_16BIT;
+    stripe.num_components = num_components;
+    stripe.comps = stripe_comps;
+    stripe.byte_order = OJPH_FRAME_BIG_ENDIAN;
+    return true;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void ppm_out::write_stripe(ui32 comp_num, ui32 num_rows)
+  {
+    ojph_unused(comp_num);
+    assert(fh);
+    size_t num_samples = (size_t)num_rows * samples_per_line;
+    if (fwrite(buffer, bytes_per_sample, num_samples, fh) != num_samples)
+      OJPH_ERROR(0x03000042, "error writing to file %s", fname);
+  }
+
   ////////////////////////////////////////////////////////////////////////////
   //
   //
@@ -1342,10 +1376,33 @@ namespace ojph {
       comp_address[i] += width[i-1] * height[i-1] * bytes_per_sample[i-1];
       max_byte_width = ojph_max(max_byte_width, width[i]*bytes_per_sample[i]);
     }
+    frame_size = 0;
+    for (ui32 i = 0; i < num_com; ++i)
+      frame_size += (ui64)width[i] * height[i] * bytes_per_sample[i];
+    num_frames = 0;
+    if (ojph_fseek(fh, 0, SEEK_END) == 0)
+    {
+      si64 file_size = ojph_ftell(fh);
+      if (file_size > 0 && frame_size > 0)
+        num_frames = (ui64)file_size / frame_size;
+    }
+    ojph_fseek(fh, 0, SEEK_SET);
     temp_buf = malloc(max_byte_width);
     fname = filename;
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  void yuv_in::seek_frame(ui64 frame)
+  {
+    assert(fh);
+    if (frame >= num_frames ||
+        ojph_fseek(fh, (si64)(frame * frame_size), SEEK_SET) != 0)
+      OJPH_ERROR(0x030000D2, "frame %llu is not in file %s",
+        (unsigned long long)frame, fname);
+    cur_line = 0;
+    last_comp = 0;
+  }
+
   ////////////////////////////////////////////////////////////////////////////
   ui32 yuv_in::read(const line_buf* line, ui32 comp_num)
   {
@@ -1454,6 +1511,18 @@ namespace ojph {
     fname = filename;
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  void yuv_out::open(char *filename, si64 offset)
+  {
+    assert(fh == NULL); //configure before open
+    fh = fopen(filename, "r+b");
+    if (fh == 0)
+      OJPH_ERROR(0x03000112, "Unable to open file %s", filename);
+    if (ojph_fseek(fh, offset, SEEK_SET) != 0)
+      OJPH_ERROR(0x03000113, "Unable to seek in file %s", filename);
+    fname = filename;
+  }
+
   ////////////////////////////////////////////////////////////////////////////
   void yuv_out::configure(ui32 bit_depth, ui32 num_components,
                           ui32* comp_width)
@@ -1513,6 +1582,42 @@ namespace ojph {
     return w;
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  bool yuv_out::get_stripe(ui32 num_rows, frame_buffer& stripe)
+  {
+    assert(fh);
+    ui32 bytes_per_sample = bit_depth > 8 ? 2 : 1;
+    ui32 size = num_rows * width * bytes_per_sample;
+    if (size > buffer_size)
+    {
+      buffer = (ui8*)realloc(buffer, size);
+      buffer_size = size;
+    }
+    for (ui32 c = 0; c < num_components; ++c)
+    { // planar; the stripe holds rows of one component at a time
+      stripe_comps[c].data = buffer;
+      stripe_comps[c].stride = comp_width[c] * bytes_per_sample;
+      stripe_comps[c].step = 1;
+    }
+    stripe.sample = bytes_per_sample == 1 ? OJPH_FRAME_8BIT
+                                          : OJPH_FRAME_16BIT;
+    stripe.num_components = num_components;
+    stripe.comps = stripe_comps;
+    stripe.byte_order = OJPH_FRAME_LITTLE_ENDIAN;
+    return true;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void yuv_out::write_stripe(ui32 comp_num, ui32 num_rows)
+  {
+    assert(fh);
+    assert(comp_num < num_components);
+    ui32 bytes_per_sample = bit_depth > 8 ? 2 : 1;
+    size_t num_samples = (size_t)num_rows * comp_width[comp_num];
+    if (fwrite(buffer, bytes_per_sample, num_samples, fh) != num_samples)
+      OJPH_ERROR(0x03000123, "unable to write to file %s", fname);
+  }
+
   ////////////////////////////////////////////////////////////////////////////
   //
   //
@@ -1533,9 +1638,29 @@ namespace ojph {
     bytes_per_sample = (bit_depth + 7) >> 3;
     buffer_size = (size_t)width * bytes_per_sample;
     buffer = (ui8*)malloc(buffer_size);
+    frame_size = (ui64)buffer_size * height;
+    num_frames = 0;
+    if (ojph_fseek(fh, 0, SEEK_END) == 0)
+    {
+      si64 file_size = ojph_ftell(fh);
+      if (file_size > 0 && frame_size > 0)
+        num_frames = (ui64)file_size / frame_size;
+    }
+    ojph_fseek(fh, 0, SEEK_SET);
     fname = filename;
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  void raw_in::seek_frame(ui64 frame)
+  {
+    assert(fh);
+    if (frame >= num_frames ||
+        ojph_fseek(fh, (si64)(frame * frame_size), SEEK_SET) != 0)
+      OJPH_ERROR(0x03000133, "frame %llu is not in file %s",
+        (unsigned long long)frame, fname);
+    cur_line = 0;
+  }
+
   ////////////////////////////////////////////////////////////////////////////
   ui32 raw_in::read(const line_buf* line, ui32 comp_num)
   {
@@ -1653,6 +1778,18 @@ namespace ojph {
     fname = filename;
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  void raw_out::open(char *filename, si64 offset)
+  {
+    assert(fh == NULL); //configure before open
+    fh = fopen(filename, "r+b");
+    if (fh == 0)
+      OJPH_ERROR(0x03000142, "Unable to open file %s", filename);
+    if (ojph_fseek(fh, offset, SEEK_SET) != 0)
+      OJPH_ERROR(0x03000143, "Unable to seek in file %s", filename);
+    fname = filename;
+  }
+
   ////////////////////////////////////////////////////////////////////////////
   void raw_out::configure(bool is_signed, ui32 bit_depth, ui32 width)
   {
@@ -1808,6 +1945,40 @@ namespace ojph {
     return width;
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  bool raw_out::get_stripe(ui32 num_rows, frame_buffer& stripe)
+  {
+    assert(fh);
+    if (bytes_per_sample > 2)
+      return false;
+    ui32 size = num_rows * width * bytes_per_sample;
+    if (size > buffer_size)
+    {
+      buffer = (ui8*)realloc(buffer, size);
+      buffer_size = size;
+    }
+    stripe_comps[0].data = buffer;
+    stripe_comps[0].stride = width * bytes_per_sample;
+    stripe_comps[0].step = 1;
+    stripe.sample = bytes_per_sample == 1 ? OJPH_FRAME_8BIT
+                                          : OJPH_FRAME_16BIT;
+    stripe.num_components = 1;
+    stripe.comps = stripe_comps;
+    stripe.byte_order = OJPH_FRAME_LITTLE_ENDIAN;
+    return true;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void raw_out::write_stripe(ui32 comp_num, ui32 num_rows)
+  {
+    ojph_unused(comp_num);
+    assert(fh);
+    assert(comp_num == 0);
+    size_t num_samples = (size_t)num_rows * width;
+    if (fwrite(buffer, bytes_per_sample, num_samples, fh) != num_samples)
+      OJPH_ERROR(0x03000159, "unable to write to file %s", fname);
+  }
+
 
   ////////////////////////////////////////////////////////////////////////////
   //
@@ -35,6 +35,7 @@
 // Date: 22 April 2024
 //***************************************************************************/
 
+#include "ojph_trace.h"
 #include "ojph_threads.h"
 
 namespace ojph
@@ -81,6 +82,7 @@ void thread_pool::add_task(worker_thread_base* task)
 ///////////////////////////////////////////////////////////////////////////////
 void thread_pool::start_thread(thread_pool* tp)
 {
+  trace_set_thread_name("pool worker");
   while (1)
   {
     // setup the condition variable
@@ -39,6 +39,8 @@
 #ifndef OJPH_BITBUFFER_READ_H
 #define OJPH_BITBUFFER_READ_H
 
+#include <cstring>
+
 #include "ojph_defs.h"
 #include "ojph_arch.h"
 #include "ojph_file.h"
@@ -54,6 +56,16 @@ namespace ojph {
 
 
     //////////////////////////////////////////////////////////////////////////
+    // Reads packet headers and codeblock data of one tile part.  Bytes are
+    // fetched from the file into a window of up to buf_size bytes, with one
+    // read call per refill, instead of one call per byte.  The window never
+    // extends beyond the end of the tile part; bytes_left counts the bytes
+    // of the tile part that have not been consumed, including those that
+    // are in the window, so the file position is ahead of the parsing
+    // position by (end - cur) bytes.
+    // When the file resides in memory, the window is the file data itself,
+    // covering the whole tile part, and is never refilled; if, in addition,
+    // the data is persistent, codeblocks refer to their data in place.
     struct bit_read_buf
     {
       infile_base *file;
@@ -61,17 +73,78 @@ namespace ojph {
       int avail_bits;
       bool unstuff;
       ui32 bytes_left;
+      ui8 *buf;           // window storage
+      ui32 buf_size;      // window capacity
+      const ui8 *cur;     // next unconsumed byte in the window
+      const ui8 *end;     // one past the last valid byte in the window
+      bool in_place;      // codeblocks can refer to the file data in place
+      const ui8 *data_begin, *data_end; // the file data, when in_place
     };
 
     //////////////////////////////////////////////////////////////////////////
     static inline
-    void bb_init(bit_read_buf *bbp, ui32 bytes_left, infile_base* file)
+    void bb_init(bit_read_buf *bbp, ui32 bytes_left, infile_base* file,
+                 ui8 *buf, ui32 buf_size)
     {
       bbp->avail_bits = 0;
       bbp->file = file;
       bbp->bytes_left = bytes_left;
       bbp->tmp = 0;
       bbp->unstuff = false;
+      bbp->buf = buf;
+      bbp->buf_size = buf_size;
+      bbp->cur = bbp->end = buf;
+      bbp->in_place = false;
+      bbp->data_begin = bbp->data_end = NULL;
+
+      size_t avail;
+      const ui8 *data = file->get_data_ptr(avail);
+      if (data != NULL)
+      {
+        ui32 t = (ui32)ojph_min((size_t)bytes_left, avail);
+        bbp->buf = NULL;
+        bbp->buf_size = 0;
+        bbp->cur = data;
+        bbp->end = data + t;
+        file->seek(t, infile_base::OJPH_SEEK_CUR);
+        if (file->is_data_persistent())
+        {
+          bbp->in_place = true;
+          bbp->data_begin = data - file->tell() + t;
+          bbp->data_end = data + avail;
+        }
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // Moves any unconsumed bytes to the start of the window and refills
+    // the rest of it, without reading past the end of the tile part.
+    // Returns the number of bytes now available in the window.
+    static inline
+    ui32 bb_fill(bit_read_buf *bbp)
+    {
+      ui32 avail = (ui32)(bbp->end - bbp->cur);
+      ui32 total = ojph_min(bbp->buf_size, bbp->bytes_left);
+      if (avail < total)
+      {
+        if (avail)
+          memmove(bbp->buf, bbp->cur, avail);
+        size_t bytes = bbp->file->read(bbp->buf + avail, total - avail);
+        avail += (ui32)bytes;
+        bbp->cur = bbp->buf;
+        bbp->end = bbp->buf + avail;
+      }
+      return avail;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // Makes sure that at least num_bytes are available in the window
+    static inline
+    bool bb_ensure(bit_read_buf *bbp, ui32 num_bytes)
+    {
+      if ((ui32)(bbp->end - bbp->cur) >= num_bytes)
+        return true;
+      return bb_fill(bbp) >= num_bytes;
     }
 
     /////////////////////////////////////////////////////////////////////////////
@@ -80,9 +153,9 @@ namespace ojph {
     {
       if (bbp->bytes_left > 0)
       {
-        ui8 t = 0;
-        if (bbp->file->read(&t, 1) != 1)
+        if (bbp->cur == bbp->end && bb_fill(bbp) == 0)
           throw "error reading from file";
+        ui8 t = *bbp->cur++;
         bbp->tmp = t;
         bbp->avail_bits = 8 - bbp->unstuff;
         bbp->unstuff = (t == 0xFF);
@@ -136,28 +209,85 @@ namespace ojph {
                        mem_elastic_allocator *elastic)
     {
       assert(bbp->avail_bits == 0 && bbp->unstuff == false);
+      if (bbp->in_place && num_bytes <= (ui32)(bbp->end - bbp->cur)
+          && bbp->cur - bbp->data_begin >= coded_cb_header::prefix_buf_size
+          && (size_t)(bbp->data_end - bbp->cur) >=
+             (size_t)num_bytes + coded_cb_header::suffix_buf_size)
+      { // refer to the data in place; the decoders may read, but never
+        // write, the bytes surrounding it
+        elastic->get_buffer(0, cur_coded_list);
+        cur_coded_list->buf =
+          const_cast<ui8*>(bbp->cur) - coded_cb_header::prefix_buf_size;
+        cur_coded_list->buf_size = num_bytes
+          + coded_cb_header::prefix_buf_size
+          + coded_cb_header::suffix_buf_size;
+        bbp->cur += num_bytes;
+        bbp->bytes_left -= num_bytes;
+        return true;
+      }
+
       elastic->get_buffer(num_bytes + coded_cb_header::prefix_buf_size
         + coded_cb_header::suffix_buf_size, cur_coded_list);
+      ui8 *dp = cur_coded_list->buf + coded_cb_header::prefix_buf_size;
       ui32 bytes = ojph_min(num_bytes, bbp->bytes_left);
-      ui32 bytes_read = (ui32)bbp->file->read(
-        cur_coded_list->buf + coded_cb_header::prefix_buf_size, bytes);
+      ui32 bytes_read = 0;
+      while (bytes_read < bytes)
+      {
+        ui32 avail = (ui32)(bbp->end - bbp->cur);
+        if (avail == 0)
+        {
+          ui32 rest = bytes - bytes_read;
+          if (rest >= (bbp->buf_size >> 1))
+          { // large chunks bypass the window
+            ui32 t = (ui32)bbp->file->read(dp + bytes_read, rest);
+            bytes_read += t;
+            bbp->bytes_left -= t;
+            break;
+          }
+          avail = bb_fill(bbp);
+          if (avail == 0)
+            break;
+        }
+        ui32 t = ojph_min(avail, bytes - bytes_read);
+        memcpy(dp + bytes_read, bbp->cur, t);
+        bbp->cur += t;
+        bytes_read += t;
+        bbp->bytes_left -= t;
+      }
       if (num_bytes > bytes_read)
-        memset(
-          cur_coded_list->buf + coded_cb_header::prefix_buf_size + bytes_read,
-          0, num_bytes - bytes_read);
-      bbp->bytes_left -= bytes_read;
+        memset(dp + bytes_read, 0, num_bytes - bytes_read);
       return bytes_read == bytes;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void bb_skip_chunk(bit_read_buf *bbp, ui32 num_bytes)
+    {
+      assert(bbp->avail_bits == 0 && bbp->unstuff == false);
+      ui32 bytes = ojph_min(num_bytes, bbp->bytes_left);
+      ui32 t = ojph_min(bytes, (ui32)(bbp->end - bbp->cur));
+      bbp->cur += t;
+      ui32 bytes_skipped = t;
+      if (bytes > t)
+      {
+        si64 cur_loc = bbp->file->tell();
+        bbp->file->seek(bytes - t, infile_base::OJPH_SEEK_CUR);
+        bytes_skipped += (ui32)(bbp->file->tell() - cur_loc);
+      }
+      bbp->bytes_left -= bytes_skipped;
+      assert(bytes_skipped == bytes || bbp->bytes_left == 0);
+    }
+
     //////////////////////////////////////////////////////////////////////////
     static inline
     void bb_skip_eph(bit_read_buf *bbp)
     {
       if (bbp->bytes_left >= 2)
       {
-        ui8 marker[2];
-        if (bbp->file->read(marker, 2) != 2)
+        if (!bb_ensure(bbp, 2))
           throw "error reading from file";
+        const ui8 *marker = bbp->cur;
+        bbp->cur += 2;
         bbp->bytes_left -= 2;
         if ((int)marker[0] != (EPH >> 8) || (int)marker[1] != (EPH & 0xFF))
           throw "should find EPH, but found something else";
@@ -185,24 +315,23 @@ namespace ojph {
     {
       if (bbp->bytes_left >= 2)
       {
-        ui8 marker[2];
-        if (bbp->file->read(marker, 2) != 2)
+        if (!bb_ensure(bbp, 2))
           throw "error reading from file";
+        const ui8 *marker = bbp->cur; // look ahead, without consuming
         if ((int)marker[0] == (SOP >> 8) && (int)marker[1] == (SOP & 0xFF))
         {
+          bbp->cur += 2;
           bbp->bytes_left -= 2;
           if (bbp->bytes_left >= 4)
           {
-            ui16 com_len;
-            if (bbp->file->read(&com_len, 2) != 2)
+            if (!bb_ensure(bbp, 2))
               throw "error reading from file";
-            com_len = swap_bytes_if_le(com_len);
+            ui16 com_len = (ui16)((bbp->cur[0] << 8) | bbp->cur[1]);
             if (com_len != 4)
               throw "something is wrong with SOP length";
-            int result = 
-              bbp->file->seek(com_len - 2, infile_base::OJPH_SEEK_CUR);
-            if (result != 0)
-              throw "error seeking file";
+            if (!bb_ensure(bbp, com_len))
+              throw "error reading from file";
+            bbp->cur += com_len;
             bbp->bytes_left -= com_len;
           }
           else
@@ -210,12 +339,7 @@ namespace ojph {
           return true;
         }
         else
-        {
-          //put the bytes back
-          if (bbp->file->seek(-2, infile_base::OJPH_SEEK_CUR) != 0)
-            throw "error seeking file";
           return false;
-        }
       }
 
       return false;
@@ -117,13 +117,23 @@ namespace ojph {
       // convert to sign and magnitude and keep max_val
       if (precision == BUF32)
       {
-        assert(line->flags & line_buf::LFT_32BIT);
-        const void *sp = (line->flags & line_buf::LFT_INTEGER)
-          ? (const void*)(line->i32 + line_offset)
-          : (const void*)(line->f32 + line_offset);
         ui32 *dp = buf32 + cur_line * stride;
-        this->codeblock_functions.tx_to_cb32(sp, dp, K_max, delta_inv,
-                                             cb_size.w, max_val32);
+        if (line->flags & line_buf::LFT_16BIT)
+        {
+          assert(reversible);
+          const si16 *sp = line->i16 + line_offset;
+          this->codeblock_functions.tx16_to_cb32(sp, dp, K_max, delta_inv,
+                                                 cb_size.w, max_val32);
+        }
+        else
+        {
+          assert(line->flags & line_buf::LFT_32BIT);
+          const void *sp = (line->flags & line_buf::LFT_INTEGER)
+            ? (const void*)(line->i32 + line_offset)
+            : (const void*)(line->f32 + line_offset);
+          this->codeblock_functions.tx_to_cb32(sp, dp, K_max, delta_inv,
+                                               cb_size.w, max_val32);
+        }
         ++cur_line;
       }
       else
@@ -232,18 +242,35 @@ namespace ojph {
       //convert to sign and magnitude
       if (precision == BUF32)
       {
-        assert(line->flags & line_buf::LFT_32BIT);
-        void *dp = (line->flags & line_buf::LFT_INTEGER)
-          ? (void*)(line->i32 + line_offset)
-          : (void*)(line->f32 + line_offset);
-        if (!zero_block)
+        if (line->flags & line_buf::LFT_16BIT)
         {
-          const ui32 *sp = buf32 + cur_line * stride;
-          this->codeblock_functions.tx_from_cb32(sp, dp, K_max, delta,
-                                                 cb_size.w);
+          assert(reversible);
+          si16 *dp = line->i16 + line_offset;
+          if (!zero_block)
+          {
+            const ui32 *sp = buf32 + cur_line * stride;
+            this->codeblock_functions.tx16_from_cb32(sp, dp, K_max, delta,
+                                                     cb_size.w);
+          }
+          else
+            this->codeblock_functions.mem_clear(dp, cb_size.w * sizeof(*dp));
         }
         else
-          this->codeblock_functions.mem_clear(dp, cb_size.w * sizeof(ui32));
+        {
+          assert(line->flags & line_buf::LFT_32BIT);
+          void *dp = (line->flags & line_buf::LFT_INTEGER)
+            ? (void*)(line->i32 + line_offset)
+            : (void*)(line->f32 + line_offset);
+          if (!zero_block)
+          {
+            const ui32 *sp = buf32 + cur_line * stride;
+            this->codeblock_functions.tx_from_cb32(sp, dp, K_max, delta,
+                                                   cb_size.w);
+          }
+          else
+            this->codeblock_functions.mem_clear(dp,
+              cb_size.w * sizeof(ui32));
+        }
       }
       else
       {
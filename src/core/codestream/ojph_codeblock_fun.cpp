@@ -55,95 +55,7 @@ namespace ojph {
 
   namespace local
   {
-
-    //////////////////////////////////////////////////////////////////////////
-    void gen_mem_clear(void* addr, size_t count);
-    void sse_mem_clear(void* addr, size_t count);
-    void avx_mem_clear(void* addr, size_t count);
-    void wasm_mem_clear(void* addr, size_t count);
-    void vsx_mem_clear(void* addr, size_t count);
-
-    //////////////////////////////////////////////////////////////////////////
-    ui32  gen_find_max_val32(ui32* address);
-    ui32 sse2_find_max_val32(ui32* address);
-    ui32 avx2_find_max_val32(ui32* address);
-    ui32 wasm_find_max_val32(ui32* address);
-    ui32 vsx_find_max_val32(ui32* address);
-    ui64  gen_find_max_val64(ui64* address);
-    ui64 sse2_find_max_val64(ui64* address);
-    ui64 avx2_find_max_val64(ui64* address);
-    ui64 wasm_find_max_val64(ui64* address);
-    ui64 vsx_find_max_val64(ui64* address);
-
-
     //////////////////////////////////////////////////////////////////////////
-    void  gen_rev_tx_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
-                             float delta_inv, ui32 count, ui32* max_val);
-    void sse2_rev_tx_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
-                             float delta_inv, ui32 count, ui32* max_val);
-    void avx2_rev_tx_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
-                             float delta_inv, ui32 count, ui32* max_val);
-    void  gen_irv_tx_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
-                             float delta_inv, ui32 count, ui32* max_val);
-    void sse2_irv_tx_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
-                             float delta_inv, ui32 count, ui32* max_val);
-    void avx2_irv_tx_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
-                             float delta_inv, ui32 count, ui32* max_val);
-    void wasm_rev_tx_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
-                             float delta_inv, ui32 count, ui32* max_val);
-    void vsx_rev_tx_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
-                            float delta_inv, ui32 count, ui32* max_val);
-    void wasm_irv_tx_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
-                             float delta_inv, ui32 count, ui32* max_val);
-    void vsx_irv_tx_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
-                            float delta_inv, ui32 count, ui32* max_val);
-
-    void  gen_rev_tx_to_cb64(const void *sp, ui64 *dp, ui32 K_max,
-                             float delta_inv, ui32 count, ui64* max_val);
-    void sse2_rev_tx_to_cb64(const void *sp, ui64 *dp, ui32 K_max,
-                             float delta_inv, ui32 count, ui64* max_val);
-    void avx2_rev_tx_to_cb64(const void *sp, ui64 *dp, ui32 K_max,
-                             float delta_inv, ui32 count, ui64* max_val);
-    void wasm_rev_tx_to_cb64(const void *sp, ui64 *dp, ui32 K_max,
-                             float delta_inv, ui32 count, ui64* max_val);
-    void vsx_rev_tx_to_cb64(const void *sp, ui64 *dp, ui32 K_max,
-                            float delta_inv, ui32 count, ui64* max_val);
-
-    //////////////////////////////////////////////////////////////////////////
-    void  gen_rev_tx_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
-                               float delta, ui32 count);
-    void sse2_rev_tx_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
-                               float delta, ui32 count);
-    void avx2_rev_tx_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
-                               float delta, ui32 count);
-    void  gen_irv_tx_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
-                               float delta, ui32 count);
-    void sse2_irv_tx_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
-                               float delta, ui32 count);
-    void avx2_irv_tx_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
-                               float delta, ui32 count);
-    void wasm_rev_tx_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
-                               float delta, ui32 count);
-    void vsx_rev_tx_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
-                              float delta, ui32 count);
-    void wasm_irv_tx_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
-                               float delta, ui32 count);
-    void vsx_irv_tx_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
-                              float delta, ui32 count);
-
-    void  gen_rev_tx_from_cb64(const ui64 *sp, void *dp, ui32 K_max,
-                               float delta, ui32 count);
-    void sse2_rev_tx_from_cb64(const ui64 *sp, void *dp, ui32 K_max,
-                               float delta, ui32 count);
-    void avx2_rev_tx_from_cb64(const ui64 *sp, void *dp, ui32 K_max,
-                               float delta, ui32 count);
-    void gen_irv_tx_from_cb64(const ui64 *sp, void *dp, ui32 K_max,
-                              float delta, ui32 count);
-    void wasm_rev_tx_from_cb64(const ui64 *sp, void *dp, ui32 K_max,
-                               float delta, ui32 count);
-    void vsx_rev_tx_from_cb64(const ui64 *sp, void *dp, ui32 K_max,
-                              float delta, ui32 count);
-
     void codeblock_fun::init(bool reversible) {
 
 #if !defined(OJPH_ENABLE_WASM_SIMD) || !defined(OJPH_EMSCRIPTEN)
@@ -155,11 +67,15 @@ namespace ojph {
       if (reversible) {
         tx_to_cb32 = gen_rev_tx_to_cb32;
         tx_from_cb32 = gen_rev_tx_from_cb32;
+        tx16_to_cb32 = gen_rev_tx16_to_cb32;
+        tx16_from_cb32 = gen_rev_tx16_from_cb32;
       }
       else
       {
         tx_to_cb32 = gen_irv_tx_to_cb32;
         tx_from_cb32 = gen_irv_tx_from_cb32;
+        tx16_to_cb32 = NULL;
+        tx16_from_cb32 = NULL;
       }
       encode_cb32 = ojph_encode_codeblock32;
 
@@ -194,6 +110,8 @@ namespace ojph {
           if (reversible) {
             tx_to_cb32 = sse2_rev_tx_to_cb32;
             tx_from_cb32 = sse2_rev_tx_from_cb32;
+            tx16_to_cb32 = sse2_rev_tx16_to_cb32;
+            tx16_from_cb32 = sse2_rev_tx16_from_cb32;
           }
           else {
             tx_to_cb32 = sse2_irv_tx_to_cb32;
@@ -229,6 +147,8 @@ namespace ojph {
           if (reversible) {
             tx_to_cb32 = avx2_rev_tx_to_cb32;
             tx_from_cb32 = avx2_rev_tx_from_cb32;
+            tx16_to_cb32 = avx2_rev_tx16_to_cb32;
+            tx16_from_cb32 = avx2_rev_tx16_from_cb32;
           }
           else {
             tx_to_cb32 = avx2_irv_tx_to_cb32;
@@ -313,6 +233,9 @@ namespace ojph {
         tx_to_cb32 = wasm_irv_tx_to_cb32;
         tx_from_cb32 = wasm_irv_tx_from_cb32;
       }
+      // 16bit lines are not used with WASM SIMD
+      tx16_to_cb32 = NULL;
+      tx16_from_cb32 = NULL;
       encode_cb32 = ojph_encode_codeblock32;
 
       decode_cb64 = ojph_decode_codeblock64;
@@ -81,12 +81,24 @@ namespace ojph {
     return param_siz(&state->siz);
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  const param_siz codestream::get_siz() const
+  {
+    return param_siz(&state->siz);
+  }
+
   ////////////////////////////////////////////////////////////////////////////
   param_cod codestream::access_cod()
   {
     return param_cod(&state->cod);
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  const param_cod codestream::get_cod() const
+  {
+    return param_cod(&state->cod);
+  }
+
   ////////////////////////////////////////////////////////////////////////////
   param_qcd codestream::access_qcd()
   {
@@ -102,12 +114,14 @@ namespace ojph {
   ////////////////////////////////////////////////////////////////////////////
   void codestream::set_planar(bool planar)
   {
+    state->discard_cached_header();
     state->set_planar(planar ? 1 : 0);
   }
 
   ////////////////////////////////////////////////////////////////////////////
   void codestream::set_profile(const char *s)
   {
+    state->discard_cached_header();
     state->set_profile(s);
   }
 
@@ -115,6 +129,7 @@ namespace ojph {
   void codestream::set_tilepart_divisions(bool at_resolutions,
                                           bool at_components)
   {
+    state->discard_cached_header();
     ui32 value = 0;
     if (at_resolutions)
       value |= OJPH_TILEPART_RESOLUTIONS;
@@ -140,6 +155,7 @@ namespace ojph {
   ////////////////////////////////////////////////////////////////////////////
   void codestream::request_tlm_marker(bool needed)
   {
+    state->discard_cached_header();
     state->request_tlm_marker(needed);
   }
 
@@ -195,6 +211,18 @@ namespace ojph {
     return state->pull(comp_num);
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  void codestream::pull_frame(const frame_buffer& frame)
+  {
+    state->pull_frame(frame);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  ui32 codestream::pull_stripe(const frame_buffer& stripe, ui32 num_rows)
+  {
+    return state->pull_stripe(stripe, num_rows);
+  }
+
 
   ////////////////////////////////////////////////////////////////////////////
   void codestream::flush()
@@ -214,4 +242,128 @@ namespace ojph {
     return state->exchange(line, next_component);
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  void codestream::push_frame(const frame_buffer& frame)
+  {
+    state->push_frame(frame);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  ui32 codestream::push_stripe(const frame_buffer& stripe, ui32 num_rows)
+  {
+    return state->push_stripe(stripe, num_rows);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void codestream::enable_stats(bool enable)
+  {
+#ifndef OJPH_DISABLE_STATS
+    state->get_stage_timer()->enabled = enable;
+#else
+    ojph_unused(enable);
+#endif
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  static codestream_stage_stats get_stage_stats(const local::stage_timer* t,
+                                                ui32 stage)
+  {
+    codestream_stage_stats s;
+    s.seconds = (double)t->ns[stage] * 1e-9;
+    s.ticks = t->ticks[stage];
+    s.count = t->count[stage];
+    return s;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  codestream_stats codestream::get_stats() const
+  {
+    typedef local::stage_timer st;
+    static_assert((ui32)codestream_stats::MAX_RESOLUTIONS ==
+      (ui32)st::MAX_RESOLUTIONS && (ui32)codestream_stats::NUM_BANDS ==
+      (ui32)st::NUM_BANDS, "codestream_stats does not match stage_timer");
+    const st* t = state->get_stage_timer();
+    codestream_stats stats;
+    stats.colour_stage = get_stage_stats(t, st::COLOUR);
+    stats.cb_transfer_stage = get_stage_stats(t, st::CB_TX);
+    stats.packet_stage = get_stage_stats(t, st::PACKETS);
+    stats.codestream_stage = get_stage_stats(t, st::CODESTREAM);
+    stats.colour = stats.colour_stage.seconds;
+    stats.cb_transfer = stats.cb_transfer_stage.seconds;
+    stats.codestream = stats.packet_stage.seconds
+                     + stats.codestream_stage.seconds;
+    stats.dwt = stats.block_coding = 0.0;
+    for (ui32 r = 0; r < st::MAX_RESOLUTIONS; ++r)
+    {
+      stats.dwt_stage[r] = get_stage_stats(t, st::DWT + r);
+      stats.dwt += stats.dwt_stage[r].seconds;
+      for (ui32 b = 0; b < st::NUM_BANDS; ++b)
+      {
+        stats.block_stage[r][b] =
+          get_stage_stats(t, st::BLOCK_CODING + r * st::NUM_BANDS + b);
+        stats.block_coding += stats.block_stage[r][b].seconds;
+      }
+    }
+    const mem_elastic_allocator* elastic = state->get_elastic_alloc();
+    stats.alloc_count = t->alloc_count + elastic->get_growth_count();
+    stats.alloc_bytes = t->alloc_bytes + elastic->get_growth_bytes();
+    return stats;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void codestream::reset_stats()
+  {
+    state->get_stage_timer()->reset();
+    state->get_elastic_alloc()->reset_growth();
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  memory_estimate codestream::estimate_memory()
+  {
+    memory_estimate est;
+    state->estimate_memory(est.fixed_bytes, est.coded_bytes);
+    return est;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  coded_size_stats codestream::get_coded_size_stats(ui32 comp_num,
+                                                    ui32 res_num,
+                                                    ui32 band_num) const
+  {
+    coded_size_stats stats;
+    state->get_coded_size_stats(comp_num, res_num, band_num, stats);
+    return stats;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void codestream::enable_header_cache(bool enable)
+  {
+    state->enable_header_cache(enable);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  bool codestream::is_header_repeated() const
+  {
+    return state->is_header_repeated();
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void codestream::set_memory_budget(ui64 bytes)
+  {
+    state->set_memory_budget(bytes);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void codestream::use_shared_pool(bool enable)
+  {
+    state->get_elastic_alloc()->set_shared(enable);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void codestream::set_fixed_memory_placement(ui32 flags,
+                                              const mem_store_hooks* hooks)
+  {
+    state->get_allocator()->set_placement(flags, hooks);
+  }
+
 }
@@ -120,6 +120,46 @@ namespace ojph {
       _mm256_storeu_si256((__m256i*)max_val, tmax);
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_rev_tx16_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
+                               float delta_inv, ui32 count, ui32* max_val)
+    {
+      ojph_unused(delta_inv);
+
+      // convert to sign and magnitude and keep max_val
+      ui32 shift = 31 - K_max;
+      __m256i m0 = _mm256_set1_epi32(INT_MIN);
+      __m256i tmax = _mm256_loadu_si256((__m256i*)max_val);
+      const si16 *p = (const si16*)sp;
+      for ( ; count >= 8; count -= 8, p += 8, dp += 8)
+      {
+        __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i*)p));
+        __m256i sign = _mm256_and_si256(v, m0);
+        __m256i val = _mm256_abs_epi32(v);
+        val = _mm256_slli_epi32(val, (int)shift);
+        tmax = _mm256_or_si256(tmax, val);
+        val = _mm256_or_si256(val, sign);
+        _mm256_storeu_si256((__m256i*)dp, val);
+      }
+      if (count)
+      {
+        __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i*)p));
+        __m256i sign = _mm256_and_si256(v, m0);
+        __m256i val = _mm256_abs_epi32(v);
+        val = _mm256_slli_epi32(val, (int)shift);
+
+        __m256i c = _mm256_set1_epi32((si32)count);
+        __m256i idx = _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+        __m256i mask = _mm256_cmpgt_epi32(c, idx);
+        c = _mm256_and_si256(val, mask);
+        tmax = _mm256_or_si256(tmax, c);
+
+        val = _mm256_or_si256(val, sign);
+        _mm256_storeu_si256((__m256i*)dp, val);
+      }
+      _mm256_storeu_si256((__m256i*)max_val, tmax);
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void avx2_irv_tx_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
                              float delta_inv, ui32 count, ui32* max_val)
@@ -181,6 +221,28 @@ namespace ojph {
       }
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_rev_tx16_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
+                                 float delta, ui32 count)
+    {
+      ojph_unused(delta);
+      ui32 shift = 31 - K_max;
+      __m256i m1 = _mm256_set1_epi32(INT_MAX);
+      si16 *p = (si16*)dp;
+      for (ui32 i = 0; i < count; i += 8, sp += 8, p += 8)
+      {
+        __m256i v = _mm256_load_si256((__m256i*)sp);
+        __m256i val = _mm256_and_si256(v, m1);
+        val = _mm256_srli_epi32(val, (int)shift);
+        val = _mm256_sign_epi32(val, v);
+        // magnitudes are below 2^K_max, with K_max < 16, so saturation
+        // never kicks in
+        _mm_storeu_si128((__m128i*)p,
+          _mm_packs_epi32(_mm256_castsi256_si128(val),
+                          _mm256_extracti128_si256(val, 1)));
+      }
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void avx2_irv_tx_from_cb32(const ui32 *sp, void *dp, ui32 K_max, 
                                float delta, ui32 count)
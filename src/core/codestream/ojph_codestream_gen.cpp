@@ -77,6 +77,28 @@ namespace ojph {
       *max_val = tmax;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void gen_rev_tx16_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
+                              float delta_inv, ui32 count,
+                              ui32* max_val)
+    {
+      ojph_unused(delta_inv);
+      ui32 shift = 31 - K_max;
+      // convert to sign and magnitude and keep max_val
+      ui32 tmax = *max_val;
+      si16 *p = (si16*)sp;
+      for (ui32 i = count; i > 0; --i)
+      {
+        si32 v = *p++;
+        ui32 sign = v >= 0 ? 0U : 0x80000000U;
+        ui32 val = (ui32)(v >= 0 ? v : -v);
+        val <<= shift;
+        *dp++ = sign | val;
+        tmax |= val; // it is more efficient to use or than max
+      }
+      *max_val = tmax;
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void gen_rev_tx_to_cb64(const void *sp, ui64 *dp, ui32 K_max,
                             float delta_inv, ui32 count,
@@ -136,6 +158,22 @@ namespace ojph {
       }
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void gen_rev_tx16_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
+                                float delta, ui32 count)
+    {
+      ojph_unused(delta);
+      ui32 shift = 31 - K_max;
+      //convert to sign and magnitude
+      si16 *p = (si16*)dp;
+      for (ui32 i = count; i > 0; --i)
+      {
+        ui32 v = *sp++;
+        si32 val = (v & 0x7FFFFFFFU) >> shift;
+        *p++ = (si16)((v & 0x80000000U) ? -val : val);
+      }
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void gen_rev_tx_from_cb64(const ui64 *sp, void *dp, ui32 K_max,
                               float delta, ui32 count)
@@ -38,11 +38,16 @@
 
 #include <climits>
 #include <cmath>
+#include <cstring>
 
 #include "ojph_mem.h"
 #include "ojph_params.h"
+#include "ojph_boxes.h"
+#include "ojph_codestream.h"
 #include "ojph_codestream_local.h"
 #include "ojph_tile.h"
+#include "ojph_codeblock.h" // for coded_cb_header
+#include "ojph_trace.h"
 
 #include "../transform/ojph_colour.h"
 #include "../transform/ojph_transform.h"
@@ -54,7 +59,10 @@ namespace ojph {
 
     //////////////////////////////////////////////////////////////////////////
     codestream::codestream()
-    : precinct_scratch(NULL), allocator(NULL), elastic_alloc(NULL)
+    : precinct_scratch(NULL), packet_window(NULL), gather_vecs(NULL),
+      allocator(NULL), elastic_alloc(NULL), memory_budget(0),
+      header_cache_enabled(false), header_cache_kind(HEADER_CACHE_NONE),
+      params_retained(false), header_repeated(false)
     {
       allocator = new mem_fixed_allocator;
       elastic_alloc = new mem_elastic_allocator(1048576); // 1 megabyte
@@ -62,6 +70,11 @@ namespace ojph {
       init_colour_transform_functions();
       init_wavelet_transform_functions();
 
+      siz.set_owner(this);
+      cod.set_owner(this);
+      qcd.set_owner(this);
+      nlt.set_owner(this);
+
       restart();
     }
 
@@ -86,10 +99,6 @@ namespace ojph {
 
       num_comps = 0;
       employ_color_transform = false;
-      planar = -1;
-      profile = OJPH_PN_UNDEFINED;
-      tilepart_div = OJPH_TILEPART_NO_DIVISIONS;
-      need_tlm = false;
 
       cur_comp = 0;
       cur_line = 0;
@@ -98,6 +107,28 @@ namespace ojph {
       skipped_res_for_read = skipped_res_for_recon = 0;
 
       precinct_scratch_needed_bytes = 0;
+      packet_window_size = 0;
+      gather_vecs_size = 0;
+
+      // with a cached header, the parameters are kept until one of them is
+      // set, so that an unchanged header need not be redone
+      header_repeated = false;
+      if (header_cache_enabled && header_cache_kind != HEADER_CACHE_NONE)
+        params_retained = true;
+      else
+        reset_params();
+
+      allocator->restart();
+      elastic_alloc->restart();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::reset_params()
+    {
+      planar = -1;
+      profile = OJPH_PN_UNDEFINED;
+      tilepart_div = OJPH_TILEPART_NO_DIVISIONS;
+      need_tlm = false;
 
       cod.restart();
       qcd.restart();
@@ -105,8 +136,27 @@ namespace ojph {
       dfs.restart();
       atk.restart();
 
-      allocator->restart();
-      elastic_alloc->restart();
+      params_retained = false;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::enable_header_cache(bool enable)
+    {
+      if (enable == header_cache_enabled)
+        return;
+      if (!enable && params_retained)
+        reset_params();
+      header_cache_enabled = enable;
+      header_cache_kind = HEADER_CACHE_NONE;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::discard_cached_header()
+    {
+      // a parameter is about to be set; do what restart() deferred.  The
+      // cached header is kept, and write_headers() compares against it
+      if (params_retained)
+        reset_params();
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -215,16 +265,47 @@ namespace ojph {
         4 * ((max_ratio * max_ratio * 4 + 2) / 3);
 
       allocator->pre_alloc_obj<ui8>(precinct_scratch_needed_bytes);
+
+      // a window of 16KB amortizes the cost of reading from the file over
+      // many packet header bytes, while fitting in the L1 cache
+      packet_window_size = infile != NULL ? 16384 : 0;
+      allocator->pre_alloc_obj<ui8>(packet_window_size);
+
+      // tile-parts are written through gather writes; 1024 is the number
+      // of regions a single writev() call accepts on most systems
+      gather_vecs_size = outfile != NULL ? 1024 : 0;
+      allocator->pre_alloc_obj<out_vec>(gather_vecs_size);
     }
 
     //////////////////////////////////////////////////////////////////////////
     void codestream::finalize_alloc()
     {
+      // fail before allocating anything if the budget cannot be met
+      ui64 fixed_bytes = allocator->eval_alloc_size();
+      if (memory_budget != 0 && fixed_bytes > memory_budget)
+        OJPH_ERROR(0x00030013, "the codestream needs %llu bytes for its "
+          "structures and line buffers, exceeding the memory budget of "
+          "%llu bytes", (unsigned long long)fixed_bytes,
+          (unsigned long long)memory_budget);
+      size_t held_bytes = allocator->get_allocated_size();
       allocator->alloc();
+      if (allocator->get_allocated_size() != held_bytes)
+      {
+        ++timer.alloc_count;
+        timer.alloc_bytes += allocator->get_allocated_size();
+      }
+      // coded data may use what is left; a limit of 0 means no limit
+      if (memory_budget != 0)
+        elastic_alloc->set_limit((size_t)ojph_max(memory_budget -
+          (ui64)allocator->get_allocated_size(), (ui64)1));
+      else
+        elastic_alloc->set_limit(0);
 
       //precinct scratch buffer
       precinct_scratch =
         allocator->post_alloc_obj<ui8>(precinct_scratch_needed_bytes);
+      packet_window = allocator->post_alloc_obj<ui8>(packet_window_size);
+      gather_vecs = allocator->post_alloc_obj<out_vec>(gather_vecs_size);
 
       //get tiles
       tiles = this->allocator->post_alloc_obj<tile>((size_t)num_tiles.area());
@@ -553,11 +634,8 @@ namespace ojph {
     }
 
     //////////////////////////////////////////////////////////////////////////
-    void codestream::write_headers(outfile_base *file,
-                                   const comment_exchange* comments,
-                                   ui32 num_comments)
+    void codestream::finalize_params()
     {
-      //finalize
       siz.set_cod(cod);
       // set the tile size if it was not set by the user
       size tile_size = siz.get_tile_size();
@@ -620,8 +698,8 @@ namespace ojph {
           "resolution level.");
       }
 
-      if (planar == -1) //not initialized
-        planar = cod.is_employing_color_transform() ? 1 : 0;
+      if (planar == -1) //not initialized; the colour transform needs
+        planar = 0;     //interleaved, and others have always defaulted to it
       else if (planar == 0) //interleaved is chosen
       {
       }
@@ -634,12 +712,11 @@ namespace ojph {
       }
       else
         assert(0);
+    }
 
-      assert(this->outfile == NULL);
-      this->outfile = file;
-      this->pre_alloc();
-      this->finalize_alloc();
-
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::write_main_header(outfile_base *file)
+    {
       ui16 t = swap_bytes_if_le((ui16)JP2K_MARKER::SOC);
       if (file->write(&t, 2) != 2)
         OJPH_ERROR(0x00030022, "Error writing to file");
@@ -683,11 +760,63 @@ namespace ojph {
         OJPH_ERROR(0x0003002E, "Error writing to file");
       if (file->write(version_str, data_len) != data_len)
         OJPH_ERROR(0x0003002F, "Error writing to file");
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::write_headers(outfile_base *file,
+                                   const comment_exchange* comments,
+                                   ui32 num_comments)
+    {
+      trace_span span("write_headers", "codestream");
+      stage_scope scope(&timer, stage_timer::CODESTREAM);
+
+      header_repeated =
+        params_retained && header_cache_kind == HEADER_CACHE_WRITTEN;
+      if (!header_repeated)
+      {
+        if (params_retained) // retained from reading; start afresh
+          reset_params();
+        finalize_params();
+      }
+      params_retained = false;
+
+      assert(this->outfile == NULL);
+      this->outfile = file;
+      this->pre_alloc();
+      this->finalize_alloc();
+
+      if (header_cache_enabled && !header_repeated)
+      {
+        // the parameters were set anew; they may still give the same header
+        header_check.close(); // keeps the buffer
+        header_check.open(1024);
+        write_main_header(&header_check);
+        size_t len = (size_t)header_check.tell();
+        header_repeated = header_cache_kind == HEADER_CACHE_WRITTEN
+          && (size_t)header_cache.tell() == len
+          && memcmp(header_cache.get_data(), header_check.get_data(), len)==0;
+        if (!header_repeated)
+        {
+          header_cache.close(); // keeps the buffer
+          header_cache.open(1024);
+          if (header_cache.write(header_check.get_data(), len) != len)
+            OJPH_ERROR(0x000300D2, "Error writing to file");
+          header_cache_kind = HEADER_CACHE_WRITTEN;
+        }
+      }
+      if (header_cache_enabled)
+      {
+        size_t len = (size_t)header_cache.tell();
+        if (file->write(header_cache.get_data(), len) != len)
+          OJPH_ERROR(0x00030015, "Error writing to file");
+      }
+      else
+        write_main_header(file);
 
       if (comments != NULL) {
         for (ui32 i = 0; i < num_comments; ++i)
         {
-          t = swap_bytes_if_le((ui16)JP2K_MARKER::COM);
+          ui16 t = swap_bytes_if_le((ui16)JP2K_MARKER::COM);
           if (file->write(&t, 2) != 2)
             OJPH_ERROR(0x00030029, "Error writing to file");
           t = swap_bytes_if_le((ui16)(comments[i].len + 4));
@@ -765,9 +894,93 @@ namespace ojph {
       return 0;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    // Walks the marker segments of a main header, from SOC to SOT, skipping
+    // those that do not change how the codestream is decoded, which are
+    // PRF, CPF, TLM, PLM, and COM.  The other segments are appended to
+    // copy, when not NULL, or compared against ref otherwise.  Returns
+    // false if the header is not well formed or is different from ref.
+    static
+    bool walk_main_header(infile_base *file, mem_outfile *copy,
+                          const ui8 *ref, size_t ref_size)
+    {
+      ui8 buf[256];
+      size_t pos = 0;
+      ui16 marker, len;
+      if (file->read(&marker, 2) != 2 || swap_bytes_if_le(marker) != SOC)
+        return false;
+      while (true)
+      {
+        if (file->read(&marker, 2) != 2)
+          return false;
+        ui16 m = swap_bytes_if_le(marker);
+        if (m == SOT)
+          return copy != NULL || pos == ref_size;
+        if ((m & 0xFF00) != 0xFF00 || file->read(&len, 2) != 2)
+          return false;
+        size_t remaining = swap_bytes_if_le(len);
+        if (remaining < 2)
+          return false;
+        remaining -= 2;
+        if (m == PRF || m == CPF || m == TLM || m == PLM || m == COM)
+        {
+          if (file->seek((si64)remaining, infile_base::OJPH_SEEK_CUR) != 0)
+            return false;
+          continue;
+        }
+
+        memcpy(buf, &marker, 2);
+        memcpy(buf + 2, &len, 2);
+        size_t num = 4;
+        while (true)
+        {
+          if (copy != NULL)
+            copy->write(buf, num);
+          else if (pos + num > ref_size || memcmp(buf, ref + pos, num) != 0)
+            return false;
+          pos += num;
+          if (remaining == 0)
+            break;
+          num = ojph_min(remaining, sizeof(buf));
+          if (file->read(buf, num) != num)
+            return false;
+          remaining -= num;
+        }
+      }
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void codestream::read_headers(infile_base *file)
     {
+      trace_span span("read_headers", "codestream");
+      stage_scope scope(&timer, stage_timer::CODESTREAM);
+
+      // a .jph or .jp2 file is walked box by box to its jp2c box
+      if (jph_reader::starts_with_signature(file))
+      {
+        jph_reader boxes;
+        boxes.read(file);
+      }
+
+      si64 start = file->tell();
+      if (params_retained && header_cache_kind == HEADER_CACHE_READ)
+      {
+        if (walk_main_header(file, NULL, header_cache.get_data(),
+                             (size_t)header_cache.tell()))
+        { // same header as the last one; its parameters are still in place
+          params_retained = false;
+          header_repeated = true;
+          siz.set_skipped_resolutions(0);
+          this->infile = file;
+          planar = cod.is_employing_color_transform() ? 0 : 1;
+          return;
+        }
+        file->seek(start, infile_base::OJPH_SEEK_SET);
+      }
+      if (params_retained)
+        reset_params();
+      header_repeated = false;
+
       ui16 marker_list[20] = { SOC, SIZ, CAP, PRF, CPF, COD, COC, QCD, QCC,
         RGN, POC, PPM, TLM, PLM, CRG, COM, DFS, ATK, NLT, SOT };
       find_marker(file, marker_list, 1); //find SOC
@@ -875,6 +1088,18 @@ namespace ojph {
       if (received_markers != 3)
         OJPH_ERROR(0x00030052, "markers error, COD and QCD are required");
 
+      if (header_cache_enabled)
+      { // keep the header to compare the next one against
+        si64 end = file->tell();
+        file->seek(start, infile_base::OJPH_SEEK_SET);
+        header_cache.close(); // keeps the buffer
+        header_cache.open(1024);
+        bool ok = walk_main_header(file, &header_cache, NULL, 0);
+        ok = ok && file->tell() == end;
+        header_cache_kind = ok ? HEADER_CACHE_READ : HEADER_CACHE_NONE;
+        file->seek(end, infile_base::OJPH_SEEK_SET);
+      }
+
       this->infile = file;
       planar = cod.is_employing_color_transform() ? 0 : 1;
     }
@@ -911,6 +1136,9 @@ namespace ojph {
     //////////////////////////////////////////////////////////////////////////
     void codestream::read()
     {
+      trace_span span("create", "codestream");
+      stage_scope scope(&timer, stage_timer::CODESTREAM);
+
       this->pre_alloc();
       this->finalize_alloc();
 
@@ -1147,6 +1375,9 @@ namespace ojph {
     //////////////////////////////////////////////////////////////////////////
     void codestream::flush()
     {
+      trace_span span("flush", "codestream");
+      stage_scope scope(&timer, stage_timer::CODESTREAM);
+
       si32 repeat = (si32)num_tiles.area();
       for (si32 i = 0; i < repeat; ++i)
         tiles[i].prepare_for_flush();
@@ -1163,6 +1394,95 @@ namespace ojph {
         OJPH_ERROR(0x00030071, "Error writing to file");
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::estimate_memory(ui64& fixed_bytes, ui64& coded_bytes)
+    {
+      if (infile == NULL && outfile == NULL)
+        OJPH_ERROR(0x00030014, "memory can only be estimated after calling "
+          "read_headers() or write_headers()");
+
+      if (tiles != NULL) // already allocated
+        fixed_bytes = allocator->get_allocated_size();
+      else
+      { // size the structures as create() would, without allocating
+        allocator->restart();
+        pre_alloc();
+        fixed_bytes = allocator->eval_alloc_size();
+        allocator->restart();
+      }
+
+      // count codeblocks, assuming that every tile is full-sized; each
+      // coded codeblock costs a coded_lists header, and, when decoding,
+      // space before and after its data for the block decoder
+      ui64 num_cbs = 0;
+      size tile_size = siz.get_tile_size();
+      ui64 num_tiles = (ui64)ojph_div_ceil(siz.get_image_extent().x
+        - siz.get_tile_offset().x, tile_size.w)
+        * ojph_div_ceil(siz.get_image_extent().y
+        - siz.get_tile_offset().y, tile_size.h);
+      ui64 raw_bytes = 0;
+      for (ui32 c = 0; c < siz.get_num_components(); ++c)
+      {
+        const param_cod* cdp = cod.get_coc(c);
+        size log_cb = cdp->get_log_block_dims();
+        point ds = siz.get_downsampling(c);
+        ui32 w = ojph_div_ceil(tile_size.w, ds.x);
+        ui32 h = ojph_div_ceil(tile_size.h, ds.y);
+        ui32 num_decomps = cdp->get_num_decompositions();
+        for (ui32 d = 1; d <= num_decomps; ++d)
+        {
+          w = (w + 1) >> 1; h = (h + 1) >> 1;
+          num_cbs += 3 * (ui64)ojph_div_ceil(w, 1u << log_cb.w)
+            * ojph_div_ceil(h, 1u << log_cb.h);
+        }
+        num_cbs += (ui64)ojph_div_ceil(w, 1u << log_cb.w)
+          * ojph_div_ceil(h, 1u << log_cb.h);
+        raw_bytes += (ui64)siz.get_width(c) * siz.get_height(c)
+          * ((siz.get_bit_depth(c) + 7) >> 3);
+      }
+      num_cbs *= num_tiles;
+      ui64 per_cb = ((sizeof(coded_lists) + 15) & ~(size_t)15);
+      if (infile != NULL)
+        per_cb += coded_cb_header::prefix_buf_size
+                + coded_cb_header::suffix_buf_size;
+
+      ui64 data_bytes = 0;
+      if (infile != NULL)
+      { // decoding stores no more than the rest of the file, unless the
+        // file data is referred to in place
+        size_t avail;
+        if (infile->get_data_ptr(avail) == NULL)
+        {
+          si64 pos = infile->tell();
+          infile->seek(0, infile_base::OJPH_SEEK_END);
+          avail = (size_t)(infile->tell() - pos);
+          infile->seek(pos, infile_base::OJPH_SEEK_SET);
+        }
+        if (!infile->is_data_persistent())
+          data_bytes = avail;
+      }
+      else // a lossless codestream is rarely larger than the samples
+        data_bytes = raw_bytes;
+
+      // memory grows in chunks, the last of which is partially used
+      coded_bytes = data_bytes + num_cbs * per_cb
+                  + elastic_alloc->get_chunk_size();
+      coded_bytes = ojph_max(coded_bytes,
+                             (ui64)elastic_alloc->get_allocated_size());
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::get_coded_size_stats(ui32 comp_num, ui32 res_num,
+                                          ui32 band_num,
+                                          coded_size_stats& stats) const
+    {
+      memset(&stats, 0, sizeof(stats));
+      if (tiles == NULL)
+        return;
+      for (ui32 i = 0; i < num_tiles.area(); ++i)
+        tiles[i].add_size_stats(comp_num, res_num, band_num, stats);
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void codestream::close()
     {
@@ -1224,7 +1544,7 @@ namespace ojph {
     }
 
     //////////////////////////////////////////////////////////////////////////
-    line_buf* codestream::pull(ui32 &comp_num)
+    line_buf* codestream::pull(ui32 &comp_num, const frame_row *row)
     {
       bool success = false;
       while (!success)
@@ -1233,7 +1553,8 @@ namespace ojph {
         for (ui32 i = 0; i < num_tiles.w; ++i)
         {
           ui32 idx = i + cur_tile_row * num_tiles.w;
-          if ((success &= tiles[idx].pull(lines + cur_comp, cur_comp)) == false)
+          if ((success &= tiles[idx].pull(lines + cur_comp, cur_comp,
+                                          row)) == false)
             break;
         }
         cur_tile_row += success == false ? 1 : 0;
@@ -1271,5 +1592,139 @@ namespace ojph {
       return lines + comp_num;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::check_frame(const frame_buffer& frame)
+    {
+      if (frame.num_components != num_comps)
+        OJPH_ERROR(0x00030016, "The frame has %d components, but the "
+          "codestream has %d", frame.num_components, num_comps);
+      if (frame.sample != OJPH_FRAME_8BIT && frame.sample != OJPH_FRAME_16BIT)
+        OJPH_ERROR(0x00030017, "Unsupported frame sample type %d",
+          frame.sample);
+      if (frame.byte_order > OJPH_FRAME_BIG_ENDIAN)
+        OJPH_ERROR(0x00030019, "Unsupported frame byte order %d",
+          frame.byte_order);
+      for (ui32 c = 0; c < num_comps; ++c)
+        if (siz.get_bit_depth(c) > 8 * frame.sample)
+          OJPH_ERROR(0x00030018, "Component %d has a bit depth of %d, "
+            "which does not fit in %d-bit frame samples", c,
+            siz.get_bit_depth(c), 8 * frame.sample);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    ui32 codestream::get_stripe_rows(const size* sizes, ui32 max_rows) const
+    {
+      // the number of rows, up to max_rows, that remain in the current
+      // component for planar order, or in the image for interleaved order
+      if (cur_comp >= num_comps)
+        return 0; // planar, and all components are done
+      return ojph_min(max_rows, sizes[planar ? cur_comp : 0].h - cur_line);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static bool is_frame_swapped(const frame_buffer& frame)
+    {
+      // whether 16-bit samples are in the other byte order than the
+      // machine's
+      if (frame.byte_order == OJPH_FRAME_LITTLE_ENDIAN)
+        return !is_machine_little_endian;
+      else if (frame.byte_order == OJPH_FRAME_BIG_ENDIAN)
+        return is_machine_little_endian;
+      return false;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::push_rows(const frame_buffer& frame, ui32 first_line,
+                               ui32 num_rows)
+    {
+      // row y of a component is at row y - first_line of the frame
+      bool swap = is_frame_swapped(frame);
+      ui32 num_calls = planar ? num_rows : num_rows * num_comps - cur_comp;
+      for (ui32 n = num_calls; n > 0; --n)
+      {
+        ui32 c = cur_comp;
+        const frame_component& fc = frame.comps[c];
+        const ui8* sp =
+          (const ui8*)fc.data + (si64)(cur_line - first_line) * fc.stride;
+        {
+          // lines are counted by tile::push()
+          stage_scope scope(&timer, stage_timer::COLOUR, 0);
+          if (frame.sample == OJPH_FRAME_8BIT)
+            cnvrt_8b_to_si32(sp, fc.step, siz.is_signed(c), lines[c].i32,
+              comp_size[c].w);
+          else
+            cnvrt_16b_to_si32(sp, fc.step, siz.is_signed(c), swap,
+              lines[c].i32, comp_size[c].w);
+        }
+        ui32 next_comp;
+        exchange(lines + c, next_comp);
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::pull_rows(const frame_buffer& frame, ui32 first_line,
+                               ui32 num_rows)
+    {
+      // row y of a component is stored in row y - first_line of the frame;
+      // the tiles store their samples there directly
+      frame_row row;
+      row.bytes = frame.sample;
+      row.swap = is_frame_swapped(frame);
+      ui32 num_calls = planar ? num_rows : num_rows * num_comps - cur_comp;
+      for (ui32 n = num_calls; n > 0; --n)
+      {
+        ui32 c = cur_comp;
+        const frame_component& fc = frame.comps[c];
+        row.data = (ui8*)fc.data + (si64)(cur_line - first_line) * fc.stride;
+        row.step = fc.step;
+        ui32 bit_depth = siz.get_bit_depth(c);
+        row.low = 0;
+        row.high = (si32)((1u << bit_depth) - 1);
+        if (siz.is_signed(c)) {
+          row.low = -(si32)(1u << (bit_depth - 1));
+          row.high = (si32)(1u << (bit_depth - 1)) - 1;
+        }
+        pull(c, &row);
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::push_frame(const frame_buffer& frame)
+    {
+      check_frame(frame);
+      // in planar order, this visits one component at a time
+      ui32 rows;
+      while ((rows = get_stripe_rows(comp_size, UINT_MAX)) > 0)
+        push_rows(frame, 0, rows);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::pull_frame(const frame_buffer& frame)
+    {
+      check_frame(frame);
+      // in planar order, this visits one component at a time
+      ui32 rows;
+      while ((rows = get_stripe_rows(recon_comp_size, UINT_MAX)) > 0)
+        pull_rows(frame, 0, rows);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    ui32 codestream::push_stripe(const frame_buffer& stripe, ui32 num_rows)
+    {
+      check_frame(stripe);
+      ui32 rows = get_stripe_rows(comp_size, num_rows);
+      push_rows(stripe, cur_line, rows);
+      return rows;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    ui32 codestream::pull_stripe(const frame_buffer& stripe, ui32 num_rows)
+    {
+      check_frame(stripe);
+      ui32 rows = get_stripe_rows(recon_comp_size, num_rows);
+      pull_rows(stripe, cur_line, rows);
+      return rows;
+    }
+
   }
 }
@@ -41,7 +41,9 @@
 
 #include "ojph_defs.h"
 #include "ojph_arch.h"
+#include "ojph_file.h"
 #include "ojph_params_local.h"
+#include "ojph_stage_timer.h"
 
 namespace ojph {
 
@@ -51,6 +53,9 @@ namespace ojph {
   class mem_fixed_allocator;
   class mem_elastic_allocator;
   class codestream;
+  struct out_vec;
+  struct frame_buffer;
+  struct coded_size_stats;
 
   namespace local {
 
@@ -59,6 +64,7 @@ namespace ojph {
     //////////////////////////////////////////////////////////////////////////
     //defined elsewhere
     class tile;
+    struct frame_row;
 
     //////////////////////////////////////////////////////////////////////////
     class codestream
@@ -95,6 +101,8 @@ namespace ojph {
       outfile_base* get_file() { return outfile; }
 
       line_buf* exchange(line_buf* line, ui32& next_component);
+      void push_frame(const frame_buffer& frame);
+      ui32 push_stripe(const frame_buffer& stripe, ui32 num_rows);
       void write_headers(outfile_base *file, const comment_exchange* comments,
                          ui32 num_comments);
       void enable_resilience();
@@ -107,9 +115,18 @@ namespace ojph {
       void set_profile(const char *s);
       void set_tilepart_divisions(ui32 value);
       void request_tlm_marker(bool needed);
-      line_buf* pull(ui32 &comp_num);
+      line_buf* pull(ui32 &comp_num, const frame_row *row = NULL);
+      void pull_frame(const frame_buffer& frame);
+      ui32 pull_stripe(const frame_buffer& stripe, ui32 num_rows);
       void flush();
       void close();
+      void enable_header_cache(bool enable);
+      void discard_cached_header();
+      bool is_header_repeated() const { return header_repeated; }
+      void set_memory_budget(ui64 bytes) { memory_budget = bytes; }
+      void estimate_memory(ui64& fixed_bytes, ui64& coded_bytes);
+      void get_coded_size_stats(ui32 comp_num, ui32 res_num, ui32 band_num,
+                                coded_size_stats& stats) const;
 
       bool is_planar() const { return planar != 0; }
       si32 get_profile() const { return profile; };
@@ -120,14 +137,34 @@ namespace ojph {
       void check_broadcast_validity();
 
       ui8* get_precinct_scratch() { return precinct_scratch; }
+      ui8* get_packet_window() { return packet_window; }
+      ui32 get_packet_window_size() { return packet_window_size; }
+      out_vec* get_gather_vecs() { return gather_vecs; }
+      ui32 get_gather_vecs_size() { return gather_vecs_size; }
       ui32 get_skipped_res_for_recon()
       { return skipped_res_for_recon; }
       ui32 get_skipped_res_for_read()
       { return skipped_res_for_read; }
+      stage_timer* get_stage_timer() { return &timer; }
+
+    private:
+      void reset_params();
+      void finalize_params();
+      void write_main_header(outfile_base *file);
+      void check_frame(const frame_buffer& frame);
+      ui32 get_stripe_rows(const size* sizes, ui32 max_rows) const;
+      void push_rows(const frame_buffer& frame, ui32 first_line,
+                     ui32 num_rows);
+      void pull_rows(const frame_buffer& frame, ui32 first_line,
+                     ui32 num_rows);
 
     private:
       ui32 precinct_scratch_needed_bytes;
       ui8* precinct_scratch;
+      ui32 packet_window_size;  // packet headers are read through a window
+      ui8* packet_window;       // of this size, when reading
+      ui32 gather_vecs_size;    // coded data is handed to the file in
+      out_vec* gather_vecs;     // batches of this many regions
 
     private:
       ui32 cur_line;
@@ -166,6 +203,24 @@ namespace ojph {
       mem_elastic_allocator *elastic_alloc;
       outfile_base *outfile;
       infile_base *infile;
+      ui64 memory_budget;    // 0 for no budget; survives restart()
+
+    private:
+      enum : ui32 {
+        HEADER_CACHE_NONE = 0,    // nothing cached
+        HEADER_CACHE_WRITTEN = 1, // main header as written by write_headers()
+        HEADER_CACHE_READ = 2,    // main header as read by read_headers()
+      };
+      bool header_cache_enabled;
+      ui32 header_cache_kind;
+      bool params_retained;  // restart() kept the parameters of the last
+                             // header, and none has been set since
+      bool header_repeated;  // the last header matched the cached one
+      mem_outfile header_cache;
+      mem_outfile header_check; // a header built anew, to compare with it
+
+    private:
+      stage_timer timer;     // per-stage time, when enabled
     };
 
   }
@@ -125,6 +125,40 @@ namespace ojph {
       _mm_storeu_si128((__m128i*)max_val, tmax);
     }
                            
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_rev_tx16_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
+                               float delta_inv, ui32 count, ui32* max_val)
+    {
+      ojph_unused(delta_inv);
+
+      // convert to sign and magnitude and keep max_val
+      ui32 shift = 31 - K_max;
+      __m128i m0 = _mm_set1_epi32(INT_MIN);
+      __m128i zero = _mm_setzero_si128();
+      __m128i one = _mm_set1_epi32(1);
+      __m128i idx = _mm_set_epi32(3, 2, 1, 0);
+      __m128i tmax = _mm_loadu_si128((__m128i*)max_val);
+      const si16 *p = (const si16*)sp;
+      for (int c = (int)count; c > 0; c -= 4, p += 4, dp += 4)
+      {
+        __m128i v = _mm_loadl_epi64((__m128i*)p);
+        v = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16); // sign extend
+        __m128i sign = _mm_cmplt_epi32(v, zero);
+        __m128i val = _mm_xor_si128(v, sign); // negate 1's complement
+        __m128i ones = _mm_and_si128(sign, one);
+        val = _mm_add_epi32(val, ones);        // 2's complement
+        sign = _mm_and_si128(sign, m0);
+        val = _mm_slli_epi32(val, (int)shift);
+
+        __m128i mask = _mm_cmpgt_epi32(_mm_set1_epi32(c), idx);
+        tmax = _mm_or_si128(tmax, _mm_and_si128(val, mask));
+
+        val = _mm_or_si128(val, sign);
+        _mm_storeu_si128((__m128i*)dp, val);
+      }
+      _mm_storeu_si128((__m128i*)max_val, tmax);
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void sse2_irv_tx_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
                              float delta_inv, ui32 count, ui32* max_val)
@@ -198,6 +232,34 @@ namespace ojph {
       }
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_rev_tx16_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
+                                 float delta, ui32 count)
+    {
+      ojph_unused(delta);
+      ui32 shift = 31 - K_max;
+      __m128i m1 = _mm_set1_epi32(INT_MAX);
+      __m128i zero = _mm_setzero_si128();
+      __m128i one = _mm_set1_epi32(1);
+      si16 *p = (si16*)dp;
+      for (ui32 i = 0; i < count; i += 8, sp += 8, p += 8)
+      {
+        __m128i v0 = _mm_load_si128((__m128i*)sp);
+        __m128i v1 = _mm_load_si128((__m128i*)sp + 1);
+        __m128i val0 = _mm_srli_epi32(_mm_and_si128(v0, m1), (int)shift);
+        __m128i val1 = _mm_srli_epi32(_mm_and_si128(v1, m1), (int)shift);
+        __m128i sign = _mm_cmplt_epi32(v0, zero);
+        val0 = _mm_xor_si128(val0, sign); // negate 1's complement
+        val0 = _mm_add_epi32(val0, _mm_and_si128(sign, one)); // 2's comp.
+        sign = _mm_cmplt_epi32(v1, zero);
+        val1 = _mm_xor_si128(val1, sign);
+        val1 = _mm_add_epi32(val1, _mm_and_si128(sign, one));
+        // magnitudes are below 2^K_max, with K_max < 16, so saturation
+        // never kicks in
+        _mm_storeu_si128((__m128i*)p, _mm_packs_epi32(val0, val1));
+      }
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void sse2_irv_tx_from_cb32(const ui32 *sp, void *dp, ui32 K_max, 
                                float delta, ui32 count)
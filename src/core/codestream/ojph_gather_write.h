@@ -0,0 +1,110 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2019, Aous Naman 
+// Copyright (c) 2019, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2019, The University of New South Wales, Australia
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_gather_write.h
+// Author: Aous Naman
+// Date: 19 October 2026
+//***************************************************************************/
+
+
+
+#ifndef OJPH_GATHER_WRITE_H
+#define OJPH_GATHER_WRITE_H
+
+#include <cassert>
+
+#include "ojph_defs.h"
+#include "ojph_file.h"
+
+namespace ojph {
+  namespace local {
+
+    //////////////////////////////////////////////////////////////////////////
+    // collects regions of coded data, which must remain valid until they
+    // are flushed, and hands them to the file in batches through
+    // outfile_base::write_v()
+    struct gather_buf
+    {
+      outfile_base *file;
+      out_vec *vecs;
+      ui32 capacity;
+      ui32 count;
+      size_t bytes;   // bytes in the current batch
+      bool ok;        // false once any write has failed
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void gb_init(gather_buf *gbp, outfile_base *file, out_vec *vecs,
+                 ui32 capacity)
+    {
+      assert(capacity > 0);
+      gbp->file = file;
+      gbp->vecs = vecs;
+      gbp->capacity = capacity;
+      gbp->count = 0;
+      gbp->bytes = 0;
+      gbp->ok = true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    bool gb_flush(gather_buf *gbp)
+    {
+      if (gbp->count)
+      {
+        size_t t = gbp->file->write_v(gbp->vecs, gbp->count);
+        gbp->ok = gbp->ok && t == gbp->bytes;
+        gbp->count = 0;
+        gbp->bytes = 0;
+      }
+      return gbp->ok;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void gb_add(gather_buf *gbp, const void *data, size_t size)
+    {
+      if (size == 0)
+        return;
+      if (gbp->count == gbp->capacity)
+        gb_flush(gbp);
+      gbp->vecs[gbp->count].data = data;
+      gbp->vecs[gbp->count].size = size;
+      ++gbp->count;
+      gbp->bytes += size;
+    }
+
+  }
+}
+
+#endif // !OJPH_GATHER_WRITE_H
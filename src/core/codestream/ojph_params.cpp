@@ -44,10 +44,20 @@
 #include "ojph_params.h"
 
 #include "ojph_params_local.h"
+#include "ojph_codestream_local.h"
 #include "ojph_message.h"
 
 namespace ojph {
 
+  ////////////////////////////////////////////////////////////////////////////
+  // tells the owning codestream that a parameter is about to be set, so
+  // that parameters kept by restart() for a cached header start afresh
+  static inline void params_changing(local::codestream* owner)
+  {
+    if (owner != NULL)
+      owner->discard_cached_header();
+  }
+
   ////////////////////////////////////////////////////////////////////////////
   //
   //
@@ -59,30 +69,35 @@ namespace ojph {
   ////////////////////////////////////////////////////////////////////////////
   void param_siz::set_image_extent(point dims)
   {
+    params_changing(state->get_owner());
     state->set_image_extent(dims);
   }
 
   ////////////////////////////////////////////////////////////////////////////
   void param_siz::set_tile_size(size s)
   {
+    params_changing(state->get_owner());
     state->set_tile_size(s);
   }
 
   ////////////////////////////////////////////////////////////////////////////
   void param_siz::set_image_offset(point offset)
   {
+    params_changing(state->get_owner());
     state->set_image_offset(offset);
   }
 
   ////////////////////////////////////////////////////////////////////////////
   void param_siz::set_tile_offset(point offset)
   {
+    params_changing(state->get_owner());
     state->set_tile_offset(offset);
   }
 
   ////////////////////////////////////////////////////////////////////////////
   void param_siz::set_num_components(ui32 num_comps)
   {
+    params_changing(state->get_owner());
     state->set_num_components(num_comps);
   }
 
@@ -90,6 +105,7 @@ namespace ojph {
   void param_siz::set_component(ui32 comp_num, const point& downsampling,
                                 ui32 bit_depth, bool is_signed)
   {
+    params_changing(state->get_owner());
     state->set_comp_info(comp_num, downsampling, bit_depth, is_signed);
   }
 
@@ -164,6 +180,7 @@ namespace ojph {
   ////////////////////////////////////////////////////////////////////////////
   void param_cod::set_num_decomposition(ui32 num_decompositions)
   {
+    params_changing(state->get_owner());
     if (num_decompositions > 32)
       OJPH_ERROR(0x00050001,
         "maximum number of decompositions cannot exceed 32");
@@ -173,6 +190,7 @@ namespace ojph {
   ////////////////////////////////////////////////////////////////////////////
   void param_cod::set_block_dims(ui32 width, ui32 height)
   {
+    params_changing(state->get_owner());
     ui32 log_width = 31 - count_leading_zeros(width);
     ui32 log_height = 31 - count_leading_zeros(height);
     if (width == 0 || width != (1u << log_width)
@@ -187,6 +205,7 @@ namespace ojph {
   ////////////////////////////////////////////////////////////////////////////
   void param_cod::set_precinct_size(int num_levels, size* precinct_size)
   {
+    params_changing(state->get_owner());
     if (num_levels == 0 || precinct_size == NULL)
       state->Scod &= 0xFE;
     else
@@ -215,6 +234,7 @@ namespace ojph {
   ////////////////////////////////////////////////////////////////////////////
   void param_cod::set_progression_order(const char *name)
   {
+    params_changing(state->get_owner());
     int prog_order = 0;
     size_t len = strlen(name);
     if (len == 4)
@@ -242,18 +262,21 @@ namespace ojph {
   ////////////////////////////////////////////////////////////////////////////
   void param_cod::set_color_transform(bool color_transform)
   {
+    params_changing(state->get_owner());
     state->employ_color_transform(color_transform ? 1 : 0);
   }
 
   ////////////////////////////////////////////////////////////////////////////
   void param_cod::set_reversible(bool reversible)
   {
+    params_changing(state->get_owner());
     state->set_reversible(reversible);
   }
 
   ////////////////////////////////////////////////////////////////////////////
   void param_cod::set_num_decomposition(ui32 comp_idx, ui32 num_decompositions)
   {
+    params_changing(state->get_owner());
     local::param_cod* cdp = state->get_or_add_coc(comp_idx);
     ojph::param_cod(cdp).set_num_decomposition(num_decompositions);
   }
@@ -261,6 +284,7 @@ namespace ojph {
   ////////////////////////////////////////////////////////////////////////////
   void param_cod::set_block_dims(ui32 comp_idx, ui32 width, ui32 height)
   {
+    params_changing(state->get_owner());
     local::param_cod* cdp = state->get_or_add_coc(comp_idx);
     ojph::param_cod(cdp).set_block_dims(width, height);
   }
@@ -269,6 +293,7 @@ namespace ojph {
   void param_cod::set_precinct_size(ui32 comp_idx, int num_levels,
                                     size* precinct_size)
   {
+    params_changing(state->get_owner());
     local::param_cod* cdp = state->get_or_add_coc(comp_idx);
     ojph::param_cod(cdp).set_precinct_size(num_levels, precinct_size);
   }
@@ -276,6 +301,7 @@ namespace ojph {
   ////////////////////////////////////////////////////////////////////////////
   void param_cod::set_reversible(ui32 comp_idx, bool reversible)
   {
+    params_changing(state->get_owner());
     local::param_cod* cdp = state->get_or_add_coc(comp_idx);
     ojph::param_cod(cdp).set_reversible(reversible);
   }
@@ -410,22 +436,26 @@ namespace ojph {
   //////////////////////////////////////////////////////////////////////////
   void param_qcd::set_irrev_quant(float delta)
   {
+    params_changing(state->get_owner());
     state->set_delta(delta);
   }
 
   //////////////////////////////////////////////////////////////////////////
   void param_qcd::set_qfactor(ui8 qfactor) {
+    params_changing(state->get_owner());
     state->set_qfactor(qfactor);
   }
 
   //////////////////////////////////////////////////////////////////////////
   void param_qcd::set_irrev_quant(ui32 comp_idx, float delta)
   {
+    params_changing(state->get_owner());
     state->set_delta(comp_idx, delta);
   }
 
   //////////////////////////////////////////////////////////////////////////
   void param_qcd::set_qfactor(ui32 comp_idx, comp_type ctype, ui8 qfactor) {
+    params_changing(state->get_owner());
     state->set_qfactor(comp_idx, ctype, qfactor);
   }
 
@@ -440,6 +470,7 @@ namespace ojph {
   ////////////////////////////////////////////////////////////////////////////
   void param_nlt::set_nonlinear_transform(ui32 comp_num, ui8 nl_type)
   {
+    params_changing(state->get_owner());
     state->set_nonlinear_transform(comp_num, nl_type);
   }
 
@@ -2478,6 +2509,7 @@ namespace ojph {
                    "In any case, this limit means that we have 10922 "
                    "tileparts or more, which is a huge number.");
       this->num_pairs = num_pairs;
+      this->next_pair_index = 0;
       pairs = store;
       Ltlm = (ui16)(4 + 6 * num_pairs);
       Ztlm = 0;
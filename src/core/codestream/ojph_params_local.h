@@ -105,6 +105,9 @@ namespace ojph {
 
   namespace local {
 
+    //defined elsewhere
+    class codestream;
+
     //defined here
     struct param_siz;
     struct param_cod;
@@ -174,9 +177,13 @@ namespace ojph {
       };
 
     public:
-      param_siz() { init(); }
+      param_siz() { owner = NULL; init(); }
       ~param_siz() { destroy(); }
 
+      // the codestream is told before a setter changes a parameter
+      void set_owner(codestream* c) { owner = c; }
+      codestream* get_owner() const { return owner; }
+
       void init()
       {
         Lsiz = Csiz = 0;
@@ -328,6 +335,7 @@ namespace ojph {
       siz_comp_info store[4];
       bool ws_kern_support_needed;
       bool dfs_support_needed;
+      codestream* owner;
       const param_cod* cod;
       const param_dfs* dfs;
       param_siz(const param_siz&) = delete; //prevent copy constructor
@@ -411,9 +419,13 @@ namespace ojph {
 
     public: // COD_MAIN and COC_MAIN common functions
       param_cod(param_cod* top_cod = NULL, ui16 comp_idx = OJPH_COD_DEFAULT)
-      { avail = NULL; init(top_cod, comp_idx); }
+      { avail = NULL; owner = NULL; init(top_cod, comp_idx); }
       ~param_cod() { destroy(); }
 
+      // the codestream is told before a setter changes a parameter
+      void set_owner(codestream* c) { owner = c; }
+      codestream* get_owner() const { return owner; }
+
       ////////////////////////////////////////
       void restart()
       {
@@ -674,6 +686,7 @@ namespace ojph {
 
     private: // on restart, already allocated param_cod objs are stored here
       param_cod* avail;
+      codestream* owner;    // NULL for COC objects
     };
 
     ///////////////////////////////////////////////////////////////////////////
@@ -711,9 +724,13 @@ namespace ojph {
 
     public:
       param_qcd(param_qcd* top_qcd = NULL, ui16 comp_idx = OJPH_QCD_DEFAULT)
-      { avail = NULL; init(top_qcd, comp_idx); }
+      { avail = NULL; owner = NULL; init(top_qcd, comp_idx); }
       ~param_qcd() { destroy(); }
 
+      // the codestream is told before a setter changes a parameter
+      void set_owner(codestream* c) { owner = c; }
+      codestream* get_owner() const { return owner; }
+
       ////////////////////////////////////////
       void restart()
       {
@@ -828,6 +845,7 @@ namespace ojph {
 
     private:  // on restart, already allocated param_qcd objs are stored here
       param_qcd* avail;
+      codestream* owner;    // NULL for QCC objects
     };
 
     ///////////////////////////////////////////////////////////////////////////
@@ -843,9 +861,13 @@ namespace ojph {
       using special_comp_num = ojph::param_nlt::special_comp_num;
       using nonlinearity = ojph::param_nlt::nonlinearity;
     public:
-      param_nlt() { avail = NULL; init(); }
+      param_nlt() { avail = NULL; owner = NULL; init(); }
       ~param_nlt() { destroy(); }
 
+      // the codestream is told before a setter changes a parameter
+      void set_owner(codestream* c) { owner = c; }
+      codestream* get_owner() const { return owner; }
+
       ////////////////////////////////////////
       void restart()
       {
@@ -907,6 +929,7 @@ namespace ojph {
 
     private: // on restart, already allocated param_nlt objs are stored here
       param_nlt* avail;
+      codestream* owner;    // NULL for chained objects
     };
 
     ///////////////////////////////////////////////////////////////////////////
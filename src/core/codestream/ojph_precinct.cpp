@@ -47,6 +47,7 @@
 #include "ojph_codeblock.h" // for coded_cb_header
 #include "ojph_bitbuffer_write.h"
 #include "ojph_bitbuffer_read.h"
+#include "ojph_gather_write.h"
 
 
 namespace ojph {
@@ -278,7 +279,7 @@ namespace ojph {
     }
 
     //////////////////////////////////////////////////////////////////////////
-    void precinct::write(outfile_base *file)
+    void precinct::write(gather_buf *gbp)
     {
       if (coded)
       {
@@ -286,7 +287,7 @@ namespace ojph {
         coded_lists *ccl = coded;
         while (ccl)
         {
-          file->write(ccl->buf, ccl->buf_size - ccl->avail_size);
+          gb_add(gbp, ccl->buf, ccl->buf_size - ccl->avail_size);
           ccl = ccl->next_list;
         }
 
@@ -308,7 +309,7 @@ namespace ojph {
               coded_lists *ccl = cp->next_coded;
               while (ccl)
               {
-                file->write(ccl->buf, ccl->buf_size - ccl->avail_size);
+                gb_add(gbp, ccl->buf, ccl->buf_size - ccl->avail_size);
                 ccl = ccl->next_list;
               }
             }
@@ -318,8 +319,8 @@ namespace ojph {
       else
       {
         //empty packet
-        char buf = 0x00;
-        file->write(&buf, 1);
+        static const ui8 empty_packet = 0x00;
+        gb_add(gbp, &empty_packet, 1);
       }
     }
 
@@ -327,14 +328,11 @@ namespace ojph {
     //////////////////////////////////////////////////////////////////////////
     void precinct::parse(int tag_tree_size, ui32* lev_idx,
                          mem_elastic_allocator *elastic,
-                         ui32 &data_left, infile_base *file,
-                         bool skipped)
+                         bit_read_buf *bbp, bool skipped)
     {
-      assert(data_left > 0);
-      bit_read_buf bb;
-      bb_init(&bb, data_left, file);
+      assert(bbp->bytes_left > 0);
       if (may_use_sop)
-        bb_skip_sop(&bb);
+        bb_skip_sop(bbp);
 
       bool empty_packet = true;
       for (int s = 0; s < 4; ++s)
@@ -348,9 +346,9 @@ namespace ojph {
         if (empty_packet) //one bit to check if the packet is empty
         {
           ui32 bit;
-          bb_read_bit(&bb, bit);
+          bb_read_bit(bbp, bit);
           if (bit == 0) //empty packet
-          { bb_terminate(&bb, uses_eph); data_left = bb.bytes_left; return; }
+          { bb_terminate(bbp, uses_eph); return; }
           empty_packet = false;
         }
 
@@ -393,8 +391,8 @@ namespace ojph {
               if (*inc_tag_flags.get(x>>cur_lev, y>>cur_lev, cur_lev) == 0)
               {
                 ui32 bit;
-                if (bb_read_bit(&bb, bit) == false)
-                { data_left = 0; throw "error reading from file p1"; }
+                if (bb_read_bit(bbp, bit) == false)
+                { throw "error reading from file p1"; }
                 empty_cb = (bit == 0);
                 *inc_tag.get(x>>cur_lev, y>>cur_lev, cur_lev) = (ui8)(1 - bit);
                 *inc_tag_flags.get(x>>cur_lev, y>>cur_lev, cur_lev) = 1;
@@ -418,8 +416,8 @@ namespace ojph {
                 ui32 bit = 0;
                 while (bit == 0)
                 {
-                  if (bb_read_bit(&bb, bit) == false)
-                  { data_left = 0; throw "error reading from file p2"; }
+                  if (bb_read_bit(bbp, bit) == false)
+                  { throw "error reading from file p2"; }
                   mmsbs += 1 - bit;
                 }
                 *mmsb_tag.get(x>>cur_lev, y>>cur_lev, cur_lev) = (ui8)mmsbs;
@@ -435,27 +433,27 @@ namespace ojph {
 
             //get number of passes
             ui32 bit, num_passes = 1;
-            if (bb_read_bit(&bb, bit) == false)
-            { data_left = 0; throw "error reading from file p3"; }
+            if (bb_read_bit(bbp, bit) == false)
+            { throw "error reading from file p3"; }
             if (bit)
             {
               num_passes = 2;
-              if (bb_read_bit(&bb, bit) == false)
-              { data_left = 0; throw "error reading from file p4"; }
+              if (bb_read_bit(bbp, bit) == false)
+              { throw "error reading from file p4"; }
               if (bit)
               {
-                if (bb_read_bits(&bb, 2, bit) == false)
-                { data_left = 0; throw "error reading from file p5";  }
+                if (bb_read_bits(bbp, 2, bit) == false)
+                { throw "error reading from file p5"; }
                 num_passes = 3 + bit;
                 if (bit == 3)
                 {
-                  if (bb_read_bits(&bb, 5, bit) == false)
-                  { data_left = 0; throw "error reading from file p6"; }
+                  if (bb_read_bits(bbp, 5, bit) == false)
+                  { throw "error reading from file p6"; }
                   num_passes = 6 + bit;
                   if (bit == 31)
                   {
-                    if (bb_read_bits(&bb, 7, bit) == false)
-                    { data_left = 0; throw "error reading from file p7"; }
+                    if (bb_read_bits(bbp, 7, bit) == false)
+                    { throw "error reading from file p7"; }
                     num_passes = 37 + bit;
                   }
                 }
@@ -484,15 +482,15 @@ namespace ojph {
             while (bit)
             {
               // add any extra bits here
-              if (bb_read_bit(&bb, bit) == false)
-              { data_left = 0; throw "error reading from file p8"; }
+              if (bb_read_bit(bbp, bit) == false)
+              { throw "error reading from file p8"; }
               Lblock += bit;
             }
 
             int bits = Lblock + 31 -
               (int)count_leading_zeros(num_phld_passes + 1);
-            if (bb_read_bits(&bb, bits, bit) == false)
-            { data_left = 0; throw "error reading from file p9"; }
+            if (bb_read_bits(bbp, bits, bit) == false)
+            { throw "error reading from file p9"; }
             if (bit < 2)
               throw "The cleanup segment of an HT codeblock cannot contain "
                 "less than 2 bytes";
@@ -506,8 +504,8 @@ namespace ojph {
               //bits = Lblock + 31 - count_leading_zeros(cp->num_passes - 1);
               // The following is simpler than the above, I think?
               bits = Lblock + (cp->num_passes > 2 ? 1 : 0);
-              if (bb_read_bits(&bb, bits, bit) == false)
-              { data_left = 0; throw "error reading from file p10"; }
+              if (bb_read_bits(bbp, bits, bit) == false)
+              { throw "error reading from file p10"; }
               if (bit >= 2047)
                 throw "The refinement segment (SigProp and MagRep passes) of "
                   "an HT codeblock must contain less than 2047 bytes";
@@ -519,11 +517,12 @@ namespace ojph {
       if (empty_packet)
       { // all subbands are empty
         ui32 bit = 0;
-        bb_read_bit(&bb, bit);
+        bb_read_bit(bbp, bit);
         //assert(bit == 0);
       }
-      bb_terminate(&bb, uses_eph);
+      bb_terminate(bbp, uses_eph);
       //read codeblock data
+      bool data_ok = true;
       for (int s = 0; s < 4; ++s)
       {
         if (bands[s].empty)
@@ -539,27 +538,22 @@ namespace ojph {
           for (ui32 x = 0; x < width; ++x, ++cp)
           {
             ui32 num_bytes = cp->pass_length[0] + cp->pass_length[1];
-            if (data_left)
+            if (data_ok)
             {
               if (num_bytes)
               {
                 if (skipped)
                 { //no need to read
-                  si64 cur_loc = file->tell();
-                  ui32 t = ojph_min(num_bytes, bb.bytes_left);
-                  file->seek(t, infile_base::OJPH_SEEK_CUR);
-                  ui32 bytes_read = (ui32)(file->tell() - cur_loc);
+                  bb_skip_chunk(bbp, num_bytes);
                   cp->pass_length[0] = cp->pass_length[1] = 0;
-                  bb.bytes_left -= bytes_read;
-                  assert(bytes_read == t || bb.bytes_left == 0);
                 }
                 else
                 {
-                  if (!bb_read_chunk(&bb, num_bytes, cp->next_coded, elastic))
+                  if (!bb_read_chunk(bbp, num_bytes, cp->next_coded, elastic))
                   {
                     //no need to decode a broken codeblock
                     cp->pass_length[0] = cp->pass_length[1] = 0;
-                    data_left = 0;
+                    data_ok = false;
                   }
                 }
               }
@@ -569,7 +563,6 @@ namespace ojph {
           }
         }
       }
-      data_left = bb.bytes_left;
     }
 
   }
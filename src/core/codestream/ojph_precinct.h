@@ -53,6 +53,8 @@ namespace ojph {
     //////////////////////////////////////////////////////////////////////////
     //defined here
     class subband;
+    struct bit_read_buf;
+    struct gather_buf;
     
     //////////////////////////////////////////////////////////////////////////
     struct precinct
@@ -63,10 +65,10 @@ namespace ojph {
       }
       ui32 prepare_precinct(int tag_tree_size, ui32* lev_idx,
                             mem_elastic_allocator *elastic);
-      void write(outfile_base *file);
+      void write(gather_buf *gbp);
       void parse(int tag_tree_size, ui32* lev_idx,
                  mem_elastic_allocator *elastic,
-                 ui32& data_left, infile_base *file, bool skipped);
+                 bit_read_buf *bbp, bool skipped);
 
       ui8 *scratch;
       point img_point; //the precinct projected to full resolution
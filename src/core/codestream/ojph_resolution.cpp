@@ -42,12 +42,16 @@
 
 #include "ojph_mem.h"
 #include "ojph_params.h"
+#include "ojph_codestream.h"
 #include "ojph_codestream_local.h"
 #include "ojph_resolution.h"
 #include "ojph_tile_comp.h"
 #include "ojph_tile.h"
 #include "ojph_subband.h"
 #include "ojph_precinct.h"
+#include "ojph_codeblock.h" // for coded_cb_header
+#include "ojph_bitbuffer_read.h"
+#include "ojph_trace.h"
 
 #include "../transform/ojph_transform.h"
 
@@ -55,6 +59,25 @@ namespace ojph {
 
   namespace local
   {
+    //////////////////////////////////////////////////////////////////////////
+    // Vertical lifting steps work on each column independently, so, rather
+    // than applying each step to full lines, vert_lift applies all steps to
+    // one column strip at a time; for wide resolutions, the strips of the
+    // num_steps + 2 lines involved then stay in cache.  Strip width is a
+    // multiple of any SIMD width, keeping strips aligned and disjoint.
+    static const ui32 vert_strip_bytes = 8192;
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void make_line_view(line_buf* view, const line_buf* line, ui32 offset)
+    {
+      ui32 ele_size = line->flags & line_buf::LFT_SIZE_MASK;
+      view->size = line->size - offset;
+      view->pre_size = 0;
+      view->flags = line->flags;
+      view->p = (ui8*)line->p + (size_t)offset * ele_size;
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void resolution::pre_alloc(codestream* codestream, const rect& res_rect,
                                const rect& recon_res_rect,
@@ -213,7 +236,13 @@ namespace ojph {
         ui32 width = res_rect.siz.w + 1;
         if (reversible)
         {
-          if (precision <= 32) {
+          if (precision <= 16 && rev_supports_16bit_lines()) {
+            for (ui32 i = 0; i < num_steps; ++i)
+              allocator->pre_alloc_data<si16>(width, 1);
+            allocator->pre_alloc_data<si16>(width, 1);
+            allocator->pre_alloc_data<si16>(width, 1);
+          }
+          else if (precision <= 32) {
             for (ui32 i = 0; i < num_steps; ++i)
               allocator->pre_alloc_data<si32>(width, 1);
             allocator->pre_alloc_data<si32>(width, 1);
@@ -247,6 +276,7 @@ namespace ojph {
     {
       mem_fixed_allocator* allocator = codestream->get_allocator();
       elastic = codestream->get_elastic_alloc();
+      timer = codestream->get_stage_timer();
       const param_cod* cdp = codestream->get_coc(comp_num);
       ui32 t, num_decomps = cdp->get_num_decompositions();
       t = num_decomps - codestream->get_skipped_res_for_recon();
@@ -487,7 +517,17 @@ namespace ojph {
         ui32 width = res_rect.siz.w + 1;
         if (this->reversible)
         {
-          if (precision <= 32)
+          if (precision <= 16 && rev_supports_16bit_lines())
+          {
+            for (ui32 i = 0; i < num_steps; ++i)
+              ssp[i].line->wrap(
+                allocator->post_alloc_data<si16>(width, 1), width, 1);
+            sig->line->wrap(
+              allocator->post_alloc_data<si16>(width, 1), width, 1);
+            aug->line->wrap(
+              allocator->post_alloc_data<si16>(width, 1), width, 1);
+          }
+          else if (precision <= 32)
           {
             for (ui32 i = 0; i < num_steps; ++i)
               ssp[i].line->wrap(
@@ -546,6 +586,10 @@ namespace ojph {
     //////////////////////////////////////////////////////////////////////////
     void resolution::push_line()
     {
+      trace_span span("push_line", "resolution", "comp", comp_num,
+                      "res", res_num);
+      stage_scope scope(timer, stage_timer::DWT + res_num);
+
       if (res_num == 0)
       {
         assert(child_res == NULL);
@@ -569,18 +613,7 @@ namespace ojph {
           do
           {
             //vertical transform
-            for (ui32 i = 0; i < num_steps; ++i)
-            {
-              if (aug->active && (sig->active || ssp[i].active))
-              {
-                line_buf* dp = aug->line;
-                line_buf* sp1 = sig->active ? sig->line : ssp[i].line;
-                line_buf* sp2 = ssp[i].active ? ssp[i].line : sig->line;
-                const lifting_step* s = atk->get_step(num_steps - i - 1);
-                rev_vert_step(s, sp1, sp2, dp, width, false);
-              }
-              lifting_buf t = *aug; *aug = ssp[i]; ssp[i] = *sig; *sig = t;
-            }
+            vert_lift(width, false);
 
             if (aug->active) {
               rev_horz_ana(atk, bands[2].get_line(),
@@ -613,7 +646,13 @@ namespace ojph {
           else
           {
             // vertical transform
-            if (aug->line->flags & line_buf::LFT_32BIT)
+            if (aug->line->flags & line_buf::LFT_16BIT)
+            {
+              si16* sp = aug->line->i16;
+              for (ui32 i = width; i > 0; --i, ++sp)
+                *sp = (si16)(*sp << 1);
+            }
+            else if (aug->line->flags & line_buf::LFT_32BIT)
             {
               si32* sp = aug->line->i32;
               for (ui32 i = width; i > 0; --i)
@@ -646,18 +685,7 @@ namespace ojph {
           do
           {
             //vertical transform
-            for (ui32 i = 0; i < num_steps; ++i)
-            {
-              if (aug->active && (sig->active || ssp[i].active))
-              {
-                line_buf* dp = aug->line;
-                line_buf* sp1 = sig->active ? sig->line : ssp[i].line;
-                line_buf* sp2 = ssp[i].active ? ssp[i].line : sig->line;
-                const lifting_step* s = atk->get_step(num_steps - i - 1);
-                irv_vert_step(s, sp1, sp2, dp, width, false);
-              }
-              lifting_buf t = *aug; *aug = ssp[i]; ssp[i] = *sig; *sig = t;
-            }
+            vert_lift(width, false);
 
             if (aug->active) {
               const float K = atk->get_K();
@@ -709,9 +737,47 @@ namespace ojph {
       }
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void resolution::vert_lift(ui32 width, bool synthesis)
+    {
+      ui32 ele_size = aug->line->flags & line_buf::LFT_SIZE_MASK;
+      ui32 strip = vert_strip_bytes / ele_size;
+      for (ui32 x = 0; x < width; x += strip)
+      {
+        ui32 w = ojph_min(strip, width - x);
+        // aug and sig for step i, as if they were rotated after each step
+        const lifting_buf* a = aug, * g = sig;
+        for (ui32 i = 0; i < num_steps; ++i)
+        {
+          if (a->active && (g->active || ssp[i].active))
+          {
+            line_buf dp, sp1, sp2;
+            make_line_view(&dp, a->line, x);
+            make_line_view(&sp1, g->active ? g->line : ssp[i].line, x);
+            make_line_view(&sp2, ssp[i].active ? ssp[i].line : g->line, x);
+            const lifting_step* s =
+              atk->get_step(synthesis ? i : num_steps - i - 1);
+            if (reversible)
+              rev_vert_step(s, &sp1, &sp2, &dp, w, synthesis);
+            else
+              irv_vert_step(s, &sp1, &sp2, &dp, w, synthesis);
+          }
+          g = a; a = ssp + i;
+        }
+      }
+
+      for (ui32 i = 0; i < num_steps; ++i) {
+        lifting_buf t = *aug; *aug = ssp[i]; ssp[i] = *sig; *sig = t;
+      }
+    }
+
     //////////////////////////////////////////////////////////////////////////
     line_buf* resolution::pull_line()
     {
+      trace_span span("pull_line", "resolution", "comp", comp_num,
+                      "res", res_num);
+      stage_scope scope(timer, stage_timer::DWT + res_num);
+
       if (res_num == 0)
       {
         assert(child_res == NULL);
@@ -768,18 +834,7 @@ namespace ojph {
               }
 
               //vertical transform
-              for (ui32 i = 0; i < num_steps; ++i)
-              {
-                if (aug->active && (sig->active || ssp[i].active))
-                {
-                  line_buf* dp = aug->line;
-                  line_buf* sp1 = sig->active ? sig->line : ssp[i].line;
-                  line_buf* sp2 = ssp[i].active ? ssp[i].line : sig->line;
-                  const lifting_step* s = atk->get_step(i);
-                  rev_vert_step(s, sp1, sp2, dp, width, true);
-                }
-                lifting_buf t = *aug; *aug = ssp[i]; ssp[i] = *sig; *sig = t;
-              }
+              vert_lift(width, true);
 
               if (aug->active) {
                 aug->active = false;
@@ -811,7 +866,13 @@ namespace ojph {
                 memcpy(aug->line->p, bands[2].pull_line()->p,
                   (size_t)width
                   * (aug->line->flags & line_buf::LFT_SIZE_MASK));
-              if (aug->line->flags & line_buf::LFT_32BIT)
+              if (aug->line->flags & line_buf::LFT_16BIT)
+              {
+                si16* sp = aug->line->i16;
+                for (ui32 i = width; i > 0; --i, ++sp)
+                  *sp = (si16)(*sp >> 1);
+              }
+              else if (aug->line->flags & line_buf::LFT_32BIT)
               {
                 si32* sp = aug->line->i32;
                 for (ui32 i = width; i > 0; --i)
@@ -874,18 +935,7 @@ namespace ojph {
               }
 
               //vertical transform
-              for (ui32 i = 0; i < num_steps; ++i)
-              {
-                if (aug->active && (sig->active || ssp[i].active))
-                {
-                  line_buf* dp = aug->line;
-                  line_buf* sp1 = sig->active ? sig->line : ssp[i].line;
-                  line_buf* sp2 = ssp[i].active ? ssp[i].line : sig->line;
-                  const lifting_step* s = atk->get_step(i);
-                  irv_vert_step(s, sp1, sp2, dp, width, true);
-                }
-                lifting_buf t = *aug; *aug = ssp[i]; ssp[i] = *sig; *sig = t;
-              }
+              vert_lift(width, true);
 
               if (aug->active) {
                 aug->active = false;
@@ -957,6 +1007,7 @@ namespace ojph {
 
       this->num_bytes = 0;
       si32 repeat = (si32)num_precincts.area();
+      stage_scope scope(timer, stage_timer::PACKETS, (ui64)repeat);
       for (si32 i = 0; i < repeat; ++i)
         this->num_bytes += precincts[i].prepare_precinct(tag_tree_size,
           level_index, elastic);
@@ -964,11 +1015,11 @@ namespace ojph {
     }
 
     //////////////////////////////////////////////////////////////////////////
-    void resolution::write_precincts(outfile_base* file)
+    void resolution::write_precincts(gather_buf *gbp)
     {
       precinct* p = precincts;
       for (si32 i = 0; i < (si32)num_precincts.area(); ++i)
-        p[i].write(file);
+        p[i].write(gbp);
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -984,11 +1035,11 @@ namespace ojph {
     }
 
     //////////////////////////////////////////////////////////////////////////
-    void resolution::write_one_precinct(outfile_base* file)
+    void resolution::write_one_precinct(gather_buf *gbp)
     {
       ui32 idx = cur_precinct_loc.x + cur_precinct_loc.y * num_precincts.w;
       assert(idx < num_precincts.area());
-      precincts[idx].write(file);
+      precincts[idx].write(gbp);
 
       if (++cur_precinct_loc.x >= num_precincts.w)
       {
@@ -998,16 +1049,19 @@ namespace ojph {
     }
 
     //////////////////////////////////////////////////////////////////////////
-    void resolution::parse_all_precincts(ui32& data_left, infile_base* file)
+    void resolution::parse_all_precincts(bit_read_buf *bbp)
     {
       precinct* p = precincts;
       ui32 idx = cur_precinct_loc.x + cur_precinct_loc.y * num_precincts.w;
       for (ui32 i = idx; i < num_precincts.area(); ++i)
       {
-        if (data_left == 0)
+        if (bbp->bytes_left == 0)
           break;
-        p[i].parse(tag_tree_size, level_index, elastic, data_left, file,
+        stage_scope scope(timer, stage_timer::PACKETS);
+        ui32 bytes_left = bbp->bytes_left;
+        p[i].parse(tag_tree_size, level_index, elastic, bbp,
           skipped_res_for_read);
+        num_bytes += bytes_left - bbp->bytes_left;
         if (++cur_precinct_loc.x >= num_precincts.w)
         {
           cur_precinct_loc.x = 0;
@@ -1017,16 +1071,19 @@ namespace ojph {
     }
 
     //////////////////////////////////////////////////////////////////////////
-    void resolution::parse_one_precinct(ui32& data_left, infile_base* file)
+    void resolution::parse_one_precinct(bit_read_buf *bbp)
     {
       ui32 idx = cur_precinct_loc.x + cur_precinct_loc.y * num_precincts.w;
       assert(idx < num_precincts.area());
 
-      if (data_left == 0)
+      if (bbp->bytes_left == 0)
         return;
       precinct* p = precincts + idx;
-      p->parse(tag_tree_size, level_index, elastic, data_left, file,
+      stage_scope scope(timer, stage_timer::PACKETS);
+      ui32 bytes_left = bbp->bytes_left;
+      p->parse(tag_tree_size, level_index, elastic, bbp,
         skipped_res_for_read);
+      num_bytes += bytes_left - bbp->bytes_left;
       if (++cur_precinct_loc.x >= num_precincts.w)
       {
         cur_precinct_loc.x = 0;
@@ -1045,5 +1102,22 @@ namespace ojph {
       }
       return 0;
     }
+
+    //////////////////////////////////////////////////////////////////////////
+    void resolution::add_size_stats(ui32 res_num, ui32 band_num,
+                                    coded_size_stats& stats) const
+    {
+      const ui32 all = coded_size_stats::ALL;
+      if (res_num == all || res_num == this->res_num)
+      {
+        if (band_num == all)
+          stats.packet_bytes += num_bytes;
+        for (ui32 b = 0; b < 4; ++b)
+          if (band_num == all || band_num == b)
+            bands[b].add_size_stats(stats);
+      }
+      if (child_res && (res_num == all || res_num < this->res_num))
+        child_res->add_size_stats(res_num, band_num, stats);
+    }
   }
 }
\ No newline at end of file
@@ -48,6 +48,7 @@ namespace ojph {
   class line_buf;
   class mem_elastic_allocator;
   class codestream;
+  struct coded_size_stats;
 
   namespace local {
 
@@ -56,6 +57,9 @@ namespace ojph {
     class tile_comp;
     struct precinct;
     class subband;
+    struct stage_timer;
+    struct bit_read_buf;
+    struct gather_buf;
 
     //////////////////////////////////////////////////////////////////////////
     class resolution
@@ -85,15 +89,20 @@ namespace ojph {
       bool has_vert_transform() { return (transform_flags & VERT_TRX) != 0; }
 
       ui32 prepare_precinct();
-      void write_precincts(outfile_base *file);
+      void write_precincts(gather_buf *gbp);
       bool get_top_left_precinct(point &top_left);
-      void write_one_precinct(outfile_base *file);
+      void write_one_precinct(gather_buf *gbp);
       resolution *next_resolution() { return child_res; }
-      void parse_all_precincts(ui32& data_left, infile_base *file);
-      void parse_one_precinct(ui32& data_left, infile_base *file);
+      void parse_all_precincts(bit_read_buf *bbp);
+      void parse_one_precinct(bit_read_buf *bbp);
 
       ui32 get_num_bytes() const { return num_bytes; }
       ui32 get_num_bytes(ui32 resolution_num) const;
+      void add_size_stats(ui32 res_num, ui32 band_num,
+                          coded_size_stats& stats) const;
+
+    private:
+      void vert_lift(ui32 width, bool synthesis);
 
     private:
       bool reversible, skipped_res_for_read, skipped_res_for_recon;
@@ -101,7 +110,7 @@ namespace ojph {
       ui32 res_num;
       ui32 comp_num;
       ui32 num_bytes; // number of bytes in this resolution 
-                      // used for tilepart length
+                      // used for tilepart length, or parsed so far
       point comp_downsamp;
       rect res_rect;                             // resolution rectangle
       line_buf* lines;                           // used to store lines
@@ -125,6 +134,7 @@ namespace ojph {
       ui32 rows_to_produce;
       bool vert_even, horz_even;
       mem_elastic_allocator *elastic;
+      stage_timer *timer;
     };
 
   }
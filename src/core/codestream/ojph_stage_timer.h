@@ -0,0 +1,197 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2019, Aous Naman
+// Copyright (c) 2019, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2019, The University of New South Wales, Australia
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_stage_timer.h
+// Author: Aous Naman
+// Date: 19 October 2026
+//***************************************************************************/
+
+
+#ifndef OJPH_STAGE_TIMER_H
+#define OJPH_STAGE_TIMER_H
+
+#include <cassert>
+#include <chrono>
+
+#include "ojph_arch.h"
+#include "ojph_defs.h"
+
+#if defined(OJPH_ARCH_X86_64) || defined(OJPH_ARCH_I386)
+  #ifdef _MSC_VER
+    #include <intrin.h>
+  #else
+    #include <x86intrin.h>
+  #endif
+#endif
+
+namespace ojph {
+  namespace local {
+
+    //////////////////////////////////////////////////////////////////////////
+    // Accumulates the wall-clock time, time-stamp counter ticks, and units
+    // of work of each stage of the codec.
+    // Stages nest (a resolution pushes into its subbands, which encode
+    // codeblocks); time is charged exclusively to the innermost stage, so
+    // the per-stage totals add up to the total time spent inside the
+    // library.  Time spent outside any stage, while cur == NONE, is not
+    // charged at all.  The wavelet transform has a stage per resolution,
+    // and block coding a stage per resolution and subband, so that the
+    // cost of each can be told apart.
+    struct stage_timer
+    {
+      enum : ui32 {
+        MAX_RESOLUTIONS = 33,  // 32 decompositions, plus the LL subband
+        NUM_BANDS = 4,         // LL, HL, LH, and HH
+
+        COLOUR = 0,       // sample conversion and colour transform
+        CB_TX = 1,        // transfer to and from codeblock buffers
+        PACKETS = 2,      // packet header writing and packet parsing
+        CODESTREAM = 3,   // markers and codestream I/O
+        DWT = 4,          // wavelet analysis and synthesis, plus res_num
+        BLOCK_CODING =    // HTJ2K codeblock encoding and decoding,
+          DWT + MAX_RESOLUTIONS, // plus res_num * NUM_BANDS + band_num
+        NUM_STAGES = BLOCK_CODING + MAX_RESOLUTIONS * NUM_BANDS,
+        NONE = NUM_STAGES
+      };
+
+      stage_timer() { enabled = false; reset(); }
+
+      void reset()
+      {
+        cur = NONE;
+        last = last_ticks = 0;
+        for (ui32 i = 0; i < NUM_STAGES; ++i)
+          ns[i] = ticks[i] = count[i] = 0;
+        alloc_count = alloc_bytes = 0;
+      }
+
+      static ui64 now()
+      {
+        using namespace std::chrono;
+        return (ui64)duration_cast<nanoseconds>(
+          steady_clock::now().time_since_epoch()).count();
+      }
+
+      // reads the processor's time-stamp counter, or returns 0 where
+      // there is none that user code can read cheaply
+      static ui64 now_ticks()
+      {
+#if defined(OJPH_ARCH_X86_64) || defined(OJPH_ARCH_I386)
+        return (ui64)__rdtsc();
+#elif defined(OJPH_ARCH_PPC64) && defined(__GNUC__)
+        return (ui64)__builtin_ppc_get_timebase();
+#else
+        return 0;
+#endif
+      }
+
+      // switches to stage, returning the stage that should be restored
+      // by leave(); re-entering the current stage does not read the clock
+      ui32 enter(ui32 stage, ui64 units)
+      {
+        assert(stage < NUM_STAGES);
+        count[stage] += units;
+        ui32 prev = cur;
+        if (stage != prev)
+        {
+          ui64 t = now(), k = now_ticks();
+          if (prev != NONE) {
+            ns[prev] += t - last;
+            ticks[prev] += k - last_ticks;
+          }
+          last = t;
+          last_ticks = k;
+          cur = stage;
+        }
+        return prev;
+      }
+
+      void leave(ui32 prev)
+      {
+        if (prev != cur)
+        {
+          ui64 t = now(), k = now_ticks();
+          if (cur != NONE) {
+            ns[cur] += t - last;
+            ticks[cur] += k - last_ticks;
+          }
+          last = t;
+          last_ticks = k;
+          cur = prev;
+        }
+      }
+
+      bool enabled;
+      ui32 cur;                // the stage currently being charged
+      ui64 last, last_ticks;   // when cur was last charged
+      ui64 ns[NUM_STAGES];     // accumulated nanoseconds for each stage
+      ui64 ticks[NUM_STAGES];  // accumulated counter ticks for each stage
+      ui64 count[NUM_STAGES];  // accumulated units of work for each stage
+      ui64 alloc_count;        // times the fixed allocator grew its store
+      ui64 alloc_bytes;        // and the bytes it obtained doing so
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    // Charges the enclosing block to a stage, and adds units to the work
+    // done in that stage; a NULL or disabled timer costs one branch at
+    // entry and one at exit, and nothing at all when the library is built
+    // with OJPH_DISABLE_STATS.
+    class stage_scope
+    {
+    public:
+#ifndef OJPH_DISABLE_STATS
+      stage_scope(stage_timer *t, ui32 stage, ui64 units = 1)
+      {
+        timer = (t != NULL && t->enabled) ? t : NULL;
+        prev = timer ? timer->enter(stage, units)
+                     : (ui32)stage_timer::NONE;
+      }
+      ~stage_scope() { if (timer) timer->leave(prev); }
+#else
+      stage_scope(stage_timer *, ui32, ui64 = 1) {}
+#endif
+
+    private:
+      stage_scope(const stage_scope&) = delete;
+      stage_scope& operator=(const stage_scope&) = delete;
+
+#ifndef OJPH_DISABLE_STATS
+    private:
+      stage_timer *timer;
+      ui32 prev;
+#endif
+    };
+
+  }
+}
+
+#endif // !OJPH_STAGE_TIMER_H
@@ -42,11 +42,14 @@
 
 #include "ojph_mem.h"
 #include "ojph_params.h"
+#include "ojph_codestream.h"
 #include "ojph_codestream_local.h"
 #include "ojph_subband.h"
 #include "ojph_resolution.h"
 #include "ojph_codeblock.h"
 #include "ojph_precinct.h"
+#include "ojph_trace.h"
+#include "../transform/ojph_transform.h"
 
 namespace ojph {
 
@@ -104,7 +107,9 @@ namespace ojph {
       ui32 width = band_rect.siz.w + 1;
       if (reversible)
       {
-        if (precision <= 32)
+        if (precision <= 16 && rev_supports_16bit_lines())
+          allocator->pre_alloc_data<si16>(width, 1);
+        else if (precision <= 32)
           allocator->pre_alloc_data<si32>(width, 1);
         else
           allocator->pre_alloc_data<si64>(width, 1);
@@ -121,6 +126,7 @@ namespace ojph {
     {
       mem_fixed_allocator* allocator = codestream->get_allocator();
       elastic = codestream->get_elastic_alloc();
+      timer = codestream->get_stage_timer();
 
       this->res_num = res_num;
       this->band_num = subband_num;
@@ -211,7 +217,9 @@ namespace ojph {
       ui32 width = band_rect.siz.w + 1;
       if (reversible)
       {
-        if (precision <= 32)
+        if (precision <= 16 && rev_supports_16bit_lines())
+          lines->wrap(allocator->post_alloc_data<si16>(width, 1), width, 1);
+        else if (precision <= 32)
           lines->wrap(allocator->post_alloc_data<si32>(width, 1), width, 1);
         else
           lines->wrap(allocator->post_alloc_data<si64>(width, 1), width, 1);
@@ -294,13 +302,21 @@ namespace ojph {
       if (empty)
         return;
 
+      stage_scope scope(timer, stage_timer::CB_TX);
+
       //push to codeblocks
       for (ui32 i = 0; i < num_blocks.w; ++i)
         blocks[i].push(lines + 0);
       if (++cur_line >= cur_cb_height)
       {
-        for (ui32 i = 0; i < num_blocks.w; ++i)
-          blocks[i].encode(elastic);
+        {
+          trace_span span("encode_row", "codeblock", "res", res_num,
+                          "band", band_num);
+          stage_scope coding_scope(timer, stage_timer::BLOCK_CODING
+            + res_num * stage_timer::NUM_BANDS + band_num, num_blocks.w);
+          for (ui32 i = 0; i < num_blocks.w; ++i)
+            blocks[i].encode(elastic);
+        }
 
         if (++cur_cb_row < num_blocks.h)
         {
@@ -338,11 +354,17 @@ namespace ojph {
       if (empty)
         return lines;
 
+      stage_scope scope(timer, stage_timer::CB_TX);
+
       //pull from codeblocks
       if (--cur_line <= 0)
       {
         if (cur_cb_row < num_blocks.h)
         {
+          trace_span span("decode_row", "codeblock", "res", res_num,
+                          "band", band_num);
+          stage_scope coding_scope(timer, stage_timer::BLOCK_CODING
+            + res_num * stage_timer::NUM_BANDS + band_num, num_blocks.w);
           ui32 tbx0 = band_rect.org.x;
           ui32 tby0 = band_rect.org.y;
           ui32 tbx1 = band_rect.org.x + band_rect.siz.w;
@@ -379,5 +401,30 @@ namespace ojph {
       return lines;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void subband::add_size_stats(coded_size_stats& stats) const
+    {
+      if (empty)
+        return;
+
+      const coded_cb_header *cp = coded_cbs;
+      for (ui64 i = num_blocks.area(); i > 0; --i, ++cp)
+      {
+        ui32 bytes = cp->pass_length[0] + cp->pass_length[1];
+        ++stats.num_blocks;
+        if (bytes == 0)
+        {
+          ++stats.num_zero_blocks;
+          ++stats.size_histogram[0];
+          continue;
+        }
+        stats.coded_bytes += bytes;
+        stats.missing_msbs += cp->missing_msbs;
+        ui32 bin = 32 - count_leading_zeros(bytes);
+        bin = ojph_min(bin, (ui32)coded_size_stats::NUM_SIZE_BINS - 1);
+        ++stats.size_histogram[bin];
+      }
+    }
+
   }
 }
\ No newline at end of file
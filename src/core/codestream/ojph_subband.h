@@ -48,6 +48,7 @@ namespace ojph {
   class line_buf;
   class mem_elastic_allocator;
   class codestream;
+  struct coded_size_stats;
 
   namespace local {
 
@@ -57,6 +58,7 @@ namespace ojph {
     struct precinct;
     class codeblock;
     struct coded_cb_header;
+    struct stage_timer;
   
   //////////////////////////////////////////////////////////////////////////
     class subband
@@ -78,6 +80,7 @@ namespace ojph {
         K_max = 0;
         coded_cbs = NULL;
         elastic = NULL;
+        timer = NULL;
       }
 
       static void pre_alloc(codestream *codestream, const rect& band_rect,
@@ -96,6 +99,7 @@ namespace ojph {
       line_buf* pull_line();
       resolution* get_parent() { return parent; }
       const resolution* get_parent() const { return parent; }
+      void add_size_stats(coded_size_stats& stats) const;
 
     private:
       bool empty;                  // true if the subband has no pixels or
@@ -116,6 +120,7 @@ namespace ojph {
       ui32 K_max;
       coded_cb_header *coded_cbs;
       mem_elastic_allocator *elastic;
+      stage_timer *timer;
     };
 
   }
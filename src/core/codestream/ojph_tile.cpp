@@ -42,9 +42,14 @@
 
 #include "ojph_mem.h"
 #include "ojph_params.h"
+#include "ojph_codestream.h"
 #include "ojph_codestream_local.h"
 #include "ojph_tile.h"
 #include "ojph_tile_comp.h"
+#include "ojph_codeblock.h" // for coded_cb_header
+#include "ojph_bitbuffer_read.h"
+#include "ojph_gather_write.h"
+#include "ojph_trace.h"
 
 #include "../transform/ojph_colour.h"
 
@@ -194,6 +199,11 @@ namespace ojph {
     {
       //this->parent = codestream;
       mem_fixed_allocator* allocator = codestream->get_allocator();
+      timer = codestream->get_stage_timer();
+      packet_window = codestream->get_packet_window();
+      packet_window_size = codestream->get_packet_window_size();
+      gather_vecs = codestream->get_gather_vecs();
+      gather_vecs_size = codestream->get_gather_vecs_size();
 
       sot.init(0, (ui16)tile_idx, 0, 1);
       prog_order = codestream->access_cod().get_progression_order();
@@ -339,6 +349,10 @@ namespace ojph {
         return false;
       cur_line[comp_num]++;
 
+      trace_span span("push", "component", "tile", sot.get_tile_index(),
+                      "comp", comp_num);
+      stage_scope scope(timer, stage_timer::COLOUR);
+
       //converts to signed representation
       //employs color transform if there is a need
       if (!employ_color_transform || comp_num >= 3)
@@ -422,7 +436,7 @@ namespace ojph {
     }
 
     //////////////////////////////////////////////////////////////////////////
-    bool tile::pull(line_buf* tgt_line, ui32 comp_num)
+    bool tile::pull(line_buf* tgt_line, ui32 comp_num, const frame_row *row)
     {
       constexpr ui8 type3 =
         param_nlt::nonlinearity::OJPH_NLT_BINARY_COMPLEMENT_NLT;
@@ -437,33 +451,13 @@ namespace ojph {
       if (comp_width == 0)
         return true; // nothing to pull, but not an error
 
+      trace_span span("pull", "component", "tile", sot.get_tile_index(),
+                      "comp", comp_num);
+      stage_scope scope(timer, stage_timer::COLOUR);
+
+      line_buf *src_line;
       if (!employ_color_transform || num_comps == 1)
-      {
-        line_buf *src_line = comps[comp_num].pull_line();
-        if (reversible[comp_num])
-        {
-          si64 shift = (si64)1 << (num_bits[comp_num] - 1);
-          if (is_signed[comp_num] && nlt_type3[comp_num] == type3)
-            rev_convert_nlt_type3(src_line, 0, tgt_line,
-              line_offsets[comp_num], shift + 1, comp_width);
-          else {
-            shift = is_signed[comp_num] ? 0 : shift;
-            rev_convert(src_line, 0, tgt_line,
-              line_offsets[comp_num], shift, comp_width);
-          }
-        }
-        else
-        {
-          if (nlt_type3[comp_num] == type3)
-            irv_convert_to_integer_nlt_type3(src_line, tgt_line,
-              line_offsets[comp_num], num_bits[comp_num],
-              is_signed[comp_num], comp_width);
-          else
-            irv_convert_to_integer(src_line, tgt_line,
-              line_offsets[comp_num], num_bits[comp_num],
-              is_signed[comp_num], comp_width);
-        }
-      }
+        src_line = comps[comp_num].pull_line();
       else
       {
         assert(num_comps >= 3);
@@ -478,45 +472,109 @@ namespace ojph {
               comps[2].pull_line()->f32, lines[0].f32, lines[1].f32,
               lines[2].f32, comp_width);
         }
-        if (reversible[comp_num])
-        {
-          si64 shift = (si64)1 << (num_bits[comp_num] - 1);
-          line_buf* src_line;
-          if (comp_num < 3)
-            src_line = lines + comp_num;
-          else
-            src_line = comps[comp_num].pull_line();
-          if (is_signed[comp_num] && nlt_type3[comp_num] == type3)
-            rev_convert_nlt_type3(src_line, 0, tgt_line,
-              line_offsets[comp_num], shift + 1, comp_width);
-          else {
-            shift = is_signed[comp_num] ? 0 : shift;
-            rev_convert(src_line, 0, tgt_line,
-              line_offsets[comp_num], shift, comp_width);
-          }
+        if (comp_num < 3)
+          src_line = lines + comp_num;
+        else
+          src_line = comps[comp_num].pull_line();
+      }
+
+      if (row != NULL && store_in_frame(src_line, comp_num, row, comp_width))
+        return true;
+
+      if (reversible[comp_num])
+      {
+        si64 shift = (si64)1 << (num_bits[comp_num] - 1);
+        if (is_signed[comp_num] && nlt_type3[comp_num] == type3)
+          rev_convert_nlt_type3(src_line, 0, tgt_line,
+            line_offsets[comp_num], shift + 1, comp_width);
+        else {
+          shift = is_signed[comp_num] ? 0 : shift;
+          rev_convert(src_line, 0, tgt_line,
+            line_offsets[comp_num], shift, comp_width);
         }
+      }
+      else
+      {
+        if (nlt_type3[comp_num] == type3)
+          irv_convert_to_integer_nlt_type3(src_line, tgt_line,
+            line_offsets[comp_num], num_bits[comp_num],
+            is_signed[comp_num], comp_width);
         else
+          irv_convert_to_integer(src_line, tgt_line,
+            line_offsets[comp_num], num_bits[comp_num],
+            is_signed[comp_num], comp_width);
+      }
+
+      if (row != NULL)
+      { // there is no direct conversion for this line; store it from the
+        // codestream's line instead
+        const si32 *sp = tgt_line->i32 + line_offsets[comp_num];
+        ui8 *dp = row->data
+                + (size_t)line_offsets[comp_num] * row->step * row->bytes;
+        if (row->bytes == 1)
+          cnvrt_si32_to_8b(sp, 0, dp, row->step, row->low, row->high,
+            comp_width);
+        else
+          cnvrt_si32_to_16b(sp, 0, dp, row->step, row->low, row->high,
+            row->swap, comp_width);
+      }
+
+      return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool tile::store_in_frame(const line_buf *src_line, ui32 comp_num,
+                              const frame_row *row, ui32 width)
+    {
+      // Converts src_line directly into the caller's frame, fusing the
+      // level shift, clamping and packing; returns false when this line
+      // needs the general conversion instead
+      constexpr ui8 type3 =
+        param_nlt::nonlinearity::OJPH_NLT_BINARY_COMPLEMENT_NLT;
+      if (nlt_type3[comp_num] == type3)
+        return false;
+
+      ui8 *dp = row->data
+              + (size_t)line_offsets[comp_num] * row->step * row->bytes;
+      si32 shift = is_signed[comp_num] ? 0 : 1 << (num_bits[comp_num] - 1);
+      if (reversible[comp_num])
+      {
+        if (src_line->flags & line_buf::LFT_32BIT)
         {
-          line_buf* lbp;
-          if (comp_num < 3)
-            lbp = lines + comp_num;
+          if (row->bytes == 1)
+            cnvrt_si32_to_8b(src_line->i32, shift, dp, row->step,
+              row->low, row->high, width);
           else
-            lbp = comps[comp_num].pull_line();
-          if (nlt_type3[comp_num] == type3)
-            irv_convert_to_integer_nlt_type3(lbp, tgt_line,
-              line_offsets[comp_num], num_bits[comp_num],
-              is_signed[comp_num], comp_width);
+            cnvrt_si32_to_16b(src_line->i32, shift, dp, row->step,
+              row->low, row->high, row->swap, width);
+        }
+        else if (src_line->flags & line_buf::LFT_16BIT)
+        {
+          if (row->bytes == 1)
+            cnvrt_si16_to_8b(src_line->i16, shift, dp, row->step,
+              row->low, row->high, width);
           else
-            irv_convert_to_integer(lbp, tgt_line,
-              line_offsets[comp_num], num_bits[comp_num],
-              is_signed[comp_num], comp_width);
+            cnvrt_si16_to_16b(src_line->i16, shift, dp, row->step,
+              row->low, row->high, row->swap, width);
         }
+        else
+          return false;
+      }
+      else
+      {
+        if (cnvrt_f32_to_8b == NULL)
+          return false;
+        float mul = (float)(1u << num_bits[comp_num]);
+        if (row->bytes == 1)
+          cnvrt_f32_to_8b(src_line->f32, mul, shift, dp, row->step,
+            row->low, row->high, width);
+        else
+          cnvrt_f32_to_16b(src_line->f32, mul, shift, dp, row->step,
+            row->low, row->high, row->swap, width);
       }
-
       return true;
     }
 
-
     //////////////////////////////////////////////////////////////////////////
     void tile::prepare_for_flush()
     {
@@ -583,11 +641,16 @@ namespace ojph {
     //////////////////////////////////////////////////////////////////////////
     void tile::flush(outfile_base *file)
     {
+      trace_span span("flush", "tile", "tile", sot.get_tile_index());
       ui32 max_decompositions = 0;
       for (ui32 c = 0; c < num_comps; ++c)
         max_decompositions = ojph_max(max_decompositions,
           comps[c].get_num_decompositions());
 
+      //precincts are collected and written one tile-part at a time
+      gather_buf gb;
+      gb_init(&gb, file, gather_vecs, gather_vecs_size);
+
       if (tilepart_div == OJPH_TILEPART_NO_DIVISIONS)
       {
         //write tile header
@@ -608,7 +671,7 @@ namespace ojph {
         {
           for (ui32 r = 0; r <= max_decompositions; ++r)
             for (ui32 c = 0; c < num_comps; ++c)
-              comps[c].write_precincts(r, file);
+              comps[c].write_precincts(r, &gb);
         }
         else if (tilepart_div == OJPH_TILEPART_RESOLUTIONS)
         {
@@ -618,6 +681,9 @@ namespace ojph {
             for (ui32 c = 0; c < num_comps; ++c)
               bytes += comps[c].get_num_bytes(r);
 
+            //finish the previous tile-part
+            if (!gb_flush(&gb))
+              OJPH_ERROR(0x0003008C, "Error writing to file");
             //write tile header
             if (!sot.write(file, bytes, (ui8)r, (ui8)(max_decompositions + 1)))
               OJPH_ERROR(0x00030083, "Error writing to file");
@@ -629,7 +695,7 @@ namespace ojph {
 
             //write precincts
             for (ui32 c = 0; c < num_comps; ++c)
-              comps[c].write_precincts(r, file);
+              comps[c].write_precincts(r, &gb);
           }
         }
         else
@@ -638,6 +704,9 @@ namespace ojph {
           for (ui32 r = 0; r <= max_decompositions; ++r)
             for (ui32 c = 0; c < num_comps; ++c)
               if (r <= comps[c].get_num_decompositions()) {
+                //finish the previous tile-part
+                if (!gb_flush(&gb))
+                  OJPH_ERROR(0x0003008C, "Error writing to file");
                 //write tile header
                 if (!sot.write(file, comps[c].get_num_bytes(r),
                                (ui8)(c + r * num_comps), (ui8)num_tileparts))
@@ -646,7 +715,7 @@ namespace ojph {
                 ui16 t = swap_bytes_if_le((ui16)JP2K_MARKER::SOD);
                 if (!file->write(&t, 2))
                   OJPH_ERROR(0x00030086, "Error writing to file");
-                comps[c].write_precincts(r, file);
+                comps[c].write_precincts(r, &gb);
               }
         }
       }
@@ -659,6 +728,9 @@ namespace ojph {
             ui32 bytes = 0;
             for (ui32 c = 0; c < num_comps; ++c)
               bytes += comps[c].get_num_bytes(r);
+            //finish the previous tile-part
+            if (!gb_flush(&gb))
+              OJPH_ERROR(0x0003008C, "Error writing to file");
             //write tile header
             if (!sot.write(file, bytes, (ui8)r, (ui8)(max_decompositions + 1)))
               OJPH_ERROR(0x00030087, "Error writing to file");
@@ -686,7 +758,7 @@ namespace ojph {
               { smallest = cur; comp_num = c; }
             }
             if (found == true)
-              comps[comp_num].write_one_precinct(r, file);
+              comps[comp_num].write_one_precinct(r, &gb);
             else
               break;
           }
@@ -722,7 +794,7 @@ namespace ojph {
             }
           }
           if (found == true)
-            comps[comp_num].write_one_precinct(res_num, file);
+            comps[comp_num].write_one_precinct(res_num, &gb);
           else
             break;
         }
@@ -734,6 +806,9 @@ namespace ojph {
           if (tilepart_div == OJPH_TILEPART_COMPONENTS)
           {
             ui32 bytes = comps[c].get_num_bytes();
+            //finish the previous tile-part
+            if (!gb_flush(&gb))
+              OJPH_ERROR(0x0003008C, "Error writing to file");
             //write tile header
             if (!sot.write(file, bytes, (ui8)c, (ui8)num_comps))
               OJPH_ERROR(0x0003008A, "Error writing to file");
@@ -762,7 +837,7 @@ namespace ojph {
               { smallest = cur; res_num = r; }
             }
             if (found == true)
-              comps[c].write_one_precinct(res_num, file);
+              comps[c].write_one_precinct(res_num, &gb);
             else
               break;
           }
@@ -771,12 +846,16 @@ namespace ojph {
       else
         assert(0);
 
+      if (!gb_flush(&gb))
+        OJPH_ERROR(0x0003008C, "Error writing to file");
     }
 
     //////////////////////////////////////////////////////////////////////////
     void tile::parse_tile_header(const param_sot &sot, infile_base *file,
                                  const ui64& tile_start_location)
     {
+      trace_span span("parse", "tile", "tile", sot.get_tile_index(),
+                      "part", sot.get_tile_part_index());
       if (sot.get_tile_part_index() != next_tile_part)
       {
         if (resilient)
@@ -795,6 +874,9 @@ namespace ojph {
       if (data_left == 0)
         return;
 
+      bit_read_buf bb;
+      bb_init(&bb, data_left, file, packet_window, packet_window_size);
+
       ui32 max_decompositions = 0;
       for (ui32 c = 0; c < num_comps; ++c)
         max_decompositions = ojph_max(max_decompositions,
@@ -808,8 +890,8 @@ namespace ojph {
           max_decompositions -= skipped_res_for_read;
           for (ui32 r = 0; r <= max_decompositions; ++r)
             for (ui32 c = 0; c < num_comps; ++c)
-              if (data_left > 0)
-                comps[c].parse_precincts(r, data_left, file);
+              if (bb.bytes_left > 0)
+                comps[c].parse_precincts(r, &bb);
         }
         else if (prog_order == OJPH_PO_RPCL)
         {
@@ -833,8 +915,8 @@ namespace ojph {
                 else if (cur.y == smallest.y && cur.x < smallest.x)
                 { smallest = cur; comp_num = c; }
               }
-              if (found == true && data_left > 0)
-                comps[comp_num].parse_one_precinct(r, data_left, file);
+              if (found == true && bb.bytes_left > 0)
+                comps[comp_num].parse_one_precinct(r, &bb);
               else
                 break;
             }
@@ -869,8 +951,8 @@ namespace ojph {
                 { smallest = cur; comp_num = c; res_num = r; }
               }
             }
-            if (found == true && data_left > 0)
-              comps[comp_num].parse_one_precinct(res_num, data_left, file);
+            if (found == true && bb.bytes_left > 0)
+              comps[comp_num].parse_one_precinct(res_num, &bb);
             else
               break;
           }
@@ -896,8 +978,8 @@ namespace ojph {
                 else if (cur.y == smallest.y && cur.x < smallest.x)
                 { smallest = cur; res_num = r; }
               }
-              if (found == true && data_left > 0)
-                comps[c].parse_one_precinct(res_num, data_left, file);
+              if (found == true && bb.bytes_left > 0)
+                comps[c].parse_one_precinct(res_num, &bb);
               else
                 break;
             }
@@ -937,5 +1019,14 @@ namespace ojph {
       file->seek((si64)tile_end_location, infile_base::OJPH_SEEK_SET);
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void tile::add_size_stats(ui32 comp_num, ui32 res_num, ui32 band_num,
+                              coded_size_stats& stats) const
+    {
+      for (ui32 c = 0; c < num_comps; ++c)
+        if (comp_num == coded_size_stats::ALL || comp_num == c)
+          comps[c].add_size_stats(res_num, band_num, stats);
+    }
+
   }
 }
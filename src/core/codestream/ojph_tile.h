@@ -49,12 +49,27 @@ namespace ojph {
   //defined elsewhere
   class line_buf;
   class codestream;
+  struct coded_size_stats;
 
   namespace local {
 
     //////////////////////////////////////////////////////////////////////////
     //defined here
     class tile_comp;
+    struct stage_timer;
+    struct bit_read_buf;
+
+    //////////////////////////////////////////////////////////////////////////
+    // A row of one component in a caller's frame; tile::pull() stores
+    // decoded samples there, instead of in the codestream's line
+    struct frame_row
+    {
+      ui8 *data;       // the first sample of the row
+      ui32 step;       // samples from one sample to the next
+      ui32 bytes;      // bytes per sample, 1 or 2
+      bool swap;       // 16-bit samples are byte-swapped
+      si32 low, high;  // samples are clamped to this range
+    };
 
     //////////////////////////////////////////////////////////////////////////
     class tile
@@ -71,10 +86,15 @@ namespace ojph {
       void flush(outfile_base *file);
       void parse_tile_header(const param_sot& sot, infile_base *file,
                              const ui64& tile_start_location);
-      bool pull(line_buf *, ui32 comp_num);
+      bool pull(line_buf *, ui32 comp_num, const frame_row *row = NULL);
       rect get_tile_rect() { return tile_rect; }
+      void add_size_stats(ui32 comp_num, ui32 res_num, ui32 band_num,
+                          coded_size_stats& stats) const;
 
     private:
+      bool store_in_frame(const line_buf *src_line, ui32 comp_num,
+                          const frame_row *row, ui32 width);
+
       //codestream *parent;
       rect tile_rect;
       ui32 num_comps;
@@ -104,6 +124,13 @@ namespace ojph {
 
       ui32 num_bytes; // number of bytes in this tile
                       // used for tile length
+
+    private:
+      stage_timer *timer;
+      ui8 *packet_window;     // storage for bit_read_buf windows
+      ui32 packet_window_size;
+      out_vec *gather_vecs;   // storage for gather_buf regions
+      ui32 gather_vecs_size;
     };
     
   }
@@ -41,6 +41,7 @@
 
 #include "ojph_mem.h"
 #include "ojph_params.h"
+#include "ojph_codestream.h"
 #include "ojph_codestream_local.h"
 #include "ojph_tile_comp.h"
 #include "ojph_resolution.h"
@@ -114,7 +115,7 @@ namespace ojph {
     }
 
     //////////////////////////////////////////////////////////////////////////
-    void tile_comp::write_precincts(ui32 res_num, outfile_base *file)
+    void tile_comp::write_precincts(ui32 res_num, gather_buf *gbp)
     {
       assert(res_num <= num_decomps);
       res_num = num_decomps - res_num; //how many levels to go down
@@ -125,7 +126,7 @@ namespace ojph {
         --res_num;
       }
       if (r) //resolution does not exist if r is NULL
-        r->write_precincts(file);
+        r->write_precincts(gbp);
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -145,7 +146,7 @@ namespace ojph {
     }
 
     //////////////////////////////////////////////////////////////////////////
-    void tile_comp::write_one_precinct(ui32 res_num, outfile_base *file)
+    void tile_comp::write_one_precinct(ui32 res_num, gather_buf *gbp)
     {
       int resolution_num = (int)num_decomps - (int)res_num;
       resolution *r = res;
@@ -155,12 +156,11 @@ namespace ojph {
         --resolution_num;
       }
       if (r) //resolution does not exist if r is NULL
-        r->write_one_precinct(file);
+        r->write_one_precinct(gbp);
     }
 
     //////////////////////////////////////////////////////////////////////////
-    void tile_comp::parse_precincts(ui32 res_num, ui32& data_left,
-                                    infile_base *file)
+    void tile_comp::parse_precincts(ui32 res_num, bit_read_buf *bbp)
     {
       assert(res_num <= num_decomps);
       res_num = num_decomps - res_num; //how many levels to go down
@@ -171,13 +171,12 @@ namespace ojph {
         --res_num;
       }
       if (r) //resolution does not exist if r is NULL
-        r->parse_all_precincts(data_left, file);
+        r->parse_all_precincts(bbp);
     }
 
 
     //////////////////////////////////////////////////////////////////////////
-    void tile_comp::parse_one_precinct(ui32 res_num, ui32& data_left,
-                                       infile_base *file)
+    void tile_comp::parse_one_precinct(ui32 res_num, bit_read_buf *bbp)
     {
       assert(res_num <= num_decomps);
       res_num = num_decomps - res_num;
@@ -188,7 +187,7 @@ namespace ojph {
         --res_num;
       }
       if (r) //resolution does not exist if r is NULL
-        r->parse_one_precinct(data_left, file);
+        r->parse_one_precinct(bbp);
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -196,5 +195,12 @@ namespace ojph {
     {
       return res->get_num_bytes(resolution_num);
     }
+
+    //////////////////////////////////////////////////////////////////////////
+    void tile_comp::add_size_stats(ui32 res_num, ui32 band_num,
+                                   coded_size_stats& stats) const
+    {
+      res->add_size_stats(res_num, band_num, stats);
+    }
   }
 }
@@ -50,6 +50,7 @@ namespace ojph {
   //defined elsewhere
   class line_buf;
   class codestream;
+  struct coded_size_stats;
 
   namespace local {
 
@@ -57,6 +58,8 @@ namespace ojph {
     //defined here
     class tile;
     class resolution;
+    struct bit_read_buf;
+    struct gather_buf;
 
     //////////////////////////////////////////////////////////////////////////
     class tile_comp
@@ -77,15 +80,16 @@ namespace ojph {
       line_buf* pull_line();
 
       ui32 prepare_precincts();
-      void write_precincts(ui32 res_num, outfile_base *file);
+      void write_precincts(ui32 res_num, gather_buf *gbp);
       bool get_top_left_precinct(ui32 res_num, point &top_left);
-      void write_one_precinct(ui32 res_num, outfile_base *file);
-      void parse_precincts(ui32 res_num, ui32& data_left, infile_base *file);
-      void parse_one_precinct(ui32 res_num, ui32& data_left, 
-                              infile_base *file);
+      void write_one_precinct(ui32 res_num, gather_buf *gbp);
+      void parse_precincts(ui32 res_num, bit_read_buf *bbp);
+      void parse_one_precinct(ui32 res_num, bit_read_buf *bbp);
 
       ui32 get_num_bytes() const { return num_bytes; }
       ui32 get_num_bytes(ui32 resolution_num) const;
+      void add_size_stats(ui32 res_num, ui32 band_num,
+                          coded_size_stats& stats) const;
 
     private:
       tile *parent_tile;
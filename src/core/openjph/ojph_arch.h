@@ -150,6 +150,16 @@ namespace ojph {
   OJPH_EXPORT
   int get_cpu_ext_level();
 
+  /////////////////////////////////////////////////////////////////////////////
+  // Caps the level returned by get_cpu_ext_level() to at most level; a
+  //   negative value removes the cap.  Without a call to this function, the
+  //   cap is read from the OJPH_MAX_CPU_EXT_LEVEL environment variable, which
+  //   accepts a number or a name, such as generic, sse2, avx2, or avx512.
+  //   The kernels are selected when a codestream is created, so this should
+  //   be called before creating codestreams, and not while any is in use.
+  OJPH_EXPORT
+  void set_max_cpu_ext_level(int level);
+
   enum : int {
     X86_CPU_EXT_LEVEL_GENERIC = 0,
     X86_CPU_EXT_LEVEL_MMX = 1,
@@ -0,0 +1,226 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2026, Aous Naman
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_boxes.h
+// Author: Aous Naman
+// Date: 19 October 2026
+//***************************************************************************/
+
+
+#ifndef OJPH_BOXES_H
+#define OJPH_BOXES_H
+
+#include "ojph_arch.h"
+#include "ojph_defs.h"
+
+namespace ojph {
+
+  ////////////////////////////////////////////////////////////////////////////
+  //defined elsewhere
+  class param_siz;
+  class outfile_base;
+  class infile_base;
+
+  ////////////////////////////////////////////////////////////////////////////
+  /**
+   *  @brief The header of a box of the JP2 family of file formats, which
+   *         includes .jp2 and .jph files.
+   *
+   *  A box starts with its length, LBox, and its type, TBox; an LBox of 1
+   *  is followed by an 8-byte length, XLBox, for boxes of 4 GB or more,
+   *  and an LBox of 0 means that the box extends to the end of the file.
+   */
+  struct jp2_box
+  {
+    enum : ui32 {
+      SIGNATURE = 0x6A502020, //!<'jP  ', the signature box
+      FTYP = 0x66747970,      //!<'ftyp', the file type box
+      JP2H = 0x6A703268,      //!<'jp2h', the header superbox
+      IHDR = 0x69686472,      //!<'ihdr', the image header box
+      BPCC = 0x62706363,      //!<'bpcc', the bits per component box
+      COLR = 0x636F6C72,      //!<'colr', the colour specification box
+      RES  = 0x72657320,      //!<'res ', the resolution superbox
+      RESC = 0x72657363,      //!<'resc', the capture resolution box
+      RESD = 0x72657364,      //!<'resd', the display resolution box
+      JP2C = 0x6A703263,      //!<'jp2c', the codestream box
+    };
+
+    ui32 type;          //!<TBox
+    ui32 header_size;   //!<8, or 16 when XLBox is present
+    si64 offset;        //!<file position of the contents of the box
+    ui64 length;        //!<bytes of contents; 0 when to_end is true
+    bool to_end;        //!<the box extends to the end of the file
+  };
+
+  ////////////////////////////////////////////////////////////////////////////
+  /**
+   *  @brief Writes the boxes of a .jph file, or a .jp2 file, that precede
+   *         the codestream, which is then written into the file directly.
+   *
+   *  write_headers() writes the signature, file type, and header boxes,
+   *  and the header of the jp2c box, taking the image size, components,
+   *  and bit depths from the SIZ marker segment; codestream::write_headers()
+   *  and codestream::flush() follow, on the same file, and finalize()
+   *  completes the jp2c box, before codestream::close().
+   *
+   *  The length of the jp2c box is needed before the codestream.  If it is
+   *  known, set it with set_codestream_length(), and the file is written
+   *  front to back, which suits files that cannot seek, such as streams.
+   *  Otherwise, the jp2c box is written to extend to the end of the file,
+   *  and finalize() replaces that with the actual length if the file can
+   *  seek; either way, the file is valid.
+   */
+  class OJPH_EXPORT jph_writer
+  {
+  public:
+    enum : ui32 {
+      JPH_BRAND = 0x6A706820,       //!<'jph ', ISO/IEC 15444-15 (HTJ2K)
+      JP2_BRAND = 0x6A703220,       //!<'jp2 ', ISO/IEC 15444-1
+    };
+    enum : ui32 {
+      DEFAULT_COLOUR_SPACE = 0,     //!<grey for 1 or 2 components, else sRGB
+      SRGB = 16,                    //!<sRGB
+      GREYSCALE = 17,               //!<greyscale
+      SYCC = 18,                    //!<sYCC
+    };
+
+  public:
+    jph_writer()
+    : brand(JPH_BRAND), colour_space(DEFAULT_COLOUR_SPACE),
+      codestream_length(0), jp2c_position(-1), jp2c_header_size(0)
+    {
+      for (int i = 0; i < 2; ++i)
+        capture_res[i] = display_res[i] = 0.0;
+    }
+
+    /** JPH_BRAND, the default, or JP2_BRAND */
+    void set_brand(ui32 brand) { this->brand = brand; }
+    /** an enumerated colour space, written into the colr box */
+    void set_colour_space(ui32 enumcs) { colour_space = enumcs; }
+    /** the grid points per metre, horizontally and vertically, at which
+     *  the image was captured; no resc box is written unless set */
+    void set_capture_resolution(double x, double y)
+    { capture_res[0] = x; capture_res[1] = y; }
+    /** the grid points per metre at which the image should be displayed;
+     *  no resd box is written unless set */
+    void set_display_resolution(double x, double y)
+    { display_res[0] = x; display_res[1] = y; }
+    /** the exact length of the codestream, if known in advance */
+    void set_codestream_length(ui64 length) { codestream_length = length; }
+
+    /**
+     *  @brief Writes the boxes up to, and including, the header of the jp2c
+     *         box; the codestream must be written next.
+     *
+     *  @param file the file to write into.
+     *  @param siz the SIZ marker segment of the codestream.
+     */
+    void write_headers(outfile_base *file, const param_siz& siz);
+
+    /**
+     *  @brief Completes the jp2c box, once the codestream is written.
+     *
+     *  If the codestream length was set, this checks it against the bytes
+     *  written; otherwise, it writes the length into the jp2c box, if the
+     *  file can seek and the length fits in LBox.
+     *
+     *  @param file the file passed to write_headers().
+     */
+    void finalize(outfile_base *file);
+
+  private:
+    ui32 brand;
+    ui32 colour_space;
+    double capture_res[2], display_res[2];
+    ui64 codestream_length;
+    si64 jp2c_position;          // of the jp2c box, in the file
+    ui32 jp2c_header_size;
+  };
+
+  ////////////////////////////////////////////////////////////////////////////
+  /**
+   *  @brief Reads the boxes of a .jph or .jp2 file that precede the
+   *         codestream, leaving the file at the start of the codestream.
+   *
+   *  Boxes are skipped by their lengths, including XLBox, so the file is
+   *  never scanned for markers.  The image header and the first colour
+   *  specification are kept.  codestream::read_headers() does this itself
+   *  when its file starts with a signature box; this object is for
+   *  applications that want the boxes, or the position of the codestream.
+   */
+  class OJPH_EXPORT jph_reader
+  {
+  public:
+    jph_reader() { clear(); }
+
+    /** true if file, from its current position, starts with a signature
+     *  box; the position of file is not changed */
+    static bool starts_with_signature(infile_base *file);
+
+    /** reads the header of the box at the current position of file, and
+     *  leaves file at its contents; returns false at the end of file */
+    static bool read_box_header(infile_base *file, jp2_box& box);
+
+    /**
+     *  @brief Reads the boxes from the current position of file up to the
+     *         jp2c box, and leaves file at the start of its contents.
+     *
+     *  @param file a file positioned at the signature box.
+     */
+    void read(infile_base *file);
+
+    ui32 get_brand() const { return brand; }
+    ui32 get_width() const { return width; }
+    ui32 get_height() const { return height; }
+    ui32 get_num_components() const { return num_components; }
+    /** the bit depth of all components, or 0 if they differ */
+    ui32 get_bit_depth() const { return bit_depth; }
+    /** true if all components are signed; see get_bit_depth() */
+    bool is_signed() const { return is_signed_samples; }
+    /** the enumerated colour space, or 0 if the colr box has none */
+    ui32 get_colour_space() const { return colour_space; }
+    /** the jp2c box; its offset is that of the codestream */
+    const jp2_box& get_codestream_box() const { return codestream_box; }
+
+  private:
+    void clear();
+    void read_header_box(infile_base *file, const jp2_box& jp2h);
+
+  private:
+    ui32 brand;
+    ui32 width, height, num_components, bit_depth;
+    bool is_signed_samples;
+    ui32 colour_space;
+    jp2_box codestream_box;
+  };
+
+}
+
+#endif // !OJPH_BOXES_H
@@ -64,6 +64,184 @@ namespace ojph {
   class line_buf;
   class outfile_base;
   class infile_base;
+  struct mem_store_hooks;
+
+  ////////////////////////////////////////////////////////////////////////////
+  /**
+   *  @brief Time and work of one stage of the codec.
+   *
+   *  See codestream_stats for the unit of work counted by each stage.
+   */
+  struct codestream_stage_stats
+  {
+    double seconds;  //!<wall-clock time charged to the stage
+    ui64 ticks;      //!<time-stamp counter ticks charged to the stage, on
+                     //!<x86 and POWER; always 0 on other architectures
+    ui64 count;      //!<units of work done in the stage
+  };
+
+  ////////////////////////////////////////////////////////////////////////////
+  /**
+   *  @brief Time spent in each stage of the codec, and the work done.
+   *
+   *  Times are wall-clock and exclusive; for example, the time a
+   *  resolution spends waiting for its subbands to encode codeblocks is
+   *  counted under block_coding, not under dwt.  Time spent in the
+   *  calling application, between calls into the library, is not counted.
+   *
+   *  The first five members are totals, in seconds, kept for convenience;
+   *  the members that follow them break these totals down.
+   */
+  struct codestream_stats
+  {
+    enum : ui32 {
+      MAX_RESOLUTIONS = 33,  //!<32 decomposition levels, plus the LL band
+      NUM_BANDS = 4          //!<LL, HL, LH, and HH, in this order
+    };
+
+    double colour;       //!<sample conversion and colour transform
+    double dwt;          //!<wavelet analysis and synthesis
+    double cb_transfer;  //!<tx_to_cb and tx_from_cb, (de)quantization
+    double block_coding; //!<HTJ2K codeblock encoding and decoding
+    double codestream;   //!<headers, packets, and codestream reading or
+                         //!<writing, including memory allocation
+
+    //! colour stage; count is component lines
+    codestream_stage_stats colour_stage;
+    //! wavelet stage of each resolution, 0 being the lowest; resolution
+    //! r is analysed into, or synthesized from, resolution r - 1 and the
+    //! subbands of r; count is lines
+    codestream_stage_stats dwt_stage[MAX_RESOLUTIONS];
+    //! codeblock transfer stage; count is subband lines
+    codestream_stage_stats cb_transfer_stage;
+    //! block coding stage of each subband, indexed by resolution and band
+    //! number; count is codeblocks
+    codestream_stage_stats block_stage[MAX_RESOLUTIONS][NUM_BANDS];
+    //! packet header writing, and packet parsing, which includes reading
+    //! codeblock data; count is packets
+    codestream_stage_stats packet_stage;
+    //! the rest of the codestream stage; count is calls
+    codestream_stage_stats codestream_stage;
+
+    ui64 alloc_count;    //!<times the codestream allocated memory for its
+                         //!<structures or coded data, rather than reusing
+                         //!<memory it already held
+    ui64 alloc_bytes;    //!<the bytes allocated those times
+  };
+
+  ////////////////////////////////////////////////////////////////////////////
+  /**
+   *  @brief Coded sizes of a selection of codeblocks, in bytes.
+   *
+   *  See codestream::get_coded_size_stats().  A zero block is a codeblock
+   *  without coded data; all its samples quantize to zero, or, in a
+   *  decoder, it belongs to a resolution that was skipped.
+   */
+  struct coded_size_stats
+  {
+    enum : ui32 {
+      ALL = 0xFFFFFFFF,    //!<selects all components, resolutions or bands
+      NUM_SIZE_BINS = 18   //!<enough for the largest HTJ2K codeblock
+    };
+
+    ui64 num_blocks;       //!<codeblocks selected
+    ui64 num_zero_blocks;  //!<selected codeblocks without coded data
+    ui64 coded_bytes;      //!<coded data of the selected codeblocks
+    ui64 missing_msbs;     //!<missing MSBs, summed over the codeblocks that
+                           //!<have coded data
+    ui64 packet_bytes;     //!<packets of the selected resolutions, headers
+                           //!<included; 0 unless all bands are selected
+    //! size_histogram[0] counts zero blocks, and size_histogram[k]
+    //! codeblocks of 2^(k-1) to 2^k - 1 bytes
+    ui64 size_histogram[NUM_SIZE_BINS];
+
+    /** the fraction of the selected codeblocks that are zero blocks */
+    double get_zero_block_ratio() const
+    {
+      return num_blocks ? (double)num_zero_blocks / (double)num_blocks
+                        : 0.0;
+    }
+
+    /** the average missing MSBs of codeblocks that have coded data */
+    double get_average_missing_msbs() const
+    {
+      ui64 n = num_blocks - num_zero_blocks;
+      return n ? (double)missing_msbs / (double)n : 0.0;
+    }
+  };
+
+  ////////////////////////////////////////////////////////////////////////////
+  /**
+   *  @brief Memory needed by a codestream, in bytes.
+   *
+   *  See codestream::estimate_memory().
+   */
+  struct memory_estimate
+  {
+    ui64 fixed_bytes;  //!<tiles, codeblock and line buffers; this is exact,
+                       //!<and is allocated in one go by create() or
+                       //!<write_headers()
+    ui64 coded_bytes;  //!<coded codeblock data, which is stored as it is
+                       //!<read or encoded; this is an upper estimate
+  };
+
+  ////////////////////////////////////////////////////////////////////////////
+  /**
+   *  @brief The sample type of a frame_buffer.
+   *
+   *  Samples of unsigned components are unsigned integers, and samples of
+   *  signed components are two's complement integers; 16-bit samples are
+   *  in the byte order given by OJPH_FRAME_BYTE_ORDER.
+   */
+  enum OJPH_FRAME_SAMPLE : ui32 {
+    OJPH_FRAME_8BIT = 1,   //!<one byte per sample
+    OJPH_FRAME_16BIT = 2,  //!<two bytes per sample
+  };
+
+  ////////////////////////////////////////////////////////////////////////////
+  /**
+   *  @brief The byte order of the 16-bit samples of a frame_buffer.
+   */
+  enum OJPH_FRAME_BYTE_ORDER : ui32 {
+    OJPH_FRAME_NATIVE_ENDIAN = 0,  //!<the byte order of the machine
+    OJPH_FRAME_LITTLE_ENDIAN = 1,  //!<least significant byte first
+    OJPH_FRAME_BIG_ENDIAN = 2,     //!<most significant byte first, as in
+                                   //!<PGM and PPM files
+  };
+
+  ////////////////////////////////////////////////////////////////////////////
+  /**
+   *  @brief Where the samples of one component are in a frame_buffer.
+   *
+   *  For planar images, step is 1.  For images with interleaved
+   *  components, such as RGB, data points to the first sample of the
+   *  component, and step is the number of interleaved components.
+   */
+  struct frame_component
+  {
+    void *data;   //!<the first sample of the first row of the component
+    si64 stride;  //!<bytes from the start of one row to the next; can be
+                  //!<negative for images stored bottom-up
+    ui32 step;    //!<samples from one sample to the next within a row
+  };
+
+  ////////////////////////////////////////////////////////////////////////////
+  /**
+   *  @brief Describes a caller-owned image buffer holding a whole frame;
+   *         see codestream::push_frame() and codestream::pull_frame().
+   *
+   *  Component c has siz.get_recon_width(c) samples in each of
+   *  siz.get_recon_height(c) rows, where siz is codestream::access_siz();
+   *  these equal the component's full dimensions, unless resolutions are
+   *  skipped for reconstruction while decoding.
+   */
+  struct frame_buffer
+  {
+    ui32 sample;                  //!<a value from OJPH_FRAME_SAMPLE
+    ui32 num_components;          //!<must equal the codestream's
+    const frame_component *comps; //!<one for each component
+    ui32 byte_order;              //!<a value from OJPH_FRAME_BYTE_ORDER
+  };
 
   ////////////////////////////////////////////////////////////////////////////
   /**
@@ -121,6 +299,39 @@ namespace ojph {
      */
     void restart();
 
+    /**
+     * @brief Keeps the main header from one codestream to the next.
+     *
+     * Without the cache, restart() returns all parameters to their
+     * defaults, and write_headers() validates and serializes them every
+     * time, while read_headers() parses every marker segment.  With the
+     * cache, restart() keeps the parameters of the last main header, and
+     * returns them to their defaults, as it would without the cache, only
+     * when one is set before the next header, through a setter of the
+     * objects returned by access_siz(), access_cod(), access_qcd(), or
+     * access_nlt(), or through set_planar(), set_profile(),
+     * set_tilepart_divisions(), or request_tlm_marker(); reading them
+     * changes nothing.  When none is set after restart(), write_headers()
+     * writes the bytes of the last main header, without validation or
+     * serialization; otherwise, it builds the header afresh and keeps the
+     * cached one when the two are identical.  read_headers() compares the
+     * incoming main header against the last one and, when they match,
+     * skips parsing it; PRF, CPF, TLM, PLM, and COM marker segments are
+     * not compared, since they do not change how a codestream is decoded.
+     *
+     * @param enable true to keep the main header across restart().
+     */
+    void enable_header_cache(bool enable);
+
+    /**
+     * @brief Returns true when the last write_headers() or read_headers()
+     *        reused the cached main header of the previous codestream.
+     *
+     * The parameters are then those of the previous codestream, and so is
+     * everything derived from them, such as image and tile dimensions.
+     */
+    bool is_header_repeated() const;
+
     /**
      *  @brief Sets the sequence of pushing or pull rows from the machinery.
      *
@@ -132,6 +343,12 @@ namespace ojph {
      *  three  components.  Therefore, planar, while recommended, can only be
      *  used when there is no color transform.
      *
+     *  When this function is not called, an encoding codestream uses the
+     *  interleaved order.  A decoding codestream uses the planar order,
+     *  unless a colour transform is employed; is_planar() returns the
+     *  order in effect, which push_frame(), pull_frame(), and the stripe
+     *  functions follow.
+     *
      *  @param planar true for when components are pushed in full one at
      *         a time.
      */
@@ -254,6 +471,47 @@ namespace ojph {
 
     line_buf* exchange(line_buf* line, ui32& next_component);
 
+    /**
+     *  @brief Sends a whole frame to the library, instead of calling
+     *         exchange() for each row.
+     *
+     *  Samples are converted from the caller's buffer directly into the
+     *  library's lines, using SIMD where available; the caller need not
+     *  copy samples into line_buf objects.  The bit depth of each
+     *  component must fit in the frame's sample type.  Call this function
+     *  once, after write_headers() and before flush(); if rows were sent
+     *  with exchange() before, the frame's remaining rows are sent.
+     *
+     *  @param frame the frame to encode; it is not needed after this
+     *               function returns.
+     */
+    void push_frame(const frame_buffer& frame);
+
+    /**
+     *  @brief Sends the next rows of the image, as a stripe, instead of
+     *         calling exchange() for each row.
+     *
+     *  This is a convenience wrapper around exchange(): the rows are
+     *  converted straight into the library's lines, and then go through
+     *  the library one at a time, as they would with exchange(), so the
+     *  height of the stripe does not change how they are processed.
+     *  Row 0 of each component in the stripe is the next row that the
+     *  codestream expects for that component.  In the interleaved order
+     *  (see set_planar()), the stripe holds num_rows rows of every
+     *  component.  In the planar order, the stripe holds rows of the
+     *  current component only, and the other components of the stripe
+     *  are not used; components are sent in order, one after the other,
+     *  and a stripe does not cross from one component to the next.
+     *
+     *  @param stripe   the rows to encode, described like a frame; they
+     *                  are not needed after this function returns.
+     *  @param num_rows the number of rows in the stripe.
+     *  @return the number of rows sent, which is smaller than num_rows
+     *          near the end of the image or, in the planar order, of a
+     *          component, and is 0 when all rows have been sent.
+     */
+    ui32 push_stripe(const frame_buffer& stripe, ui32 num_rows);
+
     /**
      * @brief This is the last call to a writing (encoding) codestream.
      *        This will write encoded bitstream data to the file.  This
@@ -325,6 +583,42 @@ namespace ojph {
      */
     line_buf* pull(ui32 &comp_num);
 
+    /**
+     *  @brief Decodes a whole frame into a caller-owned buffer, instead
+     *         of calling pull() for each row.
+     *
+     *  Decoded samples are clamped to the range of their component's bit
+     *  depth, and stored in the frame's sample type, using SIMD where
+     *  available.  Each tile stores its samples in the frame as part of
+     *  the conversion it makes anyway, without going through the 32-bit
+     *  lines that pull() returns.  The bit depth of each component must
+     *  fit in the frame's sample type.  Call this function once, after
+     *  create(); if rows were pulled with pull() before, the frame's
+     *  remaining rows are decoded.
+     *
+     *  @param frame the buffer that receives the decoded frame.
+     */
+    void pull_frame(const frame_buffer& frame);
+
+    /**
+     *  @brief Decodes the next rows of the image into a stripe, instead of
+     *         calling pull() for each row.
+     *
+     *  This mirrors push_stripe(), and is likewise a convenience: rows
+     *  are decoded one at a time, as with pull(), and each is stored in
+     *  the stripe as it is produced.  Row 0 of each component in the
+     *  stripe receives the next row that would be pulled for that
+     *  component, and in the planar order only the current component is
+     *  decoded.
+     *  Samples are clamped and stored as in pull_frame().
+     *
+     *  @param stripe   the buffer that receives the decoded rows.
+     *  @param num_rows the number of rows the stripe can hold.
+     *  @return the number of rows decoded, which is 0 when all rows have
+     *          been decoded.
+     */
+    ui32 pull_stripe(const frame_buffer& stripe, ui32 num_rows);
+
     /**
      * @brief Call this function to close the underlying file; works for both
      *        encoding and decoding codestreams.
@@ -335,12 +629,26 @@ namespace ojph {
     /**
      * @brief Returns the underlying SIZ marker segment object
      *
+     * With the header cache enabled, setting a parameter through this
+     * object after restart() returns the other parameters, including COD,
+     * QCD, and NLT, to their defaults; see enable_header_cache().
+     *
      * @return param_siz This object holds SIZ marker segment information,
      *                   which deals with codestream dimensions, number
      *                   of components, bit depth, ... etc.
      */
     param_siz access_siz();
 
+    /**
+     * @brief Returns the SIZ marker segment object for reading only
+     *
+     * Use it to read the parameters of the last main header, or of the
+     * one being set up, from a const codestream.
+     *
+     * @return param_siz whose setters must not be called.
+     */
+    const param_siz get_siz() const;
+
     /**
      * @brief Returns the underlying COD marker segment object
      *
@@ -351,6 +659,15 @@ namespace ojph {
      */
     param_cod access_cod();
 
+    /**
+     * @brief Returns the COD marker segment object for reading only
+     *
+     * As get_siz(), for a const codestream.
+     *
+     * @return param_cod whose setters must not be called.
+     */
+    const param_cod get_cod() const;
+
     /**
      * @brief Returns the underlying QCD marker segment object
      *
@@ -378,6 +695,129 @@ namespace ojph {
      */
     bool is_planar() const;
 
+    /**
+     * @brief Enables or disables accumulation of per-stage timing.
+     *
+     * Timing is disabled by default, and costs a branch per line per
+     * stage when disabled; building the library with OJPH_DISABLE_STATS
+     * removes even that, and this function then has no effect.  When
+     * enabled, every transition between stages reads a clock and the
+     * time-stamp counter, which adds a small overhead.  The accumulated
+     * times survive codestream::restart(), so that they can be summed
+     * over many codestreams; use codestream::reset_stats() to clear them.
+     * Allocations are counted whether or not timing is enabled.
+     *
+     * @param enable true to start accumulating, false to stop.
+     */
+    void enable_stats(bool enable);
+
+    /**
+     * @brief Returns the times accumulated since the last call to
+     *        codestream::reset_stats(), or since construction.
+     *
+     * @return codestream_stats the accumulated per-stage times.
+     */
+    codestream_stats get_stats() const;
+
+    /**
+     * @brief Clears the accumulated per-stage times, counts, and
+     *        allocations.
+     */
+    void reset_stats();
+
+    /**
+     * @brief Returns the coded sizes of the codeblocks of a component,
+     *        resolution, and band, summed over all tiles.
+     *
+     * An encoder has these after flush(), and a decoder after create(),
+     * from the packet headers it has parsed; restart() clears them.
+     * Resolutions are numbered from 0, the lowest; bands are numbered 0
+     * for LL, which only resolution 0 has, and 1, 2, and 3 for HL, LH,
+     * and HH.  Any of the arguments can be coded_size_stats::ALL, to sum
+     * over all its values.
+     *
+     * @param comp_num component number, or coded_size_stats::ALL.
+     * @param res_num resolution number, or coded_size_stats::ALL.
+     * @param band_num band number, or coded_size_stats::ALL.
+     * @return coded_size_stats the sizes of the selected codeblocks.
+     */
+    coded_size_stats get_coded_size_stats(ui32 comp_num, ui32 res_num,
+                                          ui32 band_num) const;
+
+    /**
+     * @brief Returns the memory this codestream needs.
+     *
+     * For a reading codestream, call this function after read_headers()
+     * and restrict_input_resolution(), and before create(), to learn the
+     * memory create() and decoding will need; nothing is allocated.  When
+     * the file is a persistent mem_infile, or an mmap_infile, codeblock
+     * data is not copied, and coded_bytes drops to bookkeeping only.
+     *
+     * For a writing codestream, call this function after write_headers(),
+     * which allocates fixed_bytes; coded_bytes then assumes that the
+     * codestream is no larger than the image samples, which holds for
+     * nearly all lossless codestreams, and is generous for lossy ones.
+     *
+     * @return memory_estimate the fixed and coded-data byte counts.
+     */
+    memory_estimate estimate_memory();
+
+    /**
+     * @brief Limits the memory this codestream may hold.
+     *
+     * When create() or write_headers() would need more than bytes for
+     * fixed allocations, they raise an error before allocating.  Memory
+     * for coded data is then limited to what is left of the budget;
+     * exceeding it raises an error while reading or encoding, rather
+     * than exhausting system memory.  Memory already held from previous
+     * use of this object, before restart(), is counted.  The budget
+     * survives restart().
+     *
+     * @param bytes the budget in bytes, or 0 for no budget (the default).
+     */
+    void set_memory_budget(ui64 bytes);
+
+    /**
+     * @brief Stores coded data in memory borrowed from a process-wide pool.
+     *
+     * By default, a codestream keeps the memory it used for coded data
+     * across restart(), for its own reuse only.  When many codestreams
+     * are used concurrently, or one after another by different threads,
+     * that memory sits idle in each of them.  With the shared pool, the
+     * codestream returns this memory to the pool on restart() and on
+     * destruction, and borrows from the pool before allocating.  The
+     * pool is thread-safe; see set_shared_pool_limit() in ojph_mem.h to
+     * bound the idle memory it keeps.
+     *
+     * @param enable true to use the shared pool; memory kept by this
+     *        codestream is moved to the pool.
+     */
+    void use_shared_pool(bool enable);
+
+    /**
+     * @brief Controls where the codestream's fixed memory is placed.
+     *
+     * create() and write_headers() allocate one block, of
+     * memory_estimate::fixed_bytes, for all structures, codeblock buffers
+     * and line buffers.  By default, it comes from malloc().  The flags,
+     * from OJPH_MEM_PLACEMENT in ojph_mem.h, can back it with huge pages,
+     * which reduces TLB misses across the many buffers, and can place it
+     * on the NUMA node of the thread that calls create() or
+     * write_headers().  Huge pages are currently supported on Linux only;
+     * elsewhere the flags fall back to malloc().  Alternatively, hooks
+     * supply the allocation, for example, to bind it to a specific node.
+     *
+     * Call this function before create() or write_headers(); a block kept
+     * from before restart() is freed, and allocated again as requested.
+     *
+     * @param flags a combination of OJPH_MEM_PLACEMENT values.
+     * @param hooks user allocation functions, or NULL; when given, they
+     *        take precedence over flags, except OJPH_MEM_LOCAL_NODE,
+     *        which is left to the hooks.
+     */
+    void set_fixed_memory_placement(ui32 flags,
+                                    const mem_store_hooks* hooks = NULL);
+
   private:
     local::codestream* state;
   };
@@ -70,6 +70,17 @@ namespace ojph {
 #endif
 
 
+  ////////////////////////////////////////////////////////////////////////////
+  /**
+   *  @brief A region of memory that is part of a gather write; see
+   *         outfile_base::write_v().
+   */
+  struct out_vec
+  {
+    const void *data;
+    size_t size;
+  };
+
   ////////////////////////////////////////////////////////////////////////////
   class OJPH_EXPORT outfile_base
   {
@@ -83,6 +94,17 @@ namespace ojph {
     virtual ~outfile_base() {}
 
     virtual size_t write(const void *ptr, size_t size) = 0;
+    //writes num_vecs regions in order, as if write() was called for each
+    //one, returning the total number of bytes written; the codestream
+    //hands whole tile-parts to this function.  Override it when the
+    //output can do better than one write() per region
+    virtual size_t write_v(const out_vec *vecs, ui32 num_vecs)
+    {
+      size_t total = 0;
+      for (ui32 i = 0; i < num_vecs; ++i)
+        total += write(vecs[i].data, vecs[i].size);
+      return total;
+    }
     virtual si64 tell() { return 0; }
     virtual int seek(si64 offset, enum outfile_base::seek origin)
     {
@@ -102,7 +124,10 @@ namespace ojph {
 
     void open(const char *filename);
     size_t write(const void *ptr, size_t size) override;
+    //large batches bypass stdio and are written with writev()
+    size_t write_v(const out_vec *vecs, ui32 num_vecs) override;
     si64 tell() override;
+    int seek(si64 offset, enum outfile_base::seek origin) override;
     void flush() override;
     void close() override;
 
@@ -110,6 +135,63 @@ namespace ojph {
     FILE *fh;
   };
 
+  //*************************************************************************/
+  /**  @brief j2c_async_outfile writes to a file from a background thread
+   *
+   *  Data is copied into one of two large blocks; a full block is handed
+   *  to a background thread, which writes it while the caller fills the
+   *  other block.  Thus, encoding continues while the previous block is
+   *  being written; the caller waits only when both blocks are full.
+   *
+   *  flush() and close() are completion barriers; they return when all
+   *  data is written, and they report any write error.  Errors that occur
+   *  in the background also make later write() calls return 0.
+   *  seek() is supported anywhere in the written data, for example to
+   *  patch a header; seeking outside the current block waits for pending
+   *  blocks.
+   *
+   *  codestream::close() closes the file, and therefore waits for the last
+   *  block.  To overlap writing a codestream with encoding the next one,
+   *  call codestream::flush() only, and close the file later.
+   */
+  class OJPH_EXPORT j2c_async_outfile : public outfile_base
+  {
+  public:
+    /**  A constructor */
+    j2c_async_outfile() : state(NULL) {}
+    /**  A destructor; closes the file, discarding any error */
+    ~j2c_async_outfile() override;
+
+    j2c_async_outfile(j2c_async_outfile const&) = delete;
+    j2c_async_outfile& operator=(j2c_async_outfile const&) = delete;
+
+    /**
+     *  @brief Opens a file for writing.
+     *
+     *  @param filename the file name.
+     *  @param block_size the size of each of the two blocks, rounded up to
+     *         a multiple of 4096 bytes.
+     *  @param direct true to write full blocks with O_DIRECT, bypassing
+     *         the page cache; Linux only.  Data that is not block aligned,
+     *         such as the last block, is written normally.  If O_DIRECT is
+     *         not supported by the file system, a warning is issued and
+     *         the file is written normally.
+     */
+    void open(const char *filename, size_t block_size = 4194304,
+              bool direct = false);
+    size_t write(const void *ptr, size_t size) override;
+    si64 tell() override;
+    int seek(si64 offset, enum outfile_base::seek origin) override;
+    /**  Waits until all data written so far is in the file */
+    void flush() override;
+    /**  Waits for all data, and closes the file */
+    void close() override;
+
+  private:
+    struct async_state;
+    async_state *state;
+  };
+
   //*************************************************************************/
   /**  @brief mem_outfile stores encoded j2k codestreams in memory
    *
@@ -168,6 +250,16 @@ namespace ojph {
      */
     size_t write(const void *ptr, size_t size) override;
 
+    /**
+     *  @brief Call this function to write several regions to the memory
+     *         file; the buffer is expanded at most once.
+     *
+     *  @param vecs is an array of regions to write, in order.
+     *  @param num_vecs is the number of regions in vecs.
+     *  @return the total number of bytes written.
+     */
+    size_t write_v(const out_vec *vecs, ui32 num_vecs) override;
+
     /**
      *  @brief Call this function to know the file size (i.e., number of
      *         bytes used to store the file).
@@ -262,6 +354,135 @@ namespace ojph {
     static const size_t ALIGNED_ALLOC_MASK = 4096 - 1;
   };
 
+  //*************************************************************************/
+  /**  @brief mem_chunked_outfile stores encoded j2k codestreams in memory,
+   *         in a list of fixed-size chunks
+   *
+   *  Unlike mem_outfile, storage grows by adding chunks, so data already
+   *  written is never copied, and no more than one chunk of memory is
+   *  allocated beyond what is used.  The data is not contiguous; it can be
+   *  accessed one chunk at a time using get_chunk(), or handed to another
+   *  file, such as a j2c_outfile or a socket-backed outfile_base, using
+   *  write_to().
+   *
+   *  Chunks are kept when the file is closed and reopened, so encoding
+   *  many frames with one object allocates memory only for the first
+   *  frame, or when a frame is larger than all earlier ones.
+   */
+  class OJPH_EXPORT mem_chunked_outfile : public outfile_base
+  {
+  public:
+    /**  A constructor */
+    mem_chunked_outfile();
+    /**  A destructor */
+    ~mem_chunked_outfile() override;
+
+    mem_chunked_outfile(mem_chunked_outfile const&) = delete;
+    mem_chunked_outfile& operator=(mem_chunked_outfile const&) = delete;
+
+    /**
+     *  @brief Call this function to open a chunked memory file.
+     *
+     *  @param chunk_size is the size of each chunk; it is rounded up to a
+     *         multiple of 4096.  It can only be changed when the file
+     *         holds no chunks, i.e., on the first call, or after
+     *         release() is called.  The default value is 2^20.
+     *  @param clear_mem if set to true, newly allocated chunks are reset
+     *         to 0, so bytes skipped over by seek() read as 0.
+     */
+    void open(size_t chunk_size = 1048576, bool clear_mem = false);
+
+    /**
+     *  @brief Call this function to write data to the memory file; chunks
+     *         are added as needed.
+     *
+     *  @param ptr is a pointer to new data.
+     *  @param size the number of bytes in the new data.
+     *  @return the number of bytes written.
+     */
+    size_t write(const void *ptr, size_t size) override;
+
+    /**  @brief Writes several regions to the memory file */
+    size_t write_v(const out_vec *vecs, ui32 num_vecs) override;
+
+    /**  @brief Returns the write position */
+    si64 tell() override { return (si64)cur_pos; }
+
+    /**
+     *  @brief Call this function to change write pointer location; chunks
+     *         are added if the new location is beyond the last chunk.
+     *
+     *  @return 0 on success, non-zero otherwise.
+     */
+    int seek(si64 offset, enum outfile_base::seek origin) override;
+
+    /**
+     *  @brief Call this function to close the file; data remains
+     *         accessible until the file is opened again.
+     */
+    void close() override;
+
+    /**  @brief Frees all chunks; the file must be closed. */
+    void release();
+
+    /**
+     *  @brief Call this function to get the used size of the memory file.
+     *
+     *  @return the used size of the memory file in bytes.
+     */
+    size_t get_used_size() const { return used_size; }
+
+    /**  @brief Returns the size of each chunk. */
+    size_t get_chunk_size() const { return chunk_size; }
+
+    /**  @brief Returns the number of chunks holding data. */
+    ui32 get_num_chunks() const
+    { return chunk_size ? (ui32)((used_size+chunk_size-1) / chunk_size) : 0; }
+
+    /**
+     *  @brief Call this function to access the data in one chunk.
+     *
+     *  The returned pointer remains valid until the file is released or
+     *  destroyed.
+     *
+     *  @param idx is the chunk index, less than get_num_chunks().
+     *  @param size receives the number of used bytes in the chunk, which
+     *         is get_chunk_size() for all chunks except the last one.
+     *  @return a constant pointer to the chunk data.
+     */
+    const ui8* get_chunk(ui32 idx, size_t &size) const;
+
+    /**
+     *  @brief Writes the used data of all chunks to another file, using
+     *         outfile_base::write_v().
+     *
+     *  @return the number of bytes written.
+     */
+    size_t write_to(outfile_base *file) const;
+
+    /**
+     *  @brief Call this function to write the memory file data to a file
+     */
+    void write_to_file(const char *file_name) const;
+
+  private:
+    // makes sure chunks exist to hold needed_size bytes
+    void expand_storage(size_t needed_size);
+
+  private:
+    bool is_open;
+    bool clear_mem;
+    size_t chunk_size;
+    size_t cur_pos;
+    size_t used_size;
+    ui8 **chunks;
+    ui32 num_chunks;         // allocated chunks
+    ui32 chunks_capacity;    // entries in the chunks array
+
+  private:
+    static const size_t ALIGNED_ALLOC_MASK = 4096 - 1;
+  };
+
   ////////////////////////////////////////////////////////////////////////////
   class OJPH_EXPORT infile_base
   {
@@ -281,6 +502,15 @@ namespace ojph {
     virtual si64 tell() = 0;
     virtual bool eof() = 0;
     virtual void close() {}
+    //returns a pointer to the data at the current position, when the file
+    //resides in memory, or NULL otherwise; avail receives the number of
+    //bytes from the current position to the end of the file
+    virtual const ui8* get_data_ptr(size_t &avail)
+    { avail = 0; return NULL; }
+    //returns true when the data returned by get_data_ptr() remains valid
+    //and unchanged until the file is closed; the codestream then refers to
+    //codeblock data in place instead of copying it
+    virtual bool is_data_persistent() { return false; }
   };
 
   ////////////////////////////////////////////////////////////////////////////
@@ -304,6 +534,58 @@ namespace ojph {
     FILE *fh;
   };
 
+  //*************************************************************************/
+  /**  @brief j2c_prefetch_infile reads a file ahead from a background thread
+   *
+   *  The file is read in large blocks into a window of several blocks; a
+   *  background thread fills the window ahead of the read position, while
+   *  the caller parses and decodes data that is already in memory.
+   *  Tile-parts are stored one after the other and the codestream reads
+   *  them in order, so reading ahead sequentially fetches the upcoming
+   *  tile-parts before they are needed.  read(), seek() and tell() are
+   *  served from the window; a read outside the window, after a seek
+   *  for example, restarts reading ahead from the new position.
+   *
+   *  Errors in the background make read() return fewer bytes than
+   *  requested, as a short read from a file would.
+   */
+  class OJPH_EXPORT j2c_prefetch_infile : public infile_base
+  {
+  public:
+    /**  A constructor */
+    j2c_prefetch_infile() : state(NULL) {}
+    /**  A destructor; closes the file */
+    ~j2c_prefetch_infile() override;
+
+    j2c_prefetch_infile(j2c_prefetch_infile const&) = delete;
+    j2c_prefetch_infile& operator=(j2c_prefetch_infile const&) = delete;
+
+    /**
+     *  @brief Opens a file for reading.
+     *
+     *  @param filename the file name.
+     *  @param block_size the size of each block, rounded up to a multiple
+     *         of 4096 bytes.
+     *  @param num_blocks the number of blocks in the window, at least 2;
+     *         the background thread reads up to num_blocks - 1 blocks
+     *         ahead of the block being read.
+     */
+    void open(const char *filename, size_t block_size = 1048576,
+              ui32 num_blocks = 4);
+
+    //read reads size bytes, returns the number of bytes read
+    size_t read(void *ptr, size_t size) override;
+    //seek returns 0 on success
+    int seek(si64 offset, enum infile_base::seek origin) override;
+    si64 tell() override;
+    bool eof() override;
+    void close() override;
+
+  private:
+    struct prefetch_state;
+    prefetch_state *state;
+  };
+
   ////////////////////////////////////////////////////////////////////////////
   class OJPH_EXPORT mem_infile : public infile_base
   {
@@ -325,7 +607,18 @@ namespace ojph {
      **/
     mem_infile& operator=(mem_infile&&) noexcept;
 
-    void open(const ui8* data, size_t size);
+    /**
+     * Opens a memory buffer for reading.
+     *
+     * @param data the buffer holding the codestream.
+     * @param size the buffer size in bytes.
+     * @param persistent set to true if data remains valid and unchanged
+     *        until this file is closed, by calling close() or
+     *        codestream::close(); the codestream then refers to codeblock
+     *        data in the buffer instead of copying it.  When false, data
+     *        is not needed after codestream::create() returns.
+     **/
+    void open(const ui8* data, size_t size, bool persistent = false);
 
     //read reads size bytes, returns the number of bytes read
     size_t read(void *ptr, size_t size) override;
@@ -333,7 +626,14 @@ namespace ojph {
     int seek(si64 offset, enum infile_base::seek origin) override;
     si64 tell() override { return cur_ptr - data; }
     bool eof() override { return cur_ptr >= data + size; }
-    void close() override { data = cur_ptr = NULL; size = 0; }
+    void close() override
+    { data = cur_ptr = NULL; size = 0; persistent = false; }
+    const ui8* get_data_ptr(size_t &avail) override
+    {
+      avail = cur_ptr < data + size ? (size_t)(data + size - cur_ptr) : 0;
+      return data ? cur_ptr : NULL;
+    }
+    bool is_data_persistent() override { return persistent; }
 
   private:
     // swap the contents of two instances
@@ -341,6 +641,36 @@ namespace ojph {
 
     const ui8 *data, *cur_ptr;
     size_t size;
+    bool persistent;
+  };
+
+  ////////////////////////////////////////////////////////////////////////////
+  /**
+   *  @brief Reads a codestream file through a read-only memory mapping.
+   *
+   *  The file is mapped in its entirety when opened; codeblock data is
+   *  then referred to in place by the codestream, instead of being copied
+   *  into memory owned by the codestream.  This avoids copying the whole
+   *  codestream and reduces the memory needed to decode large files; the
+   *  operating system pages data in as it is needed.  The mapping is
+   *  released by close(), which codestream::close() calls.
+   */
+  class OJPH_EXPORT mmap_infile : public mem_infile
+  {
+  public:
+    mmap_infile() : map_addr(NULL), map_size(0), map_handle(NULL) {}
+    ~mmap_infile() override { close(); }
+
+    mmap_infile(mmap_infile const&) = delete;
+    mmap_infile& operator=(mmap_infile const&) = delete;
+
+    void open(const char *filename);
+    void close() override;
+
+  private:
+    void *map_addr;
+    size_t map_size;
+    void *map_handle;     // the file mapping object on Windows
   };
 
 
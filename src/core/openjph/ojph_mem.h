@@ -54,20 +54,67 @@ namespace ojph {
     void ojph_aligned_free(void* pointer);
   }
 
+  /////////////////////////////////////////////////////////////////////////////
+  // The process-wide pool of memory from which codestreams that call
+  // codestream::use_shared_pool(true) store coded data.  It keeps idle
+  // memory returned by such codestreams, up to a limit (256MB by default),
+  // for other codestreams to reuse.
+  //
+  // set_shared_pool_limit() sets the most idle bytes the pool keeps,
+  // freeing any excess; get_shared_pool_size() returns the idle bytes kept;
+  // trim_shared_pool() frees all idle memory.
+  OJPH_EXPORT void set_shared_pool_limit(size_t bytes);
+  OJPH_EXPORT size_t get_shared_pool_size();
+  OJPH_EXPORT void trim_shared_pool();
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Placement of the single block of memory that a codestream allocates
+  // for its structures, codeblock buffers and line buffers; see
+  // codestream::set_fixed_memory_placement().  Flags can be combined.
+  enum OJPH_MEM_PLACEMENT : ui32 {
+    OJPH_MEM_DEFAULT     = 0x0, // plain malloc()
+    OJPH_MEM_HUGE_PAGES  = 0x1, // back with 2MB transparent huge pages
+    OJPH_MEM_HUGETLB     = 0x2, // use explicit (reserved) huge pages, if
+                                // available, or else as OJPH_MEM_HUGE_PAGES
+    OJPH_MEM_LOCAL_NODE  = 0x4, // touch every page from the allocating
+                                // thread, placing the block on that thread's
+                                // NUMA node under the default first-touch
+                                // policy
+  };
+
+  /////////////////////////////////////////////////////////////////////////////
+  // User-supplied allocation for the same block, for example to call
+  // numa_alloc_onnode() for a specific node; free receives the size that
+  // was passed to alloc, and context is passed to both.
+  struct mem_store_hooks
+  {
+    void* (*alloc)(size_t size, void *context);
+    void (*free)(void *ptr, size_t size, void *context);
+    void *context;
+  };
+
   /////////////////////////////////////////////////////////////////////////////
   class mem_fixed_allocator
   {
   public:
     mem_fixed_allocator()
     {
-      store = NULL; allocated_data = 0;
+      store = NULL; allocated_data = 0; store_mapped = 0;
+      placement = store_placement = OJPH_MEM_DEFAULT;
+      hooks.alloc = store_hooks.alloc = NULL;
+      hooks.free = store_hooks.free = NULL;
+      hooks.context = store_hooks.context = NULL;
       restart();
     }
     ~mem_fixed_allocator()
     {
-      if (store) free(store);
+      release_store();
     }
 
+    // sets how the store is allocated, from OJPH_MEM_PLACEMENT flags, or
+    // by hooks when not NULL; takes effect at the next alloc()
+    void set_placement(ui32 flags, const mem_store_hooks* hooks);
+
     template<typename T>
     void pre_alloc_data(size_t num_ele, ui32 pre_size)
     {
@@ -87,12 +134,14 @@ namespace ojph {
       {
         // We should be here once only, because, in subsequent, calls we
         // should have size_data + size_obj <= allocated_data
-        free(store);
+        release_store();
         allocated_data = size_data + size_obj;
         allocated_data = allocated_data + (allocated_data + 19) / 20; // 5%
-        store = malloc(allocated_data);
-        if (store == NULL)
+        store = acquire_store(allocated_data);
+        if (store == NULL) {
+          allocated_data = 0;
           OJPH_ERROR(0x00090001, "malloc failed");
+        }
       }
       avail_obj = store;
       avail_data = (ui8*)store + size_obj;
@@ -101,6 +150,17 @@ namespace ojph {
       preallocation = false;
     }
 
+    // the number of bytes alloc() would hold, given the sizes requested
+    // with pre_alloc_data() and pre_alloc_obj() so far
+    size_t eval_alloc_size() const
+    {
+      size_t t = size_data + size_obj;
+      return t > allocated_data ? t + (t + 19) / 20 : allocated_data;
+    }
+
+    // the number of bytes currently held
+    size_t get_allocated_size() const { return allocated_data; }
+
     void restart()
     {
       avail_obj = avail_data = NULL;
@@ -123,6 +183,10 @@ namespace ojph {
     }
 
   private:
+    // allocate and free the store according to placement and hooks
+    void* acquire_store(size_t size);
+    void release_store();
+
     template<typename T, int N>
     void pre_alloc_local(size_t num_ele, ui32 pre_size, size_t& sz)
     {
@@ -154,6 +218,11 @@ namespace ojph {
     size_t size_data, size_obj, avail_size_obj, avail_size_data;
     size_t allocated_data;
     bool preallocation;
+    ui32 placement;               // requested placement
+    mem_store_hooks hooks;        // requested hooks
+    ui32 store_placement;         // how store was allocated, needed to
+    mem_store_hooks store_hooks;  // free it
+    size_t store_mapped;          // bytes mapped, 0 if store is malloc'ed
   };
 
   /////////////////////////////////////////////////////////////////////////////
@@ -164,7 +233,7 @@ namespace ojph {
       LFT_UNDEFINED  = 0x00, // Type is undefined/uninitialized
                              // These flags reflects data size in bytes
       LFT_BYTE       = 0x01, // Set when data is 1 byte  (not used)
-      LFT_16BIT      = 0x02, // Set when data is 2 bytes (not used)
+      LFT_16BIT      = 0x02, // Set when data is 2 bytes
       LFT_32BIT      = 0x04, // Set when data is 4 bytes
       LFT_64BIT      = 0x08, // Set when data is 8 bytes
       LFT_INTEGER    = 0x10, // Set when data is an integer, in other words
@@ -182,6 +251,7 @@ namespace ojph {
     ui32 pre_size;
     ui32 flags;
     union {
+      si16* i16;  // 16bit integer type, used for low-precision lossless
       si32* i32;  // 32bit integer type, used for lossless compression
       si64* i64;  // 64bit integer type, used for lossless compression
       float* f32; // float type, used for lossy compression
@@ -223,10 +293,18 @@ namespace ojph {
   public:
     mem_elastic_allocator(ui32 chunk_size)
     : chunk_size(chunk_size)
-    { cur_store = store = avail = NULL; total_allocated = 0; }
+    {
+      cur_store = store = avail = NULL;
+      total_allocated = 0;
+      limit = 0;
+      shared = false;
+      growth_count = growth_bytes = 0;
+    }
 
     ~mem_elastic_allocator()
     {
+      if (shared)
+        restart(); // returns stores in use to the shared pool
       while (store) { // stores in use
         stores_list* t = store->next_store;
         free(store);
@@ -242,6 +320,31 @@ namespace ojph {
     void get_buffer(ui32 needed_bytes, coded_lists*& p);
     void restart();
 
+    // sets the most bytes this allocator may hold, 0 for no limit;
+    // exceeding it raises an error
+    void set_limit(size_t bytes) { limit = bytes; }
+    // the number of bytes currently held, including recycled stores
+    size_t get_allocated_size() const { return total_allocated; }
+    ui32 get_chunk_size() const { return chunk_size; }
+    // the number of stores obtained from the system or the shared pool,
+    // rather than recycled, and their bytes; reset_growth() clears them
+    ui64 get_growth_count() const { return growth_count; }
+    ui64 get_growth_bytes() const { return growth_bytes; }
+    void reset_growth() { growth_count = growth_bytes = 0; }
+
+    // when shared, stores are borrowed from a process-wide pool, and are
+    // returned to it by restart() and the destructor, instead of being
+    // kept for reuse by this allocator only
+    void set_shared(bool shared);
+
+    // the shared pool keeps no more than this many idle bytes; stores
+    // returned beyond that are freed
+    static void set_pool_limit(size_t bytes);
+    // the number of idle bytes kept by the shared pool
+    static size_t get_pool_size();
+    // frees all idle stores kept by the shared pool
+    static void trim_pool();
+
   private:
     struct stores_list
     {
@@ -276,10 +379,15 @@ namespace ojph {
 
     stores_list* allocate(stores_list** list, ui32 extended_bytes);
 
+    struct shared_pool;     // defined in ojph_mem.cpp
+
     stores_list *store;
     stores_list *cur_store;
     stores_list *avail;
     size_t total_allocated;
+    size_t limit;
+    ui64 growth_count, growth_bytes;
+    bool shared;
     const ui32 chunk_size;
   };
 
@@ -0,0 +1,140 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2026, Aous Naman
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_trace.h
+// Author: Aous Naman
+// Date: 19 October 2026
+//***************************************************************************/
+
+
+#ifndef OJPH_TRACE_H
+#define OJPH_TRACE_H
+
+#include "ojph_arch.h"
+
+namespace ojph {
+
+  ////////////////////////////////////////////////////////////////////////////
+  //                              trace events
+  ////////////////////////////////////////////////////////////////////////////
+  //
+  // The library can record a timeline of its work, made of spans, each
+  //   with a name, a category, a thread, and up to two integer arguments.
+  //   The timeline is written as trace-event JSON, which chrome://tracing
+  //   and the Perfetto UI (ui.perfetto.dev) display.
+  //
+  // The library records spans for tiles, component lines, resolution
+  //   lines, codeblock rows, and file reads and writes; applications can
+  //   add their own with trace_span.  Each thread records into a buffer of
+  //   its own, whose lock is uncontended.  While tracing is off, a span
+  //   costs a call to trace_is_enabled(), which goes through a
+  //   thread-safe function-local static and makes an atomic load, and a
+  //   branch; the library's spans cover no less than a line, so this cost
+  //   is negligible.
+
+  ////////////////////////////////////////////////////////////////////////////
+  // Starts recording, discarding any recorded spans; the timeline is
+  //   written to filename by trace_stop().  Returns false, and does not
+  //   start, if filename cannot be opened for writing.
+  OJPH_EXPORT
+  bool trace_start(const char *filename);
+
+  ////////////////////////////////////////////////////////////////////////////
+  // Stops recording, and writes the recorded spans; spans that are still
+  //   open in other threads are dropped.  Returns false if writing fails.
+  //   Does nothing, and returns true, if recording is off.
+  OJPH_EXPORT
+  bool trace_stop();
+
+  ////////////////////////////////////////////////////////////////////////////
+  // Returns true while recording.
+  OJPH_EXPORT
+  bool trace_is_enabled();
+
+  ////////////////////////////////////////////////////////////////////////////
+  // Names the calling thread in the timeline; name must outlive tracing,
+  //   which is the case for string literals.
+  OJPH_EXPORT
+  void trace_set_thread_name(const char *name);
+
+  ////////////////////////////////////////////////////////////////////////////
+  // Returns the nanoseconds elapsed since trace_start().
+  OJPH_EXPORT
+  ui64 trace_now();
+
+  ////////////////////////////////////////////////////////////////////////////
+  // Records a span of the calling thread that started at start and ends
+  //   now, both in trace_now() nanoseconds.  name, cat, arg0_name, and
+  //   arg1_name must outlive tracing; an argument with a NULL name is not
+  //   recorded.
+  OJPH_EXPORT
+  void trace_add_span(const char *name, const char *cat, ui64 start,
+                      const char *arg0_name, si64 arg0,
+                      const char *arg1_name, si64 arg1);
+
+  ////////////////////////////////////////////////////////////////////////////
+  /**
+   *  @brief Records the lifetime of a scope as a span, while recording.
+   *
+   *  The strings must outlive tracing, which is the case for string
+   *  literals.
+   */
+  class trace_span
+  {
+  public:
+    trace_span(const char *name, const char *cat,
+               const char *arg0_name = NULL, si64 arg0 = 0,
+               const char *arg1_name = NULL, si64 arg1 = 0)
+    : name(name), cat(cat), arg0_name(arg0_name), arg1_name(arg1_name),
+      arg0(arg0), arg1(arg1)
+    {
+      active = trace_is_enabled();
+      start = active ? trace_now() : 0;
+    }
+    ~trace_span()
+    {
+      if (active)
+        trace_add_span(name, cat, start, arg0_name, arg0, arg1_name, arg1);
+    }
+
+  private:
+    trace_span(const trace_span&) = delete;
+    trace_span& operator=(const trace_span&) = delete;
+
+  private:
+    bool active;
+    const char *name, *cat, *arg0_name, *arg1_name;
+    si64 arg0, arg1;
+    ui64 start;
+  };
+
+}
+
+#endif // !OJPH_TRACE_H
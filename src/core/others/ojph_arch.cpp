@@ -36,9 +36,14 @@
 // Date: 28 August 2019
 //***************************************************************************/
 
+#include <atomic>
 #include <cassert>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
 
 #include "ojph_arch.h"
+#include "ojph_message.h"
 
 namespace ojph {
 
@@ -292,11 +297,74 @@ namespace ojph {
   static int cpu_level;
   static bool cpu_level_initialized = init_cpu_ext_level(cpu_level);
 
+  ////////////////////////////////////////////////////////////////////////////
+  // set by set_max_cpu_ext_level(); a negative value defers to the
+  // OJPH_MAX_CPU_EXT_LEVEL environment variable
+  static std::atomic<int> max_cpu_level(-1);
+
+  ////////////////////////////////////////////////////////////////////////////
+  static int read_max_cpu_ext_level_env()
+  {
+    const char *val = getenv("OJPH_MAX_CPU_EXT_LEVEL");
+    if (val == NULL || *val == 0)
+      return INT_MAX;
+
+    char *end = NULL;
+    long level = strtol(val, &end, 10);
+    if (*end == 0 && level >= 0)
+      return (int)ojph_min(level, (long)INT_MAX);
+
+    struct level_name { const char *name; int level; };
+    static const level_name names[] = {
+      { "generic", 0 },
+  #if (defined(OJPH_ARCH_X86_64) || defined(OJPH_ARCH_I386))
+      { "mmx", X86_CPU_EXT_LEVEL_MMX },
+      { "sse", X86_CPU_EXT_LEVEL_SSE },
+      { "sse2", X86_CPU_EXT_LEVEL_SSE2 },
+      { "sse3", X86_CPU_EXT_LEVEL_SSE3 },
+      { "ssse3", X86_CPU_EXT_LEVEL_SSSE3 },
+      { "sse41", X86_CPU_EXT_LEVEL_SSE41 },
+      { "sse42", X86_CPU_EXT_LEVEL_SSE42 },
+      { "avx", X86_CPU_EXT_LEVEL_AVX },
+      { "avx2", X86_CPU_EXT_LEVEL_AVX2 },
+      { "avx2fma", X86_CPU_EXT_LEVEL_AVX2FMA },
+      { "avx512", X86_CPU_EXT_LEVEL_AVX512 },
+  #elif defined(OJPH_ARCH_ARM)
+      { "neon", ARM_CPU_EXT_LEVEL_NEON },
+      { "asimd", ARM_CPU_EXT_LEVEL_ASIMD },
+      { "sve", ARM_CPU_EXT_LEVEL_SVE },
+      { "sve2", ARM_CPU_EXT_LEVEL_SVE2 },
+  #elif defined(OJPH_ARCH_PPC64LE)
+      { "power9", PPC_CPU_EXT_LEVEL_ARCH_3_00 },
+      { "power10", PPC_CPU_EXT_LEVEL_ARCH_3_1 },
+  #endif
+    };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+      if (strcmp(val, names[i].name) == 0)
+        return names[i].level;
+
+    OJPH_WARN(0x000A0001, "OJPH_MAX_CPU_EXT_LEVEL has an unrecognized "
+      "value \"%s\"; it is ignored.", val);
+    return INT_MAX;
+  }
+
   ////////////////////////////////////////////////////////////////////////////
   int get_cpu_ext_level()
   {
     assert(cpu_level_initialized);
-    return cpu_level;
+    int max_level = max_cpu_level.load(std::memory_order_relaxed);
+    if (max_level < 0)
+    {
+      static const int env_level = read_max_cpu_ext_level_env();
+      max_level = env_level;
+    }
+    return ojph_min(cpu_level, max_level);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void set_max_cpu_ext_level(int level)
+  {
+    max_cpu_level.store(level < 0 ? -1 : level, std::memory_order_relaxed);
   }
 
 }
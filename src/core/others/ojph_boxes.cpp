@@ -0,0 +1,388 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2026, Aous Naman
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_boxes.cpp
+// Author: Aous Naman
+// Date: 19 October 2026
+//***************************************************************************/
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include "ojph_arch.h"
+#include "ojph_base.h"
+#include "ojph_boxes.h"
+#include "ojph_file.h"
+#include "ojph_message.h"
+#include "ojph_params.h"
+
+namespace ojph {
+
+  ////////////////////////////////////////////////////////////////////////////
+  // box fields are big-endian
+  static void put_ui16(std::vector<ui8>& v, ui32 val)
+  {
+    v.push_back((ui8)(val >> 8));
+    v.push_back((ui8)val);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  static void put_ui32(std::vector<ui8>& v, ui32 val)
+  {
+    put_ui16(v, val >> 16);
+    put_ui16(v, val);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  static void put_ui64(std::vector<ui8>& v, ui64 val)
+  {
+    put_ui32(v, (ui32)(val >> 32));
+    put_ui32(v, (ui32)val);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  static ui32 get_ui16(const ui8 *p)
+  {
+    return ((ui32)p[0] << 8) | p[1];
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  static ui32 get_ui32(const ui8 *p)
+  {
+    return (get_ui16(p) << 16) | get_ui16(p + 2);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  // appends the box header and contents of a box without subboxes
+  static void put_box(std::vector<ui8>& v, ui32 type,
+                      const std::vector<ui8>& contents)
+  {
+    put_ui32(v, (ui32)contents.size() + 8);
+    put_ui32(v, type);
+    v.insert(v.end(), contents.begin(), contents.end());
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  // appends the contents of a resc or resd box, holding grid points per
+  //   metre as N/D * 10^E, with D = 1 and N as large as 16 bits allow
+  static void put_resolution(std::vector<ui8>& v, const double res[2])
+  {
+    si32 exp[2];
+    ui32 num[2];
+    for (int i = 0; i < 2; ++i)
+    {
+      double r = res[1 - i]; // vertical first
+      si32 e = 0;
+      while (r > 65535.0 && e < 127) { r /= 10.0; ++e; }
+      while (r * 10.0 <= 65535.0 && e > -128) { r *= 10.0; --e; }
+      exp[i] = e;
+      num[i] = (ui32)ojph_max(1.0, floor(r + 0.5));
+    }
+    put_ui16(v, num[0]); put_ui16(v, 1);
+    put_ui16(v, num[1]); put_ui16(v, 1);
+    v.push_back((ui8)(si8)exp[0]);
+    v.push_back((ui8)(si8)exp[1]);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  static void write_bytes(outfile_base *file, const std::vector<ui8>& v)
+  {
+    if (file->write(v.data(), v.size()) != v.size())
+      OJPH_ERROR(0x000B0001, "error writing the boxes of a jph file");
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  //
+  //
+  //
+  //
+  //
+  ////////////////////////////////////////////////////////////////////////////
+
+  ////////////////////////////////////////////////////////////////////////////
+  void jph_writer::write_headers(outfile_base *file, const param_siz& siz)
+  {
+    std::vector<ui8> out, contents, header;
+
+    // signature and file type boxes
+    contents.push_back(0x0D); contents.push_back(0x0A);
+    contents.push_back(0x87); contents.push_back(0x0A);
+    put_box(out, jp2_box::SIGNATURE, contents);
+    contents.clear();
+    put_ui32(contents, brand);
+    put_ui32(contents, 0);           // minor version
+    put_ui32(contents, brand);       // compatibility list
+    put_box(out, jp2_box::FTYP, contents);
+
+    // the image header, followed by a bpcc box if the components differ
+    ui32 num_comps = siz.get_num_components();
+    ui32 bpc = 0xFF;
+    bool same = true;
+    for (ui32 c = 1; c < num_comps; ++c)
+      same = same && siz.get_bit_depth(c) == siz.get_bit_depth(0)
+                  && siz.is_signed(c) == siz.is_signed(0);
+    if (same)
+      bpc = (siz.get_bit_depth(0) - 1) | (siz.is_signed(0) ? 0x80 : 0);
+    contents.clear();
+    put_ui32(contents, siz.get_image_extent().y - siz.get_image_offset().y);
+    put_ui32(contents, siz.get_image_extent().x - siz.get_image_offset().x);
+    put_ui16(contents, num_comps);
+    contents.push_back((ui8)bpc);
+    contents.push_back(7);           // compression type, JPEG 2000
+    contents.push_back(0);           // colour space is known
+    contents.push_back(0);           // no intellectual property box
+    put_box(header, jp2_box::IHDR, contents);
+    if (!same)
+    {
+      contents.clear();
+      for (ui32 c = 0; c < num_comps; ++c)
+        contents.push_back((ui8)((siz.get_bit_depth(c) - 1)
+                                 | (siz.is_signed(c) ? 0x80 : 0)));
+      put_box(header, jp2_box::BPCC, contents);
+    }
+
+    // an enumerated colour space
+    ui32 enumcs = colour_space;
+    if (enumcs == DEFAULT_COLOUR_SPACE)
+      enumcs = num_comps < 3 ? (ui32)GREYSCALE : (ui32)SRGB;
+    contents.clear();
+    contents.push_back(1);           // enumerated method
+    contents.push_back(0);           // precedence
+    contents.push_back(0);           // approximation
+    put_ui32(contents, enumcs);
+    put_box(header, jp2_box::COLR, contents);
+
+    // the resolution superbox, if any resolution is set
+    std::vector<ui8> res;
+    if (capture_res[0] > 0.0 && capture_res[1] > 0.0)
+    {
+      contents.clear();
+      put_resolution(contents, capture_res);
+      put_box(res, jp2_box::RESC, contents);
+    }
+    if (display_res[0] > 0.0 && display_res[1] > 0.0)
+    {
+      contents.clear();
+      put_resolution(contents, display_res);
+      put_box(res, jp2_box::RESD, contents);
+    }
+    if (!res.empty())
+      put_box(header, jp2_box::RES, res);
+    put_box(out, jp2_box::JP2H, header);
+    write_bytes(file, out);
+
+    // the header of the codestream box
+    jp2c_position = file->tell();
+    out.clear();
+    if (codestream_length == 0)
+    { // extends to the end of file, unless finalize() can do better
+      put_ui32(out, 0);
+      put_ui32(out, jp2_box::JP2C);
+    }
+    else if (codestream_length + 8 <= 0xFFFFFFFFu)
+    {
+      put_ui32(out, (ui32)(codestream_length + 8));
+      put_ui32(out, jp2_box::JP2C);
+    }
+    else
+    {
+      put_ui32(out, 1);
+      put_ui32(out, jp2_box::JP2C);
+      put_ui64(out, codestream_length + 16);
+    }
+    jp2c_header_size = (ui32)out.size();
+    write_bytes(file, out);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void jph_writer::finalize(outfile_base *file)
+  {
+    assert(jp2c_position >= 0);
+    si64 end = file->tell();
+    ui64 length = (ui64)(end - jp2c_position - jp2c_header_size);
+    if (codestream_length != 0)
+    {
+      if (length != codestream_length)
+        OJPH_ERROR(0x000B0002, "the jp2c box was sized for a codestream of "
+          "%llu bytes, but %llu bytes were written",
+          (unsigned long long)codestream_length, (unsigned long long)length);
+      return;
+    }
+    if (length + 8 > 0xFFFFFFFFu)
+      return; // the box stays open to the end of file
+    if (file->seek(jp2c_position, outfile_base::OJPH_SEEK_SET) != 0)
+      return; // likewise
+    std::vector<ui8> lbox;
+    put_ui32(lbox, (ui32)(length + 8));
+    write_bytes(file, lbox);
+    if (file->seek(end, outfile_base::OJPH_SEEK_SET) != 0)
+      OJPH_ERROR(0x000B0003, "error seeking in a jph file");
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  //
+  //
+  //
+  //
+  //
+  ////////////////////////////////////////////////////////////////////////////
+
+  ////////////////////////////////////////////////////////////////////////////
+  bool jph_reader::starts_with_signature(infile_base *file)
+  {
+    static const ui8 signature[12] = { 0x00, 0x00, 0x00, 0x0C,
+      0x6A, 0x50, 0x20, 0x20, 0x0D, 0x0A, 0x87, 0x0A };
+    si64 pos = file->tell();
+    ui8 buf[12];
+    size_t len = file->read(buf, sizeof(buf));
+    file->seek(pos, infile_base::OJPH_SEEK_SET);
+    if (len != sizeof(buf))
+      return false;
+    for (int i = 0; i < 12; ++i)
+      if (buf[i] != signature[i])
+        return false;
+    return true;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  bool jph_reader::read_box_header(infile_base *file, jp2_box& box)
+  {
+    ui8 buf[8];
+    size_t len = file->read(buf, 8);
+    if (len == 0)
+      return false;
+    if (len != 8)
+      OJPH_ERROR(0x000B0011, "a box header is truncated");
+    ui64 lbox = get_ui32(buf);
+    box.type = get_ui32(buf + 4);
+    box.header_size = 8;
+    box.to_end = lbox == 0;
+    if (lbox == 1)
+    {
+      if (file->read(buf, 8) != 8)
+        OJPH_ERROR(0x000B0012, "a box header is truncated");
+      lbox = ((ui64)get_ui32(buf) << 32) | get_ui32(buf + 4);
+      box.header_size = 16;
+    }
+    if (!box.to_end && lbox < box.header_size)
+      OJPH_ERROR(0x000B0013, "a box is shorter than its header");
+    box.length = box.to_end ? 0 : lbox - box.header_size;
+    box.offset = file->tell();
+    return true;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void jph_reader::clear()
+  {
+    brand = 0;
+    width = height = num_components = bit_depth = 0;
+    is_signed_samples = false;
+    colour_space = 0;
+    codestream_box.type = 0;
+    codestream_box.header_size = 0;
+    codestream_box.offset = 0;
+    codestream_box.length = 0;
+    codestream_box.to_end = false;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void jph_reader::read(infile_base *file)
+  {
+    clear();
+    if (!starts_with_signature(file))
+      OJPH_ERROR(0x000B0021, "the file does not start with a signature box");
+
+    jp2_box box;
+    ui32 index = 0;
+    while (read_box_header(file, box))
+    {
+      if (index++ == 1 && box.type != jp2_box::FTYP)
+        OJPH_ERROR(0x000B0023, "the signature box is not followed by "
+          "a file type box");
+      if (box.type == jp2_box::JP2C)
+      {
+        codestream_box = box;
+        return;
+      }
+      if (box.to_end)
+        break;
+      if (box.type == jp2_box::FTYP && box.length >= 8)
+      {
+        ui8 buf[4];
+        if (file->read(buf, 4) != 4)
+          OJPH_ERROR(0x000B0022, "the ftyp box is truncated");
+        brand = get_ui32(buf);
+      }
+      else if (box.type == jp2_box::JP2H)
+        read_header_box(file, box);
+      file->seek(box.offset + (si64)box.length, infile_base::OJPH_SEEK_SET);
+    }
+    OJPH_ERROR(0x000B0024, "the file has no jp2c box");
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void jph_reader::read_header_box(infile_base *file, const jp2_box& jp2h)
+  {
+    si64 end = jp2h.offset + (si64)jp2h.length;
+    jp2_box box;
+    while (file->tell() < end && read_box_header(file, box))
+    {
+      if (box.to_end || box.offset + (si64)box.length > end)
+        OJPH_ERROR(0x000B0031, "a box extends beyond its jp2h box");
+      ui8 buf[14];
+      if (box.type == jp2_box::IHDR)
+      {
+        if (box.length < 14 || file->read(buf, 14) != 14)
+          OJPH_ERROR(0x000B0032, "the ihdr box is truncated");
+        height = get_ui32(buf);
+        width = get_ui32(buf + 4);
+        num_components = get_ui16(buf + 8);
+        if (buf[10] != 0xFF) {
+          bit_depth = (buf[10] & 0x7Fu) + 1;
+          is_signed_samples = (buf[10] & 0x80) != 0;
+        }
+      }
+      else if (box.type == jp2_box::COLR && colour_space == 0)
+      {
+        if (box.length < 3 || file->read(buf, 3) != 3)
+          OJPH_ERROR(0x000B0033, "the colr box is truncated");
+        if (buf[0] == 1)
+        {
+          if (box.length < 7 || file->read(buf, 4) != 4)
+            OJPH_ERROR(0x000B0034, "the colr box is truncated");
+          colour_space = get_ui32(buf);
+        }
+      }
+      file->seek(box.offset + (si64)box.length, infile_base::OJPH_SEEK_SET);
+    }
+  }
+
+}
@@ -42,11 +42,39 @@
 
 #include <cassert>
 #include <cstddef>
+#include <cstdlib>
+#include <cstring>
 #include <utility>
+#include <atomic>
+#ifndef OJPH_EMSCRIPTEN
+  #include <condition_variable>
+  #include <mutex>
+  #include <thread>
+#endif
+
+#include "ojph_arch.h"
+#ifdef OJPH_OS_WINDOWS
+  #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+  #endif
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <sys/uio.h>
+  #include <unistd.h>
+  #include <cerrno>
+  #include <climits>
+#endif
 
 #include "ojph_mem.h"
 #include "ojph_file.h"
 #include "ojph_message.h"
+#include "ojph_trace.h"
 
 namespace ojph {
 
@@ -71,9 +99,74 @@ namespace ojph {
   size_t j2c_outfile::write(const void *ptr, size_t size)
   {
     assert(fh);
+    trace_span span("write", "io", "bytes", (si64)size);
     return fwrite(ptr, 1, size, fh);
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  size_t j2c_outfile::write_v(const out_vec *vecs, ui32 num_vecs)
+  {
+    assert(fh);
+    trace_span span("write_v", "io", "vecs", num_vecs);
+#ifdef OJPH_OS_WINDOWS
+    return outfile_base::write_v(vecs, num_vecs);
+#else
+    // small batches are cheaper through the stdio buffer
+    const size_t min_writev_bytes = 65536;
+    size_t total = 0;
+    for (ui32 i = 0; i < num_vecs; ++i)
+      total += vecs[i].size;
+    if (total < min_writev_bytes)
+      return outfile_base::write_v(vecs, num_vecs);
+
+    // stdio buffered data must reach the file before ours
+    if (fflush(fh) != 0)
+      return 0;
+
+  #ifdef IOV_MAX
+    const ui32 max_iov = IOV_MAX < 1024 ? IOV_MAX : 1024;
+  #else
+    const ui32 max_iov = 16;
+  #endif
+    struct iovec iov[1024];
+    int fd = fileno(fh);
+    size_t written = 0;
+    ui32 i = 0;
+    size_t offset = 0; // bytes of vecs[i] already written
+    while (i < num_vecs)
+    {
+      ui32 n = 0;
+      for (; n < max_iov && i + n < num_vecs; ++n)
+      {
+        size_t skip = n == 0 ? offset : 0;
+        iov[n].iov_base = (ui8*)vecs[i + n].data + skip;
+        iov[n].iov_len = vecs[i + n].size - skip;
+      }
+      ssize_t result = writev(fd, iov, (int)n);
+      if (result < 0 && errno == EINTR)
+        continue;
+      if (result <= 0)
+        break;
+
+      // advance past what was written, which can be a partial write
+      size_t bytes = (size_t)result;
+      written += bytes;
+      while (i < num_vecs && bytes >= vecs[i].size - offset)
+      {
+        bytes -= vecs[i].size - offset;
+        offset = 0;
+        ++i;
+      }
+      offset += bytes;
+    }
+
+    // stdio must continue from the end of our data
+    if (ojph_fseek(fh, (si64)lseek(fd, 0, SEEK_CUR), SEEK_SET) != 0)
+      return 0;
+    return written;
+#endif
+  }
+
   ////////////////////////////////////////////////////////////////////////////
   si64 j2c_outfile::tell()
   {
@@ -81,6 +174,13 @@ namespace ojph {
     return ojph_ftell(fh);
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  int j2c_outfile::seek(si64 offset, enum outfile_base::seek origin)
+  {
+    assert(fh);
+    return ojph_fseek(fh, offset, origin);
+  }
+
   ////////////////////////////////////////////////////////////////////////////
   void j2c_outfile::flush()
   {
@@ -96,6 +196,347 @@ namespace ojph {
     fh = NULL;
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  //
+  //
+  // j2c_async_outfile
+  //
+  //
+  ////////////////////////////////////////////////////////////////////////////
+
+  ////////////////////////////////////////////////////////////////////////////
+  // At most one block is pending at any time; the caller fills the other.
+  struct j2c_async_outfile::async_state
+  {
+    struct block
+    {
+      ui8 *data;
+      size_t fill;      // bytes of data in use
+      si64 offset;      // file offset of data[0]
+      bool pending;     // handed to the writer, but not written yet
+    };
+
+    async_state()
+    {
+      for (int i = 0; i < 2; ++i) {
+        blocks[i].data = NULL;
+        blocks[i].fill = 0;
+        blocks[i].offset = 0;
+        blocks[i].pending = false;
+      }
+      cur = 0; cur_pos = 0; block_size = 0; end = 0;
+      failed = false; stop = false;
+#ifdef OJPH_OS_WINDOWS
+      fh = NULL;
+#else
+      fd = direct_fd = -1;
+#endif
+    }
+
+    void start_block(si64 offset)
+    {
+      blocks[cur].offset = offset;
+      blocks[cur].fill = 0;
+      cur_pos = 0;
+    }
+
+    bool write_block(const block& b);
+    void run();
+    void submit();
+    void drain();
+    bool finish();
+
+    block blocks[2];
+    ui32 cur;                 // the block being filled by the caller
+    size_t cur_pos;           // write position within the current block
+    size_t block_size;
+    si64 end;                 // file size, as seen by the caller
+    std::atomic<bool> failed; // a write has failed; sticky
+    bool stop;                // the writer thread should exit
+#ifdef OJPH_OS_WINDOWS
+    FILE *fh;
+#else
+    int fd;
+    int direct_fd;            // -1 when O_DIRECT is not used
+#endif
+#ifndef OJPH_EMSCRIPTEN
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::thread writer;
+#endif
+  };
+
+  ////////////////////////////////////////////////////////////////////////////
+  bool j2c_async_outfile::async_state::write_block(const block& b)
+  {
+#ifdef OJPH_OS_WINDOWS
+    if (ojph_fseek(fh, b.offset, SEEK_SET) != 0)
+      return false;
+    return fwrite(b.data, 1, b.fill, fh) == b.fill;
+#else
+    // O_DIRECT needs aligned offsets and sizes; blocks are aligned in memory
+    const si64 align_mask = 4095;
+    int f = fd;
+    if (direct_fd >= 0 && (b.offset & align_mask) == 0
+        && ((si64)b.fill & align_mask) == 0)
+      f = direct_fd;
+    const ui8 *p = b.data;
+    size_t left = b.fill;
+    si64 offset = b.offset;
+    while (left > 0)
+    {
+      ssize_t result = pwrite(f, p, left, (off_t)offset);
+      if (result < 0 && errno == EINTR)
+        continue;
+      if (result <= 0)
+        return false;
+      p += result;
+      left -= (size_t)result;
+      offset += result;
+      f = fd; // what is left of a partial write is no longer aligned
+    }
+    return true;
+#endif
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void j2c_async_outfile::async_state::run()
+  {
+#ifndef OJPH_EMSCRIPTEN
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+      cv.wait(lock, [this] {
+        return stop || blocks[0].pending || blocks[1].pending; });
+      block *b = blocks[0].pending ? blocks : (blocks[1].pending ? blocks + 1
+                                                                 : NULL);
+      if (b == NULL) // stop, with nothing left to write
+        break;
+      lock.unlock();
+      bool ok = write_block(*b);
+      lock.lock();
+      if (!ok)
+        failed = true;
+      b->pending = false;
+      cv.notify_all();
+    }
+#endif
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void j2c_async_outfile::async_state::submit()
+  {
+    block &b = blocks[cur];
+    ui32 next = cur ^ 1;
+#ifdef OJPH_EMSCRIPTEN
+    if (!write_block(b)) // no threads; write in place
+      failed = true;
+#else
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      b.pending = true;
+      cv.notify_all();
+      cv.wait(lock, [this, next] { return !blocks[next].pending; });
+    }
+#endif
+    cur = next;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void j2c_async_outfile::async_state::drain()
+  {
+#ifndef OJPH_EMSCRIPTEN
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] {
+      return !blocks[0].pending && !blocks[1].pending; });
+#endif
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  bool j2c_async_outfile::async_state::finish()
+  {
+    if (blocks[cur].fill > 0 && !failed)
+      submit();
+#ifndef OJPH_EMSCRIPTEN
+    if (writer.joinable())
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+      }
+      cv.notify_all();
+      writer.join();
+    }
+#endif
+#ifdef OJPH_OS_WINDOWS
+    if (fh != NULL && fclose(fh) != 0)
+      failed = true;
+    fh = NULL;
+#else
+    if (direct_fd >= 0)
+      ::close(direct_fd);
+    if (fd >= 0 && ::close(fd) != 0)
+      failed = true;
+    fd = direct_fd = -1;
+#endif
+    for (int i = 0; i < 2; ++i) {
+      if (blocks[i].data)
+        ojph_aligned_free(blocks[i].data);
+      blocks[i].data = NULL;
+    }
+    return !failed;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  j2c_async_outfile::~j2c_async_outfile()
+  {
+    if (state)
+    {
+      state->finish();
+      delete state;
+    }
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void j2c_async_outfile::open(const char *filename, size_t block_size,
+                               bool direct)
+  {
+    assert(state == NULL);
+    async_state *st = new async_state;
+    block_size = ojph_max((block_size + 4095) & ~(size_t)4095, (size_t)4096);
+    st->block_size = block_size;
+    for (int i = 0; i < 2; ++i)
+    {
+      st->blocks[i].data = (ui8*)ojph_aligned_malloc(4096, block_size);
+      if (st->blocks[i].data == NULL)
+      {
+        st->finish();
+        delete st;
+        OJPH_ERROR(0x00060034, "failed to allocate %zu bytes for writing %s",
+          block_size, filename);
+      }
+    }
+
+#ifdef OJPH_OS_WINDOWS
+    st->fh = fopen(filename, "wb");
+    bool opened = st->fh != NULL;
+#else
+    st->fd = ::open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    bool opened = st->fd >= 0;
+#endif
+    if (!opened)
+    {
+      st->finish();
+      delete st;
+      OJPH_ERROR(0x00060031, "failed to open %s for writing", filename);
+    }
+
+    if (direct)
+    {
+#if defined(OJPH_OS_LINUX) && defined(O_DIRECT)
+      st->direct_fd = ::open(filename, O_WRONLY | O_DIRECT);
+      if (st->direct_fd < 0)
+#endif
+        OJPH_WARN(0x00060032, "O_DIRECT is not available for %s; the file "
+          "is written through the page cache", filename);
+    }
+
+#ifndef OJPH_EMSCRIPTEN
+    st->writer = std::thread(&async_state::run, st);
+#endif
+    state = st;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  size_t j2c_async_outfile::write(const void *ptr, size_t size)
+  {
+    assert(state);
+    async_state *st = state;
+    if (st->failed)
+      return 0;
+    const ui8 *p = (const ui8*)ptr;
+    size_t left = size;
+    while (left > 0)
+    {
+      async_state::block &b = st->blocks[st->cur];
+      size_t n = ojph_min(left, st->block_size - st->cur_pos);
+      memcpy(b.data + st->cur_pos, p, n);
+      st->cur_pos += n;
+      b.fill = ojph_max(b.fill, st->cur_pos);
+      p += n;
+      left -= n;
+      if (st->cur_pos == st->block_size)
+      {
+        si64 next = b.offset + (si64)st->block_size;
+        st->submit();
+        st->start_block(next);
+      }
+    }
+    st->end = ojph_max(st->end, tell());
+    return size;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  si64 j2c_async_outfile::tell()
+  {
+    assert(state);
+    return state->blocks[state->cur].offset + (si64)state->cur_pos;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  int j2c_async_outfile::seek(si64 offset, enum outfile_base::seek origin)
+  {
+    assert(state);
+    async_state *st = state;
+    si64 target = offset;
+    if (origin == OJPH_SEEK_CUR)
+      target += tell();
+    else if (origin == OJPH_SEEK_END)
+      target += st->end;
+    else if (origin != OJPH_SEEK_SET)
+      return -1;
+    if (target < 0)
+      return -1;
+
+    async_state::block &b = st->blocks[st->cur];
+    if (target >= b.offset && target <= b.offset + (si64)b.fill)
+      st->cur_pos = (size_t)(target - b.offset); // within the current block
+    else
+    { // data before target must reach the file before anything after it
+      if (b.fill > 0)
+        st->submit();
+      st->drain();
+      st->start_block(target);
+    }
+    return 0;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void j2c_async_outfile::flush()
+  {
+    assert(state);
+    async_state *st = state;
+    st->drain();
+    // the current block is written, but kept, so that writing continues
+    // into it; it is written again when full
+    async_state::block &b = st->blocks[st->cur];
+    if (b.fill > 0 && !st->failed && !st->write_block(b))
+      st->failed = true;
+    if (st->failed)
+      OJPH_ERROR(0x00060033, "error writing to file");
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void j2c_async_outfile::close()
+  {
+    assert(state);
+    bool ok = state->finish();
+    delete state;
+    state = NULL;
+    if (!ok)
+      OJPH_ERROR(0x00060033, "error writing to file");
+  }
+
   ////////////////////////////////////////////////////////////////////////////
   //
   //
@@ -216,6 +657,27 @@ namespace ojph {
     return new_size;
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  size_t mem_outfile::write_v(const out_vec *vecs, ui32 num_vecs)
+  {
+    assert(this->is_open);
+    assert(this->buf);
+
+    size_t total = 0;
+    for (ui32 i = 0; i < num_vecs; ++i)
+      total += vecs[i].size;
+    expand_storage((size_t)tell() + total, false);
+
+    for (ui32 i = 0; i < num_vecs; ++i)
+    {
+      memcpy(this->cur_ptr, vecs[i].data, vecs[i].size);
+      cur_ptr += vecs[i].size;
+    }
+    used_size = ojph_max(used_size, (size_t)tell());
+
+    return total;
+  }
+
   ////////////////////////////////////////////////////////////////////////////
   void mem_outfile::write_to_file(const char *file_name) const
   {
@@ -261,6 +723,190 @@ namespace ojph {
       memset(this->buf, 0, this->buf_size);
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  //
+  //
+  // mem_chunked_outfile
+  //
+  //
+  ////////////////////////////////////////////////////////////////////////////
+
+  ////////////////////////////////////////////////////////////////////////////
+  mem_chunked_outfile::mem_chunked_outfile()
+  {
+    is_open = clear_mem = false;
+    chunk_size = 0;
+    cur_pos = used_size = 0;
+    chunks = NULL;
+    num_chunks = chunks_capacity = 0;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  mem_chunked_outfile::~mem_chunked_outfile()
+  {
+    is_open = false;
+    release();
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void mem_chunked_outfile::open(size_t chunk_size, bool clear_mem)
+  {
+    assert(this->is_open == false);
+    assert(chunk_size > 0);
+
+    chunk_size = (chunk_size + ALIGNED_ALLOC_MASK) & (~ALIGNED_ALLOC_MASK);
+    if (num_chunks == 0)
+      this->chunk_size = chunk_size;
+    else if (chunk_size != this->chunk_size)
+      OJPH_WARN(0x00060021, "the chunk size of an already allocated "
+        "mem_chunked_outfile cannot be changed; call release() first; "
+        "keeping the chunk size of %zu bytes", this->chunk_size);
+
+    this->is_open = true;
+    this->clear_mem = clear_mem;
+    if (clear_mem)
+      for (ui32 i = 0; i < num_chunks; ++i)
+        memset(chunks[i], 0, this->chunk_size);
+    this->cur_pos = this->used_size = 0;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void mem_chunked_outfile::close()
+  {
+    is_open = false;
+    cur_pos = 0;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void mem_chunked_outfile::release()
+  {
+    assert(is_open == false);
+    for (ui32 i = 0; i < num_chunks; ++i)
+      ojph_aligned_free(chunks[i]);
+    free(chunks);
+    chunks = NULL;
+    num_chunks = chunks_capacity = 0;
+    cur_pos = used_size = 0;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void mem_chunked_outfile::expand_storage(size_t needed_size)
+  {
+    while ((size_t)num_chunks * chunk_size < needed_size)
+    {
+      if (num_chunks == chunks_capacity)
+      {
+        ui32 new_capacity = chunks_capacity ? chunks_capacity * 2 : 16;
+        ui8 **t = (ui8**)realloc(chunks, new_capacity * sizeof(ui8*));
+        if (t == NULL)
+          OJPH_ERROR(0x00060022, "failed to allocate memory (%zu bytes)",
+            new_capacity * sizeof(ui8*));
+        chunks = t;
+        chunks_capacity = new_capacity;
+      }
+      ui8 *p = (ui8*)ojph_aligned_malloc(ALIGNED_ALLOC_MASK + 1, chunk_size);
+      if (p == NULL)
+        OJPH_ERROR(0x00060023, "failed to allocate memory (%zu bytes)",
+          chunk_size);
+      if (clear_mem)
+        memset(p, 0, chunk_size);
+      chunks[num_chunks++] = p;
+    }
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  size_t mem_chunked_outfile::write(const void *ptr, size_t size)
+  {
+    assert(this->is_open);
+    expand_storage(cur_pos + size);
+
+    const ui8 *sp = (const ui8*)ptr;
+    size_t remaining = size;
+    while (remaining)
+    {
+      size_t idx = cur_pos / chunk_size, off = cur_pos % chunk_size;
+      size_t n = ojph_min(remaining, chunk_size - off);
+      memcpy(chunks[idx] + off, sp, n);
+      sp += n;
+      cur_pos += n;
+      remaining -= n;
+    }
+    used_size = ojph_max(used_size, cur_pos);
+
+    return size;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  size_t mem_chunked_outfile::write_v(const out_vec *vecs, ui32 num_vecs)
+  {
+    size_t total = 0;
+    for (ui32 i = 0; i < num_vecs; ++i)
+      total += vecs[i].size;
+    expand_storage(cur_pos + total);
+
+    for (ui32 i = 0; i < num_vecs; ++i)
+      write(vecs[i].data, vecs[i].size);
+    return total;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  int mem_chunked_outfile::seek(si64 offset, enum outfile_base::seek origin)
+  {
+    if (origin == OJPH_SEEK_SET)
+      ; // do nothing
+    else if (origin == OJPH_SEEK_CUR)
+      offset += tell();
+    else if (origin == OJPH_SEEK_END)
+      offset += (si64)used_size;
+    else {
+      assert(0);
+      return -1;
+    }
+
+    if (offset < 0)  // offset before the start of file
+      return -1;
+
+    expand_storage((size_t)offset);
+    cur_pos = (size_t)offset;
+    return 0;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  const ui8* mem_chunked_outfile::get_chunk(ui32 idx, size_t &size) const
+  {
+    assert(idx < get_num_chunks());
+    size = ojph_min(chunk_size, used_size - (size_t)idx * chunk_size);
+    return chunks[idx];
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  size_t mem_chunked_outfile::write_to(outfile_base *file) const
+  {
+    const ui32 batch = 64;
+    out_vec vecs[batch];
+    size_t total = 0;
+    ui32 n = get_num_chunks();
+    for (ui32 i = 0; i < n; i += batch)
+    {
+      ui32 count = ojph_min(batch, n - i);
+      for (ui32 j = 0; j < count; ++j)
+        vecs[j].data = get_chunk(i + j, vecs[j].size);
+      total += file->write_v(vecs, count);
+    }
+    return total;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void mem_chunked_outfile::write_to_file(const char *file_name) const
+  {
+    assert(is_open == false);
+    j2c_outfile f;
+    f.open(file_name);
+    if (write_to(&f) != used_size)
+      OJPH_ERROR(0x00060024, "failed writing to %s", file_name);
+    f.close();
+  }
+
 
   ////////////////////////////////////////////////////////////////////////////
   //
@@ -283,6 +929,7 @@ namespace ojph {
   size_t j2c_infile::read(void *ptr, size_t size)
   {
     assert(fh);
+    trace_span span("read", "io", "bytes", (si64)size);
     return fread(ptr, 1, size, fh);
   }
 
@@ -290,6 +937,7 @@ namespace ojph {
   int j2c_infile::seek(si64 offset, enum infile_base::seek origin)
   {
     assert(fh);
+    trace_span span("seek", "io", "offset", offset);
     return ojph_fseek(fh, offset, origin);
   }
 
@@ -308,6 +956,347 @@ namespace ojph {
     fh = NULL;
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  //
+  //
+  // j2c_prefetch_infile
+  //
+  //
+  ////////////////////////////////////////////////////////////////////////////
+
+  ////////////////////////////////////////////////////////////////////////////
+  // Block i of the file, which starts at i * block_size, lives in slot
+  // i % num_blocks; the window holds blocks first to first+num_blocks-1.
+  // Only the caller assigns blocks to slots; the reader thread fills
+  // REQUESTED slots, and never touches READY ones.
+  struct j2c_prefetch_infile::prefetch_state
+  {
+    enum : ui32 { UNUSED = 0, REQUESTED = 1, BUSY = 2, READY = 3 };
+    struct slot
+    {
+      ui8 *data;
+      si64 index;       // the block held by this slot
+      size_t size;      // bytes read into data
+      ui32 status;
+    };
+
+    prefetch_state()
+    {
+      slots = NULL; num_blocks = 0; block_size = 0;
+      first = -1; pos = 0; file_size = 0;
+      cur = NULL; cur_start = cur_end = 0;
+      stop = false;
+#ifdef OJPH_OS_WINDOWS
+      fh = NULL;
+#else
+      fd = -1;
+#endif
+    }
+
+    slot& slot_of(si64 index) { return slots[index % (si64)num_blocks]; }
+    bool read_block(slot& s);
+    slot* next_request();
+    void run();
+    const slot* get_block(si64 index);
+    void finish();
+
+    slot *slots;
+    ui32 num_blocks;
+    size_t block_size;
+    si64 first;               // the first block of the window; -1 if none
+    si64 pos;                 // the read position
+    si64 file_size;
+    const ui8 *cur;           // data of the block holding pos, or NULL
+    si64 cur_start, cur_end;  // the file range held by cur
+    bool stop;                // the reader thread should exit
+#ifdef OJPH_OS_WINDOWS
+    FILE *fh;
+#else
+    int fd;
+#endif
+#ifndef OJPH_EMSCRIPTEN
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::thread reader;
+#endif
+  };
+
+  ////////////////////////////////////////////////////////////////////////////
+  bool j2c_prefetch_infile::prefetch_state::read_block(slot& s)
+  {
+    si64 offset = s.index * (si64)block_size;
+    size_t want = (size_t)ojph_min((si64)block_size, file_size - offset);
+    s.size = 0;
+#ifdef OJPH_OS_WINDOWS
+    if (ojph_fseek(fh, offset, SEEK_SET) != 0)
+      return false;
+    s.size = fread(s.data, 1, want, fh);
+#else
+    while (s.size < want)
+    {
+      ssize_t result = pread(fd, s.data + s.size, want - s.size,
+                             (off_t)(offset + (si64)s.size));
+      if (result < 0 && errno == EINTR)
+        continue;
+      if (result <= 0)
+        break;
+      s.size += (size_t)result;
+    }
+#endif
+    return s.size == want;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  j2c_prefetch_infile::prefetch_state::slot*
+  j2c_prefetch_infile::prefetch_state::next_request()
+  {
+    // the requested block nearest to the read position goes first
+    slot *s = NULL;
+    for (ui32 i = 0; i < num_blocks; ++i)
+      if (slots[i].status == REQUESTED
+          && (s == NULL || slots[i].index < s->index))
+        s = slots + i;
+    return s;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void j2c_prefetch_infile::prefetch_state::run()
+  {
+#ifndef OJPH_EMSCRIPTEN
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+      slot *s = NULL;
+      cv.wait(lock, [this, &s] {
+        s = next_request(); return stop || s != NULL; });
+      if (stop)
+        break;
+      s->status = BUSY;
+      lock.unlock();
+      read_block(*s); // a short block reads as the end of the file
+      lock.lock();
+      s->status = READY;
+      cv.notify_all();
+    }
+#endif
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  const j2c_prefetch_infile::prefetch_state::slot*
+  j2c_prefetch_infile::prefetch_state::get_block(si64 index)
+  {
+#ifdef OJPH_EMSCRIPTEN
+    slot &s = slot_of(index); // no threads; read on demand
+    if (s.index != index || s.status != READY)
+    {
+      s.index = index;
+      read_block(s);
+      s.status = READY;
+    }
+    return &s;
+#else
+    std::unique_lock<std::mutex> lock(mutex);
+    auto assign = [this, &lock](slot &s, si64 i) {
+      cv.wait(lock, [&s] { return s.status != BUSY; });
+      s.index = i;
+      s.size = 0;
+      s.status = i * (si64)block_size < file_size ? REQUESTED : UNUSED;
+    };
+    if (first >= 0 && index >= first && index < first + (si64)num_blocks)
+    { // slide the window; blocks behind index are reused ahead of it
+      for (si64 i = first; i < index; ++i)
+        assign(slot_of(i), i + (si64)num_blocks);
+    }
+    else
+    { // a jump; restart reading ahead from index
+      for (si64 i = index; i < index + (si64)num_blocks; ++i)
+        assign(slot_of(i), i);
+    }
+    first = index;
+    cv.notify_all();
+    slot &s = slot_of(index);
+    cv.wait(lock, [&s] { return s.status == READY; });
+    return &s;
+#endif
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void j2c_prefetch_infile::prefetch_state::finish()
+  {
+#ifndef OJPH_EMSCRIPTEN
+    if (reader.joinable())
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+      }
+      cv.notify_all();
+      reader.join();
+    }
+#endif
+#ifdef OJPH_OS_WINDOWS
+    if (fh != NULL)
+      fclose(fh);
+    fh = NULL;
+#else
+    if (fd >= 0)
+      ::close(fd);
+    fd = -1;
+#endif
+    if (slots)
+    {
+      for (ui32 i = 0; i < num_blocks; ++i)
+        if (slots[i].data)
+          ojph_aligned_free(slots[i].data);
+      delete[] slots;
+    }
+    slots = NULL;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  j2c_prefetch_infile::~j2c_prefetch_infile()
+  {
+    if (state)
+    {
+      state->finish();
+      delete state;
+    }
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void j2c_prefetch_infile::open(const char *filename, size_t block_size,
+                                 ui32 num_blocks)
+  {
+    assert(state == NULL);
+    prefetch_state *st = new prefetch_state;
+    block_size = ojph_max((block_size + 4095) & ~(size_t)4095, (size_t)4096);
+    num_blocks = ojph_max(num_blocks, 2u);
+    st->block_size = block_size;
+    st->num_blocks = num_blocks;
+    st->slots = new prefetch_state::slot[num_blocks];
+    for (ui32 i = 0; i < num_blocks; ++i)
+    {
+      prefetch_state::slot &s = st->slots[i];
+      s.index = -1;
+      s.size = 0;
+      s.status = prefetch_state::UNUSED;
+      s.data = (ui8*)ojph_aligned_malloc(4096, block_size);
+    }
+    for (ui32 i = 0; i < num_blocks; ++i)
+      if (st->slots[i].data == NULL)
+      {
+        st->finish();
+        delete st;
+        OJPH_ERROR(0x00060043, "failed to allocate %zu bytes for reading "
+          "%s", block_size, filename);
+      }
+
+#ifdef OJPH_OS_WINDOWS
+    st->fh = fopen(filename, "rb");
+    bool opened = st->fh != NULL;
+    if (opened && ojph_fseek(st->fh, 0, SEEK_END) == 0)
+      st->file_size = ojph_ftell(st->fh);
+    bool sized = opened && st->file_size >= 0;
+#else
+    st->fd = ::open(filename, O_RDONLY);
+    bool opened = st->fd >= 0;
+    struct stat sb;
+    bool sized = opened && fstat(st->fd, &sb) == 0;
+    if (sized)
+      st->file_size = (si64)sb.st_size;
+  #ifdef POSIX_FADV_SEQUENTIAL
+    if (sized)
+      posix_fadvise(st->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+  #endif
+#endif
+    if (!opened || !sized)
+    {
+      st->finish();
+      delete st;
+      if (!opened) {
+        OJPH_ERROR(0x00060041, "failed to open %s for reading", filename);
+      }
+      else {
+        OJPH_ERROR(0x00060042, "failed to obtain the size of %s",
+          filename);
+      }
+    }
+
+#ifndef OJPH_EMSCRIPTEN
+    st->reader = std::thread(&prefetch_state::run, st);
+#endif
+    state = st;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  size_t j2c_prefetch_infile::read(void *ptr, size_t size)
+  {
+    assert(state);
+    prefetch_state *st = state;
+    ui8 *dp = (ui8*)ptr;
+    size_t total = 0;
+    while (size > 0 && st->pos < st->file_size)
+    {
+      if (st->pos < st->cur_start || st->pos >= st->cur_end)
+      { // pos is not in the current block
+        si64 index = st->pos / (si64)st->block_size;
+        const prefetch_state::slot *s = st->get_block(index);
+        st->cur = s->data;
+        st->cur_start = index * (si64)st->block_size;
+        st->cur_end = st->cur_start + (si64)s->size;
+        if (st->pos >= st->cur_end) // the block is short; a read error
+          break;
+      }
+      size_t n = (size_t)ojph_min((si64)size, st->cur_end - st->pos);
+      memcpy(dp, st->cur + (st->pos - st->cur_start), n);
+      dp += n;
+      size -= n;
+      total += n;
+      st->pos += (si64)n;
+    }
+    return total;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  int j2c_prefetch_infile::seek(si64 offset, enum infile_base::seek origin)
+  {
+    assert(state);
+    si64 target = offset;
+    if (origin == OJPH_SEEK_CUR)
+      target += state->pos;
+    else if (origin == OJPH_SEEK_END)
+      target += state->file_size;
+    else if (origin != OJPH_SEEK_SET)
+      return -1;
+    if (target < 0)
+      return -1;
+    state->pos = target; // the window follows on the next read
+    return 0;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  si64 j2c_prefetch_infile::tell()
+  {
+    assert(state);
+    return state->pos;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  bool j2c_prefetch_infile::eof()
+  {
+    assert(state);
+    return state->pos >= state->file_size;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void j2c_prefetch_infile::close()
+  {
+    assert(state);
+    state->finish();
+    delete state;
+    state = NULL;
+  }
+
 
   ////////////////////////////////////////////////////////////////////////////
   //
@@ -334,11 +1323,12 @@ namespace ojph {
   }
 
   ////////////////////////////////////////////////////////////////////////////
-  void mem_infile::open(const ui8* data, size_t size)
+  void mem_infile::open(const ui8* data, size_t size, bool persistent)
   {
     assert(this->data == NULL);
     cur_ptr = this->data = data;
     this->size = size;
+    this->persistent = persistent;
   }
 
   ////////////////////////////////////////////////////////////////////////////
@@ -397,6 +1387,81 @@ namespace ojph {
     std::swap(this->data,other.data);
     std::swap(this->cur_ptr,other.cur_ptr);
     std::swap(this->size,other.size);
+    std::swap(this->persistent,other.persistent);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  //
+  //
+  //
+  //
+  //
+  ////////////////////////////////////////////////////////////////////////////
+
+  ////////////////////////////////////////////////////////////////////////////
+  void mmap_infile::open(const char *filename)
+  {
+    assert(map_addr == NULL);
+#ifdef OJPH_OS_WINDOWS
+    HANDLE fh = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (fh == INVALID_HANDLE_VALUE)
+      OJPH_ERROR(0x00060011, "failed to open %s for reading", filename);
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(fh, &file_size) || file_size.QuadPart == 0) {
+      CloseHandle(fh);
+      OJPH_ERROR(0x00060012, "failed to map %s; the file is empty or its "
+        "size cannot be obtained", filename);
+    }
+    HANDLE mh = CreateFileMappingA(fh, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(fh); // the mapping keeps the file open
+    void *p = mh ? MapViewOfFile(mh, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (p == NULL) {
+      if (mh)
+        CloseHandle(mh);
+      OJPH_ERROR(0x00060013, "failed to map %s into memory", filename);
+    }
+    map_handle = mh;
+    map_size = (size_t)file_size.QuadPart;
+#else
+    int fd = ::open(filename, O_RDONLY);
+    if (fd == -1)
+      OJPH_ERROR(0x00060011, "failed to open %s for reading", filename);
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+      ::close(fd);
+      OJPH_ERROR(0x00060012, "failed to map %s; the file is empty or its "
+        "size cannot be obtained", filename);
+    }
+    void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps the file open
+    if (p == MAP_FAILED)
+      OJPH_ERROR(0x00060013, "failed to map %s into memory", filename);
+  #ifdef POSIX_MADV_SEQUENTIAL
+    // the codestream is read mostly front to back
+    posix_madvise(p, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+  #endif
+    map_size = (size_t)st.st_size;
+#endif
+    map_addr = p;
+    mem_infile::open((const ui8*)map_addr, map_size, true);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void mmap_infile::close()
+  {
+    mem_infile::close();
+    if (map_addr == NULL)
+      return;
+#ifdef OJPH_OS_WINDOWS
+    UnmapViewOfFile(map_addr);
+    CloseHandle((HANDLE)map_handle);
+#else
+    munmap(map_addr, map_size);
+#endif
+    map_addr = NULL;
+    map_handle = NULL;
+    map_size = 0;
   }
 
 }
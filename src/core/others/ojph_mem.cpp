@@ -36,9 +36,18 @@
 //***************************************************************************/
 
 
+#include <atomic>
+#include <functional>
+#include <mutex>
 #include <new>
+#include <thread>
+
 #include "ojph_mem.h"
 
+#ifdef OJPH_OS_LINUX
+  #include <sys/mman.h>
+#endif
+
 namespace ojph {
 
   ////////////////////////////////////////////////////////////////////////////
@@ -49,6 +58,16 @@ namespace ojph {
   //
   ////////////////////////////////////////////////////////////////////////////
 
+  ////////////////////////////////////////////////////////////////////////////
+  template<>
+  void line_buf::wrap(si16 *buffer, size_t num_ele, ui32 pre_size)
+  {
+    this->i16 = buffer;
+    this->size = num_ele;
+    this->pre_size = pre_size;
+    this->flags = LFT_16BIT | LFT_INTEGER;
+  }
+
   ////////////////////////////////////////////////////////////////////////////
   template<>
   void line_buf::wrap(si32 *buffer, size_t num_ele, ui32 pre_size)
@@ -87,6 +106,190 @@ namespace ojph {
   //
   ////////////////////////////////////////////////////////////////////////////
 
+  ////////////////////////////////////////////////////////////////////////////
+  void mem_fixed_allocator::set_placement(ui32 flags,
+                                          const mem_store_hooks* hooks)
+  {
+    if (!preallocation)
+      OJPH_ERROR(0x00090004, "memory placement must be set before create() "
+        "or write_headers(), or after restart()");
+    placement = flags;
+    if (hooks != NULL)
+      this->hooks = *hooks;
+    else {
+      this->hooks.alloc = NULL;
+      this->hooks.free = NULL;
+      this->hooks.context = NULL;
+    }
+    // a store allocated differently is replaced at the next alloc()
+    release_store();
+    allocated_data = 0;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void* mem_fixed_allocator::acquire_store(size_t size)
+  {
+    assert(store == NULL);
+    store_placement = placement;
+    store_hooks = hooks;
+    store_mapped = 0;
+
+    void *p = NULL;
+    const bool use_hooks = hooks.alloc != NULL && hooks.free != NULL;
+    if (use_hooks)
+      p = hooks.alloc(size, hooks.context);
+#ifdef OJPH_OS_LINUX
+    else if (placement & (OJPH_MEM_HUGE_PAGES | OJPH_MEM_HUGETLB))
+    {
+      // mappings must be a multiple of the huge page size
+      const size_t huge_page = (size_t)2 << 20;
+      size_t mapped = (size + huge_page - 1) & ~(huge_page - 1);
+      void *t = MAP_FAILED;
+    #ifdef MAP_HUGETLB
+      if (placement & OJPH_MEM_HUGETLB) // fails if none are reserved
+        t = mmap(NULL, mapped, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    #endif
+      if (t == MAP_FAILED)
+      {
+        t = mmap(NULL, mapped, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    #ifdef MADV_HUGEPAGE
+        if (t != MAP_FAILED)
+          madvise(t, mapped, MADV_HUGEPAGE);
+    #endif
+      }
+      if (t != MAP_FAILED)
+      {
+        p = t;
+        store_mapped = mapped;
+      }
+    }
+#endif
+    if (p == NULL && !use_hooks) // also when huge pages are not available
+      p = malloc(size);
+
+    if (p != NULL && (placement & OJPH_MEM_LOCAL_NODE) && !use_hooks)
+    { // the first write to a page places it; write one byte per 4KB
+      volatile ui8 *b = (volatile ui8*)p;
+      for (size_t i = 0; i < size; i += 4096)
+        b[i] = 0;
+    }
+    return p;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void mem_fixed_allocator::release_store()
+  {
+    if (store == NULL)
+      return;
+    if (store_hooks.alloc != NULL && store_hooks.free != NULL)
+      store_hooks.free(store, allocated_data, store_hooks.context);
+#ifdef OJPH_OS_LINUX
+    else if (store_mapped != 0)
+      munmap(store, store_mapped);
+#endif
+    else
+      free(store);
+    store = NULL;
+    store_mapped = 0;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  // Idle stores are kept in shards, each with its own lock, so that threads
+  // returning and borrowing stores at the same time rarely wait for one
+  // another; a thread starts with the shard its id hashes to.
+  struct mem_elastic_allocator::shared_pool
+  {
+    static const int num_shards = 8;
+
+    struct shard
+    {
+      shard() : list(NULL) {}
+      std::mutex mutex;
+      stores_list *list;
+    };
+
+    shared_pool() : idle_bytes(0), max_idle_bytes((size_t)256 << 20) {}
+
+    // never destroyed, so that allocators destroyed at exit can use it
+    static shared_pool& get()
+    {
+      static shared_pool *pool = new shared_pool;
+      return *pool;
+    }
+
+    static int home_shard()
+    {
+      size_t h = std::hash<std::thread::id>()(std::this_thread::get_id());
+      return (int)(h % num_shards);
+    }
+
+    stores_list* acquire(ui32 bytes)
+    {
+      if (idle_bytes.load(std::memory_order_relaxed) == 0)
+        return NULL;
+      int h = home_shard();
+      for (int i = 0; i < num_shards; ++i)
+      {
+        shard& s = shards[(h + i) % num_shards];
+        std::lock_guard<std::mutex> lock(s.mutex);
+        for (stores_list **p = &s.list; *p != NULL; p = &(*p)->next_store)
+          if ((*p)->orig_size >= bytes)
+          {
+            stores_list *t = *p;
+            *p = t->next_store;
+            t->next_store = NULL;
+            idle_bytes -= stores_list::eval_store_bytes(t->orig_size);
+            return t;
+          }
+      }
+      return NULL;
+    }
+
+    // takes a chain of stores; those beyond max_idle_bytes are freed
+    void release(stores_list *list)
+    {
+      shard& s = shards[home_shard()];
+      while (list)
+      {
+        stores_list *t = list;
+        list = list->next_store;
+        size_t bytes = stores_list::eval_store_bytes(t->orig_size);
+        if (idle_bytes.fetch_add(bytes) + bytes > max_idle_bytes.load())
+        {
+          idle_bytes -= bytes;
+          free(t);
+          continue;
+        }
+        std::lock_guard<std::mutex> lock(s.mutex);
+        t->next_store = s.list;
+        s.list = t;
+      }
+    }
+
+    // frees idle stores until no more than max_bytes are kept
+    void trim(size_t max_bytes)
+    {
+      for (int i = 0; i < num_shards; ++i)
+      {
+        shard& s = shards[i];
+        std::lock_guard<std::mutex> lock(s.mutex);
+        while (s.list != NULL && idle_bytes.load() > max_bytes)
+        {
+          stores_list *t = s.list;
+          s.list = t->next_store;
+          idle_bytes -= stores_list::eval_store_bytes(t->orig_size);
+          free(t);
+        }
+      }
+    }
+
+    shard shards[num_shards];
+    std::atomic<size_t> idle_bytes;
+    std::atomic<size_t> max_idle_bytes;
+  };
+
   ////////////////////////////////////////////////////////////////////////////
   mem_elastic_allocator::stores_list*
   mem_elastic_allocator::allocate(mem_elastic_allocator::stores_list** list,
@@ -102,9 +305,28 @@ namespace ojph {
     }
     else
     {
-      ui32 store_bytes = stores_list::eval_store_bytes(bytes);
-      *list = (stores_list*) malloc(store_bytes);
+      stores_list *t = shared ? shared_pool::get().acquire(bytes) : NULL;
+      ui32 store_bytes = stores_list::eval_store_bytes(t ? t->orig_size
+                                                         : bytes);
+      if (limit != 0 && total_allocated + store_bytes > limit)
+      {
+        if (t)
+          shared_pool::get().release(t);
+        OJPH_ERROR(0x00090002, "storing coded data needs more than the "
+          "%zu bytes left in the memory budget", limit);
+      }
       total_allocated += store_bytes;
+      ++growth_count;
+      growth_bytes += store_bytes;
+      if (t)
+      {
+        t->restart();
+        *list = t;
+        return *list;
+      }
+      *list = (stores_list*) malloc(store_bytes);
+      if (*list == NULL)
+        OJPH_ERROR(0x00090003, "malloc failed (%u bytes)", store_bytes);
       return new (*list) stores_list(bytes);
     }
   }
@@ -132,6 +354,15 @@ namespace ojph {
   ////////////////////////////////////////////////////////////////////////////
   void mem_elastic_allocator::restart()
   {
+    if (shared)
+    {
+      for (stores_list *t = store; t != NULL; t = t->next_store)
+        total_allocated -= stores_list::eval_store_bytes(t->orig_size);
+      shared_pool::get().release(store);
+      cur_store = store = NULL;
+      return;
+    }
+
     // move to the end of avail
     stores_list** p = &avail;
     while (*p != NULL)
@@ -140,4 +371,54 @@ namespace ojph {
     cur_store = store = NULL;
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  void mem_elastic_allocator::set_shared(bool shared)
+  {
+    if (shared && !this->shared)
+    { // stores kept for reuse by this allocator go to the pool
+      for (stores_list *t = avail; t != NULL; t = t->next_store)
+        total_allocated -= stores_list::eval_store_bytes(t->orig_size);
+      shared_pool::get().release(avail);
+      avail = NULL;
+    }
+    this->shared = shared;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void mem_elastic_allocator::set_pool_limit(size_t bytes)
+  {
+    shared_pool::get().max_idle_bytes = bytes;
+    shared_pool::get().trim(bytes);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  size_t mem_elastic_allocator::get_pool_size()
+  {
+    return shared_pool::get().idle_bytes.load();
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void mem_elastic_allocator::trim_pool()
+  {
+    shared_pool::get().trim(0);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void set_shared_pool_limit(size_t bytes)
+  {
+    mem_elastic_allocator::set_pool_limit(bytes);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  size_t get_shared_pool_size()
+  {
+    return mem_elastic_allocator::get_pool_size();
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void trim_shared_pool()
+  {
+    mem_elastic_allocator::trim_pool();
+  }
+
 }
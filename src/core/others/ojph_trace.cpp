@@ -0,0 +1,258 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2026, Aous Naman
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_trace.cpp
+// Author: Aous Naman
+// Date: 19 October 2026
+//***************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "ojph_arch.h"
+#ifndef OJPH_EMSCRIPTEN
+  #include <mutex>
+#endif
+
+#include "ojph_trace.h"
+
+namespace ojph {
+
+  namespace local {
+
+    //////////////////////////////////////////////////////////////////////////
+    struct trace_event
+    {
+      const char *name, *cat, *arg0_name, *arg1_name;
+      si64 arg0, arg1;
+      ui64 start, duration;  // in nanoseconds
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    // The spans of one thread; only that thread adds to them, and only
+    // trace_start() and trace_stop() read or clear them.  The mutex is
+    // only contended when these run while the thread records.
+    struct trace_thread
+    {
+      ui32 id;
+      const char *name;
+      std::vector<trace_event> events;
+#ifndef OJPH_EMSCRIPTEN
+      std::mutex mutex;
+#endif
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    struct trace_state
+    {
+      trace_state() : enabled(false), file(NULL) {}
+
+      // never destroyed, so that threads that outlive main can still
+      // reach it; threads keep pointers to their trace_thread, so these
+      // are never freed either
+      static trace_state& get()
+      {
+        static trace_state *state = new trace_state;
+        return *state;
+      }
+
+      std::atomic<bool> enabled;
+      std::chrono::steady_clock::time_point origin;
+      FILE *file;
+      std::vector<trace_thread*> threads;
+#ifndef OJPH_EMSCRIPTEN
+      std::mutex mutex;
+#endif
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    static thread_local trace_thread *this_thread = NULL;
+
+    //////////////////////////////////////////////////////////////////////////
+    static trace_thread* get_trace_thread()
+    {
+      if (this_thread == NULL)
+      {
+        trace_state& state = trace_state::get();
+#ifndef OJPH_EMSCRIPTEN
+        std::lock_guard<std::mutex> lock(state.mutex);
+#endif
+        trace_thread *t = new trace_thread;
+        t->id = (ui32)state.threads.size() + 1;
+        t->name = NULL;
+        state.threads.push_back(t);
+        this_thread = t;
+      }
+      return this_thread;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // writes one span as a complete ("X") trace event
+    static void write_event(FILE *f, const trace_thread *t,
+                            const trace_event& e, bool first)
+    {
+      fprintf(f, "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\","
+        "\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u", first ? "" : ",",
+        e.name, e.cat, (double)e.start * 1e-3, (double)e.duration * 1e-3,
+        t->id);
+      if (e.arg0_name != NULL || e.arg1_name != NULL)
+      {
+        fprintf(f, ",\"args\":{");
+        if (e.arg0_name != NULL)
+          fprintf(f, "\"%s\":%lld", e.arg0_name, (long long)e.arg0);
+        if (e.arg1_name != NULL)
+          fprintf(f, "%s\"%s\":%lld", e.arg0_name != NULL ? "," : "",
+            e.arg1_name, (long long)e.arg1);
+        fprintf(f, "}");
+      }
+      fprintf(f, "}");
+    }
+
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  bool trace_start(const char *filename)
+  {
+    local::trace_state& state = local::trace_state::get();
+    trace_stop();
+
+    FILE *f = fopen(filename, "w");
+    if (f == NULL)
+      return false;
+#ifndef OJPH_EMSCRIPTEN
+    std::lock_guard<std::mutex> lock(state.mutex);
+#endif
+    for (size_t i = 0; i < state.threads.size(); ++i)
+    {
+      local::trace_thread *t = state.threads[i];
+#ifndef OJPH_EMSCRIPTEN
+      std::lock_guard<std::mutex> thread_lock(t->mutex);
+#endif
+      t->events.clear();
+    }
+    state.file = f;
+    state.origin = std::chrono::steady_clock::now();
+    state.enabled.store(true, std::memory_order_release);
+    return true;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  bool trace_stop()
+  {
+    local::trace_state& state = local::trace_state::get();
+    if (!state.enabled.exchange(false))
+      return true;
+
+#ifndef OJPH_EMSCRIPTEN
+    std::lock_guard<std::mutex> lock(state.mutex);
+#endif
+    FILE *f = state.file;
+    state.file = NULL;
+    bool first = true;
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (size_t i = 0; i < state.threads.size(); ++i)
+    {
+      local::trace_thread *t = state.threads[i];
+#ifndef OJPH_EMSCRIPTEN
+      std::lock_guard<std::mutex> thread_lock(t->mutex);
+#endif
+      if (t->events.empty())
+        continue;
+      if (t->name != NULL)
+      {
+        fprintf(f, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+          "\"tid\":%u,\"args\":{\"name\":\"%s\"}}", first ? "" : ",",
+          t->id, t->name);
+        first = false;
+      }
+      for (size_t j = 0; j < t->events.size(); ++j, first = false)
+        local::write_event(f, t, t->events[j], first);
+      t->events.clear();
+      t->events.shrink_to_fit();
+    }
+    fprintf(f, "\n]}\n");
+    bool ok = ferror(f) == 0;
+    return (fclose(f) == 0) && ok;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  bool trace_is_enabled()
+  {
+    // pairs with the release in trace_start(), so that origin and the
+    // buffers are seen as they were set up
+    return local::trace_state::get().enabled.load(std::memory_order_acquire);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void trace_set_thread_name(const char *name)
+  {
+    local::trace_thread *t = local::get_trace_thread();
+#ifndef OJPH_EMSCRIPTEN
+    std::lock_guard<std::mutex> lock(t->mutex);
+#endif
+    t->name = name;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  ui64 trace_now()
+  {
+    using namespace std::chrono;
+    return (ui64)duration_cast<nanoseconds>(steady_clock::now() -
+      local::trace_state::get().origin).count();
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void trace_add_span(const char *name, const char *cat, ui64 start,
+                      const char *arg0_name, si64 arg0,
+                      const char *arg1_name, si64 arg1)
+  {
+    ui64 end = trace_now();
+    if (end < start)
+      return; // tracing restarted while the span was open
+    local::trace_event e;
+    e.name = name;
+    e.cat = cat;
+    e.arg0_name = arg0_name;
+    e.arg0 = arg0;
+    e.arg1_name = arg1_name;
+    e.arg1 = arg1;
+    e.start = start;
+    e.duration = end - start;
+    local::trace_thread *t = local::get_trace_thread();
+#ifndef OJPH_EMSCRIPTEN
+    std::lock_guard<std::mutex> lock(t->mutex);
+#endif
+    if (trace_is_enabled()) // tracing may have stopped meanwhile
+      t->events.push_back(e);
+  }
+
+}
@@ -85,6 +85,46 @@ namespace ojph {
       const line_buf *src_line, ui32 src_line_offset,
       line_buf *dst_line, ui32 bit_depth, bool is_signed, ui32 width) = NULL;
 
+    //////////////////////////////////////////////////////////////////////////
+    void (*cnvrt_8b_to_si32)
+      (const void *sp, ui32 step, bool is_signed, si32 *dp, ui32 width)
+      = NULL;
+
+    //////////////////////////////////////////////////////////////////////////
+    void (*cnvrt_16b_to_si32)
+      (const void *sp, ui32 step, bool is_signed, bool swap, si32 *dp,
+       ui32 width) = NULL;
+
+    //////////////////////////////////////////////////////////////////////////
+    void (*cnvrt_si32_to_8b)
+      (const si32 *sp, si32 shift, void *dp, ui32 step, si32 low, si32 high,
+       ui32 width) = NULL;
+
+    //////////////////////////////////////////////////////////////////////////
+    void (*cnvrt_si32_to_16b)
+      (const si32 *sp, si32 shift, void *dp, ui32 step, si32 low, si32 high,
+       bool swap, ui32 width) = NULL;
+
+    //////////////////////////////////////////////////////////////////////////
+    void (*cnvrt_si16_to_8b)
+      (const si16 *sp, si32 shift, void *dp, ui32 step, si32 low, si32 high,
+       ui32 width) = NULL;
+
+    //////////////////////////////////////////////////////////////////////////
+    void (*cnvrt_si16_to_16b)
+      (const si16 *sp, si32 shift, void *dp, ui32 step, si32 low, si32 high,
+       bool swap, ui32 width) = NULL;
+
+    //////////////////////////////////////////////////////////////////////////
+    void (*cnvrt_f32_to_8b)
+      (const float *sp, float mul, si32 shift, void *dp, ui32 step,
+       si32 low, si32 high, ui32 width) = NULL;
+
+    //////////////////////////////////////////////////////////////////////////
+    void (*cnvrt_f32_to_16b)
+      (const float *sp, float mul, si32 shift, void *dp, ui32 step,
+       si32 low, si32 high, bool swap, ui32 width) = NULL;
+
     //////////////////////////////////////////////////////////////////////////
     void (*rct_forward)
       (const line_buf* r, const line_buf* g, const line_buf* b,
@@ -108,8 +148,22 @@ namespace ojph {
     //////////////////////////////////////////////////////////////////////////
     void init_colour_transform_functions()
     {
-      static std::once_flag colour_transform_functions_init_flag;
-      std::call_once(colour_transform_functions_init_flag, []() {
+      // re-dispatched whenever the effective cpu extension level changes,
+      // which only happens through set_max_cpu_ext_level()
+      static std::mutex init_mutex;
+      static int init_level = -1;
+      std::lock_guard<std::mutex> lock(init_mutex);
+      if (init_level == get_cpu_ext_level())
+        return;
+      init_level = get_cpu_ext_level();
+      {
+        cnvrt_8b_to_si32 = gen_cnvrt_8b_to_si32;
+        cnvrt_16b_to_si32 = gen_cnvrt_16b_to_si32;
+        cnvrt_si32_to_8b = gen_cnvrt_si32_to_8b;
+        cnvrt_si32_to_16b = gen_cnvrt_si32_to_16b;
+        cnvrt_si16_to_8b = gen_cnvrt_si16_to_8b;
+        cnvrt_si16_to_16b = gen_cnvrt_si16_to_16b;
+
 #if !defined(OJPH_ENABLE_WASM_SIMD) || !defined(OJPH_EMSCRIPTEN)
 
         rev_convert = gen_rev_convert;
@@ -122,6 +176,10 @@ namespace ojph {
         rct_backward = gen_rct_backward;
         ict_forward = gen_ict_forward;
         ict_backward = gen_ict_backward;
+        // the float conversions round as irv_convert_to_integer() does;
+        // they are left out wherever it has no counterpart to them
+        cnvrt_f32_to_8b = gen_cnvrt_f32_to_8b;
+        cnvrt_f32_to_16b = gen_cnvrt_f32_to_16b;
 
   #ifndef OJPH_DISABLE_SIMD
 
@@ -148,6 +206,14 @@ namespace ojph {
             sse2_irv_convert_to_float_nlt_type3;
           rct_forward = sse2_rct_forward;
           rct_backward = sse2_rct_backward;
+          cnvrt_8b_to_si32 = sse2_cnvrt_8b_to_si32;
+          cnvrt_16b_to_si32 = sse2_cnvrt_16b_to_si32;
+          cnvrt_si32_to_8b = sse2_cnvrt_si32_to_8b;
+          cnvrt_si32_to_16b = sse2_cnvrt_si32_to_16b;
+          cnvrt_si16_to_8b = sse2_cnvrt_si16_to_8b;
+          cnvrt_si16_to_16b = sse2_cnvrt_si16_to_16b;
+          cnvrt_f32_to_8b = sse2_cnvrt_f32_to_8b;
+          cnvrt_f32_to_16b = sse2_cnvrt_f32_to_16b;
         }
       #endif // !OJPH_DISABLE_SSE2
 
@@ -172,6 +238,14 @@ namespace ojph {
             avx2_irv_convert_to_float_nlt_type3;
           rct_forward = avx2_rct_forward;
           rct_backward = avx2_rct_backward;
+          cnvrt_8b_to_si32 = avx2_cnvrt_8b_to_si32;
+          cnvrt_16b_to_si32 = avx2_cnvrt_16b_to_si32;
+          cnvrt_si32_to_8b = avx2_cnvrt_si32_to_8b;
+          cnvrt_si32_to_16b = avx2_cnvrt_si32_to_16b;
+          cnvrt_si16_to_8b = avx2_cnvrt_si16_to_8b;
+          cnvrt_si16_to_16b = avx2_cnvrt_si16_to_16b;
+          cnvrt_f32_to_8b = avx2_cnvrt_f32_to_8b;
+          cnvrt_f32_to_16b = avx2_cnvrt_f32_to_16b;
         }
       #endif // !OJPH_DISABLE_AVX2
 
@@ -194,6 +268,8 @@ namespace ojph {
           rct_backward = vsx_rct_backward;
           ict_forward = vsx_ict_forward;
           ict_backward = vsx_ict_backward;
+          cnvrt_f32_to_8b = NULL;
+          cnvrt_f32_to_16b = NULL;
         }
 
     #endif // !(defined(OJPH_ARCH_X86_64) || defined(OJPH_ARCH_I386))
@@ -212,9 +288,11 @@ namespace ojph {
         rct_backward = wasm_rct_backward;
         ict_forward = wasm_ict_forward;
         ict_backward = wasm_ict_backward;
+        cnvrt_f32_to_8b = NULL;
+        cnvrt_f32_to_16b = NULL;
 
 #endif // !OJPH_ENABLE_WASM_SIMD
-      });
+      }
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -240,7 +318,25 @@ namespace ojph {
       line_buf *dst_line, const ui32 dst_line_offset,
       si64 shift, ui32 width)
     {
-      if (src_line->flags & line_buf::LFT_32BIT)
+      if (dst_line->flags & line_buf::LFT_16BIT)
+      {
+        assert(src_line->flags & line_buf::LFT_32BIT);
+        const si32 *sp = src_line->i32 + src_line_offset;
+        si16 *dp = dst_line->i16 + dst_line_offset;
+        si32 s = (si32)shift;
+        for (ui32 i = width; i > 0; --i)
+          *dp++ = (si16)(*sp++ + s);
+      }
+      else if (src_line->flags & line_buf::LFT_16BIT)
+      {
+        assert(dst_line->flags & line_buf::LFT_32BIT);
+        const si16 *sp = src_line->i16 + src_line_offset;
+        si32 *dp = dst_line->i32 + dst_line_offset;
+        si32 s = (si32)shift;
+        for (ui32 i = width; i > 0; --i)
+          *dp++ = *sp++ + s;
+      }
+      else if (src_line->flags & line_buf::LFT_32BIT)
       {
         if (dst_line->flags & line_buf::LFT_32BIT)
         {
@@ -275,7 +371,29 @@ namespace ojph {
       line_buf *dst_line, const ui32 dst_line_offset,
       si64 shift, ui32 width)
     {
-      if (src_line->flags & line_buf::LFT_32BIT)
+      if (dst_line->flags & line_buf::LFT_16BIT)
+      {
+        assert(src_line->flags & line_buf::LFT_32BIT);
+        const si32 *sp = src_line->i32 + src_line_offset;
+        si16 *dp = dst_line->i16 + dst_line_offset;
+        si32 s = (si32)shift;
+        for (ui32 i = width; i > 0; --i) {
+          const si32 v = *sp++;
+          *dp++ = (si16)(v >= 0 ? v : (- v - s));
+        }
+      }
+      else if (src_line->flags & line_buf::LFT_16BIT)
+      {
+        assert(dst_line->flags & line_buf::LFT_32BIT);
+        const si16 *sp = src_line->i16 + src_line_offset;
+        si32 *dp = dst_line->i32 + dst_line_offset;
+        si32 s = (si32)shift;
+        for (ui32 i = width; i > 0; --i) {
+          const si32 v = *sp++;
+          *dp++ = v >= 0 ? v : (- v - s);
+        }
+      }
+      else if (src_line->flags & line_buf::LFT_32BIT)
       {
         if (dst_line->flags & line_buf::LFT_32BIT)
         {
@@ -469,6 +587,24 @@ namespace ojph {
           *crp++ = (rr - gg);
         }
       }
+      else if (y->flags & line_buf::LFT_16BIT)
+      {
+        assert((y->flags  & line_buf::LFT_16BIT) &&
+               (cb->flags & line_buf::LFT_16BIT) &&
+               (cr->flags & line_buf::LFT_16BIT) &&
+               (r->flags  & line_buf::LFT_32BIT) &&
+               (g->flags  & line_buf::LFT_32BIT) &&
+               (b->flags  & line_buf::LFT_32BIT));
+        const si32 *rp = r->i32, *gp = g->i32, *bp = b->i32;
+        si16 *yp = y->i16, *cbp = cb->i16, *crp = cr->i16;
+        for (ui32 i = repeat; i > 0; --i)
+        {
+          si32 rr = *rp++, gg = *gp++, bb = *bp++;
+          *yp++ = (si16)((rr + (gg << 1) + bb) >> 2);
+          *cbp++ = (si16)(bb - gg);
+          *crp++ = (si16)(rr - gg);
+        }
+      }
       else
       {
         assert((y->flags  & line_buf::LFT_64BIT) &&
@@ -520,6 +656,25 @@ namespace ojph {
           *bp++ = cbb + gg;
         }
       }
+      else if (y->flags & line_buf::LFT_16BIT)
+      {
+        assert((y->flags  & line_buf::LFT_16BIT) &&
+               (cb->flags & line_buf::LFT_16BIT) &&
+               (cr->flags & line_buf::LFT_16BIT) &&
+               (r->flags  & line_buf::LFT_32BIT) &&
+               (g->flags  & line_buf::LFT_32BIT) &&
+               (b->flags  & line_buf::LFT_32BIT));
+        const si16 *yp = y->i16, *cbp = cb->i16, *crp = cr->i16;
+        si32 *rp = r->i32, *gp = g->i32, *bp = b->i32;
+        for (ui32 i = repeat; i > 0; --i)
+        {
+          si32 yy = *yp++, cbb = *cbp++, crr = *crp++;
+          si32 gg = yy - ((cbb + crr) >> 2);
+          *rp++ = crr + gg;
+          *gp++ = gg;
+          *bp++ = cbb + gg;
+        }
+      }
       else
       {
         assert((y->flags  & line_buf::LFT_64BIT) &&
@@ -569,5 +724,140 @@ namespace ojph {
 
 #endif // !OJPH_ENABLE_WASM_SIMD
 
+    //////////////////////////////////////////////////////////////////////////
+    void gen_cnvrt_8b_to_si32(const void *sp, ui32 step, bool is_signed,
+                              si32 *dp, ui32 width)
+    {
+      if (is_signed)
+      {
+        const si8 *p = (const si8*)sp;
+        for (ui32 i = width; i > 0; --i, p += step)
+          *dp++ = *p;
+      }
+      else
+      {
+        const ui8 *p = (const ui8*)sp;
+        for (ui32 i = width; i > 0; --i, p += step)
+          *dp++ = *p;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline ui16 gen_swap_16b(ui16 v)
+    { return (ui16)((v << 8) | (v >> 8)); }
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_cnvrt_16b_to_si32(const void *sp, ui32 step, bool is_signed,
+                               bool swap, si32 *dp, ui32 width)
+    {
+      const ui16 *p = (const ui16*)sp;
+      for (ui32 i = width; i > 0; --i, p += step)
+      {
+        ui16 v = swap ? gen_swap_16b(*p) : *p;
+        *dp++ = is_signed ? (si32)(si16)v : (si32)v;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_cnvrt_si32_to_8b(const si32 *sp, si32 shift, void *dp,
+                              ui32 step, si32 low, si32 high, ui32 width)
+    {
+      // clamping before shifting cannot overflow
+      low -= shift;
+      high -= shift;
+      ui8 *p = (ui8*)dp;
+      for (ui32 i = width; i > 0; --i, p += step)
+      {
+        si32 v = *sp++;
+        v = v < low ? low : (v > high ? high : v);
+        *p = (ui8)(v + shift);
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_cnvrt_si32_to_16b(const si32 *sp, si32 shift, void *dp,
+                               ui32 step, si32 low, si32 high, bool swap,
+                               ui32 width)
+    {
+      low -= shift;
+      high -= shift;
+      ui16 *p = (ui16*)dp;
+      for (ui32 i = width; i > 0; --i, p += step)
+      {
+        si32 v = *sp++;
+        v = v < low ? low : (v > high ? high : v);
+        ui16 u = (ui16)(v + shift);
+        *p = swap ? gen_swap_16b(u) : u;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_cnvrt_si16_to_8b(const si16 *sp, si32 shift, void *dp,
+                              ui32 step, si32 low, si32 high, ui32 width)
+    {
+      low -= shift;
+      high -= shift;
+      ui8 *p = (ui8*)dp;
+      for (ui32 i = width; i > 0; --i, p += step)
+      {
+        si32 v = *sp++;
+        v = v < low ? low : (v > high ? high : v);
+        *p = (ui8)(v + shift);
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_cnvrt_si16_to_16b(const si16 *sp, si32 shift, void *dp,
+                               ui32 step, si32 low, si32 high, bool swap,
+                               ui32 width)
+    {
+      low -= shift;
+      high -= shift;
+      ui16 *p = (ui16*)dp;
+      for (ui32 i = width; i > 0; --i, p += step)
+      {
+        si32 v = *sp++;
+        v = v < low ? low : (v > high ? high : v);
+        ui16 u = (ui16)(v + shift);
+        *p = swap ? gen_swap_16b(u) : u;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // Clamping to integer limits before rounding gives the same result as
+    // rounding first, and keeps the conversion to an integer in range;
+    // comparisons are written so that NaNs become low
+    void gen_cnvrt_f32_to_8b(const float *sp, float mul, si32 shift,
+                             void *dp, ui32 step, si32 low, si32 high,
+                             ui32 width)
+    {
+      const float lo = (float)(low - shift), hi = (float)(high - shift);
+      ui8 *p = (ui8*)dp;
+      for (ui32 i = width; i > 0; --i, p += step)
+      {
+        float t = *sp++ * mul;
+        t = t >= lo ? t : lo;
+        t = t <= hi ? t : hi;
+        *p = (ui8)(ojph_round(t) + shift);
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_cnvrt_f32_to_16b(const float *sp, float mul, si32 shift,
+                              void *dp, ui32 step, si32 low, si32 high,
+                              bool swap, ui32 width)
+    {
+      const float lo = (float)(low - shift), hi = (float)(high - shift);
+      ui16 *p = (ui16*)dp;
+      for (ui32 i = width; i > 0; --i, p += step)
+      {
+        float t = *sp++ * mul;
+        t = t >= lo ? t : lo;
+        t = t <= hi ? t : hi;
+        ui16 u = (ui16)(ojph_round(t) + shift);
+        *p = swap ? gen_swap_16b(u) : u;
+      }
+    }
+
   }
 }
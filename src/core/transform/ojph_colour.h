@@ -82,6 +82,56 @@ namespace ojph {
     const line_buf *src_line, ui32 src_line_offset,
     line_buf *dst_line, ui32 bit_depth, bool is_signed, ui32 width);
 
+  ////////////////////////////////////////////////////////////////////////////
+  // conversion between the 8- or 16-bit samples of a caller's frame and
+  // 32-bit integers; step is the distance between consecutive samples in
+  // the frame, in samples.  Frame samples are unsigned, or two's
+  // complement when is_signed is true; 16-bit samples are byte-swapped
+  // when swap is true
+  extern void (*cnvrt_8b_to_si32)
+    (const void *sp, ui32 step, bool is_signed, si32 *dp, ui32 width);
+
+  ////////////////////////////////////////////////////////////////////////////
+  extern void (*cnvrt_16b_to_si32)
+    (const void *sp, ui32 step, bool is_signed, bool swap, si32 *dp,
+     ui32 width);
+
+  ////////////////////////////////////////////////////////////////////////////
+  // stores sp[i] + shift, clamped to [low, high], which must fit in the
+  // frame sample; shift is no more than half the range of the sample
+  extern void (*cnvrt_si32_to_8b)
+    (const si32 *sp, si32 shift, void *dp, ui32 step, si32 low, si32 high,
+     ui32 width);
+
+  ////////////////////////////////////////////////////////////////////////////
+  extern void (*cnvrt_si32_to_16b)
+    (const si32 *sp, si32 shift, void *dp, ui32 step, si32 low, si32 high,
+     bool swap, ui32 width);
+
+  ////////////////////////////////////////////////////////////////////////////
+  // as above, for the 16 bit lines of low-precision lossless components
+  extern void (*cnvrt_si16_to_8b)
+    (const si16 *sp, si32 shift, void *dp, ui32 step, si32 low, si32 high,
+     ui32 width);
+
+  ////////////////////////////////////////////////////////////////////////////
+  extern void (*cnvrt_si16_to_16b)
+    (const si16 *sp, si32 shift, void *dp, ui32 step, si32 low, si32 high,
+     bool swap, ui32 width);
+
+  ////////////////////////////////////////////////////////////////////////////
+  // as above, for round(sp[i] * mul) + shift, rounding as
+  // irv_convert_to_integer() does; these are NULL where no such kernel
+  // is available
+  extern void (*cnvrt_f32_to_8b)
+    (const float *sp, float mul, si32 shift, void *dp, ui32 step,
+     si32 low, si32 high, ui32 width);
+
+  ////////////////////////////////////////////////////////////////////////////
+  extern void (*cnvrt_f32_to_16b)
+    (const float *sp, float mul, si32 shift, void *dp, ui32 step,
+     si32 low, si32 high, bool swap, ui32 width);
+
   ////////////////////////////////////////////////////////////////////////////
   extern void (*rct_forward)
     (const line_buf *r, const line_buf *g, const line_buf *b,
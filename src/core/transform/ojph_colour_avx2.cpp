@@ -44,6 +44,7 @@
 #include "ojph_defs.h"
 #include "ojph_mem.h"
 #include "ojph_colour.h"
+#include "ojph_colour_local.h"
 
 #include <immintrin.h>
 
@@ -63,6 +64,16 @@ namespace ojph {
       return result;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    // packs the 8 lanes of a into 16bit lanes keeping the 16 LSBs, like a
+    // C cast; _mm_packs_epi32 saturates, so we sign-extend the LSBs first
+    static inline __m128i avx2_cvt_epi32_epi16(__m256i a)
+    {
+      a = _mm256_srai_epi32(_mm256_slli_epi32(a, 16), 16);
+      return _mm_packs_epi32(_mm256_castsi256_si128(a),
+                             _mm256_extracti128_si256(a, 1));
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void avx2_rev_convert(const line_buf *src_line,
                           const ui32 src_line_offset,
@@ -70,7 +81,34 @@ namespace ojph {
                           const ui32 dst_line_offset,
                           si64 shift, ui32 width)
     {
-      if (src_line->flags & line_buf::LFT_32BIT)
+      if (dst_line->flags & line_buf::LFT_16BIT)
+      {
+        assert(src_line->flags & line_buf::LFT_32BIT);
+        const si32 *sp = src_line->i32 + src_line_offset;
+        si16 *dp = dst_line->i16 + dst_line_offset;
+        __m256i sh = _mm256_set1_epi32((si32)shift);
+        for (int i = (width + 7) >> 3; i > 0; --i, sp+=8, dp+=8)
+        {
+          __m256i s = _mm256_loadu_si256((__m256i*)sp);
+          s = _mm256_add_epi32(s, sh);
+          _mm_storeu_si128((__m128i*)dp, avx2_cvt_epi32_epi16(s));
+        }
+      }
+      else if (src_line->flags & line_buf::LFT_16BIT)
+      {
+        assert(dst_line->flags & line_buf::LFT_32BIT);
+        const si16 *sp = src_line->i16 + src_line_offset;
+        si32 *dp = dst_line->i32 + dst_line_offset;
+        __m256i sh = _mm256_set1_epi32((si32)shift);
+        for (int i = (width + 7) >> 3; i > 0; --i, sp+=8, dp+=8)
+        {
+          __m256i s;
+          s = _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i*)sp));
+          s = _mm256_add_epi32(s, sh);
+          _mm256_storeu_si256((__m256i*)dp, s);
+        }
+      }
+      else if (src_line->flags & line_buf::LFT_32BIT)
       {
         if (dst_line->flags & line_buf::LFT_32BIT)
         {
@@ -142,7 +180,47 @@ namespace ojph {
                                     const ui32 dst_line_offset,
                                     si64 shift, ui32 width)
     {
-      if (src_line->flags & line_buf::LFT_32BIT)
+      if ((src_line->flags | dst_line->flags) & line_buf::LFT_16BIT)
+      {
+        // one side is 16bit, the other is 32bit
+        __m256i sh = _mm256_set1_epi32((si32)(-shift));
+        __m256i zero = _mm256_setzero_si256();
+        if (dst_line->flags & line_buf::LFT_16BIT)
+        {
+          assert(src_line->flags & line_buf::LFT_32BIT);
+          const si32 *sp = src_line->i32 + src_line_offset;
+          si16 *dp = dst_line->i16 + dst_line_offset;
+          for (int i = (width + 7) >> 3; i > 0; --i, sp += 8, dp += 8)
+          {
+            __m256i s = _mm256_loadu_si256((__m256i*)sp);
+            __m256i c = _mm256_cmpgt_epi32(zero, s);  // 0xFFFFFFFF for -ve val
+            __m256i v_m_sh = _mm256_sub_epi32(sh, s); // - shift - value
+            v_m_sh = _mm256_and_si256(c, v_m_sh);     // keep only -shift-val
+            s = _mm256_andnot_si256(c, s);            // keep only +ve or 0
+            s = _mm256_or_si256(s, v_m_sh);           // combine
+            _mm_storeu_si128((__m128i*)dp, avx2_cvt_epi32_epi16(s));
+          }
+        }
+        else
+        {
+          assert(src_line->flags & line_buf::LFT_16BIT);
+          assert(dst_line->flags & line_buf::LFT_32BIT);
+          const si16 *sp = src_line->i16 + src_line_offset;
+          si32 *dp = dst_line->i32 + dst_line_offset;
+          for (int i = (width + 7) >> 3; i > 0; --i, sp += 8, dp += 8)
+          {
+            __m256i s;
+            s = _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i*)sp));
+            __m256i c = _mm256_cmpgt_epi32(zero, s);  // 0xFFFFFFFF for -ve val
+            __m256i v_m_sh = _mm256_sub_epi32(sh, s); // - shift - value
+            v_m_sh = _mm256_and_si256(c, v_m_sh);     // keep only -shift-val
+            s = _mm256_andnot_si256(c, s);            // keep only +ve or 0
+            s = _mm256_or_si256(s, v_m_sh);           // combine
+            _mm256_storeu_si256((__m256i*)dp, s);
+          }
+        }
+      }
+      else if (src_line->flags & line_buf::LFT_32BIT)
       {
         if (dst_line->flags & line_buf::LFT_32BIT)
         {
@@ -457,6 +535,34 @@ namespace ojph {
           yp += 8; cbp += 8; crp += 8;
         }
       }
+      else if (y->flags & line_buf::LFT_16BIT)
+      {
+        assert((y->flags  & line_buf::LFT_16BIT) &&
+               (cb->flags & line_buf::LFT_16BIT) &&
+               (cr->flags & line_buf::LFT_16BIT) &&
+               (r->flags  & line_buf::LFT_32BIT) &&
+               (g->flags  & line_buf::LFT_32BIT) &&
+               (b->flags  & line_buf::LFT_32BIT));
+        const si32 *rp = r->i32, * gp = g->i32, * bp = b->i32;
+        si16 *yp = y->i16, * cbp = cb->i16, * crp = cr->i16;
+        for (int i = (repeat + 7) >> 3; i > 0; --i)
+        {
+          __m256i mr = _mm256_load_si256((__m256i*)rp);
+          __m256i mg = _mm256_load_si256((__m256i*)gp);
+          __m256i mb = _mm256_load_si256((__m256i*)bp);
+          __m256i t = _mm256_add_epi32(mr, mb);
+          t = _mm256_add_epi32(t, _mm256_slli_epi32(mg, 1));
+          t = _mm256_srai_epi32(t, 2);
+          _mm_store_si128((__m128i*)yp, avx2_cvt_epi32_epi16(t));
+          t = _mm256_sub_epi32(mb, mg);
+          _mm_store_si128((__m128i*)cbp, avx2_cvt_epi32_epi16(t));
+          t = _mm256_sub_epi32(mr, mg);
+          _mm_store_si128((__m128i*)crp, avx2_cvt_epi32_epi16(t));
+
+          rp += 8; gp += 8; bp += 8;
+          yp += 8; cbp += 8; crp += 8;
+        }
+      }
       else
       {
         assert((y->flags  & line_buf::LFT_64BIT) &&
@@ -548,6 +654,34 @@ namespace ojph {
           rp += 8; gp += 8; bp += 8;
         }
       }
+      else if (y->flags & line_buf::LFT_16BIT)
+      {
+        assert((y->flags  & line_buf::LFT_16BIT) &&
+               (cb->flags & line_buf::LFT_16BIT) &&
+               (cr->flags & line_buf::LFT_16BIT) &&
+               (r->flags  & line_buf::LFT_32BIT) &&
+               (g->flags  & line_buf::LFT_32BIT) &&
+               (b->flags  & line_buf::LFT_32BIT));
+        const si16 *yp = y->i16, *cbp = cb->i16, *crp = cr->i16;
+        si32 *rp = r->i32, *gp = g->i32, *bp = b->i32;
+        for (int i = (repeat + 7) >> 3; i > 0; --i)
+        {
+          __m256i my  = _mm256_cvtepi16_epi32(_mm_load_si128((__m128i*)yp));
+          __m256i mcb = _mm256_cvtepi16_epi32(_mm_load_si128((__m128i*)cbp));
+          __m256i mcr = _mm256_cvtepi16_epi32(_mm_load_si128((__m128i*)crp));
+
+          __m256i t = _mm256_add_epi32(mcb, mcr);
+          t = _mm256_sub_epi32(my, _mm256_srai_epi32(t, 2));
+          _mm256_store_si256((__m256i*)gp, t);
+          __m256i u = _mm256_add_epi32(mcb, t);
+          _mm256_store_si256((__m256i*)bp, u);
+          u = _mm256_add_epi32(mcr, t);
+          _mm256_store_si256((__m256i*)rp, u);
+
+          yp += 8; cbp += 8; crp += 8;
+          rp += 8; gp += 8; bp += 8;
+        }
+      }
       else
       {
         assert((y->flags  & line_buf::LFT_64BIT) &&
@@ -617,6 +751,285 @@ namespace ojph {
       }
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_cnvrt_8b_to_si32(const void *sp, ui32 step, bool is_signed,
+                               si32 *dp, ui32 width)
+    {
+      if (step != 1) // interleaved samples
+        return gen_cnvrt_8b_to_si32(sp, step, is_signed, dp, width);
+
+      const ui8 *p = (const ui8*)sp;
+      ui32 i = width;
+      for (; i >= 8; i -= 8, p += 8, dp += 8)
+      {
+        __m128i x = _mm_loadl_epi64((__m128i*)p);
+        __m256i v = is_signed ? _mm256_cvtepi8_epi32(x)
+                              : _mm256_cvtepu8_epi32(x);
+        _mm256_storeu_si256((__m256i*)dp, v);
+      }
+      gen_cnvrt_8b_to_si32(p, 1, is_signed, dp, i);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_cnvrt_16b_to_si32(const void *sp, ui32 step, bool is_signed,
+                                bool swap, si32 *dp, ui32 width)
+    {
+      if (step != 1) // interleaved samples
+        return gen_cnvrt_16b_to_si32(sp, step, is_signed, swap, dp, width);
+
+      const ui16 *p = (const ui16*)sp;
+      ui32 i = width;
+      for (; i >= 8; i -= 8, p += 8, dp += 8)
+      {
+        __m128i x = _mm_loadu_si128((__m128i*)p);
+        if (swap)
+          x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+        __m256i v = is_signed ? _mm256_cvtepi16_epi32(x)
+                              : _mm256_cvtepu16_epi32(x);
+        _mm256_storeu_si256((__m256i*)dp, v);
+      }
+      gen_cnvrt_16b_to_si32(p, 1, is_signed, swap, dp, i);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // Stores 32 values that are already in the range of 8-bit samples;
+    // packing works within 128-bit lanes, and the permutation puts the
+    // samples back in order
+    static inline
+    void avx2_store_8b(__m256i a, __m256i b, __m256i c, __m256i d,
+                       bool is_signed, ui8 *p)
+    {
+      const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+      __m256i x = _mm256_packs_epi32(a, b), y = _mm256_packs_epi32(c, d);
+      x = is_signed ? _mm256_packs_epi16(x, y) : _mm256_packus_epi16(x, y);
+      _mm256_storeu_si256((__m256i*)p, _mm256_permutevar8x32_epi32(x, order));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // Stores 16 values that are already in the range of 16-bit samples
+    static inline
+    void avx2_store_16b(__m256i a, __m256i b, bool is_signed, bool swap,
+                        ui16 *p)
+    {
+      __m256i x = is_signed ? _mm256_packs_epi32(a, b)
+                            : _mm256_packus_epi32(a, b);
+      x = _mm256_permute4x64_epi64(x, 0xD8);
+      if (swap)
+        x = _mm256_or_si256(_mm256_slli_epi16(x, 8), _mm256_srli_epi16(x, 8));
+      _mm256_storeu_si256((__m256i*)p, x);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_cnvrt_si32_to_8b(const si32 *sp, si32 shift, void *dp,
+                               ui32 step, si32 low, si32 high, ui32 width)
+    {
+      if (step != 1) // interleaved samples
+        return gen_cnvrt_si32_to_8b(sp, shift, dp, step, low, high, width);
+
+      // saturating to 16 bits first does not change the clamped result,
+      // since low - shift and high - shift fit in 16 bits
+      ui8 *p = (ui8*)dp;
+      const __m256i lo = _mm256_set1_epi16((si16)(low - shift));
+      const __m256i hi = _mm256_set1_epi16((si16)(high - shift));
+      const __m256i sh = _mm256_set1_epi16((si16)shift);
+      const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+      ui32 i = width;
+      for (; i >= 32; i -= 32, sp += 32, p += 32)
+      {
+        __m256i a = _mm256_packs_epi32(_mm256_loadu_si256((__m256i*)sp),
+                                       _mm256_loadu_si256((__m256i*)sp + 1));
+        __m256i b = _mm256_packs_epi32(_mm256_loadu_si256((__m256i*)sp + 2),
+                                       _mm256_loadu_si256((__m256i*)sp + 3));
+        a = _mm256_add_epi16(_mm256_min_epi16(_mm256_max_epi16(a, lo), hi),
+                             sh);
+        b = _mm256_add_epi16(_mm256_min_epi16(_mm256_max_epi16(b, lo), hi),
+                             sh);
+        __m256i r = low >= 0 ? _mm256_packus_epi16(a, b)
+                             : _mm256_packs_epi16(a, b);
+        r = _mm256_permutevar8x32_epi32(r, order);
+        _mm256_storeu_si256((__m256i*)p, r);
+      }
+      gen_cnvrt_si32_to_8b(sp, shift, p, 1, low, high, i);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_cnvrt_si32_to_16b(const si32 *sp, si32 shift, void *dp,
+                                ui32 step, si32 low, si32 high, bool swap,
+                                ui32 width)
+    {
+      if (step != 1) // interleaved samples
+        return gen_cnvrt_si32_to_16b(sp, shift, dp, step, low, high, swap,
+          width);
+
+      ui16 *p = (ui16*)dp;
+      const __m256i lo = _mm256_set1_epi32(low - shift);
+      const __m256i hi = _mm256_set1_epi32(high - shift);
+      const __m256i sh = _mm256_set1_epi32(shift);
+      ui32 i = width;
+      for (; i >= 16; i -= 16, sp += 16, p += 16)
+      {
+        __m256i a = _mm256_loadu_si256((__m256i*)sp);
+        __m256i b = _mm256_loadu_si256((__m256i*)sp + 1);
+        a = _mm256_add_epi32(_mm256_min_epi32(_mm256_max_epi32(a, lo), hi),
+                             sh);
+        b = _mm256_add_epi32(_mm256_min_epi32(_mm256_max_epi32(b, lo), hi),
+                             sh);
+        avx2_store_16b(a, b, low < 0, swap, p);
+      }
+      gen_cnvrt_si32_to_16b(sp, shift, p, 1, low, high, swap, i);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_cnvrt_si16_to_8b(const si16 *sp, si32 shift, void *dp,
+                               ui32 step, si32 low, si32 high, ui32 width)
+    {
+      if (step != 1) // interleaved samples
+        return gen_cnvrt_si16_to_8b(sp, shift, dp, step, low, high, width);
+
+      ui8 *p = (ui8*)dp;
+      const __m256i lo = _mm256_set1_epi16((si16)(low - shift));
+      const __m256i hi = _mm256_set1_epi16((si16)(high - shift));
+      const __m256i sh = _mm256_set1_epi16((si16)shift);
+      ui32 i = width;
+      for (; i >= 32; i -= 32, sp += 32, p += 32)
+      {
+        __m256i a = _mm256_loadu_si256((__m256i*)sp);
+        __m256i b = _mm256_loadu_si256((__m256i*)sp + 1);
+        a = _mm256_add_epi16(_mm256_min_epi16(_mm256_max_epi16(a, lo), hi),
+                             sh);
+        b = _mm256_add_epi16(_mm256_min_epi16(_mm256_max_epi16(b, lo), hi),
+                             sh);
+        __m256i r = low >= 0 ? _mm256_packus_epi16(a, b)
+                             : _mm256_packs_epi16(a, b);
+        r = _mm256_permute4x64_epi64(r, 0xD8);
+        _mm256_storeu_si256((__m256i*)p, r);
+      }
+      gen_cnvrt_si16_to_8b(sp, shift, p, 1, low, high, i);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_cnvrt_si16_to_16b(const si16 *sp, si32 shift, void *dp,
+                                ui32 step, si32 low, si32 high, bool swap,
+                                ui32 width)
+    {
+      if (step != 1) // interleaved samples
+        return gen_cnvrt_si16_to_16b(sp, shift, dp, step, low, high, swap,
+          width);
+
+      // samples already fit in 16 bits, so the limits can be narrowed to
+      // 16 bits, and the shift added modulo 2^16
+      ui16 *p = (ui16*)dp;
+      const __m256i lo =
+        _mm256_set1_epi16((si16)ojph_max(low - shift, -32768));
+      const __m256i hi =
+        _mm256_set1_epi16((si16)ojph_min(high - shift, 32767));
+      const __m256i sh = _mm256_set1_epi16((si16)shift);
+      ui32 i = width;
+      for (; i >= 16; i -= 16, sp += 16, p += 16)
+      {
+        __m256i a = _mm256_loadu_si256((__m256i*)sp);
+        a = _mm256_add_epi16(_mm256_min_epi16(_mm256_max_epi16(a, lo), hi),
+                             sh);
+        if (swap)
+          a = _mm256_or_si256(_mm256_slli_epi16(a, 8),
+                              _mm256_srli_epi16(a, 8));
+        _mm256_storeu_si256((__m256i*)p, a);
+      }
+      gen_cnvrt_si16_to_16b(sp, shift, p, 1, low, high, swap, i);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // Rounds as _mm256_cvtps_epi32() does in avx2_irv_convert_to_integer();
+    // _mm256_max_ps() returns its second operand for NaNs
+    static inline
+    __m256i avx2_round_clamp_ps(__m256 t, __m256 lo, __m256 hi)
+    {
+      return _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(t, lo), hi));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // The same, for one sample
+    static inline
+    si32 avx2_round_clamp_ss(float t, __m256 lo, __m256 hi)
+    {
+      __m128 v = _mm_max_ss(_mm_set_ss(t), _mm256_castps256_ps128(lo));
+      v = _mm_min_ss(v, _mm256_castps256_ps128(hi));
+      return _mm_cvtss_si32(v);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_cnvrt_f32_to_8b(const float *sp, float mul, si32 shift,
+                              void *dp, ui32 step, si32 low, si32 high,
+                              ui32 width)
+    {
+      const __m256 m = _mm256_set1_ps(mul);
+      const __m256 lo = _mm256_set1_ps((float)(low - shift));
+      const __m256 hi = _mm256_set1_ps((float)(high - shift));
+      const __m256i sh = _mm256_set1_epi32(shift);
+      ui8 *p = (ui8*)dp;
+      ui32 i = width;
+      if (step == 1)
+        for (; i >= 32; i -= 32, sp += 32, p += 32)
+        {
+          __m256i v[4];
+          for (int k = 0; k < 4; ++k)
+            v[k] = _mm256_add_epi32(sh, avx2_round_clamp_ps(
+              _mm256_mul_ps(_mm256_loadu_ps(sp + 8 * k), m), lo, hi));
+          avx2_store_8b(v[0], v[1], v[2], v[3], low < 0, p);
+        }
+      else
+        for (si32 buf[64]; i >= 8; ) // interleaved samples
+        { // converted in blocks, then spread out
+          ui32 n = ojph_min(i & ~7u, 64u);
+          for (ui32 k = 0; k < n; k += 8)
+            _mm256_storeu_si256((__m256i*)(buf + k), _mm256_add_epi32(sh,
+              avx2_round_clamp_ps(_mm256_mul_ps(_mm256_loadu_ps(sp + k), m),
+                lo, hi)));
+          gen_cnvrt_si32_to_8b(buf, 0, p, step, low, high, n);
+          i -= n; sp += n; p += n * step;
+        }
+      for (; i > 0; --i, p += step) // the tail
+        *p = (ui8)(avx2_round_clamp_ss(*sp++ * mul, lo, hi) + shift);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_cnvrt_f32_to_16b(const float *sp, float mul, si32 shift,
+                               void *dp, ui32 step, si32 low, si32 high,
+                               bool swap, ui32 width)
+    {
+      const __m256 m = _mm256_set1_ps(mul);
+      const __m256 lo = _mm256_set1_ps((float)(low - shift));
+      const __m256 hi = _mm256_set1_ps((float)(high - shift));
+      const __m256i sh = _mm256_set1_epi32(shift);
+      ui16 *p = (ui16*)dp;
+      ui32 i = width;
+      if (step == 1)
+        for (; i >= 16; i -= 16, sp += 16, p += 16)
+        {
+          __m256i a = _mm256_add_epi32(sh, avx2_round_clamp_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(sp), m), lo, hi));
+          __m256i b = _mm256_add_epi32(sh, avx2_round_clamp_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(sp + 8), m), lo, hi));
+          avx2_store_16b(a, b, low < 0, swap, p);
+        }
+      else
+        for (si32 buf[64]; i >= 8; ) // interleaved samples
+        { // converted in blocks, then spread out
+          ui32 n = ojph_min(i & ~7u, 64u);
+          for (ui32 k = 0; k < n; k += 8)
+            _mm256_storeu_si256((__m256i*)(buf + k), _mm256_add_epi32(sh,
+              avx2_round_clamp_ps(_mm256_mul_ps(_mm256_loadu_ps(sp + k), m),
+                lo, hi)));
+          gen_cnvrt_si32_to_16b(buf, 0, p, step, low, high, swap, n);
+          i -= n; sp += n; p += n * step;
+        }
+      for (; i > 0; --i, p += step) // the tail
+      {
+        ui16 u = (ui16)(avx2_round_clamp_ss(*sp++ * mul, lo, hi) + shift);
+        *p = swap ? (ui16)((u << 8) | (u >> 8)) : u;
+      }
+    }
+
   }
 }
 
@@ -96,6 +96,42 @@ namespace ojph {
       const line_buf *src_line, line_buf *dst_line, ui32 dst_line_offset,
       ui32 bit_depth, bool is_signed, ui32 width);
 
+    //////////////////////////////////////////////////////////////////////////
+    void gen_cnvrt_8b_to_si32(const void *sp, ui32 step, bool is_signed,
+                              si32 *dp, ui32 width);
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_cnvrt_16b_to_si32(const void *sp, ui32 step, bool is_signed,
+                               bool swap, si32 *dp, ui32 width);
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_cnvrt_si32_to_8b(const si32 *sp, si32 shift, void *dp,
+                              ui32 step, si32 low, si32 high, ui32 width);
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_cnvrt_si32_to_16b(const si32 *sp, si32 shift, void *dp,
+                               ui32 step, si32 low, si32 high, bool swap,
+                               ui32 width);
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_cnvrt_si16_to_8b(const si16 *sp, si32 shift, void *dp,
+                              ui32 step, si32 low, si32 high, ui32 width);
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_cnvrt_si16_to_16b(const si16 *sp, si32 shift, void *dp,
+                               ui32 step, si32 low, si32 high, bool swap,
+                               ui32 width);
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_cnvrt_f32_to_8b(const float *sp, float mul, si32 shift,
+                             void *dp, ui32 step, si32 low, si32 high,
+                             ui32 width);
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_cnvrt_f32_to_16b(const float *sp, float mul, si32 shift,
+                              void *dp, ui32 step, si32 low, si32 high,
+                              bool swap, ui32 width);
+
     //////////////////////////////////////////////////////////////////////////
     void gen_rct_forward(
       const line_buf *r, const line_buf *g, const line_buf *b,
@@ -178,6 +214,42 @@ namespace ojph {
       const line_buf *src_line, ui32 src_line_offset,
       line_buf *dst_line, ui32 bit_depth, bool is_signed, ui32 width);
 
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_cnvrt_8b_to_si32(const void *sp, ui32 step, bool is_signed,
+                               si32 *dp, ui32 width);
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_cnvrt_16b_to_si32(const void *sp, ui32 step, bool is_signed,
+                                bool swap, si32 *dp, ui32 width);
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_cnvrt_si32_to_8b(const si32 *sp, si32 shift, void *dp,
+                               ui32 step, si32 low, si32 high, ui32 width);
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_cnvrt_si32_to_16b(const si32 *sp, si32 shift, void *dp,
+                                ui32 step, si32 low, si32 high, bool swap,
+                                ui32 width);
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_cnvrt_si16_to_8b(const si16 *sp, si32 shift, void *dp,
+                               ui32 step, si32 low, si32 high, ui32 width);
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_cnvrt_si16_to_16b(const si16 *sp, si32 shift, void *dp,
+                                ui32 step, si32 low, si32 high, bool swap,
+                                ui32 width);
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_cnvrt_f32_to_8b(const float *sp, float mul, si32 shift,
+                              void *dp, ui32 step, si32 low, si32 high,
+                              ui32 width);
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_cnvrt_f32_to_16b(const float *sp, float mul, si32 shift,
+                               void *dp, ui32 step, si32 low, si32 high,
+                               bool swap, ui32 width);
+
     //////////////////////////////////////////////////////////////////////////
     void sse2_rct_forward(
       const line_buf *r, const line_buf *g, const line_buf *b,
@@ -244,6 +316,42 @@ namespace ojph {
       const line_buf *src_line, ui32 src_line_offset,
       line_buf *dst_line, ui32 bit_depth, bool is_signed, ui32 width);
 
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_cnvrt_8b_to_si32(const void *sp, ui32 step, bool is_signed,
+                               si32 *dp, ui32 width);
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_cnvrt_16b_to_si32(const void *sp, ui32 step, bool is_signed,
+                                bool swap, si32 *dp, ui32 width);
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_cnvrt_si32_to_8b(const si32 *sp, si32 shift, void *dp,
+                               ui32 step, si32 low, si32 high, ui32 width);
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_cnvrt_si32_to_16b(const si32 *sp, si32 shift, void *dp,
+                                ui32 step, si32 low, si32 high, bool swap,
+                                ui32 width);
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_cnvrt_si16_to_8b(const si16 *sp, si32 shift, void *dp,
+                               ui32 step, si32 low, si32 high, ui32 width);
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_cnvrt_si16_to_16b(const si16 *sp, si32 shift, void *dp,
+                                ui32 step, si32 low, si32 high, bool swap,
+                                ui32 width);
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_cnvrt_f32_to_8b(const float *sp, float mul, si32 shift,
+                              void *dp, ui32 step, si32 low, si32 high,
+                              ui32 width);
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_cnvrt_f32_to_16b(const float *sp, float mul, si32 shift,
+                               void *dp, ui32 step, si32 low, si32 high,
+                               bool swap, ui32 width);
+
     //////////////////////////////////////////////////////////////////////////
     void avx2_rct_forward(
       const line_buf *r, const line_buf *g, const line_buf *b,
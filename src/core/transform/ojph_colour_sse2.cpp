@@ -44,6 +44,7 @@
 #include "ojph_defs.h"
 #include "ojph_mem.h"
 #include "ojph_colour.h"
+#include "ojph_colour_local.h"
 
 #include <emmintrin.h>
 
@@ -223,6 +224,28 @@ namespace ojph {
       return t;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    static inline __m128i sse2_cvtlo_epi16_epi32(__m128i a)
+    {
+      return _mm_srai_epi32(_mm_unpacklo_epi16(a, a), 16);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline __m128i sse2_cvthi_epi16_epi32(__m128i a)
+    {
+      return _mm_srai_epi32(_mm_unpackhi_epi16(a, a), 16);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // packs a and b into 16bit lanes keeping the 16 LSBs, like a C cast;
+    // _mm_packs_epi32 saturates, so we sign-extend the LSBs first
+    static inline __m128i sse2_cvt_epi32_epi16(__m128i a, __m128i b)
+    {
+      a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+      b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+      return _mm_packs_epi32(a, b);
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void sse2_rev_convert(const line_buf *src_line,
                           const ui32 src_line_offset,
@@ -230,7 +253,37 @@ namespace ojph {
                           const ui32 dst_line_offset,
                           si64 shift, ui32 width)
     {
-      if (src_line->flags & line_buf::LFT_32BIT)
+      if (dst_line->flags & line_buf::LFT_16BIT)
+      {
+        assert(src_line->flags & line_buf::LFT_32BIT);
+        const si32 *sp = src_line->i32 + src_line_offset;
+        si16 *dp = dst_line->i16 + dst_line_offset;
+        __m128i sh = _mm_set1_epi32((si32)shift);
+        for (int i = (width + 7) >> 3; i > 0; --i, sp+=8, dp+=8)
+        {
+          __m128i s0 = _mm_loadu_si128((__m128i*)sp);
+          __m128i s1 = _mm_loadu_si128((__m128i*)sp + 1);
+          s0 = _mm_add_epi32(s0, sh);
+          s1 = _mm_add_epi32(s1, sh);
+          _mm_storeu_si128((__m128i*)dp, sse2_cvt_epi32_epi16(s0, s1));
+        }
+      }
+      else if (src_line->flags & line_buf::LFT_16BIT)
+      {
+        assert(dst_line->flags & line_buf::LFT_32BIT);
+        const si16 *sp = src_line->i16 + src_line_offset;
+        si32 *dp = dst_line->i32 + dst_line_offset;
+        __m128i sh = _mm_set1_epi32((si32)shift);
+        for (int i = (width + 7) >> 3; i > 0; --i, sp+=8, dp+=8)
+        {
+          __m128i s = _mm_loadu_si128((__m128i*)sp);
+          __m128i t = _mm_add_epi32(sse2_cvtlo_epi16_epi32(s), sh);
+          _mm_storeu_si128((__m128i*)dp, t);
+          t = _mm_add_epi32(sse2_cvthi_epi16_epi32(s), sh);
+          _mm_storeu_si128((__m128i*)dp + 1, t);
+        }
+      }
+      else if (src_line->flags & line_buf::LFT_32BIT)
       {
         if (dst_line->flags & line_buf::LFT_32BIT)
         {
@@ -301,7 +354,52 @@ namespace ojph {
                                     const ui32 dst_line_offset,
                                     si64 shift, ui32 width)
     {
-      if (src_line->flags & line_buf::LFT_32BIT)
+      if ((src_line->flags | dst_line->flags) & line_buf::LFT_16BIT)
+      {
+        // one side is 16bit, the other is 32bit
+        __m128i sh = _mm_set1_epi32((si32)(-shift));
+        __m128i zero = _mm_setzero_si128();
+        if (dst_line->flags & line_buf::LFT_16BIT)
+        {
+          assert(src_line->flags & line_buf::LFT_32BIT);
+          const si32 *sp = src_line->i32 + src_line_offset;
+          si16 *dp = dst_line->i16 + dst_line_offset;
+          for (int i = (width + 7) >> 3; i > 0; --i, sp += 8, dp += 8)
+          {
+            __m128i s0 = _mm_loadu_si128((__m128i*)sp);
+            __m128i s1 = _mm_loadu_si128((__m128i*)sp + 1);
+            __m128i c = _mm_cmplt_epi32(s0, zero);
+            __m128i v_m_sh = _mm_and_si128(c, _mm_sub_epi32(sh, s0));
+            s0 = _mm_or_si128(_mm_andnot_si128(c, s0), v_m_sh);
+            c = _mm_cmplt_epi32(s1, zero);
+            v_m_sh = _mm_and_si128(c, _mm_sub_epi32(sh, s1));
+            s1 = _mm_or_si128(_mm_andnot_si128(c, s1), v_m_sh);
+            _mm_storeu_si128((__m128i*)dp, sse2_cvt_epi32_epi16(s0, s1));
+          }
+        }
+        else
+        {
+          assert(src_line->flags & line_buf::LFT_16BIT);
+          assert(dst_line->flags & line_buf::LFT_32BIT);
+          const si16 *sp = src_line->i16 + src_line_offset;
+          si32 *dp = dst_line->i32 + dst_line_offset;
+          for (int i = (width + 7) >> 3; i > 0; --i, sp += 8, dp += 8)
+          {
+            __m128i s = _mm_loadu_si128((__m128i*)sp);
+            __m128i s0 = sse2_cvtlo_epi16_epi32(s);
+            __m128i s1 = sse2_cvthi_epi16_epi32(s);
+            __m128i c = _mm_cmplt_epi32(s0, zero);
+            __m128i v_m_sh = _mm_and_si128(c, _mm_sub_epi32(sh, s0));
+            s0 = _mm_or_si128(_mm_andnot_si128(c, s0), v_m_sh);
+            c = _mm_cmplt_epi32(s1, zero);
+            v_m_sh = _mm_and_si128(c, _mm_sub_epi32(sh, s1));
+            s1 = _mm_or_si128(_mm_andnot_si128(c, s1), v_m_sh);
+            _mm_storeu_si128((__m128i*)dp, s0);
+            _mm_storeu_si128((__m128i*)dp + 1, s1);
+          }
+        }
+      }
+      else if (src_line->flags & line_buf::LFT_32BIT)
       {
         if (dst_line->flags & line_buf::LFT_32BIT)
         {
@@ -502,6 +600,40 @@ namespace ojph {
           yp += 4; cbp += 4; crp += 4;
         }
       }
+      else if (y->flags & line_buf::LFT_16BIT)
+      {
+        assert((y->flags  & line_buf::LFT_16BIT) &&
+               (cb->flags & line_buf::LFT_16BIT) &&
+               (cr->flags & line_buf::LFT_16BIT) &&
+               (r->flags  & line_buf::LFT_32BIT) &&
+               (g->flags  & line_buf::LFT_32BIT) &&
+               (b->flags  & line_buf::LFT_32BIT));
+        const si32 *rp = r->i32, * gp = g->i32, * bp = b->i32;
+        si16 *yp = y->i16, * cbp = cb->i16, * crp = cr->i16;
+        for (int i = (repeat + 7) >> 3; i > 0; --i)
+        {
+          __m128i mr0 = _mm_load_si128((__m128i*)rp);
+          __m128i mg0 = _mm_load_si128((__m128i*)gp);
+          __m128i mb0 = _mm_load_si128((__m128i*)bp);
+          __m128i mr1 = _mm_load_si128((__m128i*)rp + 1);
+          __m128i mg1 = _mm_load_si128((__m128i*)gp + 1);
+          __m128i mb1 = _mm_load_si128((__m128i*)bp + 1);
+          __m128i t0 = _mm_add_epi32(mr0, mb0);
+          __m128i t1 = _mm_add_epi32(mr1, mb1);
+          t0 = _mm_srai_epi32(_mm_add_epi32(t0, _mm_slli_epi32(mg0, 1)), 2);
+          t1 = _mm_srai_epi32(_mm_add_epi32(t1, _mm_slli_epi32(mg1, 1)), 2);
+          _mm_store_si128((__m128i*)yp, sse2_cvt_epi32_epi16(t0, t1));
+          t0 = _mm_sub_epi32(mb0, mg0);
+          t1 = _mm_sub_epi32(mb1, mg1);
+          _mm_store_si128((__m128i*)cbp, sse2_cvt_epi32_epi16(t0, t1));
+          t0 = _mm_sub_epi32(mr0, mg0);
+          t1 = _mm_sub_epi32(mr1, mg1);
+          _mm_store_si128((__m128i*)crp, sse2_cvt_epi32_epi16(t0, t1));
+
+          rp += 8; gp += 8; bp += 8;
+          yp += 8; cbp += 8; crp += 8;
+        }
+      }
       else
       {
         assert((y->flags  & line_buf::LFT_64BIT) &&
@@ -594,6 +726,48 @@ namespace ojph {
           rp += 4; gp += 4; bp += 4;
         }
       }
+      else if (y->flags & line_buf::LFT_16BIT)
+      {
+        assert((y->flags  & line_buf::LFT_16BIT) &&
+               (cb->flags & line_buf::LFT_16BIT) &&
+               (cr->flags & line_buf::LFT_16BIT) &&
+               (r->flags  & line_buf::LFT_32BIT) &&
+               (g->flags  & line_buf::LFT_32BIT) &&
+               (b->flags  & line_buf::LFT_32BIT));
+        const si16 *yp = y->i16, *cbp = cb->i16, *crp = cr->i16;
+        si32 *rp = r->i32, *gp = g->i32, *bp = b->i32;
+        for (int i = (repeat + 7) >> 3; i > 0; --i)
+        {
+          __m128i my  = _mm_load_si128((__m128i*)yp);
+          __m128i mcb = _mm_load_si128((__m128i*)cbp);
+          __m128i mcr = _mm_load_si128((__m128i*)crp);
+
+          for (int k = 0; k < 2; ++k)
+          {
+            __m128i y32, cb32, cr32;
+            if (k == 0) {
+              y32 = sse2_cvtlo_epi16_epi32(my);
+              cb32 = sse2_cvtlo_epi16_epi32(mcb);
+              cr32 = sse2_cvtlo_epi16_epi32(mcr);
+            }
+            else {
+              y32 = sse2_cvthi_epi16_epi32(my);
+              cb32 = sse2_cvthi_epi16_epi32(mcb);
+              cr32 = sse2_cvthi_epi16_epi32(mcr);
+            }
+            __m128i t = _mm_add_epi32(cb32, cr32);
+            t = _mm_sub_epi32(y32, _mm_srai_epi32(t, 2));
+            _mm_store_si128((__m128i*)gp, t);
+            __m128i u = _mm_add_epi32(cb32, t);
+            _mm_store_si128((__m128i*)bp, u);
+            u = _mm_add_epi32(cr32, t);
+            _mm_store_si128((__m128i*)rp, u);
+            rp += 4; gp += 4; bp += 4;
+          }
+
+          yp += 8; cbp += 8; crp += 8;
+        }
+      }
       else
       {
         assert((y->flags  & line_buf::LFT_64BIT) &&
@@ -656,6 +830,319 @@ namespace ojph {
         }
       }
     }
+
+    //////////////////////////////////////////////////////////////////////////
+    // widens eight 16-bit integers, and stores them at dp
+    static inline
+    void sse2_widen_epi16(__m128i v, bool is_signed, si32 *dp)
+    {
+      __m128i lo, hi;
+      if (is_signed) {
+        lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+      }
+      else {
+        __m128i zero = _mm_setzero_si128();
+        lo = _mm_unpacklo_epi16(v, zero);
+        hi = _mm_unpackhi_epi16(v, zero);
+      }
+      _mm_storeu_si128((__m128i*)dp, lo);
+      _mm_storeu_si128((__m128i*)dp + 1, hi);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    __m128i sse2_clamp_epi32(__m128i v, __m128i low, __m128i high)
+    {
+      __m128i c = _mm_cmplt_epi32(v, low);
+      v = _mm_or_si128(_mm_and_si128(c, low), _mm_andnot_si128(c, v));
+      c = _mm_cmpgt_epi32(v, high);
+      return _mm_or_si128(_mm_and_si128(c, high), _mm_andnot_si128(c, v));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_cnvrt_8b_to_si32(const void *sp, ui32 step, bool is_signed,
+                               si32 *dp, ui32 width)
+    {
+      if (step != 1) // interleaved samples
+        return gen_cnvrt_8b_to_si32(sp, step, is_signed, dp, width);
+
+      const ui8 *p = (const ui8*)sp;
+      const __m128i zero = _mm_setzero_si128();
+      ui32 i = width;
+      for (; i >= 16; i -= 16, p += 16, dp += 16)
+      {
+        __m128i x = _mm_loadu_si128((__m128i*)p), lo, hi;
+        if (is_signed) {
+          lo = _mm_srai_epi16(_mm_unpacklo_epi8(x, x), 8);
+          hi = _mm_srai_epi16(_mm_unpackhi_epi8(x, x), 8);
+        }
+        else {
+          lo = _mm_unpacklo_epi8(x, zero);
+          hi = _mm_unpackhi_epi8(x, zero);
+        }
+        // both are now correctly signed 16-bit integers
+        sse2_widen_epi16(lo, true, dp);
+        sse2_widen_epi16(hi, true, dp + 8);
+      }
+      gen_cnvrt_8b_to_si32(p, 1, is_signed, dp, i);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline __m128i sse2_swap_epi16(__m128i v)
+    { return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)); }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_cnvrt_16b_to_si32(const void *sp, ui32 step, bool is_signed,
+                                bool swap, si32 *dp, ui32 width)
+    {
+      if (step != 1) // interleaved samples
+        return gen_cnvrt_16b_to_si32(sp, step, is_signed, swap, dp, width);
+
+      const ui16 *p = (const ui16*)sp;
+      ui32 i = width;
+      for (; i >= 8; i -= 8, p += 8, dp += 8)
+      {
+        __m128i x = _mm_loadu_si128((__m128i*)p);
+        sse2_widen_epi16(swap ? sse2_swap_epi16(x) : x, is_signed, dp);
+      }
+      gen_cnvrt_16b_to_si32(p, 1, is_signed, swap, dp, i);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // Stores 16 values that are already in the range of 8-bit samples
+    static inline
+    void sse2_store_8b(__m128i a, __m128i b, __m128i c, __m128i d,
+                       bool is_signed, ui8 *p)
+    {
+      __m128i x = _mm_packs_epi32(a, b), y = _mm_packs_epi32(c, d);
+      x = is_signed ? _mm_packs_epi16(x, y) : _mm_packus_epi16(x, y);
+      _mm_storeu_si128((__m128i*)p, x);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // Stores 8 values that are already in the range of 16-bit samples;
+    // SSE2 has no unsigned saturation to 16 bits, so unsigned values are
+    // moved to the signed range before packing, and moved back after
+    static inline
+    void sse2_store_16b(__m128i a, __m128i b, bool is_signed, bool swap,
+                        ui16 *p)
+    {
+      if (!is_signed) {
+        const __m128i bias = _mm_set1_epi32(0x8000);
+        a = _mm_sub_epi32(a, bias);
+        b = _mm_sub_epi32(b, bias);
+      }
+      __m128i x = _mm_packs_epi32(a, b);
+      if (!is_signed)
+        x = _mm_xor_si128(x, _mm_set1_epi16((si16)0x8000));
+      if (swap)
+        x = sse2_swap_epi16(x);
+      _mm_storeu_si128((__m128i*)p, x);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_cnvrt_si32_to_8b(const si32 *sp, si32 shift, void *dp,
+                               ui32 step, si32 low, si32 high, ui32 width)
+    {
+      if (step != 1) // interleaved samples
+        return gen_cnvrt_si32_to_8b(sp, shift, dp, step, low, high, width);
+
+      // saturating to 16 bits first does not change the clamped result,
+      // since low - shift and high - shift fit in 16 bits
+      ui8 *p = (ui8*)dp;
+      const __m128i lo = _mm_set1_epi16((si16)(low - shift));
+      const __m128i hi = _mm_set1_epi16((si16)(high - shift));
+      const __m128i sh = _mm_set1_epi16((si16)shift);
+      ui32 i = width;
+      for (; i >= 16; i -= 16, sp += 16, p += 16)
+      {
+        __m128i a = _mm_packs_epi32(_mm_loadu_si128((__m128i*)sp),
+                                    _mm_loadu_si128((__m128i*)sp + 1));
+        __m128i b = _mm_packs_epi32(_mm_loadu_si128((__m128i*)sp + 2),
+                                    _mm_loadu_si128((__m128i*)sp + 3));
+        a = _mm_add_epi16(_mm_min_epi16(_mm_max_epi16(a, lo), hi), sh);
+        b = _mm_add_epi16(_mm_min_epi16(_mm_max_epi16(b, lo), hi), sh);
+        __m128i r = low >= 0 ? _mm_packus_epi16(a, b)
+                             : _mm_packs_epi16(a, b);
+        _mm_storeu_si128((__m128i*)p, r);
+      }
+      gen_cnvrt_si32_to_8b(sp, shift, p, 1, low, high, i);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_cnvrt_si32_to_16b(const si32 *sp, si32 shift, void *dp,
+                                ui32 step, si32 low, si32 high, bool swap,
+                                ui32 width)
+    {
+      if (step != 1) // interleaved samples
+        return gen_cnvrt_si32_to_16b(sp, shift, dp, step, low, high, swap,
+          width);
+
+      ui16 *p = (ui16*)dp;
+      const __m128i lo = _mm_set1_epi32(low - shift);
+      const __m128i hi = _mm_set1_epi32(high - shift);
+      const __m128i sh = _mm_set1_epi32(shift);
+      ui32 i = width;
+      for (; i >= 8; i -= 8, sp += 8, p += 8)
+      {
+        __m128i a = sse2_clamp_epi32(_mm_loadu_si128((__m128i*)sp), lo, hi);
+        __m128i b =
+          sse2_clamp_epi32(_mm_loadu_si128((__m128i*)sp + 1), lo, hi);
+        sse2_store_16b(_mm_add_epi32(a, sh), _mm_add_epi32(b, sh), low < 0,
+          swap, p);
+      }
+      gen_cnvrt_si32_to_16b(sp, shift, p, 1, low, high, swap, i);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_cnvrt_si16_to_8b(const si16 *sp, si32 shift, void *dp,
+                               ui32 step, si32 low, si32 high, ui32 width)
+    {
+      if (step != 1) // interleaved samples
+        return gen_cnvrt_si16_to_8b(sp, shift, dp, step, low, high, width);
+
+      ui8 *p = (ui8*)dp;
+      const __m128i lo = _mm_set1_epi16((si16)(low - shift));
+      const __m128i hi = _mm_set1_epi16((si16)(high - shift));
+      const __m128i sh = _mm_set1_epi16((si16)shift);
+      ui32 i = width;
+      for (; i >= 16; i -= 16, sp += 16, p += 16)
+      {
+        __m128i a = _mm_loadu_si128((__m128i*)sp);
+        __m128i b = _mm_loadu_si128((__m128i*)sp + 1);
+        a = _mm_add_epi16(_mm_min_epi16(_mm_max_epi16(a, lo), hi), sh);
+        b = _mm_add_epi16(_mm_min_epi16(_mm_max_epi16(b, lo), hi), sh);
+        __m128i r = low >= 0 ? _mm_packus_epi16(a, b)
+                             : _mm_packs_epi16(a, b);
+        _mm_storeu_si128((__m128i*)p, r);
+      }
+      gen_cnvrt_si16_to_8b(sp, shift, p, 1, low, high, i);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_cnvrt_si16_to_16b(const si16 *sp, si32 shift, void *dp,
+                                ui32 step, si32 low, si32 high, bool swap,
+                                ui32 width)
+    {
+      if (step != 1) // interleaved samples
+        return gen_cnvrt_si16_to_16b(sp, shift, dp, step, low, high, swap,
+          width);
+
+      // samples already fit in 16 bits, so the limits can be narrowed to
+      // 16 bits, and the shift added modulo 2^16
+      ui16 *p = (ui16*)dp;
+      const __m128i lo = _mm_set1_epi16((si16)ojph_max(low - shift, -32768));
+      const __m128i hi = _mm_set1_epi16((si16)ojph_min(high - shift, 32767));
+      const __m128i sh = _mm_set1_epi16((si16)shift);
+      ui32 i = width;
+      for (; i >= 8; i -= 8, sp += 8, p += 8)
+      {
+        __m128i a = _mm_loadu_si128((__m128i*)sp);
+        a = _mm_add_epi16(_mm_min_epi16(_mm_max_epi16(a, lo), hi), sh);
+        if (swap)
+          a = sse2_swap_epi16(a);
+        _mm_storeu_si128((__m128i*)p, a);
+      }
+      gen_cnvrt_si16_to_16b(sp, shift, p, 1, low, high, swap, i);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // Rounds to the nearest integer, ties to even, as _mm_cvtps_epi32()
+    // does in sse2_irv_convert_to_integer(); the rounding mode must be set
+    static inline
+    __m128i sse2_round_clamp_ps(__m128 t, __m128 lo, __m128 hi)
+    {
+      // _mm_max_ps() returns its second operand for NaNs
+      return _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(t, lo), hi));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_cnvrt_f32_to_8b(const float *sp, float mul, si32 shift,
+                              void *dp, ui32 step, si32 low, si32 high,
+                              ui32 width)
+    {
+      uint32_t rounding_mode = _MM_GET_ROUNDING_MODE();
+      _MM_SET_ROUNDING_MODE(_MM_ROUND_NEAREST);
+
+      const __m128 m = _mm_set1_ps(mul);
+      const __m128 lo = _mm_set1_ps((float)(low - shift));
+      const __m128 hi = _mm_set1_ps((float)(high - shift));
+      const __m128i sh = _mm_set1_epi32(shift);
+      ui8 *p = (ui8*)dp;
+      ui32 i = width;
+      if (step == 1)
+        for (; i >= 16; i -= 16, sp += 16, p += 16)
+        {
+          __m128i v[4];
+          for (int k = 0; k < 4; ++k)
+            v[k] = _mm_add_epi32(sh, sse2_round_clamp_ps(
+              _mm_mul_ps(_mm_loadu_ps(sp + 4 * k), m), lo, hi));
+          sse2_store_8b(v[0], v[1], v[2], v[3], low < 0, p);
+        }
+      else
+        for (si32 buf[64]; i >= 4; ) // interleaved samples
+        { // converted in blocks, then spread out
+          ui32 n = ojph_min(i & ~3u, 64u);
+          for (ui32 k = 0; k < n; k += 4)
+            _mm_storeu_si128((__m128i*)(buf + k), _mm_add_epi32(sh,
+              sse2_round_clamp_ps(_mm_mul_ps(_mm_loadu_ps(sp + k), m),
+                lo, hi)));
+          gen_cnvrt_si32_to_8b(buf, 0, p, step, low, high, n);
+          i -= n; sp += n; p += n * step;
+        }
+      for (; i > 0; --i, p += step) // the tail
+      {
+        __m128i v = sse2_round_clamp_ps(_mm_set_ss(*sp++ * mul), lo, hi);
+        *p = (ui8)(_mm_cvtsi128_si32(v) + shift);
+      }
+
+      _MM_SET_ROUNDING_MODE(rounding_mode);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_cnvrt_f32_to_16b(const float *sp, float mul, si32 shift,
+                               void *dp, ui32 step, si32 low, si32 high,
+                               bool swap, ui32 width)
+    {
+      uint32_t rounding_mode = _MM_GET_ROUNDING_MODE();
+      _MM_SET_ROUNDING_MODE(_MM_ROUND_NEAREST);
+
+      const __m128 m = _mm_set1_ps(mul);
+      const __m128 lo = _mm_set1_ps((float)(low - shift));
+      const __m128 hi = _mm_set1_ps((float)(high - shift));
+      const __m128i sh = _mm_set1_epi32(shift);
+      ui16 *p = (ui16*)dp;
+      ui32 i = width;
+      if (step == 1)
+        for (; i >= 8; i -= 8, sp += 8, p += 8)
+        {
+          __m128i a = _mm_add_epi32(sh, sse2_round_clamp_ps(
+            _mm_mul_ps(_mm_loadu_ps(sp), m), lo, hi));
+          __m128i b = _mm_add_epi32(sh, sse2_round_clamp_ps(
+            _mm_mul_ps(_mm_loadu_ps(sp + 4), m), lo, hi));
+          sse2_store_16b(a, b, low < 0, swap, p);
+        }
+      else
+        for (si32 buf[64]; i >= 4; ) // interleaved samples
+        { // converted in blocks, then spread out
+          ui32 n = ojph_min(i & ~3u, 64u);
+          for (ui32 k = 0; k < n; k += 4)
+            _mm_storeu_si128((__m128i*)(buf + k), _mm_add_epi32(sh,
+              sse2_round_clamp_ps(_mm_mul_ps(_mm_loadu_ps(sp + k), m),
+                lo, hi)));
+          gen_cnvrt_si32_to_16b(buf, 0, p, step, low, high, swap, n);
+          i -= n; sp += n; p += n * step;
+        }
+      for (; i > 0; --i, p += step) // the tail
+      {
+        __m128i v = sse2_round_clamp_ps(_mm_set_ss(*sp++ * mul), lo, hi);
+        ui16 u = (ui16)(_mm_cvtsi128_si32(v) + shift);
+        *p = swap ? (ui16)((u << 8) | (u >> 8)) : u;
+      }
+
+      _MM_SET_ROUNDING_MODE(rounding_mode);
+    }
   }
 }
 
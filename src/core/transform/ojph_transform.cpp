@@ -94,13 +94,32 @@ namespace ojph {
       (const param_atk* atk, const line_buf* dst, const line_buf* lsrc,
         const line_buf* hsrc, ui32 width, bool even) = NULL;
 
+    //////////////////////////////////////////////////////////////////////////
+    // set by init_wavelet_transform_functions()
+    static bool rev_16bit_lines = false;
+
+    //////////////////////////////////////////////////////////////////////////
+    bool rev_supports_16bit_lines()
+    {
+      return rev_16bit_lines;
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void init_wavelet_transform_functions()
     {
-      static std::once_flag wavelet_transform_functions_init_flag;
-      std::call_once(wavelet_transform_functions_init_flag, [](){
+      // re-dispatched whenever the effective cpu extension level changes,
+      // which only happens through set_max_cpu_ext_level()
+      static std::mutex init_mutex;
+      static int init_level = -1;
+      std::lock_guard<std::mutex> lock(init_mutex);
+      if (init_level == get_cpu_ext_level())
+        return;
+      init_level = get_cpu_ext_level();
+      {
 #if !defined(OJPH_ENABLE_WASM_SIMD) || !defined(OJPH_EMSCRIPTEN)
 
+        rev_16bit_lines           = true;
+
         rev_vert_step             = gen_rev_vert_step;
         rev_horz_ana              = gen_rev_horz_ana;
         rev_horz_syn              = gen_rev_horz_syn;
@@ -155,9 +174,9 @@ namespace ojph {
       #if (defined(OJPH_ARCH_X86_64) && !defined(OJPH_DISABLE_AVX512))
         if (get_cpu_ext_level() >= X86_CPU_EXT_LEVEL_AVX512)
         {
-          // rev_vert_step             = avx512_rev_vert_step;
-          // rev_horz_ana              = avx512_rev_horz_ana;
-          // rev_horz_syn              = avx512_rev_horz_syn;
+          rev_vert_step             = avx512_rev_vert_step;
+          rev_horz_ana              = avx512_rev_horz_ana;
+          rev_horz_syn              = avx512_rev_horz_syn;
 
           irv_vert_step             = avx512_irv_vert_step;
           irv_vert_times_K          = avx512_irv_vert_times_K;
@@ -173,6 +192,8 @@ namespace ojph {
         if (get_cpu_ext_level() >= PPC_CPU_EXT_LEVEL_ARCH_3_00)
         {
           // 128-bit VSX kernels; see ojph_simd_vsx.h
+          // these, and the matching colour kernels, handle 32/64bit lines
+          rev_16bit_lines           = false;
           rev_vert_step             = vsx_rev_vert_step;
           rev_horz_ana              = vsx_rev_horz_ana;
           rev_horz_syn              = vsx_rev_horz_syn;
@@ -188,6 +209,7 @@ namespace ojph {
   #endif // !OJPH_DISABLE_SIMD
 
 #else // OJPH_ENABLE_WASM_SIMD
+        rev_16bit_lines           = false;
         rev_vert_step             = wasm_rev_vert_step;
         rev_horz_ana              = wasm_rev_horz_ana;
         rev_horz_syn              = wasm_rev_horz_syn;
@@ -197,13 +219,64 @@ namespace ojph {
         irv_horz_ana              = wasm_irv_horz_ana;
         irv_horz_syn              = wasm_irv_horz_syn;
 #endif // !OJPH_ENABLE_WASM_SIMD
-      });
+      }
     }
     
     //////////////////////////////////////////////////////////////////////////
 
 #if !defined(OJPH_ENABLE_WASM_SIMD) || !defined(OJPH_EMSCRIPTEN)
 
+    /////////////////////////////////////////////////////////////////////////
+    // In the 16bit functions, samples need no more than 16 bits, and so do
+    // the sum of two samples (see param_qcd::propose_precision())
+    static
+    void gen_rev_vert_step16(const lifting_step* s, const line_buf* sig, 
+                             const line_buf* other, const line_buf* aug, 
+                             ui32 repeat, bool synthesis)
+    {
+      const si32 a = s->rev.Aatk;
+      const si32 b = s->rev.Batk;
+      const ui8 e = s->rev.Eatk;
+
+      si16* dst = aug->i16;
+      const si16* src1 = sig->i16, * src2 = other->i16;
+      if (a == 1)
+      { // 5/3 update and any case with a == 1
+        if (synthesis)
+          for (ui32 i = repeat; i > 0; --i, ++dst)
+            *dst = (si16)(*dst - ((b + *src1++ + *src2++) >> e));
+        else
+          for (ui32 i = repeat; i > 0; --i, ++dst)
+            *dst = (si16)(*dst + ((b + *src1++ + *src2++) >> e));
+      }
+      else if (a == -1 && b == 1 && e == 1)
+      { // 5/3 predict
+        if (synthesis)
+          for (ui32 i = repeat; i > 0; --i, ++dst)
+            *dst = (si16)(*dst + ((*src1++ + *src2++) >> e));
+        else
+          for (ui32 i = repeat; i > 0; --i, ++dst)
+            *dst = (si16)(*dst - ((*src1++ + *src2++) >> e));
+      }
+      else if (a == -1)
+      { // any case with a == -1, which is not 5/3 predict
+        if (synthesis)
+          for (ui32 i = repeat; i > 0; --i, ++dst)
+            *dst = (si16)(*dst - ((b - (*src1++ + *src2++)) >> e));
+        else
+          for (ui32 i = repeat; i > 0; --i, ++dst)
+            *dst = (si16)(*dst + ((b - (*src1++ + *src2++)) >> e));
+      }
+      else { // general case
+        if (synthesis)
+          for (ui32 i = repeat; i > 0; --i, ++dst)
+            *dst = (si16)(*dst - ((b + a * (*src1++ + *src2++)) >> e));
+        else
+          for (ui32 i = repeat; i > 0; --i, ++dst)
+            *dst = (si16)(*dst + ((b + a * (*src1++ + *src2++)) >> e));
+      }
+    }
+
     /////////////////////////////////////////////////////////////////////////
     static
     void gen_rev_vert_step32(const lifting_step* s, const line_buf* sig, 
@@ -313,7 +386,16 @@ namespace ojph {
                            const line_buf* other, const line_buf* aug, 
                            ui32 repeat, bool synthesis)
     {
-      if (((sig != NULL) && (sig->flags & line_buf::LFT_32BIT)) || 
+      if (((sig != NULL) && (sig->flags & line_buf::LFT_16BIT)) || 
+          ((aug != NULL) && (aug->flags & line_buf::LFT_16BIT)) ||
+          ((other != NULL) && (other->flags & line_buf::LFT_16BIT))) 
+      {
+        assert((sig == NULL || sig->flags & line_buf::LFT_16BIT) &&
+               (other == NULL || other->flags & line_buf::LFT_16BIT) && 
+               (aug == NULL || aug->flags & line_buf::LFT_16BIT));
+        gen_rev_vert_step16(s, sig, other, aug, repeat, synthesis);
+      }
+      else if (((sig != NULL) && (sig->flags & line_buf::LFT_32BIT)) || 
           ((aug != NULL) && (aug->flags & line_buf::LFT_32BIT)) ||
           ((other != NULL) && (other->flags & line_buf::LFT_32BIT))) 
       {
@@ -331,6 +413,85 @@ namespace ojph {
       }
     }
 
+    /////////////////////////////////////////////////////////////////////////
+    static
+    void gen_rev_horz_ana16(const param_atk* atk, const line_buf* ldst, 
+                            const line_buf* hdst, const line_buf* src, 
+                            ui32 width, bool even)
+    {
+      if (width > 1)
+      {
+        // combine both lsrc and hsrc into dst
+        si16* dph = hdst->i16;
+        si16* dpl = ldst->i16;
+        si16* sp = src->i16;
+        ui32 w = width;
+        if (!even)
+        {
+          *dph++ = *sp++; --w;
+        }
+        for (; w > 1; w -= 2)
+        {
+          *dpl++ = *sp++; *dph++ = *sp++;
+        }
+        if (w)
+        {
+          *dpl++ = *sp++; --w;
+        }
+
+        si16* hp = hdst->i16, * lp = ldst->i16;
+        ui32 l_width = (width + (even ? 1 : 0)) >> 1;  // low pass
+        ui32 h_width = (width + (even ? 0 : 1)) >> 1;  // high pass
+        ui32 num_steps = atk->get_num_steps();
+        for (ui32 j = num_steps; j > 0; --j)
+        {
+          // first lifting step
+          const lifting_step* s = atk->get_step(j - 1);
+          const si32 a = s->rev.Aatk;
+          const si32 b = s->rev.Batk;
+          const ui8 e = s->rev.Eatk;
+
+          // extension
+          lp[-1] = lp[0];
+          lp[l_width] = lp[l_width - 1];
+          // lifting step
+          const si16* sp = lp + (even ? 1 : 0);
+          si16* dp = hp;
+          if (a == 1) 
+          { // 5/3 update and any case with a == 1
+            for (ui32 i = h_width; i > 0; --i, sp++, dp++)
+              *dp = (si16)(*dp + ((b + (sp[-1] + sp[0])) >> e));
+          }
+          else if (a == -1 && b == 1 && e == 1)
+          {  // 5/3 predict
+            for (ui32 i = h_width; i > 0; --i, sp++, dp++)
+              *dp = (si16)(*dp - ((sp[-1] + sp[0]) >> e));
+          }
+          else if (a == -1)
+          { // any case with a == -1, which is not 5/3 predict
+            for (ui32 i = h_width; i > 0; --i, sp++, dp++)
+              *dp = (si16)(*dp + ((b - (sp[-1] + sp[0])) >> e));
+          }
+          else {
+            // general case
+            for (ui32 i = h_width; i > 0; --i, sp++, dp++)
+              *dp = (si16)(*dp + ((b + a * (sp[-1] + sp[0])) >> e));
+          }
+
+          // swap buffers
+          si16* t = lp; lp = hp; hp = t;
+          even = !even;
+          ui32 w = l_width; l_width = h_width; h_width = w;
+        }
+      }
+      else {
+        if (even)
+          ldst->i16[0] = src->i16[0];
+        else
+          hdst->i16[0] = (si16)(src->i16[0] << 1);
+      }
+    }
+
     /////////////////////////////////////////////////////////////////////////
     static
     void gen_rev_horz_ana32(const param_atk* atk, const line_buf* ldst, 
@@ -494,7 +655,13 @@ namespace ojph {
                           const line_buf* hdst, const line_buf* src, 
                           ui32 width, bool even)
     {
-      if (src->flags & line_buf::LFT_32BIT) 
+      if (src->flags & line_buf::LFT_16BIT) 
+      {
+        assert((ldst == NULL || ldst->flags & line_buf::LFT_16BIT) &&
+               (hdst == NULL || hdst->flags & line_buf::LFT_16BIT));
+        gen_rev_horz_ana16(atk, ldst, hdst, src, width, even);
+      }
+      else if (src->flags & line_buf::LFT_32BIT) 
       {
         assert((ldst == NULL || ldst->flags & line_buf::LFT_32BIT) &&
                (hdst == NULL || hdst->flags & line_buf::LFT_32BIT));
@@ -509,6 +676,85 @@ namespace ojph {
       }
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    static
+    void gen_rev_horz_syn16(const param_atk* atk, const line_buf* dst, 
+                            const line_buf* lsrc, const line_buf* hsrc, 
+                            ui32 width, bool even)
+    {
+      if (width > 1)
+      {
+        bool ev = even;
+        si16* oth = hsrc->i16, * aug = lsrc->i16;
+        ui32 aug_width = (width + (even ? 1 : 0)) >> 1;  // low pass
+        ui32 oth_width = (width + (even ? 0 : 1)) >> 1;  // high pass
+        ui32 num_steps = atk->get_num_steps();
+        for (ui32 j = 0; j < num_steps; ++j)
+        {
+          const lifting_step* s = atk->get_step(j);
+          const si32 a = s->rev.Aatk;
+          const si32 b = s->rev.Batk;
+          const ui8 e = s->rev.Eatk;
+
+          // extension
+          oth[-1] = oth[0];
+          oth[oth_width] = oth[oth_width - 1];
+          // lifting step
+          const si16* sp = oth + (ev ? 0 : 1);
+          si16* dp = aug;
+          if (a == 1)
+          { // 5/3 update and any case with a == 1
+            for (ui32 i = aug_width; i > 0; --i, sp++, dp++)
+              *dp = (si16)(*dp - ((b + (sp[-1] + sp[0])) >> e));
+          }
+          else if (a == -1 && b == 1 && e == 1)
+          {  // 5/3 predict
+            for (ui32 i = aug_width; i > 0; --i, sp++, dp++)
+              *dp = (si16)(*dp + ((sp[-1] + sp[0]) >> e));
+          }
+          else if (a == -1)
+          { // any case with a == -1, which is not 5/3 predict
+            for (ui32 i = aug_width; i > 0; --i, sp++, dp++)
+              *dp = (si16)(*dp - ((b - (sp[-1] + sp[0])) >> e));
+          }
+          else {
+            // general case
+            for (ui32 i = aug_width; i > 0; --i, sp++, dp++)
+              *dp = (si16)(*dp - ((b + a * (sp[-1] + sp[0])) >> e));
+          }
+
+          // swap buffers
+          si16* t = aug; aug = oth; oth = t;
+          ev = !ev;
+          ui32 w = aug_width; aug_width = oth_width; oth_width = w;
+        }
+
+        // combine both lsrc and hsrc into dst
+        si16* sph = hsrc->i16;
+        si16* spl = lsrc->i16;
+        si16* dp = dst->i16;
+        ui32 w = width;
+        if (!even)
+        {
+          *dp++ = *sph++; --w;
+        }
+        for (; w > 1; w -= 2)
+        {
+          *dp++ = *spl++; *dp++ = *sph++;
+        }
+        if (w)
+        {
+          *dp++ = *spl++; --w;
+        }
+      }
+      else {
+        if (even)
+          dst->i16[0] = lsrc->i16[0];
+        else
+          dst->i16[0] = (si16)(hsrc->i16[0] >> 1);
+      }
+    }
+
     //////////////////////////////////////////////////////////////////////////
     static
     void gen_rev_horz_syn32(const param_atk* atk, const line_buf* dst, 
@@ -672,7 +918,13 @@ namespace ojph {
                           const line_buf* lsrc, const line_buf* hsrc, 
                           ui32 width, bool even)
     {
-      if (dst->flags & line_buf::LFT_32BIT) 
+      if (dst->flags & line_buf::LFT_16BIT) 
+      {
+        assert((lsrc == NULL || lsrc->flags & line_buf::LFT_16BIT) && 
+               (hsrc == NULL || hsrc->flags & line_buf::LFT_16BIT));
+        gen_rev_horz_syn16(atk, dst, lsrc, hsrc, width, even);
+      }
+      else if (dst->flags & line_buf::LFT_32BIT) 
       {
         assert((lsrc == NULL || lsrc->flags & line_buf::LFT_32BIT) && 
                (hsrc == NULL || hsrc->flags & line_buf::LFT_32BIT));
@@ -53,6 +53,14 @@ namespace ojph {
     //////////////////////////////////////////////////////////////////////////
     void init_wavelet_transform_functions();
 
+    //////////////////////////////////////////////////////////////////////////
+    // Returns true when the reversible kernels selected by the init
+    // functions (wavelet, colour, and codeblock transfer) accept 16bit
+    // line_bufs; components whose precision, as given by
+    // param_qcd::propose_precision(), is 16 bits or less can then employ
+    // 16bit lines, halving their memory footprint and bandwidth.
+    bool rev_supports_16bit_lines();
+
     /////////////////////////////////////////////////////////////////////////
     // Reversible functions
     /////////////////////////////////////////////////////////////////////////
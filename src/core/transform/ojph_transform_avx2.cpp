@@ -142,6 +142,246 @@ namespace ojph {
       }
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void avx2_deinterleave16(si16* dpl, si16* dph, const si16* sp, int width)
+    {
+      for (; width > 0; width -= 32, sp += 32, dpl += 16, dph += 16)
+      {
+        __m256i a = _mm256_load_si256((__m256i*)sp);
+        __m256i b = _mm256_load_si256((__m256i*)sp + 1);
+        // even samples are in the LSBs of each 32bit lane, odd in the MSBs;
+        // packing works within 128bit lanes, so we fix the order after it
+        __m256i c = _mm256_packs_epi32(
+          _mm256_srai_epi32(_mm256_slli_epi32(a, 16), 16),
+          _mm256_srai_epi32(_mm256_slli_epi32(b, 16), 16));
+        __m256i d = _mm256_packs_epi32(_mm256_srai_epi32(a, 16),
+                                       _mm256_srai_epi32(b, 16));
+        c = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(3, 1, 2, 0));
+        d = _mm256_permute4x64_epi64(d, _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_store_si256((__m256i*)dpl, c);
+        _mm256_store_si256((__m256i*)dph, d);
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void avx2_interleave16(si16* dp, const si16* spl, const si16* sph,
+                           int width)
+    {
+      for (; width > 0; width -= 32, dp += 32, spl += 16, sph += 16)
+      {
+        __m256i a = _mm256_load_si256((__m256i*)spl);
+        __m256i b = _mm256_load_si256((__m256i*)sph);
+        __m256i c = _mm256_unpacklo_epi16(a, b);
+        __m256i d = _mm256_unpackhi_epi16(a, b);
+        __m256i e = _mm256_permute2x128_si256(c, d, (2 << 4) | (0));
+        __m256i f = _mm256_permute2x128_si256(c, d, (3 << 4) | (1));
+        _mm256_store_si256((__m256i*)dp, e);
+        _mm256_store_si256((__m256i*)dp + 1, f);
+      }
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // A lifting step on 16bit samples, dp[i] += (b + a * (sp1[i] + sp2[i]))
+    // >> e for analysis, or -= for synthesis.  Samples, and the sum of two
+    // of them, fit in 16 bits (see param_qcd::propose_precision()), and so
+    // the arithmetic is carried out in 16bit lanes; the general case,
+    // a != +/-1, uses 32bit arithmetic, as the generic implementation.
+    static inline
+    void avx2_rev_lift16(si16* dp, const si16* sp1, const si16* sp2,
+                         ui32 repeat, si32 a, si32 b, ui8 e, bool synthesis)
+    {
+      __m256i vb = _mm256_set1_epi16((si16)b);
+      int i = (int)repeat;
+      if (a == 1)
+      { // 5/3 update and any case with a == 1
+        if (synthesis)
+          for (; i > 0; i -= 16, dp += 16, sp1 += 16, sp2 += 16)
+          {
+            __m256i s1 = _mm256_loadu_si256((__m256i*)sp1);
+            __m256i s2 = _mm256_loadu_si256((__m256i*)sp2);
+            __m256i d = _mm256_load_si256((__m256i*)dp);
+            __m256i t = _mm256_add_epi16(s1, s2);
+            __m256i v = _mm256_add_epi16(vb, t);
+            __m256i w = _mm256_srai_epi16(v, e);
+            d = _mm256_sub_epi16(d, w);
+            _mm256_store_si256((__m256i*)dp, d);
+          }
+        else
+          for (; i > 0; i -= 16, dp += 16, sp1 += 16, sp2 += 16)
+          {
+            __m256i s1 = _mm256_loadu_si256((__m256i*)sp1);
+            __m256i s2 = _mm256_loadu_si256((__m256i*)sp2);
+            __m256i d = _mm256_load_si256((__m256i*)dp);
+            __m256i t = _mm256_add_epi16(s1, s2);
+            __m256i v = _mm256_add_epi16(vb, t);
+            __m256i w = _mm256_srai_epi16(v, e);
+            d = _mm256_add_epi16(d, w);
+            _mm256_store_si256((__m256i*)dp, d);
+          }
+      }
+      else if (a == -1 && b == 1 && e == 1)
+      { // 5/3 predict
+        if (synthesis)
+          for (; i > 0; i -= 16, dp += 16, sp1 += 16, sp2 += 16)
+          {
+            __m256i s1 = _mm256_loadu_si256((__m256i*)sp1);
+            __m256i s2 = _mm256_loadu_si256((__m256i*)sp2);
+            __m256i d = _mm256_load_si256((__m256i*)dp);
+            __m256i t = _mm256_add_epi16(s1, s2);
+            __m256i w = _mm256_srai_epi16(t, e);
+            d = _mm256_add_epi16(d, w);
+            _mm256_store_si256((__m256i*)dp, d);
+          }
+        else
+          for (; i > 0; i -= 16, dp += 16, sp1 += 16, sp2 += 16)
+          {
+            __m256i s1 = _mm256_loadu_si256((__m256i*)sp1);
+            __m256i s2 = _mm256_loadu_si256((__m256i*)sp2);
+            __m256i d = _mm256_load_si256((__m256i*)dp);
+            __m256i t = _mm256_add_epi16(s1, s2);
+            __m256i w = _mm256_srai_epi16(t, e);
+            d = _mm256_sub_epi16(d, w);
+            _mm256_store_si256((__m256i*)dp, d);
+          }
+      }
+      else if (a == -1)
+      { // any case with a == -1, which is not 5/3 predict
+        if (synthesis)
+          for (; i > 0; i -= 16, dp += 16, sp1 += 16, sp2 += 16)
+          {
+            __m256i s1 = _mm256_loadu_si256((__m256i*)sp1);
+            __m256i s2 = _mm256_loadu_si256((__m256i*)sp2);
+            __m256i d = _mm256_load_si256((__m256i*)dp);
+            __m256i t = _mm256_add_epi16(s1, s2);
+            __m256i v = _mm256_sub_epi16(vb, t);
+            __m256i w = _mm256_srai_epi16(v, e);
+            d = _mm256_sub_epi16(d, w);
+            _mm256_store_si256((__m256i*)dp, d);
+          }
+        else
+          for (; i > 0; i -= 16, dp += 16, sp1 += 16, sp2 += 16)
+          {
+            __m256i s1 = _mm256_loadu_si256((__m256i*)sp1);
+            __m256i s2 = _mm256_loadu_si256((__m256i*)sp2);
+            __m256i d = _mm256_load_si256((__m256i*)dp);
+            __m256i t = _mm256_add_epi16(s1, s2);
+            __m256i v = _mm256_sub_epi16(vb, t);
+            __m256i w = _mm256_srai_epi16(v, e);
+            d = _mm256_add_epi16(d, w);
+            _mm256_store_si256((__m256i*)dp, d);
+          }
+      }
+      else { // general case
+        if (synthesis)
+          for (; i > 0; --i, ++dp)
+            *dp = (si16)(*dp - ((b + a * (*sp1++ + *sp2++)) >> e));
+        else
+          for (; i > 0; --i, ++dp)
+            *dp = (si16)(*dp + ((b + a * (*sp1++ + *sp2++)) >> e));
+      }
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    static
+    void avx2_rev_vert_step16(const lifting_step* s, const line_buf* sig,
+                              const line_buf* other, const line_buf* aug,
+                              ui32 repeat, bool synthesis)
+    {
+      avx2_rev_lift16(aug->i16, sig->i16, other->i16, repeat,
+        s->rev.Aatk, s->rev.Batk, s->rev.Eatk, synthesis);
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    static
+    void avx2_rev_horz_ana16(const param_atk* atk, const line_buf* ldst,
+                             const line_buf* hdst, const line_buf* src,
+                             ui32 width, bool even)
+    {
+      if (width > 1)
+      {
+        // split src into ldst and hdst
+        {
+          si16* dpl = even ? ldst->i16 : hdst->i16;
+          si16* dph = even ? hdst->i16 : ldst->i16;
+          avx2_deinterleave16(dpl, dph, src->i16, (int)width);
+        }
+
+        si16* hp = hdst->i16, * lp = ldst->i16;
+        ui32 l_width = (width + (even ? 1 : 0)) >> 1;  // low pass
+        ui32 h_width = (width + (even ? 0 : 1)) >> 1;  // high pass
+        ui32 num_steps = atk->get_num_steps();
+        for (ui32 j = num_steps; j > 0; --j)
+        {
+          const lifting_step* s = atk->get_step(j - 1);
+
+          // extension
+          lp[-1] = lp[0];
+          lp[l_width] = lp[l_width - 1];
+          // lifting step
+          avx2_rev_lift16(hp, lp, even ? lp + 1 : lp - 1, h_width,
+            s->rev.Aatk, s->rev.Batk, s->rev.Eatk, false);
+
+          // swap buffers
+          si16* t = lp; lp = hp; hp = t;
+          even = !even;
+          ui32 w = l_width; l_width = h_width; h_width = w;
+        }
+      }
+      else {
+        if (even)
+          ldst->i16[0] = src->i16[0];
+        else
+          hdst->i16[0] = (si16)(src->i16[0] << 1);
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static
+    void avx2_rev_horz_syn16(const param_atk* atk, const line_buf* dst,
+                             const line_buf* lsrc, const line_buf* hsrc,
+                             ui32 width, bool even)
+    {
+      if (width > 1)
+      {
+        bool ev = even;
+        si16* oth = hsrc->i16, * aug = lsrc->i16;
+        ui32 aug_width = (width + (even ? 1 : 0)) >> 1;  // low pass
+        ui32 oth_width = (width + (even ? 0 : 1)) >> 1;  // high pass
+        ui32 num_steps = atk->get_num_steps();
+        for (ui32 j = 0; j < num_steps; ++j)
+        {
+          const lifting_step* s = atk->get_step(j);
+
+          // extension
+          oth[-1] = oth[0];
+          oth[oth_width] = oth[oth_width - 1];
+          // lifting step
+          avx2_rev_lift16(aug, oth, ev ? oth - 1 : oth + 1, aug_width,
+            s->rev.Aatk, s->rev.Batk, s->rev.Eatk, true);
+
+          // swap buffers
+          si16* t = aug; aug = oth; oth = t;
+          ev = !ev;
+          ui32 w = aug_width; aug_width = oth_width; oth_width = w;
+        }
+
+        // combine both lsrc and hsrc into dst
+        {
+          si16* spl = even ? lsrc->i16 : hsrc->i16;
+          si16* sph = even ? hsrc->i16 : lsrc->i16;
+          avx2_interleave16(dst->i16, spl, sph, (int)width);
+        }
+      }
+      else {
+        if (even)
+          dst->i16[0] = lsrc->i16[0];
+        else
+          dst->i16[0] = (si16)(hsrc->i16[0] >> 1);
+      }
+    }
+
     /////////////////////////////////////////////////////////////////////////
     static
     void avx2_rev_vert_step32(const lifting_step* s, const line_buf* sig,
@@ -388,7 +628,16 @@ namespace ojph {
                             const line_buf* other, const line_buf* aug,
                             ui32 repeat, bool synthesis)
     {
-      if (((sig != NULL) && (sig->flags & line_buf::LFT_32BIT)) ||
+      if (((sig != NULL) && (sig->flags & line_buf::LFT_16BIT)) ||
+          ((aug != NULL) && (aug->flags & line_buf::LFT_16BIT)) ||
+          ((other != NULL) && (other->flags & line_buf::LFT_16BIT)))
+      {
+        assert((sig == NULL || sig->flags & line_buf::LFT_16BIT) &&
+               (other == NULL || other->flags & line_buf::LFT_16BIT) &&
+               (aug == NULL || aug->flags & line_buf::LFT_16BIT));
+        avx2_rev_vert_step16(s, sig, other, aug, repeat, synthesis);
+      }
+      else if (((sig != NULL) && (sig->flags & line_buf::LFT_32BIT)) ||
           ((aug != NULL) && (aug->flags & line_buf::LFT_32BIT)) ||
           ((other != NULL) && (other->flags & line_buf::LFT_32BIT)))
       {
@@ -728,7 +977,13 @@ namespace ojph {
                            const line_buf* hdst, const line_buf* src,
                            ui32 width, bool even)
     {
-      if (src->flags & line_buf::LFT_32BIT)
+      if (src->flags & line_buf::LFT_16BIT)
+      {
+        assert((ldst == NULL || ldst->flags & line_buf::LFT_16BIT) &&
+               (hdst == NULL || hdst->flags & line_buf::LFT_16BIT));
+        avx2_rev_horz_ana16(atk, ldst, hdst, src, width, even);
+      }
+      else if (src->flags & line_buf::LFT_32BIT)
       {
         assert((ldst == NULL || ldst->flags & line_buf::LFT_32BIT) &&
                (hdst == NULL || hdst->flags & line_buf::LFT_32BIT));
@@ -1065,7 +1320,13 @@ namespace ojph {
                            const line_buf* lsrc, const line_buf* hsrc,
                            ui32 width, bool even)
     {
-      if (dst->flags & line_buf::LFT_32BIT)
+      if (dst->flags & line_buf::LFT_16BIT)
+      {
+        assert((lsrc == NULL || lsrc->flags & line_buf::LFT_16BIT) &&
+               (hsrc == NULL || hsrc->flags & line_buf::LFT_16BIT));
+        avx2_rev_horz_syn16(atk, dst, lsrc, hsrc, width, even);
+      }
+      else if (dst->flags & line_buf::LFT_32BIT)
       {
         assert((lsrc == NULL || lsrc->flags & line_buf::LFT_32BIT) &&
                (hsrc == NULL || hsrc->flags & line_buf::LFT_32BIT));
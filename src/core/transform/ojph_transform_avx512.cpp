@@ -676,12 +676,27 @@ namespace ojph {
       // }
     }
 
+    /////////////////////////////////////////////////////////////////////////
+    // 16bit lines need AVX512BW, which this file is not compiled for; the
+    // AVX2 kernels, which process 16 such samples per instruction, are used
+    // instead
+  #ifndef OJPH_DISABLE_AVX2
+    #define avx512_rev_16bit_fallback(name) avx2_rev_##name
+  #else
+    #define avx512_rev_16bit_fallback(name) gen_rev_##name
+  #endif
+
     /////////////////////////////////////////////////////////////////////////
     void avx512_rev_vert_step(const lifting_step* s, const line_buf* sig,
                               const line_buf* other, const line_buf* aug,
                               ui32 repeat, bool synthesis)
     {
-      if (((sig != NULL) && (sig->flags & line_buf::LFT_32BIT)) ||
+      if (((sig != NULL) && (sig->flags & line_buf::LFT_16BIT)) ||
+          ((aug != NULL) && (aug->flags & line_buf::LFT_16BIT)) ||
+          ((other != NULL) && (other->flags & line_buf::LFT_16BIT)))
+        avx512_rev_16bit_fallback(vert_step)(s, sig, other, aug, repeat,
+                                             synthesis);
+      else if (((sig != NULL) && (sig->flags & line_buf::LFT_32BIT)) ||
           ((aug != NULL) && (aug->flags & line_buf::LFT_32BIT)) ||
           ((other != NULL) && (other->flags & line_buf::LFT_32BIT)))
       {
@@ -1052,7 +1067,9 @@ namespace ojph {
                              const line_buf* hdst, const line_buf* src,
                              ui32 width, bool even)
     {
-      if (src->flags & line_buf::LFT_32BIT)
+      if (src->flags & line_buf::LFT_16BIT)
+        avx512_rev_16bit_fallback(horz_ana)(atk, ldst, hdst, src, width, even);
+      else if (src->flags & line_buf::LFT_32BIT)
       {
         assert((ldst == NULL || ldst->flags & line_buf::LFT_32BIT) &&
                (hdst == NULL || hdst->flags & line_buf::LFT_32BIT));
@@ -1420,7 +1437,9 @@ namespace ojph {
                              const line_buf* lsrc, const line_buf* hsrc,
                              ui32 width, bool even)
     {
-      if (dst->flags & line_buf::LFT_32BIT)
+      if (dst->flags & line_buf::LFT_16BIT)
+        avx512_rev_16bit_fallback(horz_syn)(atk, dst, lsrc, hsrc, width, even);
+      else if (dst->flags & line_buf::LFT_32BIT)
       {
         assert((lsrc == NULL || lsrc->flags & line_buf::LFT_32BIT) &&
                (hsrc == NULL || hsrc->flags & line_buf::LFT_32BIT));
@@ -1435,6 +1454,8 @@ namespace ojph {
       }
     }
 
+    #undef avx512_rev_16bit_fallback
+
   } // !local
 } // !ojph
 
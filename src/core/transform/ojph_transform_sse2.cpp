@@ -133,6 +133,240 @@ namespace ojph {
       }
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void sse2_deinterleave16(si16* dpl, si16* dph, const si16* sp, int width)
+    {
+      for (; width > 0; width -= 16, sp += 16, dpl += 8, dph += 8)
+      {
+        __m128i a = _mm_load_si128((__m128i*)sp);
+        __m128i b = _mm_load_si128((__m128i*)sp + 1);
+        // even samples are in the LSBs of each 32bit lane, odd in the MSBs
+        __m128i c = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16),
+                                    _mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+        __m128i d = _mm_packs_epi32(_mm_srai_epi32(a, 16),
+                                    _mm_srai_epi32(b, 16));
+        _mm_store_si128((__m128i*)dpl, c);
+        _mm_store_si128((__m128i*)dph, d);
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void sse2_interleave16(si16* dp, const si16* spl, const si16* sph,
+                           int width)
+    {
+      for (; width > 0; width -= 16, dp += 16, spl += 8, sph += 8)
+      {
+        __m128i a = _mm_load_si128((__m128i*)spl);
+        __m128i b = _mm_load_si128((__m128i*)sph);
+        __m128i c = _mm_unpacklo_epi16(a, b);
+        __m128i d = _mm_unpackhi_epi16(a, b);
+        _mm_store_si128((__m128i*)dp, c);
+        _mm_store_si128((__m128i*)dp + 1, d);
+      }
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // A lifting step on 16bit samples, dp[i] += (b + a * (sp1[i] + sp2[i]))
+    // >> e for analysis, or -= for synthesis.  Samples, and the sum of two
+    // of them, fit in 16 bits (see param_qcd::propose_precision()), and so
+    // the arithmetic is carried out in 16bit lanes; the general case,
+    // a != +/-1, uses 32bit arithmetic, as the generic implementation.
+    static inline
+    void sse2_rev_lift16(si16* dp, const si16* sp1, const si16* sp2,
+                         ui32 repeat, si32 a, si32 b, ui8 e, bool synthesis)
+    {
+      __m128i vb = _mm_set1_epi16((si16)b);
+      int i = (int)repeat;
+      if (a == 1)
+      { // 5/3 update and any case with a == 1
+        if (synthesis)
+          for (; i > 0; i -= 8, dp += 8, sp1 += 8, sp2 += 8)
+          {
+            __m128i s1 = _mm_loadu_si128((__m128i*)sp1);
+            __m128i s2 = _mm_loadu_si128((__m128i*)sp2);
+            __m128i d = _mm_load_si128((__m128i*)dp);
+            __m128i t = _mm_add_epi16(s1, s2);
+            __m128i v = _mm_add_epi16(vb, t);
+            __m128i w = _mm_srai_epi16(v, e);
+            d = _mm_sub_epi16(d, w);
+            _mm_store_si128((__m128i*)dp, d);
+          }
+        else
+          for (; i > 0; i -= 8, dp += 8, sp1 += 8, sp2 += 8)
+          {
+            __m128i s1 = _mm_loadu_si128((__m128i*)sp1);
+            __m128i s2 = _mm_loadu_si128((__m128i*)sp2);
+            __m128i d = _mm_load_si128((__m128i*)dp);
+            __m128i t = _mm_add_epi16(s1, s2);
+            __m128i v = _mm_add_epi16(vb, t);
+            __m128i w = _mm_srai_epi16(v, e);
+            d = _mm_add_epi16(d, w);
+            _mm_store_si128((__m128i*)dp, d);
+          }
+      }
+      else if (a == -1 && b == 1 && e == 1)
+      { // 5/3 predict
+        if (synthesis)
+          for (; i > 0; i -= 8, dp += 8, sp1 += 8, sp2 += 8)
+          {
+            __m128i s1 = _mm_loadu_si128((__m128i*)sp1);
+            __m128i s2 = _mm_loadu_si128((__m128i*)sp2);
+            __m128i d = _mm_load_si128((__m128i*)dp);
+            __m128i t = _mm_add_epi16(s1, s2);
+            __m128i w = _mm_srai_epi16(t, e);
+            d = _mm_add_epi16(d, w);
+            _mm_store_si128((__m128i*)dp, d);
+          }
+        else
+          for (; i > 0; i -= 8, dp += 8, sp1 += 8, sp2 += 8)
+          {
+            __m128i s1 = _mm_loadu_si128((__m128i*)sp1);
+            __m128i s2 = _mm_loadu_si128((__m128i*)sp2);
+            __m128i d = _mm_load_si128((__m128i*)dp);
+            __m128i t = _mm_add_epi16(s1, s2);
+            __m128i w = _mm_srai_epi16(t, e);
+            d = _mm_sub_epi16(d, w);
+            _mm_store_si128((__m128i*)dp, d);
+          }
+      }
+      else if (a == -1)
+      { // any case with a == -1, which is not 5/3 predict
+        if (synthesis)
+          for (; i > 0; i -= 8, dp += 8, sp1 += 8, sp2 += 8)
+          {
+            __m128i s1 = _mm_loadu_si128((__m128i*)sp1);
+            __m128i s2 = _mm_loadu_si128((__m128i*)sp2);
+            __m128i d = _mm_load_si128((__m128i*)dp);
+            __m128i t = _mm_add_epi16(s1, s2);
+            __m128i v = _mm_sub_epi16(vb, t);
+            __m128i w = _mm_srai_epi16(v, e);
+            d = _mm_sub_epi16(d, w);
+            _mm_store_si128((__m128i*)dp, d);
+          }
+        else
+          for (; i > 0; i -= 8, dp += 8, sp1 += 8, sp2 += 8)
+          {
+            __m128i s1 = _mm_loadu_si128((__m128i*)sp1);
+            __m128i s2 = _mm_loadu_si128((__m128i*)sp2);
+            __m128i d = _mm_load_si128((__m128i*)dp);
+            __m128i t = _mm_add_epi16(s1, s2);
+            __m128i v = _mm_sub_epi16(vb, t);
+            __m128i w = _mm_srai_epi16(v, e);
+            d = _mm_add_epi16(d, w);
+            _mm_store_si128((__m128i*)dp, d);
+          }
+      }
+      else { // general case
+        if (synthesis)
+          for (; i > 0; --i, ++dp)
+            *dp = (si16)(*dp - ((b + a * (*sp1++ + *sp2++)) >> e));
+        else
+          for (; i > 0; --i, ++dp)
+            *dp = (si16)(*dp + ((b + a * (*sp1++ + *sp2++)) >> e));
+      }
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    static
+    void sse2_rev_vert_step16(const lifting_step* s, const line_buf* sig,
+                              const line_buf* other, const line_buf* aug,
+                              ui32 repeat, bool synthesis)
+    {
+      sse2_rev_lift16(aug->i16, sig->i16, other->i16, repeat,
+        s->rev.Aatk, s->rev.Batk, s->rev.Eatk, synthesis);
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    static
+    void sse2_rev_horz_ana16(const param_atk* atk, const line_buf* ldst,
+                             const line_buf* hdst, const line_buf* src,
+                             ui32 width, bool even)
+    {
+      if (width > 1)
+      {
+        // split src into ldst and hdst
+        {
+          si16* dpl = even ? ldst->i16 : hdst->i16;
+          si16* dph = even ? hdst->i16 : ldst->i16;
+          sse2_deinterleave16(dpl, dph, src->i16, (int)width);
+        }
+
+        si16* hp = hdst->i16, * lp = ldst->i16;
+        ui32 l_width = (width + (even ? 1 : 0)) >> 1;  // low pass
+        ui32 h_width = (width + (even ? 0 : 1)) >> 1;  // high pass
+        ui32 num_steps = atk->get_num_steps();
+        for (ui32 j = num_steps; j > 0; --j)
+        {
+          const lifting_step* s = atk->get_step(j - 1);
+
+          // extension
+          lp[-1] = lp[0];
+          lp[l_width] = lp[l_width - 1];
+          // lifting step
+          sse2_rev_lift16(hp, lp, even ? lp + 1 : lp - 1, h_width,
+            s->rev.Aatk, s->rev.Batk, s->rev.Eatk, false);
+
+          // swap buffers
+          si16* t = lp; lp = hp; hp = t;
+          even = !even;
+          ui32 w = l_width; l_width = h_width; h_width = w;
+        }
+      }
+      else {
+        if (even)
+          ldst->i16[0] = src->i16[0];
+        else
+          hdst->i16[0] = (si16)(src->i16[0] << 1);
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static
+    void sse2_rev_horz_syn16(const param_atk* atk, const line_buf* dst,
+                             const line_buf* lsrc, const line_buf* hsrc,
+                             ui32 width, bool even)
+    {
+      if (width > 1)
+      {
+        bool ev = even;
+        si16* oth = hsrc->i16, * aug = lsrc->i16;
+        ui32 aug_width = (width + (even ? 1 : 0)) >> 1;  // low pass
+        ui32 oth_width = (width + (even ? 0 : 1)) >> 1;  // high pass
+        ui32 num_steps = atk->get_num_steps();
+        for (ui32 j = 0; j < num_steps; ++j)
+        {
+          const lifting_step* s = atk->get_step(j);
+
+          // extension
+          oth[-1] = oth[0];
+          oth[oth_width] = oth[oth_width - 1];
+          // lifting step
+          sse2_rev_lift16(aug, oth, ev ? oth - 1 : oth + 1, aug_width,
+            s->rev.Aatk, s->rev.Batk, s->rev.Eatk, true);
+
+          // swap buffers
+          si16* t = aug; aug = oth; oth = t;
+          ev = !ev;
+          ui32 w = aug_width; aug_width = oth_width; oth_width = w;
+        }
+
+        // combine both lsrc and hsrc into dst
+        {
+          si16* spl = even ? lsrc->i16 : hsrc->i16;
+          si16* sph = even ? hsrc->i16 : lsrc->i16;
+          sse2_interleave16(dst->i16, spl, sph, (int)width);
+        }
+      }
+      else {
+        if (even)
+          dst->i16[0] = lsrc->i16[0];
+        else
+          dst->i16[0] = (si16)(hsrc->i16[0] >> 1);
+      }
+    }
+
     /////////////////////////////////////////////////////////////////////////
     static
     void sse2_rev_vert_step32(const lifting_step* s, const line_buf* sig,
@@ -359,7 +593,16 @@ namespace ojph {
                             const line_buf* other, const line_buf* aug,
                             ui32 repeat, bool synthesis)
     {
-      if (((sig != NULL) && (sig->flags & line_buf::LFT_32BIT)) ||
+      if (((sig != NULL) && (sig->flags & line_buf::LFT_16BIT)) ||
+          ((aug != NULL) && (aug->flags & line_buf::LFT_16BIT)) ||
+          ((other != NULL) && (other->flags & line_buf::LFT_16BIT)))
+      {
+        assert((sig == NULL || sig->flags & line_buf::LFT_16BIT) &&
+               (other == NULL || other->flags & line_buf::LFT_16BIT) &&
+               (aug == NULL || aug->flags & line_buf::LFT_16BIT));
+        sse2_rev_vert_step16(s, sig, other, aug, repeat, synthesis);
+      }
+      else if (((sig != NULL) && (sig->flags & line_buf::LFT_32BIT)) ||
           ((aug != NULL) && (aug->flags & line_buf::LFT_32BIT)) ||
           ((other != NULL) && (other->flags & line_buf::LFT_32BIT)))
       {
@@ -677,7 +920,13 @@ namespace ojph {
                            const line_buf* hdst, const line_buf* src,
                            ui32 width, bool even)
     {
-      if (src->flags & line_buf::LFT_32BIT)
+      if (src->flags & line_buf::LFT_16BIT)
+      {
+        assert((ldst == NULL || ldst->flags & line_buf::LFT_16BIT) &&
+               (hdst == NULL || hdst->flags & line_buf::LFT_16BIT));
+        sse2_rev_horz_ana16(atk, ldst, hdst, src, width, even);
+      }
+      else if (src->flags & line_buf::LFT_32BIT)
       {
         assert((ldst == NULL || ldst->flags & line_buf::LFT_32BIT) &&
                (hdst == NULL || hdst->flags & line_buf::LFT_32BIT));
@@ -992,7 +1241,13 @@ namespace ojph {
                            const line_buf* lsrc, const line_buf* hsrc,
                            ui32 width, bool even)
     {
-      if (dst->flags & line_buf::LFT_32BIT)
+      if (dst->flags & line_buf::LFT_16BIT)
+      {
+        assert((lsrc == NULL || lsrc->flags & line_buf::LFT_16BIT) &&
+               (hsrc == NULL || hsrc->flags & line_buf::LFT_16BIT));
+        sse2_rev_horz_syn16(atk, dst, lsrc, hsrc, width, even);
+      }
+      else if (dst->flags & line_buf::LFT_32BIT)
       {
         assert((lsrc == NULL || lsrc->flags & line_buf::LFT_32BIT) &&
                (hsrc == NULL || hsrc->flags & line_buf::LFT_32BIT));
@@ -0,0 +1,210 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2026, Aous Naman
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: test_coded_size_stats.cpp
+// Author: Aous Naman
+// Date: 19 October 2026
+//***************************************************************************/
+//
+// These tests check codestream::get_coded_size_stats(); an encoder and a
+// decoder of the same codestream must report the same sizes.
+//
+// Everything is done in memory, so the tests need no external files.
+
+#include <vector>
+
+#include "ojph_arch.h"
+#include "ojph_codestream.h"
+#include "ojph_file.h"
+#include "ojph_mem.h"
+#include "ojph_params.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+static const ojph::ui32 IMAGE_WIDTH  = 160;
+static const ojph::ui32 IMAGE_HEIGHT = 96;
+static const ojph::ui32 NUM_DECOMPS  = 3;
+static const ojph::ui32 ALL          = ojph::coded_size_stats::ALL;
+
+////////////////////////////////////////////////////////////////////////////////
+// Encodes a two component 8 bit image with 32x32 codeblocks, and returns
+// the codestream; component 0 is a ramp, and component 1 is flat, so that
+// all the codeblocks of its high-pass bands are zero blocks.
+static std::vector<ojph::ui8> encode(ojph::codestream& cs)
+{
+  ojph::param_siz siz = cs.access_siz();
+  siz.set_image_extent(ojph::point(IMAGE_WIDTH, IMAGE_HEIGHT));
+  siz.set_num_components(2);
+  for (ojph::ui32 c = 0; c < 2; ++c)
+    siz.set_component(c, ojph::point(1, 1), 8, false);
+  ojph::param_cod cod = cs.access_cod();
+  cod.set_num_decomposition(NUM_DECOMPS);
+  cod.set_block_dims(32, 32);
+  cod.set_reversible(true);
+  cod.set_color_transform(false);
+  cs.set_planar(false);
+
+  ojph::mem_outfile out;
+  out.open();
+  cs.write_headers(&out);
+  ojph::ui32 next_comp = 0;
+  ojph::line_buf* line = cs.exchange(NULL, next_comp);
+  for (ojph::ui32 y = 0; y < IMAGE_HEIGHT; ++y)
+    for (ojph::ui32 c = 0; c < 2; ++c)
+    {
+      for (ojph::ui32 x = 0; x < IMAGE_WIDTH; ++x)
+        line->i32[x] = c ? 200 : (ojph::si32)((x * 3 + y * 5) & 0xFF);
+      line = cs.exchange(line, next_comp);
+    }
+  cs.flush();
+  cs.close();
+  return std::vector<ojph::ui8>(out.get_data(),
+                                out.get_data() + out.get_used_size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Parses the headers of a codestream and creates it, without pulling any
+// samples; the sizes are then available.
+static void parse(ojph::codestream& cs, ojph::mem_infile& in,
+                  const std::vector<ojph::ui8>& data)
+{
+  in.open(data.data(), data.size());
+  cs.read_headers(&in);
+  cs.create();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static void expect_same(const ojph::coded_size_stats& a,
+                        const ojph::coded_size_stats& b)
+{
+  EXPECT_EQ(a.num_blocks, b.num_blocks);
+  EXPECT_EQ(a.num_zero_blocks, b.num_zero_blocks);
+  EXPECT_EQ(a.coded_bytes, b.coded_bytes);
+  EXPECT_EQ(a.missing_msbs, b.missing_msbs);
+  EXPECT_EQ(a.packet_bytes, b.packet_bytes);
+  for (ojph::ui32 k = 0; k < ojph::coded_size_stats::NUM_SIZE_BINS; ++k)
+    EXPECT_EQ(a.size_histogram[k], b.size_histogram[k]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The decoder finds, in the packet headers, the sizes the encoder
+// produced, for every component, resolution, and band.
+TEST(coded_size_stats, decoder_matches_encoder)
+{
+  ojph::codestream enc;
+  std::vector<ojph::ui8> data = encode(enc);
+  ojph::codestream dec;
+  ojph::mem_infile in;
+  parse(dec, in, data);
+
+  for (ojph::ui32 c = 0; c < 2; ++c)
+    for (ojph::ui32 r = 0; r <= NUM_DECOMPS; ++r)
+      for (ojph::ui32 b = 0; b < 4; ++b)
+        expect_same(enc.get_coded_size_stats(c, r, b),
+                    dec.get_coded_size_stats(c, r, b));
+  expect_same(enc.get_coded_size_stats(ALL, ALL, ALL),
+              dec.get_coded_size_stats(ALL, ALL, ALL));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The sizes of all the codeblocks are the sums of those of each band, and
+// the packets hold the codeblocks, and the headers of the packets.
+TEST(coded_size_stats, totals)
+{
+  ojph::codestream cs;
+  std::vector<ojph::ui8> data = encode(cs);
+
+  ojph::coded_size_stats all = cs.get_coded_size_stats(ALL, ALL, ALL);
+  // 1 codeblock in LL, and in each band of the third level, 2x1 in each
+  // of the second, and 3x2 in each of the first, for each component
+  EXPECT_EQ(all.num_blocks, (ojph::ui64)2 * (1 + 3 * 1 + 3 * 2 + 3 * 6));
+  EXPECT_GT(all.coded_bytes, 0u);
+  EXPECT_LT(all.coded_bytes, all.packet_bytes);
+  EXPECT_LT(all.packet_bytes, (ojph::ui64)data.size());
+
+  ojph::ui64 blocks = 0, zero_blocks = 0, coded_bytes = 0;
+  ojph::ui64 missing_msbs = 0, packet_bytes = 0;
+  for (ojph::ui32 c = 0; c < 2; ++c)
+    for (ojph::ui32 r = 0; r <= NUM_DECOMPS; ++r)
+    {
+      packet_bytes += cs.get_coded_size_stats(c, r, ALL).packet_bytes;
+      for (ojph::ui32 b = 0; b < 4; ++b)
+      {
+        ojph::coded_size_stats s = cs.get_coded_size_stats(c, r, b);
+        EXPECT_EQ(s.packet_bytes, 0u);
+        EXPECT_EQ(s.num_blocks == 0, r == 0 ? b != 0 : b == 0);
+        blocks += s.num_blocks;
+        zero_blocks += s.num_zero_blocks;
+        coded_bytes += s.coded_bytes;
+        missing_msbs += s.missing_msbs;
+      }
+    }
+  EXPECT_EQ(blocks, all.num_blocks);
+  EXPECT_EQ(zero_blocks, all.num_zero_blocks);
+  EXPECT_EQ(coded_bytes, all.coded_bytes);
+  EXPECT_EQ(missing_msbs, all.missing_msbs);
+  EXPECT_EQ(packet_bytes, all.packet_bytes);
+
+  ojph::ui64 histogram = 0;
+  for (ojph::ui32 k = 0; k < ojph::coded_size_stats::NUM_SIZE_BINS; ++k)
+    histogram += all.size_histogram[k];
+  EXPECT_EQ(histogram, all.num_blocks);
+  EXPECT_EQ(all.size_histogram[0], all.num_zero_blocks);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A flat component has data in its LL band only; restart() clears the
+// sizes.
+TEST(coded_size_stats, zero_blocks)
+{
+  ojph::codestream cs;
+  encode(cs);
+
+  ojph::coded_size_stats ll = cs.get_coded_size_stats(1, 0, 0);
+  EXPECT_EQ(ll.num_blocks, 1u);
+  EXPECT_EQ(ll.num_zero_blocks, 0u);
+  EXPECT_EQ(ll.get_zero_block_ratio(), 0.0);
+  EXPECT_GT(ll.get_average_missing_msbs(), 0.0);
+  for (ojph::ui32 r = 1; r <= NUM_DECOMPS; ++r)
+  {
+    ojph::coded_size_stats s = cs.get_coded_size_stats(1, r, ALL);
+    EXPECT_GT(s.num_blocks, 0u);
+    EXPECT_EQ(s.get_zero_block_ratio(), 1.0);
+    EXPECT_EQ(s.coded_bytes, 0u);
+    EXPECT_EQ(s.get_average_missing_msbs(), 0.0);
+  }
+
+  cs.restart();
+  EXPECT_EQ(cs.get_coded_size_stats(ALL, ALL, ALL).num_blocks, 0u);
+}
+
+}
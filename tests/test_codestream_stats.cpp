@@ -0,0 +1,214 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2026, Aous Naman
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: test_codestream_stats.cpp
+// Author: Aous Naman
+// Date: 19 October 2026
+//***************************************************************************/
+//
+// These tests check the counters reported by codestream::get_stats(); the
+// times depend on the machine, so only their consistency is checked.
+//
+// Everything is done in memory, so the tests need no external files.
+
+#include <vector>
+
+#include "ojph_arch.h"
+#include "ojph_codestream.h"
+#include "ojph_file.h"
+#include "ojph_mem.h"
+#include "ojph_params.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+static const ojph::ui32 IMAGE_WIDTH  = 160;
+static const ojph::ui32 IMAGE_HEIGHT = 96;
+static const ojph::ui32 NUM_DECOMPS  = 3;
+
+////////////////////////////////////////////////////////////////////////////////
+// Encodes a three component 8 bit image, with the colour transform and
+// 32x32 codeblocks, and returns the codestream.
+static std::vector<ojph::ui8> encode(ojph::codestream& cs)
+{
+  ojph::param_siz siz = cs.access_siz();
+  siz.set_image_extent(ojph::point(IMAGE_WIDTH, IMAGE_HEIGHT));
+  siz.set_num_components(3);
+  for (ojph::ui32 c = 0; c < 3; ++c)
+    siz.set_component(c, ojph::point(1, 1), 8, false);
+  ojph::param_cod cod = cs.access_cod();
+  cod.set_num_decomposition(NUM_DECOMPS);
+  cod.set_block_dims(32, 32);
+  cod.set_reversible(true);
+  cod.set_color_transform(true);
+
+  ojph::mem_outfile out;
+  out.open();
+  cs.write_headers(&out);
+  ojph::ui32 next_comp = 0;
+  ojph::line_buf* line = cs.exchange(NULL, next_comp);
+  for (ojph::ui32 y = 0; y < IMAGE_HEIGHT; ++y)
+    for (ojph::ui32 c = 0; c < 3; ++c)
+    {
+      for (ojph::ui32 x = 0; x < IMAGE_WIDTH; ++x)
+        line->i32[x] = (ojph::si32)((x * (3 + c) + y * 5) & 0xFF);
+      line = cs.exchange(line, next_comp);
+    }
+  cs.flush();
+  cs.close();
+  return std::vector<ojph::ui8>(out.get_data(),
+                                out.get_data() + out.get_used_size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Returns the number of codeblocks of all subbands and components.
+static ojph::ui64 total_blocks(const ojph::codestream_stats& s)
+{
+  ojph::ui64 n = 0;
+  for (ojph::ui32 r = 0; r < ojph::codestream_stats::MAX_RESOLUTIONS; ++r)
+    for (ojph::ui32 b = 0; b < ojph::codestream_stats::NUM_BANDS; ++b)
+      n += s.block_stage[r][b].count;
+  return n;
+}
+
+#ifndef OJPH_DISABLE_STATS
+
+////////////////////////////////////////////////////////////////////////////////
+// Decodes a codestream, discarding the samples.
+static void decode(ojph::codestream& cs, const std::vector<ojph::ui8>& data)
+{
+  ojph::mem_infile in;
+  in.open(data.data(), data.size());
+  cs.read_headers(&in);
+  cs.create();
+  for (ojph::ui32 y = 0; y < IMAGE_HEIGHT; ++y)
+    for (ojph::ui32 c = 0; c < 3; ++c)
+    {
+      ojph::ui32 comp_num;
+      cs.pull(comp_num);
+    }
+  cs.close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Checks the counts of an encode or a decode of the image above; the
+// 160x96 image has one codeblock in the LL band, and in each subband of
+// the third decomposition level, 2x1 in each of the second, and 3x2 in
+// each of the first, for each of its three components.
+static void check_counts(const ojph::codestream_stats& s)
+{
+  EXPECT_EQ(s.colour_stage.count, (ojph::ui64)3 * IMAGE_HEIGHT);
+  EXPECT_EQ(total_blocks(s), (ojph::ui64)3 * (1 + 3 * 1 + 3 * 2 + 3 * 6));
+  for (ojph::ui32 b = 1; b < ojph::codestream_stats::NUM_BANDS; ++b)
+  {
+    EXPECT_EQ(s.block_stage[0][b].count, 0u);
+    EXPECT_EQ(s.block_stage[NUM_DECOMPS][b].count, (ojph::ui64)3 * 6);
+  }
+  // one precinct per resolution
+  EXPECT_EQ(s.packet_stage.count, (ojph::ui64)3 * (NUM_DECOMPS + 1));
+  for (ojph::ui32 r = 0; r <= NUM_DECOMPS; ++r)
+    EXPECT_GT(s.dwt_stage[r].count, 0u);
+  for (ojph::ui32 r = NUM_DECOMPS + 1;
+       r < ojph::codestream_stats::MAX_RESOLUTIONS; ++r)
+    EXPECT_EQ(s.dwt_stage[r].count, 0u);
+  EXPECT_GT(s.alloc_count, 0u);
+  EXPECT_GT(s.alloc_bytes, 0u);
+
+  double dwt = 0.0;
+  for (ojph::ui32 r = 0; r < ojph::codestream_stats::MAX_RESOLUTIONS; ++r)
+    dwt += s.dwt_stage[r].seconds;
+  EXPECT_DOUBLE_EQ(s.dwt, dwt);
+  EXPECT_DOUBLE_EQ(s.codestream,
+                   s.packet_stage.seconds + s.codestream_stage.seconds);
+}
+
+#endif // !OJPH_DISABLE_STATS
+
+////////////////////////////////////////////////////////////////////////////////
+// Nothing but allocations is counted unless stats are enabled.
+TEST(codestream_stats, disabled_by_default)
+{
+  ojph::codestream cs;
+  encode(cs);
+  ojph::codestream_stats s = cs.get_stats();
+  EXPECT_EQ(s.colour_stage.count, 0u);
+  EXPECT_EQ(total_blocks(s), 0u);
+  EXPECT_EQ(s.packet_stage.count, 0u);
+  EXPECT_EQ(s.block_coding, 0.0);
+  EXPECT_GT(s.alloc_count, 0u);
+
+  cs.reset_stats();
+  s = cs.get_stats();
+  EXPECT_EQ(s.alloc_count, 0u);
+  EXPECT_EQ(s.alloc_bytes, 0u);
+}
+
+#ifndef OJPH_DISABLE_STATS
+
+////////////////////////////////////////////////////////////////////////////////
+// Encoding counts every line, codeblock and packet once.
+TEST(codestream_stats, encoder_counts)
+{
+  ojph::codestream cs;
+  cs.enable_stats(true);
+  encode(cs);
+  check_counts(cs.get_stats());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Decoding counts the same work as encoding, and the counts survive
+// restart(), accumulating over codestreams, until reset_stats().
+TEST(codestream_stats, decoder_counts_accumulate)
+{
+  std::vector<ojph::ui8> data;
+  {
+    ojph::codestream enc;
+    data = encode(enc);
+  }
+  ojph::codestream cs;
+  cs.enable_stats(true);
+  decode(cs, data);
+  check_counts(cs.get_stats());
+
+  ojph::ui64 blocks = total_blocks(cs.get_stats());
+  cs.restart();
+  decode(cs, data);
+  EXPECT_EQ(total_blocks(cs.get_stats()), 2 * blocks);
+
+  cs.reset_stats();
+  cs.restart();
+  decode(cs, data);
+  EXPECT_EQ(total_blocks(cs.get_stats()), blocks);
+}
+
+#endif // !OJPH_DISABLE_STATS
+
+}
@@ -0,0 +1,543 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2019, Aous Naman
+// Copyright (c) 2019, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2019, The University of New South Wales, Australia
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: test_frame_buffer.cpp
+// Author: Aous Naman
+// Date: 19 October 2026
+//***************************************************************************/
+//
+// These tests check that codestream::push_frame() encodes exactly what
+// exchange() encodes for the same samples, and that pull_frame() stores
+// exactly what pull() returns, clamped to each component's bit depth, for
+// interleaved and planar frames with 8- and 16-bit samples; likewise for
+// push_stripe() and pull_stripe(), which move a few rows at a time, and
+// for 16-bit samples in either byte order.
+//
+// Everything is done in memory, so the tests need no external files.
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "ojph_arch.h"
+#include "ojph_codestream.h"
+#include "ojph_file.h"
+#include "ojph_mem.h"
+#include "ojph_message.h"
+#include "ojph_params.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+// Odd dimensions and small tiles exercise partial vectors and rows that
+// span several tiles.
+static const ojph::ui32 IMAGE_WIDTH  = 101;
+static const ojph::ui32 IMAGE_HEIGHT = 67;
+
+////////////////////////////////////////////////////////////////////////////////
+// An image with interleaved components, as a caller would hold it; the
+// samples are in [low, high] and exercise every bit.
+struct test_image
+{
+  test_image(ojph::ui32 num_comps, ojph::si32 low, ojph::si32 high)
+  : num_comps(num_comps), samples(IMAGE_WIDTH * IMAGE_HEIGHT * num_comps)
+  {
+    ojph::ui32 range = (ojph::ui32)(high - low) + 1;
+    for (size_t i = 0; i < samples.size(); ++i)
+      samples[i] = low + (ojph::si32)((i * 2654435761u + (i >> 7)) % range);
+  }
+
+  ojph::si32 at(ojph::ui32 x, ojph::ui32 y, ojph::ui32 c) const
+  { return samples[((size_t)y * IMAGE_WIDTH + x) * num_comps + c]; }
+
+  ojph::ui32 num_comps;
+  std::vector<ojph::si32> samples;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Sets the parameters of an image with num_comps components.
+static void configure(ojph::codestream& cs, ojph::ui32 num_comps,
+                      ojph::ui32 bit_depth, bool is_signed, bool reversible)
+{
+  ojph::param_siz siz = cs.access_siz();
+  siz.set_image_extent(ojph::point(IMAGE_WIDTH, IMAGE_HEIGHT));
+  siz.set_tile_size(ojph::size(64, 32));
+  siz.set_num_components(num_comps);
+  for (ojph::ui32 c = 0; c < num_comps; ++c)
+    siz.set_component(c, ojph::point(1, 1), bit_depth, is_signed);
+
+  ojph::param_cod cod = cs.access_cod();
+  cod.set_num_decomposition(3);
+  cod.set_block_dims(16, 16);
+  cod.set_reversible(reversible);
+  cod.set_color_transform(num_comps == 3);
+  if (!reversible)
+    cs.access_qcd().set_irrev_quant(0.01f);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Encodes img line by line with exchange(); rows are counted per component
+// since the codestream may ask for them in planar order.
+static std::vector<ojph::ui8> encode_lines(const test_image& img,
+  ojph::ui32 bit_depth, bool is_signed, bool reversible)
+{
+  ojph::codestream cs;
+  configure(cs, img.num_comps, bit_depth, is_signed, reversible);
+  ojph::mem_outfile file;
+  file.open();
+  cs.write_headers(&file);
+  std::vector<ojph::ui32> rows(img.num_comps, 0);
+  ojph::ui32 c;
+  ojph::line_buf* line = cs.exchange(NULL, c);
+  for (ojph::ui32 i = 0; i < IMAGE_HEIGHT * img.num_comps; ++i)
+  {
+    ojph::ui32 y = rows[c]++;
+    for (ojph::ui32 x = 0; x < IMAGE_WIDTH; ++x)
+      line->i32[x] = img.at(x, y, c);
+    line = cs.exchange(line, c);
+  }
+  cs.flush();
+  std::vector<ojph::ui8> out(file.get_data(),
+                             file.get_data() + file.get_used_size());
+  cs.close();
+  return out;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Decodes codestream line by line with pull(), clamping samples as a
+// caller would, into an interleaved image.
+static std::vector<ojph::si32> decode_lines(
+  const std::vector<ojph::ui8>& codestream, ojph::si32 low, ojph::si32 high)
+{
+  ojph::codestream cs;
+  ojph::mem_infile file;
+  file.open(codestream.data(), codestream.size());
+  cs.read_headers(&file);
+  cs.create();
+  ojph::ui32 num_comps = cs.access_siz().get_num_components();
+  std::vector<ojph::si32> out(IMAGE_WIDTH * IMAGE_HEIGHT * num_comps);
+  std::vector<ojph::ui32> rows(num_comps, 0);
+  for (ojph::ui32 i = 0; i < IMAGE_HEIGHT * num_comps; ++i)
+  {
+    ojph::ui32 c;
+    ojph::line_buf* line = cs.pull(c);
+    ojph::ui32 y = rows[c]++;
+    for (ojph::ui32 x = 0; x < IMAGE_WIDTH; ++x)
+    {
+      ojph::si32 v = line->i32[x];
+      v = v < low ? low : (v > high ? high : v);
+      out[((size_t)y * IMAGE_WIDTH + x) * num_comps + c] = v;
+    }
+  }
+  cs.close();
+  return out;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// An interleaved 8-bit frame is encoded exactly as its samples are when
+// exchanged line by line, and decodes back to itself.
+TEST(frame_buffer, interleaved_8bit_round_trip)
+{
+  test_image img(3, 0, 255);
+  std::vector<ojph::ui8> expected = encode_lines(img, 8, false, true);
+
+  std::vector<ojph::ui8> rgb(img.samples.begin(), img.samples.end());
+  ojph::frame_component comps[3];
+  for (ojph::ui32 c = 0; c < 3; ++c)
+    comps[c] = { rgb.data() + c, IMAGE_WIDTH * 3, 3 };
+  ojph::frame_buffer frame = { ojph::OJPH_FRAME_8BIT, 3, comps,
+    ojph::OJPH_FRAME_NATIVE_ENDIAN };
+
+  ojph::codestream cs;
+  configure(cs, 3, 8, false, true);
+  ojph::mem_outfile file;
+  file.open();
+  cs.write_headers(&file);
+  cs.push_frame(frame);
+  cs.flush();
+  std::vector<ojph::ui8> out(file.get_data(),
+                             file.get_data() + file.get_used_size());
+  cs.close();
+  ASSERT_EQ(out, expected);
+
+  std::vector<ojph::ui8> decoded(rgb.size(), 0);
+  for (ojph::ui32 c = 0; c < 3; ++c)
+    comps[c].data = decoded.data() + c;
+  ojph::mem_infile in;
+  in.open(out.data(), out.size());
+  ojph::codestream ds;
+  ds.read_headers(&in);
+  ds.create();
+  ds.pull_frame(frame);
+  ds.close();
+  EXPECT_EQ(decoded, rgb);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Signed 12-bit samples, encoded lossily, are clamped to their range when
+// decoded into a planar 16-bit frame stored bottom-up, with padded rows.
+TEST(frame_buffer, planar_16bit_signed_lossy)
+{
+  const ojph::si32 low = -2048, high = 2047;
+  test_image img(2, low, high);
+
+  const ojph::ui32 row = IMAGE_WIDTH + 5;  // samples, including padding
+  std::vector<ojph::si16> planes(2 * row * IMAGE_HEIGHT);
+  ojph::frame_component comps[2];
+  for (ojph::ui32 c = 0; c < 2; ++c)
+  {
+    ojph::si16* last_row = planes.data() + (c * IMAGE_HEIGHT
+                         + IMAGE_HEIGHT - 1) * row;
+    comps[c] = { last_row, -(ojph::si64)(row * sizeof(ojph::si16)), 1 };
+    for (ojph::ui32 y = 0; y < IMAGE_HEIGHT; ++y)
+      for (ojph::ui32 x = 0; x < IMAGE_WIDTH; ++x)
+        last_row[x - (ptrdiff_t)y * row] = (ojph::si16)img.at(x, y, c);
+  }
+  ojph::frame_buffer frame = { ojph::OJPH_FRAME_16BIT, 2, comps,
+    ojph::OJPH_FRAME_NATIVE_ENDIAN };
+
+  std::vector<ojph::ui8> expected = encode_lines(img, 12, true, false);
+  ojph::codestream cs;
+  configure(cs, 2, 12, true, false);
+  ojph::mem_outfile file;
+  file.open();
+  cs.write_headers(&file);
+  cs.push_frame(frame);
+  cs.flush();
+  std::vector<ojph::ui8> out(file.get_data(),
+                             file.get_data() + file.get_used_size());
+  cs.close();
+  ASSERT_EQ(out, expected);
+
+  std::vector<ojph::si32> reference = decode_lines(out, low, high);
+  std::fill(planes.begin(), planes.end(), 0);
+  ojph::mem_infile in;
+  in.open(out.data(), out.size());
+  ojph::codestream ds;
+  ds.read_headers(&in);
+  ds.create();
+  ds.pull_frame(frame);
+  ds.close();
+  for (ojph::ui32 c = 0; c < 2; ++c)
+    for (ojph::ui32 y = 0; y < IMAGE_HEIGHT; ++y)
+      for (ojph::ui32 x = 0; x < IMAGE_WIDTH; ++x)
+      {
+        const ojph::si16* sp = (const ojph::si16*)comps[c].data
+                             - (ptrdiff_t)y * row;
+        ASSERT_EQ(sp[x], reference[((size_t)y * IMAGE_WIDTH + x) * 2 + c])
+          << "at (" << x << ", " << y << ") of component " << c;
+      }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Stripes of 16 interleaved rows, the last one partial, encode like the
+// whole frame and decode back to it.
+TEST(frame_buffer, interleaved_stripes)
+{
+  const ojph::ui32 stripe_rows = 16, row = IMAGE_WIDTH * 3;
+  test_image img(3, 0, 255);
+  std::vector<ojph::ui8> expected = encode_lines(img, 8, false, true);
+
+  std::vector<ojph::ui8> rgb(img.samples.begin(), img.samples.end());
+  std::vector<ojph::ui8> stripe(stripe_rows * row);
+  ojph::frame_component comps[3];
+  for (ojph::ui32 c = 0; c < 3; ++c)
+    comps[c] = { stripe.data() + c, row, 3 };
+  ojph::frame_buffer frame = { ojph::OJPH_FRAME_8BIT, 3, comps,
+    ojph::OJPH_FRAME_NATIVE_ENDIAN };
+
+  ojph::codestream cs;
+  configure(cs, 3, 8, false, true);
+  ojph::mem_outfile file;
+  file.open();
+  cs.write_headers(&file);
+  ojph::ui32 y = 0, rows;
+  do {
+    ojph::ui32 n = std::min(stripe_rows, IMAGE_HEIGHT - y);
+    std::copy(rgb.begin() + y * row, rgb.begin() + (y + n) * row,
+              stripe.begin());
+    rows = cs.push_stripe(frame, stripe_rows);
+    ASSERT_EQ(rows, n);
+    y += rows;
+  } while (rows > 0);
+  cs.flush();
+  std::vector<ojph::ui8> out(file.get_data(),
+                             file.get_data() + file.get_used_size());
+  cs.close();
+  ASSERT_EQ(out, expected);
+
+  std::vector<ojph::ui8> decoded;
+  ojph::mem_infile in;
+  in.open(out.data(), out.size());
+  ojph::codestream ds;
+  ds.read_headers(&in);
+  ds.create();
+  while ((rows = ds.pull_stripe(frame, stripe_rows)) > 0)
+    decoded.insert(decoded.end(), stripe.begin(),
+                   stripe.begin() + rows * row);
+  ds.close();
+  EXPECT_EQ(decoded, rgb);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Unless set_planar() is called, an encoder takes components in the
+// interleaved order, with or without a colour transform, and the frame
+// functions follow the order in effect.
+TEST(frame_buffer, encoder_defaults_to_interleaved)
+{
+  for (ojph::ui32 num_comps = 2; num_comps <= 3; ++num_comps)
+  {
+    SCOPED_TRACE(num_comps);
+    test_image img(num_comps, 0, 255);
+    std::vector<ojph::ui8> expected = encode_lines(img, 8, false, true);
+
+    std::vector<ojph::ui8> samples(img.samples.begin(), img.samples.end());
+    ojph::frame_component comps[3];
+    for (ojph::ui32 c = 0; c < num_comps; ++c)
+      comps[c] = { samples.data() + c, IMAGE_WIDTH * num_comps, num_comps };
+    ojph::frame_buffer frame = { ojph::OJPH_FRAME_8BIT, num_comps, comps,
+      ojph::OJPH_FRAME_NATIVE_ENDIAN };
+
+    ojph::codestream cs;
+    configure(cs, num_comps, 8, false, true);
+    ojph::mem_outfile file;
+    file.open();
+    cs.write_headers(&file);
+    EXPECT_FALSE(cs.is_planar());
+    ASSERT_EQ(cs.push_stripe(frame, 5), 5u);  // five rows of every component
+    cs.push_frame(frame);                     // the rest
+    cs.flush();
+    std::vector<ojph::ui8> out(file.get_data(),
+                               file.get_data() + file.get_used_size());
+    cs.close();
+    EXPECT_EQ(out, expected);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// In the planar order, stripes visit one component after the other, so
+// all components of the stripe can share one buffer.
+TEST(frame_buffer, planar_stripes)
+{
+  const ojph::ui32 stripe_rows = 7;
+  const ojph::si32 low = -2048, high = 2047;
+  test_image img(2, low, high);
+  std::vector<ojph::ui8> expected = encode_lines(img, 12, true, true);
+
+  std::vector<ojph::si16> stripe(stripe_rows * IMAGE_WIDTH);
+  ojph::frame_component comps[2];
+  for (ojph::ui32 c = 0; c < 2; ++c)
+    comps[c] = { stripe.data(), IMAGE_WIDTH * sizeof(ojph::si16), 1 };
+  ojph::frame_buffer frame = { ojph::OJPH_FRAME_16BIT, 2, comps,
+    ojph::OJPH_FRAME_NATIVE_ENDIAN };
+
+  ojph::codestream cs;
+  configure(cs, 2, 12, true, true);
+  cs.set_planar(true);
+  ojph::mem_outfile file;
+  file.open();
+  cs.write_headers(&file);
+  for (ojph::ui32 c = 0; c < 2; ++c)
+    for (ojph::ui32 y = 0; y < IMAGE_HEIGHT; )
+    {
+      ojph::ui32 n = std::min(stripe_rows, IMAGE_HEIGHT - y);
+      for (ojph::ui32 i = 0; i < n * IMAGE_WIDTH; ++i)
+        stripe[i] = (ojph::si16)img.at(i % IMAGE_WIDTH,
+                                       y + i / IMAGE_WIDTH, c);
+      ASSERT_EQ(cs.push_stripe(frame, stripe_rows), n);
+      y += n;
+    }
+  EXPECT_EQ(cs.push_stripe(frame, stripe_rows), 0u);
+  cs.flush();
+  std::vector<ojph::ui8> out(file.get_data(),
+                             file.get_data() + file.get_used_size());
+  cs.close();
+  ASSERT_EQ(out, expected);
+
+  ojph::mem_infile in;
+  in.open(out.data(), out.size());
+  ojph::codestream ds;
+  ds.read_headers(&in);
+  ds.create();
+  ASSERT_TRUE(ds.is_planar());  // without a colour transform
+  for (ojph::ui32 c = 0; c < 2; ++c)
+    for (ojph::ui32 y = 0; y < IMAGE_HEIGHT; )
+    {
+      ojph::ui32 n = std::min(stripe_rows, IMAGE_HEIGHT - y);
+      ASSERT_EQ(ds.pull_stripe(frame, stripe_rows), n);
+      for (ojph::ui32 i = 0; i < n * IMAGE_WIDTH; ++i)
+        ASSERT_EQ(stripe[i], img.at(i % IMAGE_WIDTH, y + i / IMAGE_WIDTH, c))
+          << "at row " << y + i / IMAGE_WIDTH << " of component " << c;
+      y += n;
+    }
+  ds.close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reversible components of up to 16 bits, without a colour transform, are
+// decoded into 16-bit lines, which pull_frame() stores directly into
+// planar frames of either sample size and byte order.
+TEST(frame_buffer, planar_reversible_16bit_lines)
+{
+  struct test_case {
+    ojph::ui32 bit_depth;
+    bool is_signed;
+    ojph::ui32 sample;
+    ojph::ui32 byte_order;
+  };
+  const test_case cases[] = {
+    { 8, false, ojph::OJPH_FRAME_8BIT, ojph::OJPH_FRAME_NATIVE_ENDIAN },
+    { 8, true, ojph::OJPH_FRAME_8BIT, ojph::OJPH_FRAME_NATIVE_ENDIAN },
+    { 12, false, ojph::OJPH_FRAME_16BIT, ojph::OJPH_FRAME_LITTLE_ENDIAN },
+    { 12, true, ojph::OJPH_FRAME_16BIT, ojph::OJPH_FRAME_BIG_ENDIAN },
+    { 16, false, ojph::OJPH_FRAME_16BIT, ojph::OJPH_FRAME_BIG_ENDIAN },
+  };
+  for (const test_case& t : cases)
+  {
+    SCOPED_TRACE(t.bit_depth);
+    SCOPED_TRACE(t.is_signed);
+    const ojph::si32 low = t.is_signed ? -(1 << (t.bit_depth - 1)) : 0;
+    const ojph::si32 high = t.is_signed ? (1 << (t.bit_depth - 1)) - 1
+                                        : (1 << t.bit_depth) - 1;
+    test_image img(2, low, high);
+    std::vector<ojph::ui8> codestream =
+      encode_lines(img, t.bit_depth, t.is_signed, true);
+
+    const ojph::ui32 bytes = t.sample == ojph::OJPH_FRAME_8BIT ? 1 : 2;
+    const size_t plane = (size_t)IMAGE_WIDTH * IMAGE_HEIGHT * bytes;
+    std::vector<ojph::ui8> planes(2 * plane, 0);
+    ojph::frame_component comps[2];
+    for (ojph::ui32 c = 0; c < 2; ++c)
+      comps[c] = { planes.data() + c * plane, IMAGE_WIDTH * bytes, 1 };
+    ojph::frame_buffer frame = { t.sample, 2, comps, t.byte_order };
+
+    ojph::mem_infile in;
+    in.open(codestream.data(), codestream.size());
+    ojph::codestream ds;
+    ds.read_headers(&in);
+    ds.create();
+    ds.pull_frame(frame);
+    ds.close();
+
+    const bool big = t.byte_order == ojph::OJPH_FRAME_BIG_ENDIAN;
+    for (ojph::ui32 c = 0; c < 2; ++c)
+      for (ojph::ui32 y = 0; y < IMAGE_HEIGHT; ++y)
+        for (ojph::ui32 x = 0; x < IMAGE_WIDTH; ++x)
+        {
+          const ojph::ui8 *sp = planes.data() + c * plane
+                              + ((size_t)y * IMAGE_WIDTH + x) * bytes;
+          ojph::si32 v;
+          if (bytes == 1)
+            v = t.is_signed ? (ojph::si32)(ojph::si8)sp[0] : sp[0];
+          else
+          {
+            ojph::ui16 u = big ? (ojph::ui16)((sp[0] << 8) | sp[1])
+                               : (ojph::ui16)((sp[1] << 8) | sp[0]);
+            v = t.is_signed ? (ojph::si32)(ojph::si16)u : u;
+          }
+          ASSERT_EQ(v, img.at(x, y, c))
+            << "at (" << x << ", " << y << ") of component " << c;
+        }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 16-bit samples can be big- or little-endian, whatever the machine's byte
+// order; this exercises both the reversible and irreversible paths.
+TEST(frame_buffer, byte_orders)
+{
+  for (int reversible = 0; reversible < 2; ++reversible)
+  {
+    test_image img(1, 0, 65535);
+    std::vector<ojph::ui8> expected =
+      encode_lines(img, 16, false, reversible != 0);
+
+    const size_t num_samples = img.samples.size();
+    std::vector<ojph::ui8> be(2 * num_samples);
+    for (size_t i = 0; i < num_samples; ++i) {
+      be[2 * i] = (ojph::ui8)(img.samples[i] >> 8);
+      be[2 * i + 1] = (ojph::ui8)img.samples[i];
+    }
+    ojph::frame_component comp = { be.data(), IMAGE_WIDTH * 2, 1 };
+    ojph::frame_buffer frame = { ojph::OJPH_FRAME_16BIT, 1, &comp,
+      ojph::OJPH_FRAME_BIG_ENDIAN };
+
+    ojph::codestream cs;
+    configure(cs, 1, 16, false, reversible != 0);
+    ojph::mem_outfile file;
+    file.open();
+    cs.write_headers(&file);
+    cs.push_frame(frame);
+    cs.flush();
+    std::vector<ojph::ui8> out(file.get_data(),
+                               file.get_data() + file.get_used_size());
+    cs.close();
+    ASSERT_EQ(out, expected);
+
+    std::vector<ojph::si32> reference = decode_lines(out, 0, 65535);
+    std::vector<ojph::ui8> le(2 * num_samples);
+    comp.data = le.data();
+    frame.byte_order = ojph::OJPH_FRAME_LITTLE_ENDIAN;
+    ojph::mem_infile in;
+    in.open(out.data(), out.size());
+    ojph::codestream ds;
+    ds.read_headers(&in);
+    ds.create();
+    ds.pull_frame(frame);
+    ds.close();
+    for (size_t i = 0; i < num_samples; ++i)
+      ASSERT_EQ(le[2 * i] | (le[2 * i + 1] << 8), reference[i])
+        << "at sample " << i << (reversible ? ", reversible" : "");
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A bit depth that does not fit in the frame's samples is an error.
+TEST(frame_buffer, bit_depth_must_fit)
+{
+  std::vector<ojph::ui8> gray(IMAGE_WIDTH * IMAGE_HEIGHT);
+  ojph::frame_component comp = { gray.data(), IMAGE_WIDTH, 1 };
+  ojph::frame_buffer frame = { ojph::OJPH_FRAME_8BIT, 1, &comp,
+    ojph::OJPH_FRAME_NATIVE_ENDIAN };
+
+  ojph::codestream cs;
+  configure(cs, 1, 10, false, true);
+  ojph::mem_outfile file;
+  file.open();
+  cs.write_headers(&file);
+  ojph::set_message_level(ojph::OJPH_MSG_NO_MSG);
+  EXPECT_THROW(cs.push_frame(frame), std::runtime_error);
+  ojph::set_message_level(ojph::OJPH_MSG_ALL_MSG);
+}
+
+} // anonymous namespace
@@ -0,0 +1,296 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2019, Aous Naman
+// Copyright (c) 2019, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2019, The University of New South Wales, Australia
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: test_header_cache.cpp
+// Author: Aous Naman
+// Date: 19 October 2026
+//***************************************************************************/
+//
+// These tests check that a codestream with its header cache enabled
+// produces, and decodes, exactly what a codestream without the cache does,
+// while reusing the main header of the previous codestream whenever the
+// parameters are left untouched after restart().
+//
+// Everything is done in memory, so the tests need no external files.
+
+#include <vector>
+
+#include "ojph_arch.h"
+#include "ojph_codestream.h"
+#include "ojph_file.h"
+#include "ojph_mem.h"
+#include "ojph_params.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+static const ojph::ui32 IMAGE_WIDTH  = 192;
+static const ojph::ui32 IMAGE_HEIGHT = 128;
+
+////////////////////////////////////////////////////////////////////////////////
+// Sets the parameters of a three component 8 bit image; num_decomps
+// changes the main header.
+static void configure(ojph::codestream& cs, ojph::ui32 num_decomps)
+{
+  ojph::param_siz siz = cs.access_siz();
+  siz.set_image_extent(ojph::point(IMAGE_WIDTH, IMAGE_HEIGHT));
+  siz.set_num_components(3);
+  for (ojph::ui32 c = 0; c < 3; ++c)
+    siz.set_component(c, ojph::point(1, 1), 8, false);
+
+  ojph::param_cod cod = cs.access_cod();
+  cod.set_num_decomposition(num_decomps);
+  cod.set_block_dims(32, 32);
+  cod.set_reversible(true);
+  cod.set_color_transform(true);
+  cs.set_tilepart_divisions(true, false);
+  cs.request_tlm_marker(true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Encodes one frame, whose samples depend on seed, and returns the
+// codestream; the parameters are set only when num_decomps is not 0.
+static std::vector<ojph::ui8> encode(ojph::codestream& cs,
+                                     ojph::ui32 num_decomps, ojph::ui32 seed)
+{
+  ojph::mem_outfile out;
+  out.open();
+  if (num_decomps != 0)
+    configure(cs, num_decomps);
+  cs.write_headers(&out);
+
+  ojph::ui32 next_comp = 0;
+  ojph::line_buf* line = cs.exchange(NULL, next_comp);
+  for (ojph::ui32 y = 0; y < IMAGE_HEIGHT; ++y)
+    for (ojph::ui32 c = 0; c < 3; ++c)
+    {
+      ojph::si32* dp = line->i32;
+      for (ojph::ui32 x = 0; x < IMAGE_WIDTH; ++x)
+        dp[x] = (ojph::si32)((x * (7 + c) + y * seed + ((x * y) >> 3)) & 0xFF);
+      line = cs.exchange(line, next_comp);
+    }
+  cs.flush();
+  cs.close();
+  return std::vector<ojph::ui8>(out.get_data(),
+                                out.get_data() + out.get_used_size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Decodes a codestream and returns its samples, component after component.
+static std::vector<ojph::si32> decode(ojph::codestream& cs,
+                                      const std::vector<ojph::ui8>& data)
+{
+  ojph::mem_infile in;
+  in.open(data.data(), data.size());
+  cs.read_headers(&in);
+  cs.create();
+
+  ojph::param_siz siz = cs.access_siz();
+  ojph::ui32 width = siz.get_recon_width(0);
+  ojph::ui32 height = siz.get_recon_height(0);
+  std::vector<ojph::si32> samples((size_t)3 * width * height);
+  for (ojph::ui32 y = 0; y < height; ++y)
+    for (ojph::ui32 c = 0; c < 3; ++c)
+    {
+      ojph::ui32 comp_num;
+      ojph::line_buf *line = cs.pull(comp_num);
+      ojph::si32 *dp =
+        samples.data() + ((size_t)comp_num * height + y) * width;
+      for (ojph::ui32 x = 0; x < width; ++x)
+        dp[x] = line->i32[x];
+    }
+  cs.close();
+  return samples;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reads the main header of a codestream, and returns the COD parameters
+// that differ between configure() and the defaults.
+struct cod_summary
+{
+  ojph::ui32 num_decomps;
+  ojph::size block_dims;
+  bool reversible;
+};
+
+static cod_summary read_cod(const std::vector<ojph::ui8>& data)
+{
+  ojph::mem_infile in;
+  in.open(data.data(), data.size());
+  ojph::codestream cs;
+  cs.read_headers(&in);
+  const ojph::param_cod cod = cs.get_cod();
+  cod_summary t;
+  t.num_decomps = cod.get_num_decompositions();
+  t.block_dims = cod.get_block_dims();
+  t.reversible = cod.is_reversible();
+  cs.close();
+  return t;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A frame encoded with the cached header is identical to one encoded from
+// scratch.
+TEST(header_cache, encoder_repeats_untouched_header)
+{
+  ojph::codestream cs;
+  cs.enable_header_cache(true);
+  std::vector<ojph::ui8> first = encode(cs, 5, 13);
+  EXPECT_FALSE(cs.is_header_repeated());
+
+  cs.restart();
+  std::vector<ojph::ui8> second = encode(cs, 0, 17);
+  EXPECT_TRUE(cs.is_header_repeated());
+
+  ojph::codestream ref_cs;
+  EXPECT_EQ(first, encode(ref_cs, 5, 13));
+  ref_cs.restart();
+  EXPECT_EQ(second, encode(ref_cs, 5, 17));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Setting the parameters after restart() starts from the defaults, as it
+// does without the cache, and a new header is written.
+TEST(header_cache, encoder_rebuilds_changed_header)
+{
+  ojph::codestream cs;
+  cs.enable_header_cache(true);
+  encode(cs, 5, 13);
+  cs.restart();
+  std::vector<ojph::ui8> second = encode(cs, 3, 13);
+  EXPECT_FALSE(cs.is_header_repeated());
+  EXPECT_EQ(cs.access_cod().get_num_decompositions(), 3u);
+
+  ojph::codestream ref_cs;  // goes through the same sequence, uncached
+  encode(ref_cs, 5, 13);
+  ref_cs.restart();
+  EXPECT_EQ(second, encode(ref_cs, 3, 13));
+
+  // the rebuilt header is cached in turn
+  cs.restart();
+  std::vector<ojph::ui8> third = encode(cs, 0, 19);
+  EXPECT_TRUE(cs.is_header_repeated());
+  ref_cs.restart();
+  EXPECT_EQ(third, encode(ref_cs, 3, 19));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Setting the same parameters after restart() gives the same header, which
+// is then kept.
+TEST(header_cache, encoder_keeps_reset_header)
+{
+  ojph::codestream cs;
+  cs.enable_header_cache(true);
+  encode(cs, 5, 13);
+  cs.restart();
+  std::vector<ojph::ui8> second = encode(cs, 5, 17);
+  EXPECT_TRUE(cs.is_header_repeated());
+
+  ojph::codestream ref_cs;
+  EXPECT_EQ(second, encode(ref_cs, 5, 17));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reading the dimensions between frames through access_siz() keeps the
+// cached header, and every frame carries the COD of the first; setting one
+// of them returns COD to its defaults, as documented, while SIZ is
+// left as it was.
+TEST(header_cache, reading_dimensions_between_frames)
+{
+  ojph::codestream cs;
+  cs.enable_header_cache(true);
+  for (ojph::ui32 frame = 0; frame < 3; ++frame)
+  {
+    SCOPED_TRACE(frame);
+    if (frame > 0)
+    {
+      cs.restart();
+      ojph::param_siz siz = cs.access_siz();
+      EXPECT_EQ(siz.get_image_extent().x, IMAGE_WIDTH);
+      EXPECT_EQ(siz.get_image_extent().y, IMAGE_HEIGHT);
+    }
+    std::vector<ojph::ui8> data = encode(cs, frame == 0 ? 2 : 0, 13);
+    EXPECT_EQ(cs.is_header_repeated(), frame > 0);
+
+    cod_summary cod = read_cod(data);
+    EXPECT_EQ(cod.num_decomps, 2u);
+    EXPECT_EQ(cod.block_dims.w, 32u);
+    EXPECT_EQ(cod.block_dims.h, 32u);
+    EXPECT_TRUE(cod.reversible);
+  }
+
+  cs.restart();
+  ojph::param_siz siz = cs.access_siz();
+  siz.set_image_extent(ojph::point(IMAGE_WIDTH, IMAGE_HEIGHT));
+  std::vector<ojph::ui8> data = encode(cs, 0, 13);
+  EXPECT_FALSE(cs.is_header_repeated());
+
+  cod_summary cod = read_cod(data);
+  EXPECT_EQ(cod.num_decomps, 5u);
+  EXPECT_EQ(cod.block_dims.w, 64u);
+  EXPECT_EQ(cod.block_dims.h, 64u);
+  EXPECT_FALSE(cod.reversible);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The decoder skips a main header that matches the previous one, even when
+// their TLM segments differ, and parses one that does not.
+TEST(header_cache, decoder_skips_matching_header)
+{
+  std::vector<std::vector<ojph::ui8> > streams;
+  {
+    ojph::codestream enc;
+    streams.push_back(encode(enc, 5, 13));
+    enc.restart();
+    streams.push_back(encode(enc, 5, 29));
+    enc.restart();
+    streams.push_back(encode(enc, 4, 29));
+  }
+  ASSERT_NE(streams[0], streams[1]);
+
+  ojph::codestream cs;
+  cs.enable_header_cache(true);
+  bool expected_repeat[3] = { false, true, false };
+  for (size_t i = 0; i < streams.size(); ++i)
+  {
+    if (i > 0)
+      cs.restart();
+    std::vector<ojph::si32> samples = decode(cs, streams[i]);
+    EXPECT_EQ(cs.is_header_repeated(), expected_repeat[i]);
+
+    ojph::codestream ref_cs;
+    EXPECT_EQ(samples, decode(ref_cs, streams[i]));
+  }
+}
+
+} // namespace
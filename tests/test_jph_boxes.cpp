@@ -0,0 +1,344 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2026, Aous Naman
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: test_jph_boxes.cpp
+// Author: Aous Naman
+// Date: 19 October 2026
+//***************************************************************************/
+//
+// These tests write .jph files with jph_writer, read them back with
+// jph_reader, and decode them with codestream::read_headers(), which
+// finds the codestream from the box lengths; they also check that frames
+// written one after the other, with the header cache, keep their coding
+// parameters.
+//
+// Everything is done in memory, so the tests need no external files.
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <vector>
+
+#include "ojph_arch.h"
+#include "ojph_boxes.h"
+#include "ojph_codestream.h"
+#include "ojph_file.h"
+#include "ojph_mem.h"
+#include "ojph_params.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+static const ojph::ui32 IMAGE_WIDTH  = 57;
+static const ojph::ui32 IMAGE_HEIGHT = 33;
+
+////////////////////////////////////////////////////////////////////////////////
+static ojph::si32 sample(ojph::ui32 x, ojph::ui32 y, ojph::ui32 c)
+{
+  return (ojph::si32)((x * (3 + c) + y * 7) & 0xFF);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// An outfile that cannot seek, as a pipe or a socket.
+class stream_outfile : public ojph::outfile_base
+{
+public:
+  explicit stream_outfile(ojph::mem_outfile *file) : file(file) {}
+  size_t write(const void *ptr, size_t size) override
+  { return file->write(ptr, size); }
+  ojph::si64 tell() override { return file->tell(); }
+
+private:
+  ojph::mem_outfile *file;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Sets up lossless coding of a three component 8 bit image, with coding
+// parameters that all differ from the defaults.
+static void configure(ojph::codestream& cs)
+{
+  ojph::param_siz siz = cs.access_siz();
+  siz.set_image_extent(ojph::point(IMAGE_WIDTH, IMAGE_HEIGHT));
+  siz.set_num_components(3);
+  for (ojph::ui32 c = 0; c < 3; ++c)
+    siz.set_component(c, ojph::point(1, 1), 8, false);
+  ojph::param_cod cod = cs.access_cod();
+  cod.set_num_decomposition(2);
+  cod.set_block_dims(16, 16);
+  cod.set_reversible(true);
+  cod.set_color_transform(true);
+  cs.set_planar(false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Encodes the image with cs into file, wrapped in the boxes of jph when it
+// is not NULL; the boxes are described from get_siz(), which, unlike
+// access_siz(), leaves a main header kept by restart() in place.
+static void encode_frame(ojph::codestream& cs, ojph::outfile_base *file,
+                         ojph::jph_writer *jph)
+{
+  if (jph)
+    jph->write_headers(file, cs.get_siz());
+  cs.write_headers(file);
+  ojph::ui32 next_comp = 0;
+  ojph::line_buf* line = cs.exchange(NULL, next_comp);
+  for (ojph::ui32 y = 0; y < IMAGE_HEIGHT; ++y)
+    for (ojph::ui32 c = 0; c < 3; ++c)
+    {
+      for (ojph::ui32 x = 0; x < IMAGE_WIDTH; ++x)
+        line->i32[x] = sample(x, y, c);
+      line = cs.exchange(line, next_comp);
+    }
+  cs.flush();
+  if (jph)
+    jph->finalize(file);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Losslessly encodes the image into file, wrapped in the boxes of jph when
+// it is not NULL.
+static void encode(ojph::outfile_base *file, ojph::jph_writer *jph)
+{
+  ojph::codestream cs;
+  configure(cs);
+  encode_frame(cs, file, jph);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Decodes data, and checks that it holds the image above.
+static void expect_image(const ojph::ui8 *data, size_t size)
+{
+  ojph::mem_infile in;
+  in.open(data, size);
+  ojph::codestream cs;
+  cs.read_headers(&in);
+  cs.create();
+  ojph::ui32 bad = 0;
+  for (ojph::ui32 y = 0; y < IMAGE_HEIGHT; ++y)
+    for (ojph::ui32 c = 0; c < 3; ++c)
+    {
+      ojph::ui32 comp_num;
+      ojph::line_buf *line = cs.pull(comp_num);
+      for (ojph::ui32 x = 0; x < IMAGE_WIDTH; ++x)
+        bad += line->i32[x] != sample(x, y, comp_num);
+    }
+  EXPECT_EQ(bad, 0u);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static ojph::ui32 get_ui32(const ojph::ui8 *p)
+{
+  return ((ojph::ui32)p[0] << 24) | ((ojph::ui32)p[1] << 16)
+       | ((ojph::ui32)p[2] << 8) | p[3];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static void put_ui32(std::vector<ojph::ui8>& v, ojph::ui32 val)
+{
+  for (int s = 24; s >= 0; s -= 8)
+    v.push_back((ojph::ui8)(val >> s));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The reader finds what the writer wrote, and the codestream in the jp2c
+// box is the one an encoder writes without boxes.
+TEST(jph_boxes, write_and_read)
+{
+  ojph::mem_outfile bare;
+  bare.open();
+  encode(&bare, NULL);
+
+  ojph::mem_outfile out;
+  out.open();
+  ojph::jph_writer jph;
+  jph.set_capture_resolution(11811.0, 11811.0);  // 300 dpi
+  encode(&out, &jph);
+
+  ojph::mem_infile in;
+  in.open(out.get_data(), out.get_used_size());
+  EXPECT_TRUE(ojph::jph_reader::starts_with_signature(&in));
+  EXPECT_EQ(in.tell(), 0);
+  ojph::jph_reader reader;
+  reader.read(&in);
+  EXPECT_EQ(reader.get_brand(), (ojph::ui32)ojph::jph_writer::JPH_BRAND);
+  EXPECT_EQ(reader.get_width(), IMAGE_WIDTH);
+  EXPECT_EQ(reader.get_height(), IMAGE_HEIGHT);
+  EXPECT_EQ(reader.get_num_components(), 3u);
+  EXPECT_EQ(reader.get_bit_depth(), 8u);
+  EXPECT_FALSE(reader.is_signed());
+  EXPECT_EQ(reader.get_colour_space(), (ojph::ui32)ojph::jph_writer::SRGB);
+
+  const ojph::jp2_box& box = reader.get_codestream_box();
+  EXPECT_EQ(box.type, (ojph::ui32)ojph::jp2_box::JP2C);
+  EXPECT_FALSE(box.to_end);
+  EXPECT_EQ(in.tell(), box.offset);
+  ASSERT_EQ(box.length, (ojph::ui64)bare.get_used_size());
+  EXPECT_EQ((size_t)box.offset + box.length, out.get_used_size());
+  EXPECT_EQ(memcmp(out.get_data() + box.offset, bare.get_data(),
+                   (size_t)box.length), 0);
+
+  expect_image(out.get_data(), out.get_used_size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A file that cannot seek gets a jp2c box that extends to the end of the
+// file, unless the length of the codestream is given in advance; a wrong
+// length is reported.
+TEST(jph_boxes, streaming)
+{
+  ojph::mem_outfile bare;
+  bare.open();
+  encode(&bare, NULL);
+  ojph::ui64 length = (ojph::ui64)bare.get_used_size();
+
+  for (int presized = 0; presized < 2; ++presized)
+  {
+    ojph::mem_outfile out;
+    out.open();
+    stream_outfile stream(&out);
+    ojph::jph_writer jph;
+    if (presized)
+      jph.set_codestream_length(length);
+    encode(&stream, &jph);
+
+    const ojph::ui8 *jp2c = out.get_data() + out.get_used_size() - length;
+    EXPECT_EQ(get_ui32(jp2c - 4), (ojph::ui32)ojph::jp2_box::JP2C);
+    EXPECT_EQ(get_ui32(jp2c - 8), presized ? (ojph::ui32)length + 8 : 0u);
+    expect_image(out.get_data(), out.get_used_size());
+  }
+
+  ojph::mem_outfile out;
+  out.open();
+  ojph::jph_writer jph;
+  jph.set_codestream_length(length + 1);
+  EXPECT_THROW(encode(&out, &jph), std::exception);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Boxes with an XLBox, or that extend to the end of the file, are
+// skipped by their lengths.
+TEST(jph_boxes, xl_boxes)
+{
+  ojph::mem_outfile bare;
+  bare.open();
+  encode(&bare, NULL);
+
+  std::vector<ojph::ui8> file;
+  ojph::mem_outfile boxes;
+  boxes.open();
+  ojph::jph_writer jph;
+  encode(&boxes, &jph);
+  // the boxes before jp2c, followed by a 'free' box with an XLBox
+  size_t jp2c_pos = boxes.get_used_size() - bare.get_used_size() - 8;
+  file.assign(boxes.get_data(), boxes.get_data() + jp2c_pos);
+  put_ui32(file, 1);
+  put_ui32(file, 0x66726565);  // 'free'
+  put_ui32(file, 0);
+  put_ui32(file, 16 + 5);
+  for (int i = 0; i < 5; ++i)
+    file.push_back(0xFF);      // would look like markers if scanned
+  // a jp2c box that extends to the end of the file
+  put_ui32(file, 0);
+  put_ui32(file, ojph::jp2_box::JP2C);
+  file.insert(file.end(), bare.get_data(),
+              bare.get_data() + bare.get_used_size());
+
+  ojph::mem_infile in;
+  in.open(file.data(), file.size());
+  in.seek((ojph::si64)jp2c_pos, ojph::infile_base::OJPH_SEEK_SET);
+  ojph::jp2_box box;
+  ASSERT_TRUE(ojph::jph_reader::read_box_header(&in, box));
+  EXPECT_EQ(box.type, 0x66726565u);
+  EXPECT_EQ(box.header_size, 16u);
+  EXPECT_EQ(box.length, 5u);
+  EXPECT_EQ(box.offset, (ojph::si64)jp2c_pos + 16);
+
+  in.seek(0, ojph::infile_base::OJPH_SEEK_SET);
+  ojph::jph_reader reader;
+  reader.read(&in);
+  EXPECT_TRUE(reader.get_codestream_box().to_end);
+  EXPECT_EQ(reader.get_codestream_box().offset,
+            (ojph::si64)(file.size() - bare.get_used_size()));
+
+  expect_image(file.data(), file.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Frames encoded one after the other, as ojph_compress does with numbered
+// .jph outputs, reuse the main header of the first, and every one carries
+// its COD and QCD.
+TEST(jph_boxes, frames_keep_coding_parameters)
+{
+  ojph::codestream cs;
+  cs.enable_header_cache(true);
+  configure(cs);
+  for (ojph::ui32 frame = 0; frame < 4; ++frame)
+  {
+    SCOPED_TRACE(frame);
+    if (frame > 0)
+      cs.restart();
+    ojph::mem_outfile out;
+    out.open();
+    ojph::jph_writer jph;
+    encode_frame(cs, &out, &jph);
+    EXPECT_EQ(cs.is_header_repeated(), frame > 0);
+    cs.close();
+    expect_image(out.get_data(), out.get_used_size());
+
+    ojph::mem_infile in;
+    in.open(out.get_data(), out.get_used_size());
+    ojph::codestream rd;
+    rd.read_headers(&in);
+    const ojph::param_cod cod = rd.get_cod();
+    EXPECT_EQ(cod.get_num_decompositions(), 2u);
+    EXPECT_EQ(cod.get_block_dims().w, 16u);
+    EXPECT_EQ(cod.get_block_dims().h, 16u);
+    EXPECT_TRUE(cod.is_reversible());
+    EXPECT_TRUE(cod.is_using_color_transform());
+    rd.close();  // closes in as well
+
+    // QCD has one exponent per subband, and no quantization, as befits a
+    // reversible codestream
+    in.open(out.get_data(), out.get_used_size());
+    ojph::jph_reader reader;
+    reader.read(&in);
+    const ojph::ui8 *p =
+      out.get_data() + reader.get_codestream_box().offset;
+    const ojph::ui8 *end = out.get_data() + out.get_used_size();
+    const ojph::ui8 qcd[2] = { 0xFF, 0x5C };
+    p = std::search(p, end, qcd, qcd + 2);
+    ASSERT_LT(p + 4, end);
+    EXPECT_EQ(((ojph::ui32)p[2] << 8) | p[3], 3u + 3u * 2u + 1u); // Lqcd
+    EXPECT_EQ(p[4] & 0x1F, 0);                                    // Sqcd
+  }
+}
+
+}
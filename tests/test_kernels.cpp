@@ -0,0 +1,875 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2019, Aous Naman
+// Copyright (c) 2019, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2019, The University of New South Wales, Australia
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: test_kernels.cpp
+// Author: Aous Naman
+// Date: 19 October 2026
+//***************************************************************************/
+
+// Runs every dispatched kernel (wavelet, colour, and codeblock) at every
+// cpu extension level up to the one this machine supports, capping the
+// level with ojph::set_max_cpu_ext_level(), and checks that the output
+// is bit-identical to that of the generic kernels, selected at level 0.
+// Inputs are random, but drawn from the same seed for every level.
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ojph_arch.h"
+#include "ojph_defs.h"
+#include "ojph_file.h"
+#include "ojph_mem.h"
+#include "ojph_params.h"
+#include "ojph_params_local.h"
+#include "ojph_codeblock.h"
+#include "ojph_codeblock_fun.h"
+#include "ojph_colour.h"
+#include "ojph_transform.h"
+#include "gtest/gtest.h"
+
+using namespace ojph;
+using namespace ojph::local;
+
+namespace {
+
+  ///////////////////////////////////////////////////////////////////////////
+  // an aligned line_buf with room on both sides for boundary extension and
+  // for kernels that process whole vectors
+  class test_line
+  {
+  public:
+    test_line() : store(NULL) {}
+    ~test_line() { if (store) ojph_aligned_free(store); }
+
+    template<typename T>
+    void init(ui32 width)
+    {
+      size_t bytes = (width + 2 * (size_t)pad) * sizeof(T);
+      store = ojph_aligned_malloc(byte_alignment, bytes);
+      memset(store, 0, bytes);
+      line.wrap((T*)store + pad, width + pad, pad);
+    }
+
+    template<typename T>
+    T* data() { return (T*)line.p; }
+
+    line_buf line;
+
+  private:
+    test_line(const test_line&);
+    test_line& operator=(const test_line&);
+
+    static const ui32 pad = 64; // in samples, keeps line data aligned
+    void* store;
+  };
+
+  ///////////////////////////////////////////////////////////////////////////
+  // named outputs of one run of a test at one cpu extension level; most
+  // must be bit-identical, but a few are only compared to a tolerance
+  struct output_log
+  {
+    void add(const std::string& name, const void* p, size_t bytes)
+    {
+      names.push_back(name);
+      data.push_back(std::vector<ui8>((const ui8*)p, (const ui8*)p + bytes));
+      values.push_back(std::vector<double>());
+      tolerances.push_back(0.0);
+    }
+
+    template<typename T>
+    void add_near(const std::string& name, const T* p, size_t count,
+                  double tolerance)
+    {
+      names.push_back(name);
+      data.push_back(std::vector<ui8>());
+      values.push_back(std::vector<double>(p, p + count));
+      tolerances.push_back(tolerance);
+    }
+
+    std::vector<std::string> names;
+    std::vector<std::vector<ui8>> data;
+    std::vector<std::vector<double>> values;
+    std::vector<double> tolerances;
+  };
+
+  ///////////////////////////////////////////////////////////////////////////
+  // returns the position of the first element of out that is not within
+  // tolerance of ref, or ref.size() if there is none
+  template<typename T>
+  size_t first_mismatch(const std::vector<T>& ref, const std::vector<T>& out,
+                        double tolerance)
+  {
+    if (ref.size() != out.size())
+      return 0;
+    size_t pos = 0;
+    while (pos < ref.size()
+      && std::fabs((double)ref[pos] - (double)out[pos]) <= tolerance)
+      ++pos;
+    return pos;
+  }
+
+  ///////////////////////////////////////////////////////////////////////////
+  template<typename T>
+  void fill_random(std::mt19937& rng, T* p, ui32 count, si64 max_mag)
+  {
+    std::uniform_int_distribution<si64> dist(-max_mag, max_mag);
+    for (ui32 i = 0; i < count; ++i)
+      p[i] = (T)dist(rng);
+  }
+
+  ///////////////////////////////////////////////////////////////////////////
+  void fill_random(std::mt19937& rng, float* p, ui32 count, float max_mag)
+  {
+    std::uniform_real_distribution<float> dist(-max_mag, max_mag);
+    for (ui32 i = 0; i < count; ++i)
+      p[i] = dist(rng);
+  }
+
+  ///////////////////////////////////////////////////////////////////////////
+  // selects the kernels of a given cpu extension level; a negative level
+  // restores those of the detected level
+  void select_level(int level)
+  {
+    set_max_cpu_ext_level(level);
+    init_wavelet_transform_functions();
+    init_colour_transform_functions();
+  }
+
+  ///////////////////////////////////////////////////////////////////////////
+  // calls run(cbf, log) at every level, and compares the logs to level 0's
+  template<typename F>
+  void check_all_levels(bool reversible, F run)
+  {
+    select_level(-1);
+    const int top_level = get_cpu_ext_level();
+
+    output_log ref;
+    for (int level = 0; level <= top_level; ++level)
+    {
+      select_level(level);
+      codeblock_fun cbf;
+      cbf.init(reversible);
+      output_log out;
+      run(cbf, out);
+
+      if (level == 0) {
+        ref = out;
+        continue;
+      }
+      ASSERT_EQ(ref.names.size(), out.names.size());
+      for (size_t i = 0; i < ref.names.size(); ++i)
+      {
+        size_t pos = first_mismatch(ref.data[i], out.data[i], 0.0);
+        EXPECT_EQ(pos, ref.data[i].size())
+          << ref.names[i] << " differs from the generic kernel at cpu "
+          << "extension level " << level << ", first at byte " << pos;
+        pos = first_mismatch(ref.values[i], out.values[i], ref.tolerances[i]);
+        EXPECT_EQ(pos, ref.values[i].size())
+          << ref.names[i] << " is not within " << ref.tolerances[i]
+          << " of the generic kernel at cpu extension level " << level
+          << ", first at sample " << pos;
+      }
+    }
+    select_level(-1);
+  }
+
+  ///////////////////////////////////////////////////////////////////////////
+  const ui32 widths[] = { 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33,
+    47, 63, 64, 65, 100, 127, 128, 129, 255, 256, 257, 1000 };
+
+  ///////////////////////////////////////////////////////////////////////////
+  std::string label(const char* name, ui32 width, int variant = -1)
+  {
+    std::string s = std::string(name) + " width " + std::to_string(width);
+    if (variant >= 0)
+      s += " variant " + std::to_string(variant);
+    return s;
+  }
+
+  ///////////////////////////////////////////////////////////////////////////
+  // a reversible 4-step atk exercising every lifting-step form the
+  // kernels specialize: 5/3 predict, a == 1, a == -1, and the general case
+  class custom_rev_atk
+  {
+  public:
+    custom_rev_atk()
+    {
+      const ui8 seg[] = {
+        0x00, 29,     // Latk
+        0x59, 0x02,   // Satk: index 2, 16bit coefficients, reversible
+        4,            // Natk
+        1, 0x00, 0x01, 1, 0xFF, 0xFF, // Eatk, Batk, LCatk, Aatk = -1
+        2, 0x00, 0x02, 1, 0x00, 0x01, //                    Aatk = 1
+        2, 0x00, 0x03, 1, 0xFF, 0xFF, //                    Aatk = -1
+        4, 0x00, 0x08, 1, 0x00, 0x03, //                    Aatk = 3
+      };
+      mem_infile file;
+      file.open(seg, sizeof(seg));
+      atk.read(&file);
+    }
+
+    const param_atk* get() { return &atk; }
+
+  private:
+    param_atk atk;
+  };
+
+} // !anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// Reversible vertical lifting steps on 16, 32, and 64bit lines
+TEST(TestKernels, RevVertStep) {
+  custom_rev_atk atk;
+  check_all_levels(true, [&](codeblock_fun&, output_log& log) {
+    std::mt19937 rng(1);
+    for (ui32 w : widths)
+      for (ui32 s = 0; s < atk.get()->get_num_steps(); ++s)
+        for (int synthesis = 0; synthesis < 2; ++synthesis)
+        {
+          const lifting_step* step = atk.get()->get_step(s);
+          int v = (int)s * 2 + synthesis;
+          {
+            test_line a, b, c;
+            a.init<si16>(w); b.init<si16>(w); c.init<si16>(w);
+            fill_random(rng, a.data<si16>(), w, 1000);
+            fill_random(rng, b.data<si16>(), w, 1000);
+            fill_random(rng, c.data<si16>(), w, 1000);
+            rev_vert_step(step, &a.line, &b.line, &c.line, w, synthesis != 0);
+            log.add(label("rev_vert_step16", w, v), c.data<si16>(), w * 2);
+          }
+          {
+            test_line a, b, c;
+            a.init<si32>(w); b.init<si32>(w); c.init<si32>(w);
+            fill_random(rng, a.data<si32>(), w, 1 << 24);
+            fill_random(rng, b.data<si32>(), w, 1 << 24);
+            fill_random(rng, c.data<si32>(), w, 1 << 24);
+            rev_vert_step(step, &a.line, &b.line, &c.line, w, synthesis != 0);
+            log.add(label("rev_vert_step32", w, v), c.data<si32>(), w * 4);
+          }
+          {
+            test_line a, b, c;
+            a.init<si64>(w); b.init<si64>(w); c.init<si64>(w);
+            fill_random(rng, a.data<si64>(), w, 1LL << 40);
+            fill_random(rng, b.data<si64>(), w, 1LL << 40);
+            fill_random(rng, c.data<si64>(), w, 1LL << 40);
+            rev_vert_step(step, &a.line, &b.line, &c.line, w, synthesis != 0);
+            log.add(label("rev_vert_step64", w, v), c.data<si64>(), w * 8);
+          }
+        }
+  });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Reversible horizontal analysis and synthesis, for the 5/3 and a custom
+// atk, on 16, 32, and 64bit lines, and for both phases
+template<typename T>
+static void rev_horz(const param_atk* atk, std::mt19937& rng, si64 max_mag,
+                     const char* name, output_log& log)
+{
+  for (ui32 w : widths)
+    for (int even = 0; even < 2; ++even)
+    {
+      const ui32 lw = even ? (w + 1) >> 1 : w >> 1, hw = w - lw;
+      test_line src, dst, l, h;
+      src.init<T>(w); dst.init<T>(w); l.init<T>(w); h.init<T>(w);
+
+      fill_random(rng, src.data<T>(), w, max_mag);
+      rev_horz_ana(atk, &l.line, &h.line, &src.line, w, even != 0);
+      std::string ana = std::string(name) + "_horz_ana";
+      log.add(label(ana.c_str(), w, even), l.data<T>(), lw * sizeof(T));
+      log.add(label(ana.c_str(), w, even), h.data<T>(), hw * sizeof(T));
+
+      fill_random(rng, l.data<T>(), lw, max_mag);
+      fill_random(rng, h.data<T>(), hw, max_mag);
+      rev_horz_syn(atk, &dst.line, &l.line, &h.line, w, even != 0);
+      std::string syn = std::string(name) + "_horz_syn";
+      log.add(label(syn.c_str(), w, even), dst.data<T>(), w * sizeof(T));
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST(TestKernels, RevHorz) {
+  param_atk atk53_store;
+  const param_atk* atk53 = atk53_store.get_atk(1);
+  custom_rev_atk atk;
+  check_all_levels(true, [&](codeblock_fun&, output_log& log) {
+    std::mt19937 rng(2);
+    const param_atk* atks[] = { atk53, atk.get() };
+    for (const param_atk* a : atks) {
+      rev_horz<si16>(a, rng, 1000, "rev16", log);
+      rev_horz<si32>(a, rng, 1 << 24, "rev32", log);
+      rev_horz<si64>(a, rng, 1LL << 40, "rev64", log);
+    }
+  });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Irreversible (9/7) lifting steps, scaling, and horizontal transforms;
+// kernels may order or fuse floating-point operations differently, and so
+// these are compared to a tolerance that is far below a quantization step
+static const double irv_tolerance = 1e-6;
+
+///////////////////////////////////////////////////////////////////////////////
+TEST(TestKernels, IrvWavelet) {
+  param_atk atk97_store;
+  const param_atk* atk97 = atk97_store.get_atk(0);
+  check_all_levels(false, [&](codeblock_fun&, output_log& log) {
+    std::mt19937 rng(3);
+    for (ui32 w : widths)
+    {
+      for (ui32 s = 0; s < atk97->get_num_steps(); ++s)
+        for (int synthesis = 0; synthesis < 2; ++synthesis)
+        {
+          test_line a, b, c;
+          a.init<float>(w); b.init<float>(w); c.init<float>(w);
+          fill_random(rng, a.data<float>(), w, 1.0f);
+          fill_random(rng, b.data<float>(), w, 1.0f);
+          fill_random(rng, c.data<float>(), w, 1.0f);
+          irv_vert_step(atk97->get_step(s), &a.line, &b.line, &c.line, w,
+                        synthesis != 0);
+          log.add_near(label("irv_vert_step", w, (int)s * 2 + synthesis),
+                       c.data<float>(), w, irv_tolerance);
+        }
+
+      test_line k;
+      k.init<float>(w);
+      fill_random(rng, k.data<float>(), w, 1.0f);
+      irv_vert_times_K(atk97->get_K(), &k.line, w);
+      log.add_near(label("irv_vert_times_K", w), k.data<float>(), w,
+                   irv_tolerance);
+
+      for (int even = 0; even < 2; ++even)
+      {
+        const ui32 lw = even ? (w + 1) >> 1 : w >> 1, hw = w - lw;
+        test_line src, dst, l, h;
+        src.init<float>(w); dst.init<float>(w);
+        l.init<float>(w); h.init<float>(w);
+        fill_random(rng, src.data<float>(), w, 1.0f);
+        irv_horz_ana(atk97, &l.line, &h.line, &src.line, w, even != 0);
+        log.add_near(label("irv_horz_ana", w, even), l.data<float>(), lw,
+                     irv_tolerance);
+        log.add_near(label("irv_horz_ana", w, even), h.data<float>(), hw,
+                     irv_tolerance);
+
+        fill_random(rng, l.data<float>(), lw, 1.0f);
+        fill_random(rng, h.data<float>(), hw, 1.0f);
+        irv_horz_syn(atk97, &dst.line, &l.line, &h.line, w, even != 0);
+        log.add_near(label("irv_horz_syn", w, even), dst.data<float>(), w,
+                     irv_tolerance);
+      }
+    }
+  });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Reversible sample conversion between the line widths the library mixes,
+// with and without the type 3 nonlinearity, from unaligned offsets
+template<typename S, typename D>
+static void rev_convert_lines(std::mt19937& rng, si64 max_mag, si64 shift,
+                              const char* name, output_log& log)
+{
+  for (ui32 w : widths)
+    for (ui32 offset = 0; offset < 4; ++offset)
+      for (int nlt = 0; nlt < 2; ++nlt)
+      {
+        test_line src, dst;
+        src.init<S>(w + offset); dst.init<D>(w + offset);
+        fill_random(rng, src.data<S>(), w + offset, max_mag);
+        const ui32 so = offset, doff = (offset * 3) & 3;
+        if (nlt)
+          rev_convert_nlt_type3(&src.line, so, &dst.line, doff, shift, w);
+        else
+          rev_convert(&src.line, so, &dst.line, doff, shift, w);
+        log.add(label(name, w, (int)offset * 2 + nlt), dst.data<D>() + doff,
+                w * sizeof(D));
+      }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST(TestKernels, RevConvert) {
+  check_all_levels(true, [&](codeblock_fun&, output_log& log) {
+    std::mt19937 rng(4);
+    rev_convert_lines<si32, si32>(rng, 1 << 30, -(1 << 11), "rev32to32", log);
+    rev_convert_lines<si32, si32>(rng, 1 << 30, 1 << 15, "rev32to32", log);
+    rev_convert_lines<si32, si64>(rng, 1 << 30, -(1LL << 31), "rev32to64",
+                                  log);
+    rev_convert_lines<si64, si32>(rng, 1LL << 30, 1LL << 31, "rev64to32",
+                                  log);
+    rev_convert_lines<si32, si16>(rng, 1 << 14, -(1 << 11), "rev32to16", log);
+    rev_convert_lines<si16, si32>(rng, 1 << 14, 1 << 11, "rev16to32", log);
+  });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Irreversible conversion between integers and floats, with clipping
+TEST(TestKernels, IrvConvert) {
+  check_all_levels(false, [&](codeblock_fun&, output_log& log) {
+    std::mt19937 rng(5);
+    const ui32 bit_depths[] = { 1, 8, 12, 16, 24, 31 };
+    for (ui32 w : widths)
+      for (ui32 bd : bit_depths)
+        for (int is_signed = 0; is_signed < 2; ++is_signed)
+          for (int nlt = 0; nlt < 2; ++nlt)
+          {
+            if (nlt && !is_signed)
+              continue;
+            const ui32 offset = (w + bd) & 3;
+            const int v = (int)bd * 4 + is_signed * 2 + nlt;
+            test_line i, f, o;
+            i.init<si32>(w + offset); f.init<float>(w);
+            o.init<si32>(w + offset);
+
+            // slightly out of range to exercise clipping; the SIMD kernels
+            // round ties to even, whereas the generic one rounds them away
+            // from zero
+            fill_random(rng, f.data<float>(), w, 0.55f);
+            if (nlt)
+              irv_convert_to_integer_nlt_type3(&f.line, &o.line, offset, bd,
+                                               is_signed != 0, w);
+            else
+              irv_convert_to_integer(&f.line, &o.line, offset, bd,
+                                     is_signed != 0, w);
+            log.add_near(label("irv_convert_to_integer", w, v),
+                         o.data<si32>() + offset, w, 1.0);
+
+            const si64 half = (si64)1 << (bd - 1);
+            si32* ip = i.data<si32>() + offset;
+            std::uniform_int_distribution<si64> dist(is_signed ? -half : 0,
+              is_signed ? half - 1 : 2 * half - 1);
+            for (ui32 j = 0; j < w; ++j)
+              ip[j] = (si32)dist(rng);
+            if (nlt)
+              irv_convert_to_float_nlt_type3(&i.line, offset, &f.line, bd,
+                                             is_signed != 0, w);
+            else
+              irv_convert_to_float(&i.line, offset, &f.line, bd,
+                                   is_signed != 0, w);
+            log.add(label("irv_convert_to_float", w, v), f.data<float>(),
+                    w * 4);
+          }
+  });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Reversible (RCT) and irreversible (ICT) colour transforms
+template<typename T>
+static void rct_lines(std::mt19937& rng, const char* name, output_log& log)
+{
+  for (ui32 w : widths)
+  {
+    test_line r, g, b, y, cb, cr;
+    r.init<si32>(w); g.init<si32>(w); b.init<si32>(w);
+    y.init<T>(w); cb.init<T>(w); cr.init<T>(w);
+    const si64 max_mag = sizeof(T) == 2 ? 1 << 13 : 1 << 29;
+    fill_random(rng, r.data<si32>(), w, max_mag);
+    fill_random(rng, g.data<si32>(), w, max_mag);
+    fill_random(rng, b.data<si32>(), w, max_mag);
+    rct_forward(&r.line, &g.line, &b.line, &y.line, &cb.line, &cr.line, w);
+    std::string fwd = std::string(name) + "_forward";
+    log.add(label(fwd.c_str(), w), y.data<T>(), w * sizeof(T));
+    log.add(label(fwd.c_str(), w), cb.data<T>(), w * sizeof(T));
+    log.add(label(fwd.c_str(), w), cr.data<T>(), w * sizeof(T));
+
+    fill_random(rng, y.data<T>(), w, max_mag);
+    fill_random(rng, cb.data<T>(), w, max_mag);
+    fill_random(rng, cr.data<T>(), w, max_mag);
+    rct_backward(&y.line, &cb.line, &cr.line, &r.line, &g.line, &b.line, w);
+    std::string bwd = std::string(name) + "_backward";
+    log.add(label(bwd.c_str(), w), r.data<si32>(), w * 4);
+    log.add(label(bwd.c_str(), w), g.data<si32>(), w * 4);
+    log.add(label(bwd.c_str(), w), b.data<si32>(), w * 4);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST(TestKernels, ColourTransform) {
+  check_all_levels(true, [&](codeblock_fun&, output_log& log) {
+    std::mt19937 rng(6);
+    rct_lines<si16>(rng, "rct16", log);
+    rct_lines<si32>(rng, "rct32", log);
+    rct_lines<si64>(rng, "rct64", log);
+
+    for (ui32 w : widths)
+    {
+      test_line r, g, b, y, cb, cr;
+      r.init<float>(w); g.init<float>(w); b.init<float>(w);
+      y.init<float>(w); cb.init<float>(w); cr.init<float>(w);
+      fill_random(rng, r.data<float>(), w, 0.5f);
+      fill_random(rng, g.data<float>(), w, 0.5f);
+      fill_random(rng, b.data<float>(), w, 0.5f);
+      ict_forward(r.data<float>(), g.data<float>(), b.data<float>(),
+                  y.data<float>(), cb.data<float>(), cr.data<float>(), w);
+      log.add(label("ict_forward", w), y.data<float>(), w * 4);
+      log.add(label("ict_forward", w), cb.data<float>(), w * 4);
+      log.add(label("ict_forward", w), cr.data<float>(), w * 4);
+
+      ict_backward(y.data<float>(), cb.data<float>(), cr.data<float>(),
+                   r.data<float>(), g.data<float>(), b.data<float>(), w);
+      log.add(label("ict_backward", w), r.data<float>(), w * 4);
+      log.add(label("ict_backward", w), g.data<float>(), w * 4);
+      log.add(label("ict_backward", w), b.data<float>(), w * 4);
+    }
+  });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Conversion between the 8- and 16-bit samples of a caller's frame and
+// 32-bit lines, planar and interleaved, from unaligned addresses; lines
+// are shifted and clamped to 8-bit, 10-bit, and 16-bit ranges, from values
+// that lie well outside them, and 16-bit samples are also byte-swapped;
+// the 16-bit lines of low-precision lossless components are stored exactly
+// as the same samples in 32-bit lines are
+TEST(TestKernels, FrameConvert) {
+  check_all_levels(true, [&](codeblock_fun&, output_log& log) {
+    std::mt19937 rng(9);
+    for (ui32 w : widths)
+      for (ui32 step = 1; step <= 3; step += 2)
+        for (int is_signed = 0; is_signed < 2; ++is_signed)
+        {
+          const int variant = (int)step * 2 + is_signed;
+          std::vector<ui8> f8(w * step + 1);
+          std::vector<ui16> f16(w * step + 1);
+          std::vector<si32> line(w);
+
+          fill_random(rng, f8.data(), (ui32)f8.size(), 255);
+          cnvrt_8b_to_si32(f8.data() + 1, step, is_signed != 0,
+                           line.data(), w);
+          log.add(label("8b_to_si32", w, variant), line.data(), w * 4);
+
+          fill_random(rng, f16.data(), (ui32)f16.size(), 65535);
+          for (int swap = 0; swap < 2; ++swap)
+          {
+            cnvrt_16b_to_si32(f16.data() + 1, step, is_signed != 0,
+                              swap != 0, line.data(), w);
+            log.add(label("16b_to_si32", w, variant * 2 + swap),
+                    line.data(), w * 4);
+          }
+
+          const ui32 bit_depths[] = { 8, 10, 16 };
+          for (ui32 bd : bit_depths)
+          {
+            si32 low = is_signed ? -(1 << (bd - 1)) : 0;
+            si32 high = is_signed ? (1 << (bd - 1)) - 1 : (1 << bd) - 1;
+            si32 half = is_signed ? 0 : 1 << (bd - 1);
+            fill_random(rng, line.data(), w, (si64)1 << (bd + 1));
+            line[0] = INT_MIN + half; line[w - 1] = INT_MAX - half;
+            for (si32 shift = 0; shift <= half; shift += half ? half : 1)
+            {
+              const int v = variant * 2 + (shift != 0);
+              if (bd == 8)
+              {
+                std::fill(f8.begin(), f8.end(), (ui8)0);
+                cnvrt_si32_to_8b(line.data(), shift, f8.data() + 1, step,
+                                 low, high, w);
+                log.add(label("si32_to_8b", w, v), f8.data(), f8.size());
+              }
+              for (int swap = 0; swap < 2; ++swap)
+              {
+                std::fill(f16.begin(), f16.end(), (ui16)0);
+                cnvrt_si32_to_16b(line.data(), shift, f16.data() + 1, step,
+                                  low, high, swap != 0, w);
+                log.add(label("si32_to_16b", w, v * 2 + swap), f16.data(),
+                        f16.size() * 2);
+              }
+            }
+
+            // 16 bit lines store exactly what the same samples in 32 bit
+            // lines do
+            std::vector<si16> line16(w);
+            fill_random(rng, line16.data(), w, 32767);
+            line16[0] = -32768; line16[w - 1] = 32767;
+            std::vector<si32> wide(line16.begin(), line16.end());
+            for (si32 shift = 0; shift <= half; shift += half ? half : 1)
+            {
+              const int v = variant * 2 + (shift != 0);
+              if (bd == 8)
+              {
+                std::vector<ui8> r8(f8.size(), 0);
+                std::fill(f8.begin(), f8.end(), (ui8)0);
+                cnvrt_si16_to_8b(line16.data(), shift, f8.data() + 1, step,
+                                 low, high, w);
+                cnvrt_si32_to_8b(wide.data(), shift, r8.data() + 1, step,
+                                 low, high, w);
+                EXPECT_EQ(f8, r8) << label("si16_to_8b", w, v);
+                log.add(label("si16_to_8b", w, v), f8.data(), f8.size());
+              }
+              for (int swap = 0; swap < 2; ++swap)
+              {
+                std::vector<ui16> r16(f16.size(), 0);
+                std::fill(f16.begin(), f16.end(), (ui16)0);
+                cnvrt_si16_to_16b(line16.data(), shift, f16.data() + 1, step,
+                                  low, high, swap != 0, w);
+                cnvrt_si32_to_16b(wide.data(), shift, r16.data() + 1, step,
+                                  low, high, swap != 0, w);
+                EXPECT_EQ(f16, r16) << label("si16_to_16b", w, v * 2 + swap);
+                log.add(label("si16_to_16b", w, v * 2 + swap), f16.data(),
+                        f16.size() * 2);
+              }
+            }
+          }
+        }
+  });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Direct conversion of irreversible lines to frame samples; at every cpu
+// extension level, this must store exactly what irv_convert_to_integer()
+// followed by clamping does
+TEST(TestKernels, FrameConvertFloat) {
+  check_all_levels(false, [&](codeblock_fun&, output_log& log) {
+    if (cnvrt_f32_to_8b == NULL)
+      return;
+    std::mt19937 rng(10);
+    for (ui32 w : widths)
+      for (ui32 step = 1; step <= 3; step += 2)
+        for (int is_signed = 0; is_signed < 2; ++is_signed)
+        {
+          const ui32 bit_depths[] = { 8, 10, 16 };
+          for (ui32 bd : bit_depths)
+          {
+            const int v = ((int)step * 2 + is_signed) * 32 + (int)bd;
+            si32 low = is_signed ? -(1 << (bd - 1)) : 0;
+            si32 high = is_signed ? (1 << (bd - 1)) - 1 : (1 << bd) - 1;
+            si32 shift = is_signed ? 0 : 1 << (bd - 1);
+            float mul = (float)(1u << bd);
+            test_line f, o;
+            f.init<float>(w); o.init<si32>(w);
+            fill_random(rng, f.data<float>(), w, 0.55f);
+            f.data<float>()[0] = 1e20f;
+            irv_convert_to_integer(&f.line, &o.line, 0, bd, is_signed != 0,
+                                   w);
+
+            std::vector<ui8> f8(w * step + 1), r8(w * step + 1);
+            std::vector<ui16> f16(w * step + 1), r16(w * step + 1);
+            for (ui32 i = 0; i < w; ++i)
+            {
+              si32 t = std::min(std::max(o.data<si32>()[i], low), high);
+              r8[1 + i * step] = (ui8)t;
+              r16[1 + i * step] = (ui16)t;
+            }
+            if (bd == 8)
+            {
+              cnvrt_f32_to_8b(f.data<float>(), mul, shift, f8.data() + 1,
+                              step, low, high, w);
+              EXPECT_EQ(f8, r8) << label("f32_to_8b", w, v);
+              log.add_near(label("f32_to_8b", w, v), f8.data(), f8.size(),
+                           1.0);
+            }
+            cnvrt_f32_to_16b(f.data<float>(), mul, shift, f16.data() + 1,
+                             step, low, high, false, w);
+            EXPECT_EQ(f16, r16) << label("f32_to_16b", w, v);
+            log.add_near(label("f32_to_16b", w, v), f16.data(), f16.size(),
+                         1.0);
+            cnvrt_f32_to_16b(f.data<float>(), mul, shift, f16.data() + 1,
+                             step, low, high, true, w);
+            for (ui16& t : r16)
+              t = (ui16)((t << 8) | (t >> 8));
+            EXPECT_EQ(f16, r16) << label("f32_to_16b_swapped", w, v);
+          }
+        }
+  });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Transfer between subband lines and codeblocks, from unaligned offsets,
+// and the maximum value search that follows it
+TEST(TestKernels, CodeblockTransfer) {
+  for (int reversible = 0; reversible < 2; ++reversible)
+    check_all_levels(reversible != 0, [&](codeblock_fun& cbf,
+                                          output_log& log) {
+      std::mt19937 rng(7);
+      const ui32 K_max = 20;
+      const float delta = 1.0f / 64.0f;
+      for (ui32 w : widths)
+      {
+        if (w > 256) // codeblocks are at most 1024 wide, but not 1000
+          continue;
+        const ui32 offset = w & 3;
+        ui32 mv32[8] = { 0 };
+        ui64 mv64[8] = { 0 };
+
+        test_line src, cb, dst;
+        src.init<si64>(w + offset); cb.init<si64>(w);
+        dst.init<si64>(w + offset);
+        ui32 m32;
+        if (reversible) {
+          fill_random(rng, src.data<si32>() + offset, w, (1 << K_max) - 1);
+          cbf.tx_to_cb32(src.data<si32>() + offset, cb.data<ui32>(), K_max,
+                         1.0f, w, mv32);
+          log.add(label("tx_to_cb32", w), cb.data<ui32>(), w * 4);
+          m32 = cbf.find_max_val32(mv32);
+          log.add(label("find_max_val32", w), &m32, sizeof(m32));
+        }
+        else {
+          // the SIMD quantizers round to the nearest integer, whereas the
+          // generic one truncates
+          fill_random(rng, src.data<float>() + offset, w, 0.5f);
+          cbf.tx_to_cb32(src.data<float>() + offset, cb.data<ui32>(), K_max,
+                         1.0f / delta, w, mv32);
+          std::vector<si32> q(w);
+          for (ui32 i = 0; i < w; ++i) {
+            ui32 v = cb.data<ui32>()[i];
+            q[i] = (v & 0x80000000u) ? -(si32)(v & 0x7FFFFFFFu) : (si32)v;
+          }
+          log.add_near(label("tx_to_cb32", w), q.data(), w, 1.0);
+
+          // the dequantizer below is then given the same codeblock at
+          // every level
+          gen_irv_tx_to_cb32(src.data<float>() + offset, cb.data<ui32>(),
+                             K_max, 1.0f / delta, w, mv32);
+        }
+
+        cbf.tx_from_cb32(cb.data<ui32>(), dst.data<si32>() + offset, K_max,
+                         delta, w);
+        log.add(label("tx_from_cb32", w), dst.data<si32>() + offset, w * 4);
+
+        if (reversible)
+        {
+          memset(mv32, 0, sizeof(mv32));
+          fill_random(rng, src.data<si16>() + offset, w, (1 << 15) - 1);
+          cbf.tx16_to_cb32(src.data<si16>() + offset, cb.data<ui32>(), 17,
+                           1.0f, w, mv32);
+          log.add(label("tx16_to_cb32", w), cb.data<ui32>(), w * 4);
+          m32 = cbf.find_max_val32(mv32);
+          log.add(label("find_max_val32 16bit", w), &m32, sizeof(m32));
+          cbf.tx16_from_cb32(cb.data<ui32>(), dst.data<si16>() + offset, 17,
+                             delta, w);
+          log.add(label("tx16_from_cb32", w), dst.data<si16>() + offset,
+                  w * 2);
+
+          fill_random(rng, src.data<si64>() + offset, w, (1LL << 40) - 1);
+          cbf.tx_to_cb64(src.data<si64>() + offset, cb.data<ui64>(), 41,
+                         1.0f, w, mv64);
+          log.add(label("tx_to_cb64", w), cb.data<ui64>(), w * 8);
+          ui64 m64 = cbf.find_max_val64(mv64);
+          log.add(label("find_max_val64", w), &m64, sizeof(m64));
+        }
+        else
+        {
+          // 64bit codeblocks carrying irreversible data produce floats
+          for (ui32 i = 0; i < w; ++i)
+            cb.data<ui64>()[i] = ((ui64)(rng() & 1) << 63)
+                               | ((ui64)(rng() & 0xFFFFFF) << 20);
+        }
+        cbf.tx_from_cb64(cb.data<ui64>(), dst.data<si64>() + offset, 41,
+                         delta, w);
+        log.add(label("tx_from_cb64", w), dst.data<si64>() + offset,
+                reversible ? w * 8 : w * 4);
+
+        fill_random(rng, dst.data<si64>(), w, 1000);
+        cbf.mem_clear(dst.data<si64>(), w * sizeof(si64));
+        log.add(label("mem_clear", w), dst.data<si64>(), w * 8);
+      }
+    });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// HT block encoding and decoding of 32 and 64bit codeblocks
+TEST(TestKernels, BlockCoding) {
+  struct cb_dims { ui32 w, h; };
+  const cb_dims dims[] = { { 1, 1 }, { 4, 4 }, { 5, 3 }, { 33, 17 },
+    { 64, 64 }, { 128, 32 }, { 1024, 4 }, { 4, 1024 } };
+  const ui32 pre = coded_cb_header::prefix_buf_size;
+  const ui32 suf = coded_cb_header::suffix_buf_size;
+
+  check_all_levels(true, [&](codeblock_fun& cbf, output_log& log) {
+    std::mt19937 rng(8);
+    mem_elastic_allocator elastic(1048576);
+    for (const cb_dims& d : dims)
+      for (int bits64 = 0; bits64 < 2; ++bits64)
+        for (int sparse = 0; sparse < 2; ++sparse)
+        {
+          // decoders write whole quads and vectors, and so codeblocks are
+          // given the room they have inside the library
+          const ui32 stride = (d.w + 15) & ~15u;
+          const ui32 n = stride * ((d.h + 3) & ~3u);
+          const ui32 K_max = bits64 ? 40 : 24;
+          const si64 max_mag = sparse ? 3 : ((si64)1 << K_max) - 1;
+          std::vector<si64> samples(d.w);
+          std::vector<si32> s32(d.w);
+
+          test_line cb, dec;
+          cb.init<si64>(n); dec.init<si64>(n);
+          ui32 mv32[8] = { 0 };
+          ui64 mv64[8] = { 0 };
+          for (ui32 y = 0; y < d.h; ++y) {
+            fill_random(rng, samples.data(), d.w, max_mag);
+            if (bits64)
+              gen_rev_tx_to_cb64(samples.data(), cb.data<ui64>() + y * stride,
+                                 K_max, 1.0f, d.w, mv64);
+            else {
+              s32.assign(samples.begin(), samples.end());
+              gen_rev_tx_to_cb32(s32.data(), cb.data<ui32>() + y * stride,
+                                 K_max, 1.0f, d.w, mv32);
+            }
+          }
+
+          ui32 lengths[2] = { 0, 0 };
+          coded_lists* coded = NULL;
+          if (bits64)
+            cbf.encode_cb64(cb.data<ui64>(), K_max - 1, 1, d.w, d.h, stride,
+                            lengths, &elastic, coded);
+          else
+            cbf.encode_cb32(cb.data<ui32>(), K_max - 1, 1, d.w, d.h, stride,
+                            lengths, &elastic, coded);
+          std::string name = std::string(bits64 ? "cb64 " : "cb32 ")
+            + std::to_string(d.w) + "x" + std::to_string(d.h)
+            + (sparse ? " sparse" : "");
+          log.add("encoded length " + name, lengths, sizeof(lengths));
+
+          ASSERT_NE(coded, (coded_lists*)NULL);
+          std::vector<ui8> buf(pre + lengths[0] + suf, 0);
+          memcpy(buf.data() + pre, coded->buf, lengths[0]);
+          log.add("encoded " + name, buf.data() + pre, lengths[0]);
+          elastic.restart();
+
+          bool result;
+          if (bits64)
+            result = cbf.decode_cb64(buf.data() + pre, dec.data<ui64>(),
+              K_max - 1, 1, lengths[0], 0, d.w, d.h, stride, false);
+          else
+            result = cbf.decode_cb32(buf.data() + pre, dec.data<ui32>(),
+              K_max - 1, 1, lengths[0], 0, d.w, d.h, stride, false);
+          EXPECT_TRUE(result) << name;
+          const size_t bytes = bits64 ? 8 : 4;
+          for (ui32 y = 0; y < d.h; ++y)
+            log.add("decoded " + name, dec.data<ui8>() + y * stride * bytes,
+                    d.w * bytes);
+        }
+  });
+}
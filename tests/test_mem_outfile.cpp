@@ -0,0 +1,381 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2019, Aous Naman
+// Copyright (c) 2019, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2019, The University of New South Wales, Australia
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: test_mem_outfile.cpp
+// Author: Aous Naman
+// Date: 19 October 2026
+//***************************************************************************/
+//
+// These tests check that mem_chunked_outfile stores exactly what
+// mem_outfile stores, whether it is written to directly, through gather
+// writes, or after seeking back to patch data already written, and that
+// reopening it reuses its chunks.  They also check that j2c_async_outfile
+// writes the same to disk, and that j2c_prefetch_infile reads it back as
+// any other file.
+//
+// Except for j2c_async_outfile and j2c_prefetch_infile, everything is done
+// in memory; their tests write a temporary file in the working directory.
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "ojph_arch.h"
+#include "ojph_codestream.h"
+#include "ojph_file.h"
+#include "ojph_mem.h"
+#include "ojph_params.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+// A small chunk size makes the codestream span many chunks, so that packets
+// and codeblock data straddle chunk boundaries.
+static const size_t CHUNK_SIZE = 4096;
+
+static const ojph::ui32 IMAGE_WIDTH  = 256;
+static const ojph::ui32 IMAGE_HEIGHT = 256;
+
+////////////////////////////////////////////////////////////////////////////////
+//                             encode_to_file
+////////////////////////////////////////////////////////////////////////////////
+// Encodes a three component 8 bit reversible image into file, which must be
+// open.
+static void encode_to_file(ojph::outfile_base *file)
+{
+  ojph::codestream cs;
+
+  ojph::param_siz siz = cs.access_siz();
+  siz.set_image_extent(ojph::point(IMAGE_WIDTH, IMAGE_HEIGHT));
+  siz.set_num_components(3);
+  for (ojph::ui32 c = 0; c < 3; ++c)
+    siz.set_component(c, ojph::point(1, 1), 8, false);
+
+  ojph::param_cod cod = cs.access_cod();
+  cod.set_num_decomposition(5);
+  cod.set_block_dims(32, 32);
+  cod.set_reversible(true);
+  cod.set_color_transform(true);
+  cs.set_tilepart_divisions(true, false);
+  cs.request_tlm_marker(true);
+
+  cs.write_headers(file);
+
+  ojph::ui32 next_comp = 0;
+  ojph::line_buf* line = cs.exchange(NULL, next_comp);
+  for (ojph::ui32 y = 0; y < IMAGE_HEIGHT; ++y)
+    for (ojph::ui32 c = 0; c < 3; ++c)
+    {
+      ojph::si32* dp = line->i32;
+      for (ojph::ui32 x = 0; x < IMAGE_WIDTH; ++x)
+        dp[x] = (ojph::si32)((x * (7 + c) + y * 13 + ((x * y) >> 3)) & 0xFF);
+      line = cs.exchange(line, next_comp);
+    }
+  cs.flush();
+  cs.close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Returns the content of a chunked file as one contiguous vector.
+static std::vector<ojph::ui8> gather(const ojph::mem_chunked_outfile& f)
+{
+  std::vector<ojph::ui8> v;
+  for (ojph::ui32 i = 0; i < f.get_num_chunks(); ++i)
+  {
+    size_t size;
+    const ojph::ui8* p = f.get_chunk(i, size);
+    v.insert(v.end(), p, p + size);
+  }
+  return v;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A codestream encoded into chunks is identical to one encoded into a
+// contiguous buffer.
+TEST(mem_chunked_outfile, codestream_matches_mem_outfile)
+{
+  ojph::mem_outfile ref;
+  ref.open();
+  encode_to_file(&ref);
+  std::vector<ojph::ui8> expected(ref.get_data(),
+                                  ref.get_data() + ref.get_used_size());
+
+  ojph::mem_chunked_outfile out;
+  out.open(CHUNK_SIZE);
+  encode_to_file(&out);
+
+  ASSERT_EQ(out.get_used_size(), expected.size());
+  EXPECT_GT(out.get_num_chunks(), 1u);
+  EXPECT_EQ(gather(out), expected);
+
+  // write_to() hands the chunks to another file in order
+  ojph::mem_outfile copy;
+  copy.open();
+  EXPECT_EQ(out.write_to(&copy), expected.size());
+  ASSERT_EQ(copy.get_used_size(), expected.size());
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(), copy.get_data()));
+  copy.close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Seeking back and overwriting, as done to patch a length field after the
+// data it describes is written, works across chunk boundaries; seeking
+// beyond the end extends the file.
+TEST(mem_chunked_outfile, seek_and_patch)
+{
+  std::vector<ojph::ui8> data(3 * CHUNK_SIZE + 100);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = (ojph::ui8)(i * 31 + 7);
+
+  ojph::mem_chunked_outfile out;
+  out.open(CHUNK_SIZE, true);
+  out.write(data.data(), data.size());
+  EXPECT_EQ(out.get_num_chunks(), 4u);
+
+  // patch 8 bytes straddling the boundary between chunks 1 and 2
+  const ojph::ui8 patch[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+  ASSERT_EQ(out.seek((ojph::si64)(2 * CHUNK_SIZE - 4),
+                     ojph::outfile_base::OJPH_SEEK_SET), 0);
+  out.write(patch, sizeof(patch));
+  std::copy(patch, patch + sizeof(patch), data.begin() + 2 * CHUNK_SIZE - 4);
+  EXPECT_EQ(out.tell(), (ojph::si64)(2 * CHUNK_SIZE + 4));
+  EXPECT_EQ(out.get_used_size(), data.size());
+
+  // continue at the end, past a gap that reads as zero
+  ASSERT_EQ(out.seek(10, ojph::outfile_base::OJPH_SEEK_END), 0);
+  ojph::out_vec vecs[2] = { { patch, 3 }, { patch + 3, 5 } };
+  EXPECT_EQ(out.write_v(vecs, 2), 8u);
+  data.insert(data.end(), 10, 0);
+  data.insert(data.end(), patch, patch + sizeof(patch));
+
+  EXPECT_EQ(out.seek(-1, ojph::outfile_base::OJPH_SEEK_SET), -1);
+  out.close();
+  EXPECT_EQ(gather(out), data);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reopening the file reuses its chunks, rather than allocating new ones.
+TEST(mem_chunked_outfile, reopen_reuses_chunks)
+{
+  ojph::mem_chunked_outfile out;
+  out.open(CHUNK_SIZE);
+  encode_to_file(&out);
+  std::vector<ojph::ui8> first = gather(out);
+  size_t size;
+  const ojph::ui8* first_chunk = out.get_chunk(0, size);
+
+  out.open(CHUNK_SIZE);
+  EXPECT_EQ(out.get_used_size(), 0u);
+  encode_to_file(&out);
+  EXPECT_EQ(out.get_chunk(0, size), first_chunk);
+  EXPECT_EQ(gather(out), first);
+
+  out.release();
+  EXPECT_EQ(out.get_num_chunks(), 0u);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Returns the content of a file on disk.
+static std::vector<ojph::ui8> read_file(const char *name)
+{
+  std::vector<ojph::ui8> v;
+  FILE *f = fopen(name, "rb");
+  if (f == NULL)
+    return v;
+  ojph::ui8 buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+    v.insert(v.end(), buf, buf + n);
+  fclose(f);
+  return v;
+}
+
+static const char ASYNC_FILE_NAME[] = "test_async_outfile.j2c";
+
+////////////////////////////////////////////////////////////////////////////////
+// A codestream written from the background thread is identical to one
+// encoded into memory, with blocks small enough that many are written
+// while encoding, with and without O_DIRECT.
+TEST(j2c_async_outfile, codestream_matches_mem_outfile)
+{
+  ojph::mem_outfile ref;
+  ref.open();
+  encode_to_file(&ref);
+  std::vector<ojph::ui8> expected(ref.get_data(),
+                                  ref.get_data() + ref.get_used_size());
+
+  for (int direct = 0; direct < 2; ++direct)
+  {
+    ojph::j2c_async_outfile out;
+    out.open(ASYNC_FILE_NAME, CHUNK_SIZE, direct != 0);
+    encode_to_file(&out); // closes the file
+    EXPECT_EQ(read_file(ASYNC_FILE_NAME), expected);
+  }
+  remove(ASYNC_FILE_NAME);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Data is in the file after flush(); seeking back patches data in blocks
+// already written, and seeking beyond the end leaves a gap of zeros.
+TEST(j2c_async_outfile, flush_and_seek)
+{
+  std::vector<ojph::ui8> data(3 * CHUNK_SIZE + 100);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = (ojph::ui8)(i * 31 + 7);
+
+  ojph::j2c_async_outfile out;
+  out.open(ASYNC_FILE_NAME, CHUNK_SIZE);
+  EXPECT_EQ(out.write(data.data(), data.size()), data.size());
+  EXPECT_EQ(out.tell(), (ojph::si64)data.size());
+  out.flush();
+  EXPECT_EQ(read_file(ASYNC_FILE_NAME), data);
+
+  // patch 8 bytes straddling the boundary between blocks 0 and 1
+  const ojph::ui8 patch[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+  ASSERT_EQ(out.seek((ojph::si64)(CHUNK_SIZE - 4),
+                     ojph::outfile_base::OJPH_SEEK_SET), 0);
+  out.write(patch, sizeof(patch));
+  std::copy(patch, patch + sizeof(patch), data.begin() + CHUNK_SIZE - 4);
+  EXPECT_EQ(out.tell(), (ojph::si64)(CHUNK_SIZE + 4));
+
+  // continue at the end, past a gap
+  ASSERT_EQ(out.seek(10, ojph::outfile_base::OJPH_SEEK_END), 0);
+  out.write(patch, sizeof(patch));
+  data.insert(data.end(), 10, 0);
+  data.insert(data.end(), patch, patch + sizeof(patch));
+
+  EXPECT_EQ(out.seek(-1, ojph::outfile_base::OJPH_SEEK_SET), -1);
+  out.close();
+  EXPECT_EQ(read_file(ASYNC_FILE_NAME), data);
+  remove(ASYNC_FILE_NAME);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Decodes the codestream in file and returns all its samples, component
+// after component for each line.
+static std::vector<ojph::si32> decode_file(ojph::infile_base *file)
+{
+  ojph::codestream cs;
+  cs.read_headers(file);
+  cs.create();
+  std::vector<ojph::si32> samples;
+  for (ojph::ui32 y = 0; y < IMAGE_HEIGHT; ++y)
+    for (ojph::ui32 c = 0; c < 3; ++c)
+    {
+      ojph::ui32 comp_num;
+      ojph::line_buf *line = cs.pull(comp_num);
+      EXPECT_EQ(comp_num, c);
+      samples.insert(samples.end(), line->i32, line->i32 + IMAGE_WIDTH);
+    }
+  cs.close();
+  return samples;
+}
+
+static const char PREFETCH_FILE_NAME[] = "test_prefetch_infile.j2c";
+
+////////////////////////////////////////////////////////////////////////////////
+// Reads of all sizes, which straddle blocks, and seeks forward, backward
+// and outside the window return what is in the file.
+TEST(j2c_prefetch_infile, reads_and_seeks)
+{
+  std::vector<ojph::ui8> data(10 * CHUNK_SIZE + 123);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = (ojph::ui8)(i * 31 + 7);
+  {
+    ojph::j2c_outfile out;
+    out.open(PREFETCH_FILE_NAME);
+    out.write(data.data(), data.size());
+    out.close();
+  }
+
+  ojph::j2c_prefetch_infile in;
+  in.open(PREFETCH_FILE_NAME, CHUNK_SIZE, 3);
+  std::vector<ojph::ui8> buf(data.size() + 10);
+  size_t pos = 0, size = 1;
+  while (pos < data.size())
+  { // sizes from 1 byte to more than the window
+    size_t n = in.read(buf.data(), size);
+    ASSERT_EQ(n, ojph_min(size, data.size() - pos));
+    EXPECT_TRUE(std::equal(buf.begin(), buf.begin() + (ptrdiff_t)n,
+                           data.begin() + (ptrdiff_t)pos));
+    pos += n;
+    EXPECT_EQ(in.tell(), (ojph::si64)pos);
+    size = size * 3 + 1;
+  }
+  EXPECT_TRUE(in.eof());
+  EXPECT_EQ(in.read(buf.data(), 1), 0u);
+
+  const ojph::si64 offsets[] = { 5, 9 * CHUNK_SIZE - 2, 2 * CHUNK_SIZE,
+                                 CHUNK_SIZE + 1, 7 * CHUNK_SIZE + 9 };
+  for (ojph::si64 offset : offsets)
+  {
+    ASSERT_EQ(in.seek(offset, ojph::infile_base::OJPH_SEEK_SET), 0);
+    EXPECT_FALSE(in.eof());
+    ASSERT_EQ(in.read(buf.data(), 100), 100u);
+    EXPECT_TRUE(std::equal(buf.begin(), buf.begin() + 100,
+                           data.begin() + offset));
+  }
+  ASSERT_EQ(in.seek(-10, ojph::infile_base::OJPH_SEEK_END), 0);
+  ASSERT_EQ(in.read(buf.data(), 100), 10u);
+  EXPECT_TRUE(std::equal(buf.begin(), buf.begin() + 10, data.end() - 10));
+  EXPECT_EQ(in.seek(-1, ojph::infile_base::OJPH_SEEK_SET), -1);
+  in.close();
+  remove(PREFETCH_FILE_NAME);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A codestream decoded through small read-ahead blocks, which split
+// tile-parts, decodes exactly as it does from memory.
+TEST(j2c_prefetch_infile, decodes_like_mem_infile)
+{
+  ojph::mem_outfile ref;
+  ref.open();
+  encode_to_file(&ref);
+  {
+    ojph::j2c_outfile out;
+    out.open(PREFETCH_FILE_NAME);
+    out.write(ref.get_data(), ref.get_used_size());
+    out.close();
+  }
+
+  ojph::mem_infile mem;
+  mem.open(ref.get_data(), ref.get_used_size());
+  std::vector<ojph::si32> expected = decode_file(&mem);
+
+  ojph::j2c_prefetch_infile in;
+  in.open(PREFETCH_FILE_NAME, CHUNK_SIZE, 2);
+  EXPECT_EQ(decode_file(&in), expected); // closes the file
+  remove(PREFETCH_FILE_NAME);
+}
+
+} // anonymous namespace
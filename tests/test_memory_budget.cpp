@@ -0,0 +1,234 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2019, Aous Naman
+// Copyright (c) 2019, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2019, The University of New South Wales, Australia
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: test_memory_budget.cpp
+// Author: Aous Naman
+// Date: 19 October 2026
+//***************************************************************************/
+//
+// These tests check codestream::estimate_memory() against what decoding
+// actually uses, and that codestream::set_memory_budget() makes decoding
+// fail with an error, rather than exhaust memory, when the budget is too
+// small -- and that referring to coded data in place, through a persistent
+// mem_infile, lets decoding fit in a budget that copying data would not.
+// They also check that codestreams using the shared pool return their
+// memory to it, and borrow from it, and that the pool honours its limit.
+//
+// Everything is done in memory, so the tests need no external files.
+
+#include <stdexcept>
+#include <vector>
+
+#include "ojph_arch.h"
+#include "ojph_codestream.h"
+#include "ojph_file.h"
+#include "ojph_mem.h"
+#include "ojph_message.h"
+#include "ojph_params.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+// The image is noisy enough that its lossless codestream spans several of the
+// 1MB chunks in which memory for coded data grows.
+static const ojph::ui32 IMAGE_WIDTH  = 1024;
+static const ojph::ui32 IMAGE_HEIGHT = 2560;
+
+////////////////////////////////////////////////////////////////////////////////
+//                          encode_test_codestream
+////////////////////////////////////////////////////////////////////////////////
+static std::vector<ojph::ui8> encode_test_codestream()
+{
+  ojph::codestream cs;
+
+  ojph::param_siz siz = cs.access_siz();
+  siz.set_image_extent(ojph::point(IMAGE_WIDTH, IMAGE_HEIGHT));
+  siz.set_num_components(1);
+  siz.set_component(0, ojph::point(1, 1), 8, false);
+
+  ojph::param_cod cod = cs.access_cod();
+  cod.set_num_decomposition(5);
+  cod.set_reversible(true);
+
+  ojph::mem_outfile out;
+  out.open();
+  cs.write_headers(&out);
+
+  ojph::memory_estimate est = cs.estimate_memory();
+  EXPECT_GT(est.fixed_bytes, 0u);
+  EXPECT_GE(est.coded_bytes, (ojph::ui64)IMAGE_WIDTH * IMAGE_HEIGHT);
+
+  ojph::ui32 next_comp = 0, seed = 1;
+  ojph::line_buf* line = cs.exchange(NULL, next_comp);
+  for (ojph::ui32 y = 0; y < IMAGE_HEIGHT; ++y)
+  {
+    ojph::si32* dp = line->i32;
+    for (ojph::ui32 x = 0; x < IMAGE_WIDTH; ++x)
+    {
+      seed = seed * 1103515245u + 12345u;
+      dp[x] = (ojph::si32)((seed >> 16) & 0xFF);
+    }
+    line = cs.exchange(line, next_comp);
+  }
+  cs.flush();
+
+  std::vector<ojph::ui8> buf(out.get_data(),
+                             out.get_data() + (size_t)out.tell());
+  cs.close();
+  return buf;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Decodes buf within budget bytes (0 for no budget), and returns the
+// estimate made before create().  When cs is given, it is used, and left
+// for the caller to destroy.
+static ojph::memory_estimate decode(const std::vector<ojph::ui8>& buf,
+                                    bool persistent, ojph::ui64 budget,
+                                    ojph::codestream* given = NULL)
+{
+  ojph::mem_infile in;
+  in.open(buf.data(), buf.size(), persistent);
+
+  ojph::codestream local_cs;
+  ojph::codestream& cs = given ? *given : local_cs;
+  cs.set_memory_budget(budget);
+  cs.read_headers(&in);
+  ojph::memory_estimate est = cs.estimate_memory();
+  cs.create();
+
+  // the structures allocated are exactly those estimated
+  ojph::memory_estimate after = cs.estimate_memory();
+  EXPECT_EQ(after.fixed_bytes, est.fixed_bytes);
+
+  for (ojph::ui32 y = 0; y < IMAGE_HEIGHT; ++y)
+  {
+    ojph::ui32 comp_num;
+    cs.pull(comp_num);
+  }
+  cs.close();
+  return est;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+class memory_budget : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    full = encode_test_codestream();
+    ASSERT_GT(full.size(), 2u << 20)
+      << "the test codestream is too small to exceed the budgets below";
+  }
+
+  void TearDown() override
+  {
+    ojph::set_message_level(ojph::OJPH_MSG_ALL_MSG);
+  }
+
+  std::vector<ojph::ui8> full;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Copying decoding counts the whole codestream as coded data; decoding in
+// place counts little more than one chunk.
+TEST_F(memory_budget, estimate_reflects_in_place_decoding)
+{
+  ojph::memory_estimate copied = decode(full, false, 0);
+  ojph::memory_estimate in_place = decode(full, true, 0);
+  EXPECT_EQ(copied.fixed_bytes, in_place.fixed_bytes);
+  EXPECT_GE(copied.coded_bytes, (ojph::ui64)full.size());
+  EXPECT_LT(in_place.coded_bytes, (ojph::ui64)full.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A budget smaller than the fixed allocation fails in create(), before
+// anything is decoded.
+TEST_F(memory_budget, create_fails_when_structures_exceed_budget)
+{
+  ojph::memory_estimate est = decode(full, false, 0);
+  ojph::set_message_level(ojph::OJPH_MSG_NO_MSG);
+  EXPECT_THROW(decode(full, false, est.fixed_bytes / 2), std::runtime_error);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A budget that holds the structures and one chunk of coded data is too
+// small to copy the codestream, but large enough to decode it in place.
+TEST_F(memory_budget, decoding_in_place_fits_a_smaller_budget)
+{
+  ojph::memory_estimate est = decode(full, true, 0);
+  ojph::ui64 budget = est.fixed_bytes + est.coded_bytes;
+  ASSERT_LT(budget, est.fixed_bytes + full.size());
+
+  EXPECT_NO_THROW(decode(full, true, budget));
+  ojph::set_message_level(ojph::OJPH_MSG_NO_MSG);
+  EXPECT_THROW(decode(full, false, budget), std::runtime_error);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A codestream using the shared pool returns its memory to the pool when
+// it is restarted; another codestream then borrows that memory instead of
+// allocating, and the pool keeps no more than its limit.
+TEST_F(memory_budget, shared_pool_recycles_memory_between_codestreams)
+{
+  ojph::trim_shared_pool();
+  ASSERT_EQ(ojph::get_shared_pool_size(), 0u);
+
+  size_t held;
+  {
+    ojph::codestream a;
+    a.use_shared_pool(true);
+    decode(full, false, 0, &a);
+    EXPECT_EQ(ojph::get_shared_pool_size(), 0u);
+    a.restart();
+    held = ojph::get_shared_pool_size();
+    EXPECT_GE(held, full.size());
+  }
+  EXPECT_EQ(ojph::get_shared_pool_size(), held);
+
+  {
+    ojph::codestream b;
+    b.use_shared_pool(true);
+    decode(full, false, 0, &b);
+    EXPECT_EQ(ojph::get_shared_pool_size(), 0u)
+      << "the second codestream allocated instead of borrowing";
+  } // b returns the memory on destruction
+  EXPECT_EQ(ojph::get_shared_pool_size(), held);
+
+  ojph::set_shared_pool_limit(held / 2);
+  EXPECT_LE(ojph::get_shared_pool_size(), held / 2);
+  ojph::trim_shared_pool();
+  EXPECT_EQ(ojph::get_shared_pool_size(), 0u);
+  ojph::set_shared_pool_limit((size_t)256 << 20);
+}
+
+} // anonymous namespace
@@ -0,0 +1,295 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2019, Aous Naman
+// Copyright (c) 2019, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2019, The University of New South Wales, Australia
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: test_memory_placement.cpp
+// Author: Aous Naman
+// Date: 19 October 2026
+//***************************************************************************/
+//
+// These tests check codestream::set_fixed_memory_placement(): that hooks
+// allocate the fixed store, once, and free it, with the size they
+// allocated, when the codestream is destroyed; and that every combination
+// of placement flags still encodes and decodes losslessly, including when
+// the kernel refuses explicit huge pages, as it does when none are
+// reserved, which is the default on most machines.
+//
+// Everything is done in memory, so the tests need no external files.
+
+#include <cstdlib>
+#include <vector>
+
+#include "ojph_arch.h"
+#include "ojph_codestream.h"
+#include "ojph_file.h"
+#include "ojph_mem.h"
+#include "ojph_message.h"
+#include "ojph_params.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+// Large enough for the fixed store to span several 2MB huge pages.
+static const ojph::ui32 IMAGE_WIDTH  = 2048;
+static const ojph::ui32 IMAGE_HEIGHT = 256;
+
+////////////////////////////////////////////////////////////////////////////////
+static ojph::si32 sample(ojph::ui32 x, ojph::ui32 y, ojph::ui32 c)
+{
+  return (ojph::si32)((x * (3 + c) + y * 5 + ((x * y) >> 4)) & 0xFF);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Encodes a three component 8 bit image losslessly, and returns the
+// codestream; cs is closed, but left for the caller to restart or destroy.
+static std::vector<ojph::ui8> encode(ojph::codestream& cs)
+{
+  ojph::param_siz siz = cs.access_siz();
+  siz.set_image_extent(ojph::point(IMAGE_WIDTH, IMAGE_HEIGHT));
+  siz.set_num_components(3);
+  for (ojph::ui32 c = 0; c < 3; ++c)
+    siz.set_component(c, ojph::point(1, 1), 8, false);
+
+  ojph::param_cod cod = cs.access_cod();
+  cod.set_num_decomposition(5);
+  cod.set_reversible(true);
+  cod.set_color_transform(true);
+
+  ojph::mem_outfile out;
+  out.open();
+  cs.write_headers(&out);
+
+  ojph::ui32 next_comp = 0;
+  ojph::line_buf* line = cs.exchange(NULL, next_comp);
+  for (ojph::ui32 y = 0; y < IMAGE_HEIGHT; ++y)
+    for (ojph::ui32 c = 0; c < 3; ++c)
+    {
+      ojph::si32* dp = line->i32;
+      for (ojph::ui32 x = 0; x < IMAGE_WIDTH; ++x)
+        dp[x] = sample(x, y, c);
+      line = cs.exchange(line, next_comp);
+    }
+  cs.flush();
+  cs.close();
+  return std::vector<ojph::ui8>(out.get_data(),
+                                out.get_data() + out.get_used_size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Decodes data with cs, and returns true if every sample is reproduced.
+static bool decodes_losslessly(ojph::codestream& cs,
+                               const std::vector<ojph::ui8>& data)
+{
+  ojph::mem_infile in;
+  in.open(data.data(), data.size());
+  cs.read_headers(&in);
+  cs.create();
+
+  bool exact = true;
+  for (ojph::ui32 y = 0; y < IMAGE_HEIGHT; ++y)
+    for (ojph::ui32 c = 0; c < 3; ++c)
+    {
+      ojph::ui32 comp_num;
+      ojph::line_buf *line = cs.pull(comp_num);
+      for (ojph::ui32 x = 0; x < IMAGE_WIDTH; ++x)
+        exact = exact && line->i32[x] == sample(x, y, comp_num);
+    }
+  cs.close();
+  return exact;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Records the calls made to the hooks; refuse makes alloc fail.
+struct hook_log
+{
+  int allocs, frees;
+  size_t allocated_size, freed_size;
+  void *allocated, *freed;
+  bool refuse;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+static void* logging_alloc(size_t size, void *context)
+{
+  hook_log* log = (hook_log*)context;
+  ++log->allocs;
+  log->allocated_size = size;
+  log->allocated = log->refuse ? NULL : malloc(size);
+  return log->allocated;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static void logging_free(void *ptr, size_t size, void *context)
+{
+  hook_log* log = (hook_log*)context;
+  ++log->frees;
+  log->freed_size = size;
+  log->freed = ptr;
+  free(ptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static ojph::mem_store_hooks make_hooks(hook_log& log)
+{
+  log = hook_log();
+  ojph::mem_store_hooks hooks;
+  hooks.alloc = logging_alloc;
+  hooks.free = logging_free;
+  hooks.context = &log;
+  return hooks;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The hooks allocate the fixed store once, at write_headers(), keep it
+// across restart(), and free it, with the size allocated, only when the
+// codestream is destroyed.
+TEST(memory_placement, hooks_allocate_and_free_the_encoder_store)
+{
+  hook_log log;
+  ojph::mem_store_hooks hooks = make_hooks(log);
+  {
+    ojph::codestream cs;
+    cs.set_fixed_memory_placement(ojph::OJPH_MEM_DEFAULT, &hooks);
+    std::vector<ojph::ui8> first = encode(cs);
+    EXPECT_EQ(log.allocs, 1);
+    EXPECT_GT(log.allocated_size, 0u);
+    EXPECT_EQ(log.frees, 0);
+
+    cs.restart();
+    std::vector<ojph::ui8> second = encode(cs);
+    EXPECT_EQ(second, first);
+    EXPECT_EQ(log.allocs, 1);
+    EXPECT_EQ(log.frees, 0);
+  }
+  EXPECT_EQ(log.frees, 1);
+  EXPECT_EQ(log.freed, log.allocated);
+  EXPECT_EQ(log.freed_size, log.allocated_size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The same for a decoder, whose store is allocated at create().
+TEST(memory_placement, hooks_allocate_and_free_the_decoder_store)
+{
+  std::vector<ojph::ui8> data;
+  {
+    ojph::codestream cs;
+    data = encode(cs);
+  }
+
+  hook_log log;
+  ojph::mem_store_hooks hooks = make_hooks(log);
+  {
+    ojph::codestream cs;
+    cs.set_fixed_memory_placement(ojph::OJPH_MEM_DEFAULT, &hooks);
+    EXPECT_TRUE(decodes_losslessly(cs, data));
+    EXPECT_EQ(log.allocs, 1);
+    EXPECT_EQ(log.frees, 0);
+  }
+  EXPECT_EQ(log.frees, 1);
+  EXPECT_EQ(log.freed, log.allocated);
+  EXPECT_EQ(log.freed_size, log.allocated_size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Setting the placement again after restart() frees the kept store
+// through the hooks that allocated it.
+TEST(memory_placement, new_placement_frees_the_hooked_store)
+{
+  hook_log log;
+  ojph::mem_store_hooks hooks = make_hooks(log);
+  ojph::codestream cs;
+  cs.set_fixed_memory_placement(ojph::OJPH_MEM_DEFAULT, &hooks);
+  std::vector<ojph::ui8> first = encode(cs);
+  ASSERT_EQ(log.allocs, 1);
+
+  cs.restart();
+  cs.set_fixed_memory_placement(ojph::OJPH_MEM_DEFAULT);
+  EXPECT_EQ(log.frees, 1);
+  EXPECT_EQ(log.freed_size, log.allocated_size);
+
+  std::vector<ojph::ui8> second = encode(cs);
+  EXPECT_EQ(second, first);
+  EXPECT_EQ(log.allocs, 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A hook that fails to allocate makes write_headers() report an error,
+// and nothing is freed.
+TEST(memory_placement, refusing_hook_is_an_error)
+{
+  hook_log log;
+  ojph::mem_store_hooks hooks = make_hooks(log);
+  log.refuse = true;
+  ojph::set_message_level(ojph::OJPH_MSG_NO_MSG);
+  {
+    ojph::codestream cs;
+    cs.set_fixed_memory_placement(ojph::OJPH_MEM_DEFAULT, &hooks);
+    EXPECT_ANY_THROW(encode(cs));
+  }
+  ojph::set_message_level(ojph::OJPH_MSG_ALL_MSG);
+  EXPECT_EQ(log.allocs, 1);
+  EXPECT_EQ(log.frees, 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Every combination of flags encodes and decodes losslessly.  Explicit
+// huge pages (OJPH_MEM_HUGETLB) are refused by the kernel unless some are
+// reserved, which must fall back to transparent huge pages, or to malloc().
+TEST(memory_placement, placement_flags_round_trip)
+{
+  std::vector<ojph::ui8> reference;
+  {
+    ojph::codestream cs;
+    reference = encode(cs);
+  }
+
+  for (ojph::ui32 flags = 1; flags <= (ojph::OJPH_MEM_HUGE_PAGES |
+                                       ojph::OJPH_MEM_HUGETLB |
+                                       ojph::OJPH_MEM_LOCAL_NODE); ++flags)
+  {
+    SCOPED_TRACE(flags);
+    ojph::codestream enc;
+    enc.set_fixed_memory_placement(flags);
+    std::vector<ojph::ui8> data = encode(enc);
+    EXPECT_EQ(data, reference);
+
+    // restart() keeps the store, which must remain usable
+    enc.restart();
+    EXPECT_EQ(encode(enc), reference);
+
+    ojph::codestream dec;
+    dec.set_fixed_memory_placement(flags);
+    EXPECT_TRUE(decodes_losslessly(dec, data));
+  }
+}
+
+} // namespace
@@ -0,0 +1,161 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2026, Aous Naman
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: test_trace.cpp
+// Author: Aous Naman
+// Date: 19 October 2026
+//***************************************************************************/
+//
+// These tests check that trace_start() and trace_stop() write the spans
+// recorded in between, from every thread, and nothing else.
+
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include "ojph_arch.h"
+#include "ojph_codestream.h"
+#include "ojph_file.h"
+#include "ojph_mem.h"
+#include "ojph_params.h"
+#include "ojph_trace.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+static const char trace_name[] = "test_trace.json";
+
+////////////////////////////////////////////////////////////////////////////////
+// Returns the contents of a file.
+static std::string read_file(const char *name)
+{
+  std::string s;
+  FILE *f = fopen(name, "rb");
+  if (f == NULL)
+    return s;
+  char buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+    s.append(buf, n);
+  fclose(f);
+  return s;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Returns the number of times what appears in s.
+static size_t count(const std::string& s, const char *what)
+{
+  size_t n = 0;
+  for (size_t p = s.find(what); p != std::string::npos;
+       p = s.find(what, p + 1))
+    ++n;
+  return n;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Encodes a small single component image into memory.
+static void encode()
+{
+  ojph::codestream cs;
+  ojph::param_siz siz = cs.access_siz();
+  siz.set_image_extent(ojph::point(64, 48));
+  siz.set_num_components(1);
+  siz.set_component(0, ojph::point(1, 1), 8, false);
+  ojph::param_cod cod = cs.access_cod();
+  cod.set_num_decomposition(2);
+  cod.set_block_dims(32, 32);
+  cod.set_reversible(true);
+
+  ojph::mem_outfile out;
+  out.open();
+  cs.write_headers(&out);
+  ojph::ui32 next_comp = 0;
+  ojph::line_buf* line = cs.exchange(NULL, next_comp);
+  for (ojph::ui32 y = 0; y < 48; ++y)
+  {
+    for (ojph::ui32 x = 0; x < 64; ++x)
+      line->i32[x] = (ojph::si32)((x + y) & 0xFF);
+    line = cs.exchange(line, next_comp);
+  }
+  cs.flush();
+  cs.close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Spans are recorded only between trace_start() and trace_stop().
+TEST(trace, records_between_start_and_stop)
+{
+  encode(); // not recorded
+  ASSERT_TRUE(ojph::trace_start(trace_name));
+  EXPECT_TRUE(ojph::trace_is_enabled());
+  encode();
+  {
+    ojph::trace_span span("user_span", "test", "value", 42);
+  }
+  ASSERT_TRUE(ojph::trace_stop());
+  EXPECT_FALSE(ojph::trace_is_enabled());
+  encode(); // not recorded
+
+  std::string s = read_file(trace_name);
+  remove(trace_name);
+  EXPECT_EQ(count(s, "\"traceEvents\""), 1u);
+  EXPECT_EQ(count(s, "\"name\":\"write_headers\""), 1u);
+  EXPECT_EQ(count(s, "\"name\":\"flush\",\"cat\":\"codestream\""), 1u);
+  EXPECT_EQ(count(s, "\"name\":\"push\""), 48u);
+  // 48 lines at each of 2 decomposition levels, and the 12 of the LL band
+  EXPECT_EQ(count(s, "\"name\":\"push_line\""), 48u + 24u + 12u);
+  // one row of codeblocks in the LL band, and in each of the 6 others
+  EXPECT_EQ(count(s, "\"name\":\"encode_row\""), 1u + 6u);
+  EXPECT_EQ(count(s, "\"args\":{\"value\":42}"), 1u);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Each thread has its own track, with its name.
+TEST(trace, records_every_thread)
+{
+  ASSERT_TRUE(ojph::trace_start(trace_name));
+  ojph::trace_set_thread_name("test main");
+  encode();
+  std::thread t([]() {
+    ojph::trace_set_thread_name("test worker");
+    encode();
+  });
+  t.join();
+  ASSERT_TRUE(ojph::trace_stop());
+
+  std::string s = read_file(trace_name);
+  remove(trace_name);
+  EXPECT_EQ(count(s, "\"name\":\"write_headers\""), 2u);
+  EXPECT_EQ(count(s, "{\"name\":\"test main\"}"), 1u);
+  EXPECT_EQ(count(s, "{\"name\":\"test worker\"}"), 1u);
+}
+
+}